@@ -0,0 +1,906 @@
+/** @file
+ * @brief HID report descriptor - format conversion benchmark
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <getopt.h>
+#include "hidrd/util/buf.h"
+#include "hidrd/fmt.h"
+
+/*
+ * Allocation counting, by interposing the glibc allocator; not possible
+ * under AddressSanitizer, which interposes it itself.
+ */
+static size_t   alloc_num;
+
+#ifdef __SANITIZE_ADDRESS__
+#define ALLOC_COUNTING  false
+#else
+#define ALLOC_COUNTING  true
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+void *
+malloc(size_t size)
+{
+    alloc_num++;
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+    alloc_num++;
+    return __libc_calloc(nmemb, size);
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+    alloc_num++;
+    return __libc_realloc(ptr, size);
+}
+
+void
+free(void *ptr)
+{
+    __libc_free(ptr);
+}
+#endif
+
+
+/**
+ * Reset the process peak resident set size, so the next reading covers
+ * only what follows; supported by Linux since 4.0.
+ *
+ * @return True if reset, false if not supported.
+ */
+static bool
+peak_rss_reset(void)
+{
+    int     fd;
+    bool    result;
+
+    fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd < 0)
+        return false;
+    result = (write(fd, "5", 1) == 1);
+    close(fd);
+
+    return result;
+}
+
+
+/**
+ * Retrieve the process peak resident set size.
+ *
+ * @return The peak resident set size in kilobytes, or -1 if unknown.
+ */
+static long
+peak_rss_get(void)
+{
+    FILE   *file;
+    char    line[128];
+    long    kb      = -1;
+
+    file = fopen("/proc/self/status", "r");
+    if (file == NULL)
+        return -1;
+    while (fgets(line, sizeof(line), file) != NULL)
+        if (sscanf(line, "VmHWM: %ld kB", &kb) == 1)
+            break;
+    fclose(file);
+
+    return kb;
+}
+
+
+/**
+ * Retrieve the monotonic time.
+ *
+ * @return The time in seconds.
+ */
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/**
+ * Generate a synthetic native report descriptor: a sequence of
+ * application collections, each with a report ID and nested physical
+ * collections, with the innermost one containing controls.
+ *
+ * @param buf   Buffer to output the descriptor to.
+ * @param size  Minimum descriptor size; the descriptor is extended up to
+ *              the end of the application collection crossing it.
+ * @param depth Collection nesting depth, zero for no collections.
+ *
+ * @return True if generated successfully, false otherwise.
+ */
+static bool
+gen_desc(hidrd_buf *buf, size_t size, unsigned int depth)
+{
+    static const uint8_t    app_open[] = {
+        0x05, 0x01,         /* Usage Page (Desktop) */
+        0x09, 0x02,         /* Usage (Mouse) */
+        0xA1, 0x01,         /* Collection (Application) */
+    };
+    static const uint8_t    phys_open[] = {
+        0x09, 0x01,         /* Usage (Pointer) */
+        0xA1, 0x00,         /* Collection (Physical) */
+    };
+    static const uint8_t    ctrl_list[] = {
+        0x05, 0x09,         /* Usage Page (Button) */
+        0x19, 0x01,         /* Usage Minimum (01h) */
+        0x29, 0x08,         /* Usage Maximum (08h) */
+        0x15, 0x00,         /* Logical Minimum (0) */
+        0x25, 0x01,         /* Logical Maximum (1) */
+        0x75, 0x01,         /* Report Size (1) */
+        0x95, 0x08,         /* Report Count (8) */
+        0x81, 0x02,         /* Input (Variable) */
+        0x05, 0x01,         /* Usage Page (Desktop) */
+        0x09, 0x30,         /* Usage (X) */
+        0x09, 0x31,         /* Usage (Y) */
+        0x16, 0x01, 0x80,   /* Logical Minimum (-32767) */
+        0x26, 0xFF, 0x7F,   /* Logical Maximum (32767) */
+        0x75, 0x10,         /* Report Size (16) */
+        0x95, 0x02,         /* Report Count (2) */
+        0x81, 0x06,         /* Input (Variable, Relative) */
+    };
+    static const uint8_t    end = 0xC0;     /* End Collection */
+    uint8_t                 report_id[2] = {0x85, 0};   /* Report ID */
+    unsigned int            i;
+
+    while (buf->len < size)
+    {
+        if (depth > 0)
+        {
+            report_id[1] = report_id[1] % UINT8_MAX + 1;
+            if (!hidrd_buf_add_ptr(buf, app_open, sizeof(app_open)) ||
+                !hidrd_buf_add_ptr(buf, report_id, sizeof(report_id)))
+                return false;
+        }
+        for (i = 1; i < depth; i++)
+            if (!hidrd_buf_add_ptr(buf, phys_open, sizeof(phys_open)))
+                return false;
+        if (!hidrd_buf_add_ptr(buf, ctrl_list, sizeof(ctrl_list)))
+            return false;
+        for (i = 0; i < depth; i++)
+            if (!hidrd_buf_add_ptr(buf, &end, sizeof(end)))
+                return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Convert a descriptor from one format to another in memory.
+ *
+ * @param src_fmt       Source format.
+ * @param src_opts      Source format options.
+ * @param in_buf        Input buffer.
+ * @param in_size       Input buffer size.
+ * @param snk_fmt       Sink format.
+ * @param snk_opts      Sink format options.
+ * @param pout_buf      Location for the output buffer pointer; the buffer
+ *                      is to be freed by the caller.
+ * @param pout_size     Location for the output size.
+ * @param pitem_num     Location for the number of items transferred.
+ *
+ * @return True if converted successfully, false otherwise.
+ */
+static bool
+convert(const hidrd_fmt    *src_fmt,
+        const char         *src_opts,
+        const void         *in_buf,
+        size_t              in_size,
+        const hidrd_fmt    *snk_fmt,
+        const char         *snk_opts,
+        void              **pout_buf,
+        size_t             *pout_size,
+        size_t             *pitem_num)
+{
+    bool                result      = false;
+    hidrd_src          *src         = NULL;
+    hidrd_snk          *snk         = NULL;
+    const hidrd_item   *item;
+    size_t              item_num    = 0;
+    char               *err         = NULL;
+
+    *pout_buf = NULL;
+    *pout_size = 0;
+
+    src = hidrd_src_new_opts(src_fmt->src, &err, in_buf, in_size, src_opts);
+    if (src == NULL)
+    {
+        fprintf(stderr, "Failed to open %s source:\n%s\n",
+                src_fmt->name, err);
+        goto cleanup;
+    }
+    free(err);
+    err = NULL;
+
+    snk = hidrd_snk_new_opts(snk_fmt->snk, &err,
+                             pout_buf, pout_size, snk_opts);
+    if (snk == NULL)
+    {
+        fprintf(stderr, "Failed to open %s sink:\n%s\n",
+                snk_fmt->name, err);
+        goto cleanup;
+    }
+    free(err);
+    err = NULL;
+
+    while ((item = hidrd_src_get(src)) != NULL)
+    {
+        if (!hidrd_snk_put(snk, item))
+        {
+            fprintf(stderr, "Failed to write %s sink:\n%s\n",
+                    snk_fmt->name, (err = hidrd_snk_errmsg(snk)));
+            goto cleanup;
+        }
+        item_num++;
+    }
+    if (hidrd_src_error(src))
+    {
+        fprintf(stderr, "Failed to read %s source:\n%s\n",
+                src_fmt->name, (err = hidrd_src_errmsg(src)));
+        goto cleanup;
+    }
+
+    if (!hidrd_snk_close(snk))
+    {
+        fprintf(stderr, "Failed to close %s sink:\n%s\n",
+                snk_fmt->name, (err = hidrd_snk_errmsg(snk)));
+        snk = NULL;
+        goto cleanup;
+    }
+    snk = NULL;
+
+    *pitem_num = item_num;
+    result = true;
+
+cleanup:
+
+    free(err);
+    hidrd_snk_delete(snk);
+    hidrd_src_delete(src);
+    if (!result)
+    {
+        free(*pout_buf);
+        *pout_buf = NULL;
+        *pout_size = 0;
+    }
+
+    return result;
+}
+
+
+/** Benchmark output format */
+typedef enum out_fmt {
+    OUT_FMT_CSV,
+    OUT_FMT_JSON,
+} out_fmt;
+
+/** Benchmark parameters */
+typedef struct param {
+    size_t          size;       /**< Minimum descriptor size */
+    unsigned int    depth;      /**< Collection nesting depth */
+    double          time;       /**< Minimum measuring time per pair */
+    size_t          iter_min;   /**< Minimum iterations per pair */
+    out_fmt         out;        /**< Output format */
+    const char    **src_opts;   /**< Source options, per format */
+    const char    **snk_opts;   /**< Sink options, per format */
+} param;
+
+/** Format pair benchmark result */
+typedef struct result {
+    const hidrd_fmt    *src_fmt;    /**< Source format */
+    const hidrd_fmt    *snk_fmt;    /**< Sink format */
+    bool                ok;         /**< True if succeeded */
+    size_t              in_size;    /**< Source input size */
+    size_t              out_size;   /**< Sink output size */
+    size_t              item_num;   /**< Items per conversion */
+    size_t              iter_num;   /**< Number of conversions */
+    double              time;       /**< Time of the conversions */
+    double              alloc_num;  /**< Allocations per conversion, or
+                                         negative if unknown */
+    long                peak_rss;   /**< Peak RSS in kilobytes, or
+                                         negative if unknown */
+} result;
+
+
+/**
+ * Retrieve the index of a format in the format list.
+ *
+ * @param fmt   Format to retrieve the index of.
+ *
+ * @return The format index.
+ */
+static size_t
+fmt_idx(const hidrd_fmt *fmt)
+{
+    size_t  i;
+
+    for (i = 0; hidrd_fmt_list[i] != fmt; i++);
+    return i;
+}
+
+
+/**
+ * Benchmark conversion from one format to another.
+ *
+ * @param res       Result to fill in; formats must be set.
+ * @param p         Benchmark parameters.
+ * @param in_buf    Input in the source format.
+ * @param in_size   Input size.
+ */
+static void
+bench_pair(result *res, const param *p,
+           const void *in_buf, size_t in_size)
+{
+    const char     *src_opts    = p->src_opts[fmt_idx(res->src_fmt)];
+    const char     *snk_opts    = p->snk_opts[fmt_idx(res->snk_fmt)];
+    void           *out_buf;
+    size_t          out_size;
+    size_t          item_num;
+    bool            rss_reset;
+    size_t          alloc_start;
+    double          start;
+
+    res->in_size = in_size;
+
+    /* Warm up, and check the conversion works */
+    if (!convert(res->src_fmt, src_opts, in_buf, in_size,
+                 res->snk_fmt, snk_opts, &out_buf, &out_size, &item_num))
+        return;
+    free(out_buf);
+    res->out_size = out_size;
+    res->item_num = item_num;
+
+    rss_reset = peak_rss_reset();
+    alloc_start = alloc_num;
+    start = now();
+    do {
+        if (!convert(res->src_fmt, src_opts, in_buf, in_size,
+                     res->snk_fmt, snk_opts, &out_buf, &out_size,
+                     &item_num))
+            return;
+        free(out_buf);
+        res->iter_num++;
+        res->time = now() - start;
+    } while (res->iter_num < p->iter_min || res->time < p->time);
+
+    res->alloc_num = ALLOC_COUNTING
+                        ? (double)(alloc_num - alloc_start) / res->iter_num
+                        : -1;
+    res->peak_rss = rss_reset ? peak_rss_get() : -1;
+    res->ok = true;
+}
+
+
+/**
+ * Output a benchmark result.
+ *
+ * @param res   Result to output.
+ * @param p     Benchmark parameters.
+ * @param first True if this is the first result output.
+ *
+ * @return True if output successfully, false otherwise.
+ */
+static bool
+result_print(const result *res, const param *p, bool first)
+{
+    double  time    = (res->time > 0) ? res->time : 1;
+
+    if (p->out == OUT_FMT_CSV)
+        return printf("%s,%s,%zu,%u,%zu,%zu,%zu,%zu,%.6f,%.0f,%.0f,"
+                      "%.1f,%ld,%s\n",
+                      res->src_fmt->name, res->snk_fmt->name,
+                      p->size, p->depth,
+                      res->in_size, res->out_size,
+                      res->item_num, res->iter_num, res->time,
+                      (double)res->item_num * res->iter_num / time,
+                      (double)res->in_size * res->iter_num / time,
+                      res->alloc_num, res->peak_rss,
+                      res->ok ? "ok" : "failed") >= 0;
+    else
+        return printf("%s\n    {\"src\": \"%s\", \"snk\": \"%s\", "
+                      "\"in_bytes\": %zu, \"out_bytes\": %zu, "
+                      "\"items\": %zu, \"iterations\": %zu, "
+                      "\"seconds\": %.6f, \"items_per_s\": %.0f, "
+                      "\"bytes_per_s\": %.0f, \"allocs\": %.1f, "
+                      "\"peak_rss_kb\": %ld, \"ok\": %s}",
+                      first ? "" : ",",
+                      res->src_fmt->name, res->snk_fmt->name,
+                      res->in_size, res->out_size,
+                      res->item_num, res->iter_num, res->time,
+                      (double)res->item_num * res->iter_num / time,
+                      (double)res->in_size * res->iter_num / time,
+                      res->alloc_num, res->peak_rss,
+                      res->ok ? "true" : "false") >= 0;
+}
+
+
+/**
+ * Benchmark conversion between all the selected readable and writable
+ * formats, outputting the results to stdout.
+ *
+ * @param p         Benchmark parameters.
+ * @param src_sel   Source format selection flags, per format.
+ * @param snk_sel   Sink format selection flags, per format.
+ *
+ * @return Program exit status: zero if all the pairs were benchmarked,
+ *         one otherwise.
+ */
+static int
+bench(const param *p, const bool *src_sel, const bool *snk_sel)
+{
+    int                 status      = 1;
+    bool                failed      = false;
+    bool                first       = true;
+    const hidrd_fmt    *natv        = hidrd_fmt_list_lkp("natv");
+    hidrd_buf           desc        = HIDRD_BUF_EMPTY;
+    void               *in_buf      = NULL;
+    size_t              in_size;
+    size_t              item_num;
+    const hidrd_fmt   **psrc;
+    const hidrd_fmt   **psnk;
+    result              res;
+
+    if (!gen_desc(&desc, p->size, p->depth))
+    {
+        fprintf(stderr, "Failed to generate descriptor\n");
+        goto cleanup;
+    }
+
+    if (p->out == OUT_FMT_CSV)
+    {
+        if (printf("src,snk,desc_size,depth,in_bytes,out_bytes,items,"
+                   "iterations,seconds,items_per_s,bytes_per_s,"
+                   "allocs,peak_rss_kb,status\n") < 0)
+            goto cleanup;
+    }
+    else if (printf("{\"desc_size\": %zu, \"depth\": %u, "
+                    "\"native_bytes\": %zu, \"results\": [",
+                    p->size, p->depth, desc.len) < 0)
+        goto cleanup;
+
+    for (psrc = hidrd_fmt_list; *psrc != NULL; psrc++)
+    {
+        if (!src_sel[psrc - hidrd_fmt_list] || !hidrd_fmt_readable(*psrc))
+            continue;
+
+        /* Produce the input in the source format */
+        if (!hidrd_fmt_writable(*psrc) ||
+            !convert(natv, "", desc.ptr, desc.len,
+                     *psrc, p->snk_opts[psrc - hidrd_fmt_list],
+                     &in_buf, &in_size, &item_num))
+        {
+            fprintf(stderr, "Failed to produce %s input\n", (*psrc)->name);
+            failed = true;
+            continue;
+        }
+
+        for (psnk = hidrd_fmt_list; *psnk != NULL; psnk++)
+        {
+            if (!snk_sel[psnk - hidrd_fmt_list] ||
+                !hidrd_fmt_writable(*psnk))
+                continue;
+
+            memset(&res, 0, sizeof(res));
+            res.src_fmt = *psrc;
+            res.snk_fmt = *psnk;
+            res.alloc_num = -1;
+            res.peak_rss = -1;
+            bench_pair(&res, p, in_buf, in_size);
+            if (!res.ok)
+            {
+                fprintf(stderr, "Failed to benchmark %s to %s\n",
+                        (*psrc)->name, (*psnk)->name);
+                failed = true;
+            }
+            if (!result_print(&res, p, first))
+                goto cleanup;
+            fflush(stdout);
+            first = false;
+        }
+
+        free(in_buf);
+        in_buf = NULL;
+    }
+
+    if (p->out == OUT_FMT_JSON && printf("\n]}\n") < 0)
+        goto cleanup;
+
+    if (first)
+    {
+        fprintf(stderr, "No format pairs selected\n");
+        failed = true;
+    }
+
+    status = failed ? 1 : 0;
+
+cleanup:
+
+    free(in_buf);
+    hidrd_buf_clnp(&desc);
+
+    return status;
+}
+
+
+static bool
+usage(FILE *stream, const char *progname)
+{
+    return fprintf(
+            stream,
+            "Usage: %s [OPTION]...\n"
+            "Benchmark HID report descriptor conversion between every\n"
+            "readable and every writable format, using a synthetic\n"
+            "descriptor, and output the results as CSV or JSON.\n"
+            "\n"
+            "Options:\n"
+            "  -h, --help                       this help message\n"
+            "  -s, --size=BYTES                 generate a native descriptor\n"
+            "                                   of at least BYTES bytes\n"
+            "                                   (4096 by default)\n"
+            "  -d, --depth=NUM                  nest collections NUM deep\n"
+            "                                   (4 by default)\n"
+            "  -t, --time=SECONDS               measure each pair for at\n"
+            "                                   least SECONDS (0.5 by\n"
+            "                                   default)\n"
+            "  -n, --iterations=NUM             convert at least NUM times\n"
+            "                                   per pair (1 by default)\n"
+            "  -i, --input-formats=LIST         benchmark only the comma-\n"
+            "                                   separated input formats\n"
+            "  -o, --output-formats=LIST        benchmark only the comma-\n"
+            "                                   separated output formats\n"
+            "  --io=FORMAT:LIST, --input-options=FORMAT:LIST\n"
+            "                                   use LIST FORMAT input\n"
+            "                                   options\n"
+            "  --oo=FORMAT:LIST, --output-options=FORMAT:LIST\n"
+            "                                   use LIST FORMAT output\n"
+            "                                   options\n"
+            "  -j, --json                       output JSON instead of CSV\n"
+            "\n"
+            "Throughput is measured in items and input bytes per second,\n"
+            "allocations are counted per conversion, and peak resident\n"
+            "set size is measured per pair, in kilobytes; -1 stands for\n"
+            "unavailable measurements.\n"
+            "\n",
+            progname) >= 0;
+}
+
+
+/**
+ * Parse a format selection list.
+ *
+ * @param list  Comma-separated format name list.
+ * @param sel   Format selection flags to set, per format.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+parse_fmt_sel(const char *list, bool *sel)
+{
+    const char         *p;
+    const char         *end;
+    const hidrd_fmt   **pfmt;
+
+    memset(sel, 0, sizeof(*sel) * fmt_idx(NULL));
+
+    for (p = list; ; p = end + 1)
+    {
+        end = strchrnul(p, ',');
+        for (pfmt = hidrd_fmt_list; *pfmt != NULL; pfmt++)
+            if (strlen((*pfmt)->name) == (size_t)(end - p) &&
+                strncmp((*pfmt)->name, p, end - p) == 0)
+                break;
+        if (*pfmt == NULL)
+        {
+            fprintf(stderr, "Unknown format \"%.*s\"\n", (int)(end - p), p);
+            return false;
+        }
+        sel[pfmt - hidrd_fmt_list] = true;
+        if (*end == '\0')
+            return true;
+    }
+}
+
+
+/**
+ * Parse a format options specification.
+ *
+ * @param spec      Options specification: format name, colon, and
+ *                  options list.
+ * @param opts      Options to set, per format.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+parse_fmt_opts(const char *spec, const char **opts)
+{
+    const char         *colon;
+    const hidrd_fmt   **pfmt;
+
+    colon = strchr(spec, ':');
+    if (colon == NULL)
+    {
+        fprintf(stderr, "Format options \"%s\" lack \"FORMAT:\" prefix\n",
+                spec);
+        return false;
+    }
+    for (pfmt = hidrd_fmt_list; *pfmt != NULL; pfmt++)
+        if (strlen((*pfmt)->name) == (size_t)(colon - spec) &&
+            strncmp((*pfmt)->name, spec, colon - spec) == 0)
+        {
+            opts[pfmt - hidrd_fmt_list] = colon + 1;
+            return true;
+        }
+
+    fprintf(stderr, "Unknown format \"%.*s\"\n", (int)(colon - spec), spec);
+    return false;
+}
+
+
+typedef enum opt_val {
+    /* Long and short options */
+    OPT_VAL_HELP            = 'h',
+    OPT_VAL_SIZE            = 's',
+    OPT_VAL_DEPTH           = 'd',
+    OPT_VAL_TIME            = 't',
+    OPT_VAL_ITERATIONS      = 'n',
+    OPT_VAL_INPUT_FORMATS   = 'i',
+    OPT_VAL_OUTPUT_FORMATS  = 'o',
+    OPT_VAL_JSON            = 'j',
+
+    /* Long options only */
+    OPT_VAL_INPUT_OPTIONS   = UINT8_MAX + 1,
+    OPT_VAL_OUTPUT_OPTIONS,
+} opt_val;
+
+int
+main(int argc, char **argv)
+{
+    static const struct option long_opt_list[] = {
+        {.val       = OPT_VAL_HELP,
+         .name      = "help",
+         .has_arg   = no_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_SIZE,
+         .name      = "size",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_DEPTH,
+         .name      = "depth",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_TIME,
+         .name      = "time",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_ITERATIONS,
+         .name      = "iterations",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_INPUT_FORMATS,
+         .name      = "input-formats",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_OUTPUT_FORMATS,
+         .name      = "output-formats",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_INPUT_OPTIONS,
+         .name      = "input-options",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_INPUT_OPTIONS,
+         .name      = "io",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_OUTPUT_OPTIONS,
+         .name      = "output-options",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_OUTPUT_OPTIONS,
+         .name      = "oo",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_JSON,
+         .name      = "json",
+         .has_arg   = no_argument,
+         .flag      = NULL},
+
+        {.val       = 0,
+         .name      = NULL,
+         .has_arg   = 0,
+         .flag      = NULL}
+    };
+    static const char  *short_opt_list = "hs:d:t:n:i:o:j";
+
+    int                 result      = 1;
+    size_t              fmt_num     = fmt_idx(NULL);
+    bool                src_sel[fmt_num];
+    bool                snk_sel[fmt_num];
+    const char         *src_opts[fmt_num];
+    const char         *snk_opts[fmt_num];
+    bool                fmt_init[fmt_num];
+    param               p;
+    char               *end;
+    unsigned long       num;
+    size_t              i;
+    int                 c;
+
+    memset(&p, 0, sizeof(p));
+    p.size = 4096;
+    p.depth = 4;
+    p.time = 0.5;
+    p.iter_min = 1;
+    p.out = OUT_FMT_CSV;
+    p.src_opts = src_opts;
+    p.snk_opts = snk_opts;
+    for (i = 0; i < fmt_num; i++)
+    {
+        src_sel[i] = true;
+        snk_sel[i] = true;
+        src_opts[i] = "";
+        snk_opts[i] = "";
+        fmt_init[i] = false;
+    }
+
+    /*
+     * Parse command line arguments
+     */
+    while ((c = getopt_long(argc, argv,
+                            short_opt_list, long_opt_list, NULL)) >= 0)
+    {
+        switch (c)
+        {
+            case OPT_VAL_HELP:
+                usage(stdout, program_invocation_short_name);
+                return 0;
+                break;
+            case OPT_VAL_SIZE:
+            case OPT_VAL_DEPTH:
+            case OPT_VAL_ITERATIONS:
+                errno = 0;
+                num = strtoul(optarg, &end, 10);
+                if (errno != 0 || *optarg == '\0' || *end != '\0' ||
+                    *optarg == '-' || num > UINT_MAX ||
+                    (num == 0 && c != OPT_VAL_DEPTH))
+                {
+                    fprintf(stderr, "Invalid number \"%s\"\n", optarg);
+                    usage(stderr, program_invocation_short_name);
+                    return 1;
+                }
+                if (c == OPT_VAL_SIZE)
+                    p.size = num;
+                else if (c == OPT_VAL_DEPTH)
+                    p.depth = num;
+                else
+                    p.iter_min = num;
+                break;
+            case OPT_VAL_TIME:
+                errno = 0;
+                p.time = strtod(optarg, &end);
+                if (errno != 0 || *optarg == '\0' || *end != '\0' ||
+                    !(p.time >= 0))
+                {
+                    fprintf(stderr, "Invalid time \"%s\"\n", optarg);
+                    usage(stderr, program_invocation_short_name);
+                    return 1;
+                }
+                break;
+            case OPT_VAL_INPUT_FORMATS:
+                if (!parse_fmt_sel(optarg, src_sel))
+                    return 1;
+                break;
+            case OPT_VAL_OUTPUT_FORMATS:
+                if (!parse_fmt_sel(optarg, snk_sel))
+                    return 1;
+                break;
+            case OPT_VAL_INPUT_OPTIONS:
+                if (!parse_fmt_opts(optarg, src_opts))
+                    return 1;
+                break;
+            case OPT_VAL_OUTPUT_OPTIONS:
+                if (!parse_fmt_opts(optarg, snk_opts))
+                    return 1;
+                break;
+            case OPT_VAL_JSON:
+                p.out = OUT_FMT_JSON;
+                break;
+            case '?':
+                usage(stderr, program_invocation_short_name);
+                return 1;
+                break;
+        }
+    }
+
+    if (optind < argc)
+    {
+        fprintf(stderr, "Too many arguments\n");
+        usage(stderr, program_invocation_short_name);
+        return 1;
+    }
+
+    /*
+     * Initialize the formats involved; native is used for input
+     * generation
+     */
+    for (i = 0; i < fmt_num; i++)
+    {
+        if (!src_sel[i] && !snk_sel[i] &&
+            strcmp(hidrd_fmt_list[i]->name, "natv") != 0)
+            continue;
+        if (!hidrd_fmt_init(hidrd_fmt_list[i]))
+        {
+            fprintf(stderr, "Failed to initialize %s format\n",
+                    hidrd_fmt_list[i]->name);
+            goto cleanup;
+        }
+        fmt_init[i] = true;
+    }
+
+    /*
+     * Run
+     */
+    result = bench(&p, src_sel, snk_sel);
+
+cleanup:
+
+    for (i = 0; i < fmt_num; i++)
+        if (fmt_init[i])
+            hidrd_fmt_clnp(hidrd_fmt_list[i]);
+
+    return result;
+}
@@ -62,4 +62,7 @@ dnl
 /** Defined if source code format is supported */
 #'WITH_CODE_DIRECTIVE()` HIDRD_FMT_WITH_CODE
 
+/** Defined if JSON format is supported */
+#'WITH_JSON_DIRECTIVE()` HIDRD_FMT_WITH_JSON
+
 #endif /* __HIDRD_FMT_CFG_H__ */'
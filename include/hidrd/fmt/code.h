@@ -27,6 +27,7 @@
 
 #include "hidrd/fmt/inst.h"
 #include "hidrd/fmt/code/snk.h"
+#include "hidrd/fmt/code/src.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +39,11 @@ typedef struct hidrd_code_snk_inst {
     hidrd_spec_snk_inst     spec_snk;   /**< Parent structure */
     bool                    indent;     /**< "Indent enabled" flag */
     bool                    comments;   /**< "Comments enabled" flag */
+    bool                    accessors;  /**< "Report accessors enabled"
+                                             flag */
+    char                   *prefix;     /**< Accessor name prefix */
+    char                   *err;        /**< Report layout compilation
+                                             error message, or NULL */
 } hidrd_code_snk_inst;
 
 #ifdef __cplusplus
@@ -0,0 +1,69 @@
+/** @file
+ * @brief HID report descriptor - source code source
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_FMT_CODE_SRC_H__
+#define __HIDRD_FMT_CODE_SRC_H__
+
+#include "hidrd/strm/src/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Source code source type */
+extern const hidrd_src_type hidrd_code_src;
+
+/** Source code source error code */
+typedef enum hidrd_code_src_err {
+    HIDRD_CODE_SRC_ERR_NONE,    /**< No error */
+    HIDRD_CODE_SRC_ERR_TOKEN,   /**< Unexpected token encountered */
+    HIDRD_CODE_SRC_ERR_NUM,     /**< Invalid byte literal encountered */
+    HIDRD_CODE_SRC_ERR_COMMENT, /**< Unterminated comment encountered */
+    HIDRD_CODE_SRC_ERR_ARRAY,   /**< Array initializer not found or
+                                     unterminated */
+    HIDRD_CODE_SRC_ERR_SHORT,   /**< Item buffer ended prematurely */
+    HIDRD_CODE_SRC_ERR_INVALID  /**< Invalid item encountered */
+} hidrd_code_src_err;
+
+/** Source code source instance */
+typedef struct hidrd_code_src_inst {
+    hidrd_src           src;        /**< Parent structure */
+    size_t              pos;        /**< Stream position */
+    size_t              line;       /**< Stream position line */
+    size_t              line_pos;   /**< Stream position of the line
+                                         start */
+    bool                started;    /**< The byte list start is located */
+    bool                ended;      /**< The byte list end is reached */
+    size_t              depth;      /**< Initializer brace nesting depth,
+                                         zero for a bare byte list */
+    uint8_t             buf[HIDRD_ITEM_MAX_SIZE];   /**< Item buffer */
+    size_t              len;        /**< Length of data in the buffer */
+    hidrd_code_src_err  err;        /**< Last error code */
+} hidrd_code_src_inst;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_FMT_CODE_SRC_H__ */
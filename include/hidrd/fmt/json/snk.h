@@ -0,0 +1,67 @@
+/** @file
+ * @brief HID report descriptor - JSON stream sink
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_FMT_JSON_SNK_H__
+#define __HIDRD_FMT_JSON_SNK_H__
+
+#include "hidrd/strm/snk/inst.h"
+#include "hidrd/util/buf.h"
+#include "hidrd/util/memo.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** JSON sink type */
+extern const hidrd_snk_type    hidrd_json_snk;
+
+/** JSON sink error code */
+typedef enum hidrd_json_snk_err {
+    HIDRD_JSON_SNK_ERR_NONE,    /**< No error */
+    HIDRD_JSON_SNK_ERR_ALLOC    /**< Memory allocation failure */
+} hidrd_json_snk_err;
+
+/** JSON sink instance */
+typedef struct hidrd_json_snk_inst {
+    hidrd_snk           snk;        /**< Parent structure */
+    bool                format;     /**< Format option flag */
+    bool                tokens;     /**< Tokens option flag */
+    hidrd_buf           buf;        /**< Output buffer, without the
+                                         closing brackets */
+    hidrd_buf           groups;     /**< Open group stack, one group
+                                         code byte per level */
+    hidrd_buf           pages;      /**< Usage page stack, pushed on
+                                         push items */
+    hidrd_usage_page    usage_page; /**< Usage page in effect */
+    bool                first;      /**< True if no elements were output
+                                         at the current level yet */
+    hidrd_memo          memo;       /**< Token cache */
+    hidrd_json_snk_err  err;        /**< Last error code */
+} hidrd_json_snk_inst;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_FMT_JSON_SNK_H__ */
@@ -0,0 +1,78 @@
+/** @file
+ * @brief HID report descriptor - JSON stream source
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_FMT_JSON_SRC_H__
+#define __HIDRD_FMT_JSON_SRC_H__
+
+#include "hidrd/strm/src/inst.h"
+#include "hidrd/util/buf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** JSON source type */
+extern const hidrd_src_type hidrd_json_src;
+
+/** JSON source error code */
+typedef enum hidrd_json_src_err {
+    HIDRD_JSON_SRC_ERR_NONE,        /**< No error */
+    HIDRD_JSON_SRC_ERR_ALLOC,       /**< Memory allocation failure */
+    HIDRD_JSON_SRC_ERR_SYNTAX,      /**< Invalid JSON syntax */
+    HIDRD_JSON_SRC_ERR_ELEMENT,     /**< Unknown element */
+    HIDRD_JSON_SRC_ERR_MEMBER,      /**< Unknown or missing element
+                                         member */
+    HIDRD_JSON_SRC_ERR_VALUE,       /**< Invalid element value */
+    HIDRD_JSON_SRC_ERR_INVALID      /**< Invalid item encountered */
+} hidrd_json_src_err;
+
+/** JSON source instance */
+typedef struct hidrd_json_src_inst {
+    hidrd_src           src;        /**< Parent structure */
+    size_t              pos;        /**< Stream position */
+    size_t              line;       /**< Stream position line */
+    size_t              line_pos;   /**< Stream position of the line
+                                         start */
+    hidrd_buf           str;        /**< Last string or number token,
+                                         decoded and zero-terminated */
+    hidrd_buf           groups;     /**< Open group stack, one group
+                                         code byte per level */
+    hidrd_buf           pages;      /**< Usage page stack, pushed on
+                                         push items */
+    hidrd_usage_page    usage_page; /**< Usage page in effect */
+    bool                started;    /**< True if the descriptor array
+                                         was opened */
+    bool                ended;      /**< True if the descriptor array
+                                         was closed */
+    bool                first;      /**< True if no elements were read
+                                         at the current level yet */
+    uint8_t             item[HIDRD_ITEM_MAX_SIZE];  /**< Item buffer */
+    hidrd_json_src_err  err;        /**< Last error code */
+} hidrd_json_src_inst;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_FMT_JSON_SRC_H__ */
@@ -28,6 +28,7 @@
 #include "hidrd/fmt/inst.h"
 #include "hidrd/fmt/natv/src.h"
 #include "hidrd/fmt/natv/snk.h"
+#include "hidrd/fmt/natv/arc.h"
 
 #ifdef __cplusplus
 extern "C" {
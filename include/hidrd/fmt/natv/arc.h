@@ -0,0 +1,299 @@
+/** @file
+ * @brief HID report descriptor - native descriptor archive
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_FMT_NATV_ARC_H__
+#define __HIDRD_FMT_NATV_ARC_H__
+
+#include "hidrd/util/buf.h"
+#include "hidrd/fmt/natv/src.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Native descriptor archive file magic, including the terminating zero */
+#define HIDRD_NATV_ARC_MAGIC    "HIDRDNA"
+
+/**
+ * Native descriptor archive file format version; files are stored in the
+ * native byte order, so files of the other byte order fail the version
+ * check.
+ */
+#define HIDRD_NATV_ARC_VERSION  1
+
+/**
+ * Native descriptor archive file header.
+ *
+ * The file is a single block without any pointers, consisting of this
+ * header followed by the entry list, the zero-terminated entry names and
+ * the native descriptors. Entries are sorted by name hash, then by name,
+ * so an entry can be found with a binary search. Identical descriptors
+ * are stored once, and shared by all the entries having them.
+ */
+typedef struct hidrd_natv_arc_hdr {
+    char        magic[8];       /**< HIDRD_NATV_ARC_MAGIC */
+    uint32_t    version;        /**< HIDRD_NATV_ARC_VERSION */
+    uint32_t    size;           /**< Size of the whole file, in bytes */
+    uint32_t    ent_off;        /**< Entry list offset, in bytes */
+    uint32_t    ent_num;        /**< Number of entries */
+    uint32_t    desc_num;       /**< Number of distinct descriptors */
+    uint32_t    reserved;       /**< Reserved, zero */
+} hidrd_natv_arc_hdr;
+
+/** Native descriptor archive entry */
+typedef struct hidrd_natv_arc_ent {
+    uint64_t    hash;           /**< Name hash */
+    uint32_t    name_off;       /**< Name offset, in bytes */
+    uint32_t    name_len;       /**< Name length, excluding the
+                                     terminating zero */
+    uint32_t    desc_off;       /**< Native descriptor offset, in bytes */
+    uint32_t    desc_size;      /**< Native descriptor size, in bytes */
+    uint16_t    vid;            /**< Device vendor ID, or zero if
+                                     unknown */
+    uint16_t    pid;            /**< Device product ID, or zero if
+                                     unknown */
+    uint32_t    reserved;       /**< Reserved, zero */
+} hidrd_natv_arc_ent;
+
+/** Loaded (mapped) native descriptor archive */
+typedef struct hidrd_natv_arc {
+    const hidrd_natv_arc_hdr   *hdr;    /**< Mapped file */
+    size_t                      size;   /**< Mapped size */
+} hidrd_natv_arc;
+
+/** Empty (unloaded) native descriptor archive initializer */
+#define HIDRD_NATV_ARC_EMPTY    {.hdr = NULL, .size = 0}
+
+/** Native descriptor archive builder */
+typedef struct hidrd_natv_arc_bld {
+    hidrd_buf   ent;    /**< Builder entry list */
+} hidrd_natv_arc_bld;
+
+/**
+ * Load a native descriptor archive file, mapping it read-only into
+ * memory.
+ *
+ * The file is never modified in place, so it can be loaded by several
+ * processes at once, while being replaced with hidrd_natv_arc_store.
+ *
+ * @param arc   Location for the loaded archive.
+ * @param path  Archive file path.
+ *
+ * @return True if loaded successfully, false otherwise (see errno in this
+ *         case; EINVAL means the file format is invalid).
+ */
+extern bool hidrd_natv_arc_load(hidrd_natv_arc *arc, const char *path);
+
+/**
+ * Check if a loaded native descriptor archive is valid.
+ *
+ * @param arc   Archive to check.
+ *
+ * @return True if the archive is valid, false otherwise.
+ */
+extern bool hidrd_natv_arc_valid(const hidrd_natv_arc *arc);
+
+/**
+ * Unload a native descriptor archive, unmapping the file; the entries
+ * retrieved from it and the sources opened over them become invalid.
+ *
+ * @param arc   Archive to unload, could be empty.
+ */
+extern void hidrd_natv_arc_unload(hidrd_natv_arc *arc);
+
+/**
+ * Retrieve a native descriptor archive entry by index, checking its
+ * bounds.
+ *
+ * @param arc   Archive to retrieve the entry from.
+ * @param idx   Entry index, in name hash order.
+ *
+ * @return The entry, pointing into the archive mapping, or NULL if the
+ *         index is out of range or the entry is invalid.
+ */
+extern const hidrd_natv_arc_ent *hidrd_natv_arc_get(
+                                        const hidrd_natv_arc   *arc,
+                                        size_t                  idx);
+
+/**
+ * Lookup a native descriptor archive entry by name.
+ *
+ * Costs a hash of the name and a binary search over the entry list;
+ * there is no parsing or copying.
+ *
+ * @param arc   Archive to lookup in.
+ * @param name  Entry name.
+ *
+ * @return The entry, pointing into the archive mapping, or NULL if not
+ *         found or the entry is invalid.
+ */
+extern const hidrd_natv_arc_ent *hidrd_natv_arc_lookup(
+                                        const hidrd_natv_arc   *arc,
+                                        const char             *name);
+
+/**
+ * Check if a native descriptor archive entry is valid, i.e. its name and
+ * descriptor are within the archive.
+ *
+ * @param arc   Archive containing the entry.
+ * @param ent   Entry to check.
+ *
+ * @return True if the entry is valid, false otherwise.
+ */
+extern bool hidrd_natv_arc_ent_valid(const hidrd_natv_arc      *arc,
+                                     const hidrd_natv_arc_ent  *ent);
+
+/**
+ * Retrieve the name of a native descriptor archive entry.
+ *
+ * @param arc   Archive containing the entry.
+ * @param ent   Valid entry to retrieve the name of.
+ *
+ * @return Zero-terminated entry name, pointing into the archive mapping.
+ */
+extern const char *hidrd_natv_arc_ent_name(
+                                    const hidrd_natv_arc       *arc,
+                                    const hidrd_natv_arc_ent   *ent);
+
+/**
+ * Retrieve the native descriptor of a native descriptor archive entry.
+ *
+ * @param arc   Archive containing the entry.
+ * @param ent   Valid entry to retrieve the descriptor of.
+ *
+ * @return The descriptor, pointing into the archive mapping; its size is
+ *         ent->desc_size.
+ */
+extern const void *hidrd_natv_arc_ent_desc(
+                                    const hidrd_natv_arc       *arc,
+                                    const hidrd_natv_arc_ent   *ent);
+
+/**
+ * Create a native source reading a native descriptor archive entry
+ * descriptor in place.
+ *
+ * @param arc   Archive containing the entry.
+ * @param ent   Valid entry to read the descriptor of.
+ * @param perr  Location for a dynamically allocated error message pointer,
+ *              in case the creation failed, or for a dynamically allocated
+ *              empty string otherwise; could be NULL.
+ *
+ * @return Created source, valid until the archive is unloaded, or NULL,
+ *         if failed to allocate or initialize.
+ */
+extern hidrd_src *hidrd_natv_arc_src_new(const hidrd_natv_arc      *arc,
+                                         const hidrd_natv_arc_ent  *ent,
+                                         char                     **perr);
+
+/**
+ * Initialize a native source reading a native descriptor archive entry
+ * descriptor in place, in caller-provided storage; nothing is allocated
+ * or copied.
+ *
+ * @param mem   Storage for the source instance.
+ * @param arc   Archive containing the entry.
+ * @param ent   Valid entry to read the descriptor of.
+ *
+ * @return Initialized source, located at mem and valid until the archive
+ *         is unloaded; must be cleaned up with hidrd_src_clnp.
+ */
+extern hidrd_src *hidrd_natv_arc_src_init(
+                                    hidrd_natv_src_inst        *mem,
+                                    const hidrd_natv_arc       *arc,
+                                    const hidrd_natv_arc_ent   *ent);
+
+/**
+ * Initialize a native descriptor archive builder.
+ *
+ * @param bld   Builder to initialize.
+ */
+extern void hidrd_natv_arc_bld_init(hidrd_natv_arc_bld *bld);
+
+/**
+ * Check if a native descriptor archive builder is valid.
+ *
+ * @param bld   Builder to check.
+ *
+ * @return True if the builder is valid, false otherwise.
+ */
+extern bool hidrd_natv_arc_bld_valid(const hidrd_natv_arc_bld *bld);
+
+/**
+ * Add an entry to a native descriptor archive builder, copying the name
+ * and the descriptor; an entry added later replaces an entry with the
+ * same name added earlier.
+ *
+ * @param bld   Builder to add to.
+ * @param name  Entry name, e.g. the descriptor source path.
+ * @param desc  Native descriptor.
+ * @param size  Native descriptor size.
+ * @param vid   Device vendor ID, or zero if unknown.
+ * @param pid   Device product ID, or zero if unknown.
+ *
+ * @return True if added successfully, false if failed to allocate memory.
+ */
+extern bool hidrd_natv_arc_bld_add(hidrd_natv_arc_bld  *bld,
+                                   const char          *name,
+                                   const void          *desc,
+                                   size_t               size,
+                                   uint16_t             vid,
+                                   uint16_t             pid);
+
+/**
+ * Add all valid entries of a loaded native descriptor archive to a
+ * native descriptor archive builder.
+ *
+ * @param bld   Builder to add to.
+ * @param arc   Archive to add the entries of.
+ *
+ * @return True if added successfully, false if failed to allocate memory.
+ */
+extern bool hidrd_natv_arc_bld_add_arc(hidrd_natv_arc_bld      *bld,
+                                       const hidrd_natv_arc    *arc);
+
+/**
+ * Store the contents of a native descriptor archive builder to an archive
+ * file, atomically replacing it.
+ *
+ * @param bld   Builder to store.
+ * @param path  Archive file path.
+ *
+ * @return True if stored successfully, false otherwise (see errno in this
+ *         case).
+ */
+extern bool hidrd_natv_arc_store(const hidrd_natv_arc_bld  *bld,
+                                 const char                *path);
+
+/**
+ * Cleanup a native descriptor archive builder.
+ *
+ * @param bld   Builder to cleanup.
+ */
+extern void hidrd_natv_arc_bld_clnp(hidrd_natv_arc_bld *bld);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_FMT_NATV_ARC_H__ */
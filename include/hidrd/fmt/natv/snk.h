@@ -34,19 +34,32 @@ extern "C" {
 /** Native sink type */
 extern const hidrd_snk_type hidrd_natv_snk;
 
+/**
+ * Fixed buffer native sink type: writes the items into the
+ * caller-provided buffer at *pbuf, *psize bytes long, which is never
+ * reallocated - running out of space fails with
+ * HIDRD_NATV_SNK_ERR_OVERFLOW, and *psize receives the written size on
+ * flush. Takes no type-specific initialization arguments. The same mode
+ * is available with the "fixed" option of the native sink type.
+ */
+extern const hidrd_snk_type hidrd_natv_fixed_snk;
+
 /** Native sink error code */
 typedef enum hidrd_natv_snk_err {
     HIDRD_NATV_SNK_ERR_NONE,    /**< No error */
-    HIDRD_NATV_SNK_ERR_ALLOC    /**< Memory allocation failure */
+    HIDRD_NATV_SNK_ERR_ALLOC,   /**< Memory allocation failure */
+    HIDRD_NATV_SNK_ERR_OVERFLOW /**< Fixed buffer overflow */
 } hidrd_natv_snk_err;
 
-/** Native sink instance */
+/** Native sink instance, of both native sink types */
 typedef struct hidrd_natv_snk_inst {
     hidrd_snk           snk;    /**< Parent structure */
     void               *buf;    /**< Buffer pointer */
     size_t              size;   /**< Stream size in bytes */
     size_t              alloc;  /**< Buffer size in bytes */
     size_t              pos;    /**< Stream position in bytes */
+    bool                fixed;  /**< True if the buffer is fixed, i.e.
+                                     is never reallocated */
     hidrd_natv_snk_err  err;    /**< Last error code */
 } hidrd_natv_snk_inst;
 
@@ -26,6 +26,7 @@
 #define __HIDRD_FMT_SPEC_H__
 
 #include "hidrd/fmt/inst.h"
+#include "hidrd/fmt/spec/src.h"
 #include "hidrd/fmt/spec/snk.h"
 
 #ifdef __cplusplus
@@ -25,6 +25,8 @@
 #ifndef __HIDRD_FMT_SPEC_SNK_H__
 #define __HIDRD_FMT_SPEC_SNK_H__
 
+#include "hidrd/util/buf.h"
+#include "hidrd/util/memo.h"
 #include "hidrd/strm/snk/inst.h"
 #include "hidrd/fmt/spec/snk/ent_list.h"
 
@@ -75,6 +77,10 @@ typedef struct hidrd_spec_snk_inst {
     hidrd_spec_snk_state       *state;      /**< Item state table stack */
 
     hidrd_spec_snk_ent_list     list;       /**< Entry list */
+    hidrd_buf                   fmt;        /**< Value formatting scratch
+                                                 buffer */
+    hidrd_memo                  memo;       /**< Token and description
+                                                 cache */
     hidrd_spec_snk_err          err;        /**< Last error code */
 } hidrd_spec_snk_inst;
 
@@ -0,0 +1,71 @@
+/** @file
+ * @brief HID report descriptor - specification example source
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_FMT_SPEC_SRC_H__
+#define __HIDRD_FMT_SPEC_SRC_H__
+
+#include "hidrd/util/buf.h"
+#include "hidrd/usage/page_desc.h"
+#include "hidrd/strm/src/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Specification example source type */
+extern const hidrd_src_type hidrd_spec_src;
+
+/** Specification example source error code */
+typedef enum hidrd_spec_src_err {
+    HIDRD_SPEC_SRC_ERR_NONE,    /**< No error */
+    HIDRD_SPEC_SRC_ERR_ALLOC,   /**< Memory allocation failure */
+    HIDRD_SPEC_SRC_ERR_SYNTAX,  /**< Invalid syntax */
+    HIDRD_SPEC_SRC_ERR_NAME,    /**< Unknown item name */
+    HIDRD_SPEC_SRC_ERR_VALUE,   /**< Invalid item value */
+    HIDRD_SPEC_SRC_ERR_INVALID  /**< Invalid item */
+} hidrd_spec_src_err;
+
+/** Specification example source instance */
+typedef struct hidrd_spec_src_inst {
+    hidrd_src                       src;        /**< Parent structure */
+    size_t                          pos;        /**< Stream position */
+    size_t                          line;       /**< Stream position line */
+    size_t                          line_pos;   /**< Stream position of the
+                                                     line start */
+    hidrd_usage_page                usage_page; /**< Usage page in effect */
+    const hidrd_usage_page_desc    *page_desc;  /**< Description of the
+                                                     usage page in effect,
+                                                     or NULL if unknown */
+    hidrd_buf                       pages;      /**< Pushed usage page
+                                                     stack */
+    uint8_t                         item[HIDRD_ITEM_MAX_SIZE];
+                                                /**< Item buffer */
+    hidrd_spec_src_err              err;        /**< Last error code */
+} hidrd_spec_src_inst;
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_FMT_SPEC_SRC_H__ */
@@ -26,6 +26,8 @@
 #define __HIDRD_FMT_XML_SNK_H__
 
 #include "libxml/tree.h"
+#include "hidrd/util/buf.h"
+#include "hidrd/util/memo.h"
 #include "hidrd/strm/snk/inst.h"
 
 #ifdef __cplusplus
@@ -44,14 +46,20 @@ struct hidrd_xml_snk_state {
 
 /** XML sink instance */
 typedef struct hidrd_xml_snk_inst {
-    hidrd_snk               snk;    /**< Parent structure */
-    bool                    format; /**< Format option flag */
-    char                   *schema; /**< Schema file path */
-    xmlDocPtr               doc;    /**< Document being built */
-    xmlNodePtr              prnt;   /**< Current parent element */
-    xmlNodePtr              cur;    /**< Current element */
-    hidrd_xml_snk_state    *state;  /**< Item state table stack */
-    char                   *err;    /**< Last error message */
+    hidrd_snk               snk;        /**< Parent structure */
+    bool                    format;     /**< Format option flag */
+    bool                    comments;   /**< Comments option flag */
+    bool                    tokens;     /**< Tokens option flag */
+    char                   *schema;     /**< Schema file path */
+    xmlDocPtr               doc;        /**< Document being built */
+    xmlNodePtr              prnt;       /**< Current parent element */
+    xmlNodePtr              cur;        /**< Current element */
+    hidrd_xml_snk_state    *state;      /**< Item state table stack */
+    hidrd_buf               fmt;        /**< Value formatting scratch
+                                             buffer */
+    hidrd_memo              memo;       /**< Token and description
+                                             cache */
+    char                   *err;        /**< Last error message */
 } hidrd_xml_snk_inst;
 
 #ifdef __cplusplus
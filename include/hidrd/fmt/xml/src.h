@@ -42,6 +42,9 @@ struct hidrd_xml_src_state {
     hidrd_usage_page        usage_page; /**< Usage page in effect */
 };
 
+/** Number of element attribute names matched by the XML source */
+#define HIDRD_XML_SRC_PROP_NUM  5
+
 /** XML source instance */
 typedef struct hidrd_xml_src_inst {
     hidrd_src               src;    /**< Parent structure */
@@ -54,6 +57,14 @@ typedef struct hidrd_xml_src_inst {
                                                              being
                                                              retrieved */
     char                   *err;    /**< Last error message */
+
+    const xmlChar          *prop_name[HIDRD_XML_SRC_PROP_NUM];
+                                    /**< Element attribute names,
+                                         interned in the document
+                                         dictionary, if any */
+    xmlChar                *content;    /**< Copy of the last element
+                                             content which couldn't be
+                                             read in place, or NULL */
 } hidrd_xml_src_inst;
 
 #ifdef __cplusplus
@@ -0,0 +1,39 @@
+/** @file
+ * @brief HID report descriptor - report layout shortcut
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_H__
+#define __HIDRD_LAYOUT_H__
+
+#include "hidrd/layout/inst.h"
+#include "hidrd/layout/cmpl.h"
+#include "hidrd/layout/dec.h"
+#include "hidrd/layout/enc.h"
+#include "hidrd/layout/col.h"
+#include "hidrd/layout/idx.h"
+#include "hidrd/layout/phys.h"
+#include "hidrd/layout/prog.h"
+#include "hidrd/layout/sum.h"
+#include "hidrd/layout/cache.h"
+
+#endif /* __HIDRD_LAYOUT_H__ */
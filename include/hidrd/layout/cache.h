@@ -0,0 +1,219 @@
+/** @file
+ * @brief HID report descriptor - report layout - on-disk cache
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_CACHE_H__
+#define __HIDRD_LAYOUT_CACHE_H__
+
+#include "hidrd/util/buf.h"
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Layout cache file magic, including the terminating zero */
+#define HIDRD_LAYOUT_CACHE_MAGIC    "HIDRDLC"
+
+/**
+ * Layout cache file format version; files are stored in the native byte
+ * order, so files of the other byte order fail the version check.
+ */
+#define HIDRD_LAYOUT_CACHE_VERSION  1
+
+/**
+ * Layout cache file header.
+ *
+ * The file is a single block without any pointers, consisting of this
+ * header followed by the bucket start list, the entry list and the
+ * descriptor and layout blocks, at the specified offsets, all aligned to
+ * 8 bytes. Entries are grouped by bucket, the bucket being the low bits
+ * of the descriptor hash.
+ */
+typedef struct hidrd_layout_cache_hdr {
+    char        magic[8];       /**< HIDRD_LAYOUT_CACHE_MAGIC */
+    uint32_t    version;        /**< HIDRD_LAYOUT_CACHE_VERSION */
+    uint32_t    size;           /**< Size of the whole file, in bytes */
+    uint32_t    bucket_log2;    /**< Log2 of the number of buckets */
+    uint32_t    bucket_off;     /**< Bucket start list offset, in bytes;
+                                     the list has an entry index for each
+                                     bucket, plus the end index */
+    uint32_t    ent_off;        /**< Entry list offset, in bytes */
+    uint32_t    ent_num;        /**< Number of entries */
+} hidrd_layout_cache_hdr;
+
+/** Layout cache file entry */
+typedef struct hidrd_layout_cache_ent {
+    uint64_t    hash;           /**< Descriptor hash */
+    uint32_t    desc_off;       /**< Native descriptor offset, in bytes */
+    uint32_t    desc_size;      /**< Native descriptor size, in bytes */
+    uint32_t    layout_off;     /**< Layout offset, in bytes */
+    uint32_t    layout_size;    /**< Layout size, in bytes */
+} hidrd_layout_cache_ent;
+
+/** Loaded (mapped) layout cache */
+typedef struct hidrd_layout_cache {
+    const hidrd_layout_cache_hdr   *hdr;    /**< Mapped file */
+    size_t                          size;   /**< Mapped size */
+} hidrd_layout_cache;
+
+/** Empty (unloaded) layout cache initializer */
+#define HIDRD_LAYOUT_CACHE_EMPTY   {.hdr = NULL, .size = 0}
+
+/** Layout cache builder */
+typedef struct hidrd_layout_cache_bld {
+    hidrd_buf   ent;    /**< Builder entry list */
+} hidrd_layout_cache_bld;
+
+/**
+ * Hash a native descriptor for the layout cache.
+ *
+ * @param desc  Native descriptor.
+ * @param size  Native descriptor size.
+ *
+ * @return Descriptor hash.
+ */
+extern uint64_t hidrd_layout_cache_hash(const void *desc, size_t size);
+
+/**
+ * Load a layout cache file, mapping it read-only into memory.
+ *
+ * The file is never modified in place, so it can be loaded by several
+ * processes at once, while being replaced with hidrd_layout_cache_store.
+ *
+ * @param cache Location for the loaded cache.
+ * @param path  Cache file path.
+ *
+ * @return True if loaded successfully, false otherwise (see errno in this
+ *         case; EINVAL means the file format is invalid).
+ */
+extern bool hidrd_layout_cache_load(hidrd_layout_cache *cache,
+                                    const char         *path);
+
+/**
+ * Check if a loaded layout cache is valid.
+ *
+ * @param cache Cache to check.
+ *
+ * @return True if the cache is valid, false otherwise.
+ */
+extern bool hidrd_layout_cache_valid(const hidrd_layout_cache *cache);
+
+/**
+ * Unload a layout cache, unmapping the file; the layouts looked up from
+ * it become invalid.
+ *
+ * @param cache Cache to unload, could be empty.
+ */
+extern void hidrd_layout_cache_unload(hidrd_layout_cache *cache);
+
+/**
+ * Lookup the layout of a native descriptor in a loaded cache.
+ *
+ * Costs a hash of the descriptor, a bucket scan and a validation of the
+ * found layout only; there is no parsing or copying, and the load checks
+ * only the header and the entry table bounds.
+ *
+ * @param cache Cache to lookup in.
+ * @param desc  Native descriptor.
+ * @param size  Native descriptor size.
+ *
+ * @return The layout, pointing into the cache mapping, or NULL if not
+ *         found or the entry is invalid.
+ */
+extern const hidrd_layout *hidrd_layout_cache_lookup(
+                                    const hidrd_layout_cache   *cache,
+                                    const void                 *desc,
+                                    size_t                      size);
+
+/**
+ * Initialize a layout cache builder.
+ *
+ * @param bld   Builder to initialize.
+ */
+extern void hidrd_layout_cache_bld_init(hidrd_layout_cache_bld *bld);
+
+/**
+ * Check if a layout cache builder is valid.
+ *
+ * @param bld   Builder to check.
+ *
+ * @return True if the builder is valid, false otherwise.
+ */
+extern bool hidrd_layout_cache_bld_valid(const hidrd_layout_cache_bld *bld);
+
+/**
+ * Add a native descriptor and its layout to a layout cache builder,
+ * copying both; a descriptor already added is skipped.
+ *
+ * @param bld       Builder to add to.
+ * @param desc      Native descriptor.
+ * @param size      Native descriptor size.
+ * @param layout    Layout compiled from the descriptor.
+ *
+ * @return True if added, or skipped, successfully, false if failed to
+ *         allocate memory.
+ */
+extern bool hidrd_layout_cache_bld_add(hidrd_layout_cache_bld  *bld,
+                                       const void              *desc,
+                                       size_t                   size,
+                                       const hidrd_layout      *layout);
+
+/**
+ * Add all valid entries of a loaded layout cache to a layout cache
+ * builder.
+ *
+ * @param bld   Builder to add to.
+ * @param cache Cache to add the entries of.
+ *
+ * @return True if added successfully, false if failed to allocate memory.
+ */
+extern bool hidrd_layout_cache_bld_add_cache(
+                                    hidrd_layout_cache_bld     *bld,
+                                    const hidrd_layout_cache   *cache);
+
+/**
+ * Store the contents of a layout cache builder to a cache file,
+ * atomically replacing it.
+ *
+ * @param bld   Builder to store.
+ * @param path  Cache file path.
+ *
+ * @return True if stored successfully, false otherwise (see errno in this
+ *         case).
+ */
+extern bool hidrd_layout_cache_store(const hidrd_layout_cache_bld  *bld,
+                                     const char                    *path);
+
+/**
+ * Cleanup a layout cache builder.
+ *
+ * @param bld   Builder to cleanup.
+ */
+extern void hidrd_layout_cache_bld_clnp(hidrd_layout_cache_bld *bld);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_CACHE_H__ */
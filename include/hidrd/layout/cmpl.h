@@ -0,0 +1,181 @@
+/** @file
+ * @brief HID report descriptor - report layout compiler
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_CMPL_H__
+#define __HIDRD_LAYOUT_CMPL_H__
+
+#include "hidrd/util/buf.h"
+#include "hidrd/item.h"
+#include "hidrd/strm/src/inst.h"
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Layout compiler error code */
+typedef enum hidrd_layout_cmpl_err {
+    HIDRD_LAYOUT_CMPL_ERR_NONE,         /**< No error */
+    HIDRD_LAYOUT_CMPL_ERR_ALLOC,        /**< Memory allocation failure */
+    HIDRD_LAYOUT_CMPL_ERR_POP,          /**< Pop without Push */
+    HIDRD_LAYOUT_CMPL_ERR_REPORT_ID,    /**< Invalid report ID */
+    HIDRD_LAYOUT_CMPL_ERR_REPORT_SIZE,  /**< Unsupported report size */
+    HIDRD_LAYOUT_CMPL_ERR_REPORT_LONG   /**< Report too long */
+} hidrd_layout_cmpl_err;
+
+/** Layout compiler global item state table */
+typedef struct hidrd_layout_cmpl_state hidrd_layout_cmpl_state;
+struct hidrd_layout_cmpl_state {
+    hidrd_layout_cmpl_state    *prev;               /**< Previous state */
+    hidrd_usage_page            usage_page;         /**< Usage page */
+    int32_t                     logical_minimum;    /**< Logical minimum */
+    int32_t                     logical_maximum;    /**< Logical maximum,
+                                                         signed */
+    uint32_t                    logical_maximum_u;  /**< Logical maximum,
+                                                         unsigned */
+    int32_t                     physical_minimum;   /**< Physical minimum */
+    int32_t                     physical_maximum;   /**< Physical maximum,
+                                                         signed */
+    uint32_t                    physical_maximum_u; /**< Physical maximum,
+                                                         unsigned */
+    uint32_t                    unit;               /**< Unit */
+    int32_t                     unit_exponent;      /**< Unit exponent */
+    uint32_t                    report_size;        /**< Report size */
+    uint32_t                    report_count;       /**< Report count */
+    uint8_t                     report_id;          /**< Report ID */
+};
+
+/**
+ * Layout compiler - builds a layout from an item stream, fed one item at a
+ * time.
+ */
+typedef struct hidrd_layout_cmpl {
+    hidrd_layout_cmpl_state    *state;          /**< Global state stack */
+    bool                        ids;            /**< Report IDs are used */
+
+    hidrd_buf                   usage_buf;      /**< Usage list */
+    size_t                      usage_start;    /**< Number of usage list
+                                                     entries belonging to
+                                                     previous main items */
+    bool                        usage_min_set;  /**< Usage minimum is
+                                                     pending */
+    hidrd_usage                 usage_min;      /**< Pending usage
+                                                     minimum */
+    bool                        usage_max_set;  /**< Usage maximum is
+                                                     pending */
+    hidrd_usage                 usage_max;      /**< Pending usage
+                                                     maximum */
+    bool                        delimiter;      /**< Inside a delimiter
+                                                     set */
+    size_t                      delimiter_num;  /**< Number of usage list
+                                                     entries at the
+                                                     delimiter set start */
+
+    hidrd_buf                   report_buf;     /**< Report list, in order
+                                                     of appearance */
+    hidrd_buf                   field_buf;      /**< Field list, in order
+                                                     of appearance */
+    /** Report index map, indexed by direction and report ID */
+    uint16_t                    report_map[HIDRD_LAYOUT_DIR_NUM]
+                                          [HIDRD_LAYOUT_ID_NUM];
+
+    hidrd_layout_cmpl_err       err;            /**< Last error code */
+} hidrd_layout_cmpl;
+
+/**
+ * Initialize a layout compiler.
+ *
+ * @param cmpl  Compiler to initialize.
+ *
+ * @return True if initialized successfully, false if failed to allocate
+ *         memory.
+ */
+extern bool hidrd_layout_cmpl_init(hidrd_layout_cmpl *cmpl);
+
+/**
+ * Check if a layout compiler is valid.
+ *
+ * @param cmpl  Compiler to check.
+ *
+ * @return True if the compiler is valid, false otherwise.
+ */
+extern bool hidrd_layout_cmpl_valid(const hidrd_layout_cmpl *cmpl);
+
+/**
+ * Feed an item to a layout compiler.
+ *
+ * @param cmpl  Compiler to feed the item to.
+ * @param item  Item to feed.
+ *
+ * @return True if the item was processed successfully, false otherwise;
+ *         the error code is stored in the compiler.
+ */
+extern bool hidrd_layout_cmpl_put(hidrd_layout_cmpl    *cmpl,
+                                  const hidrd_item     *item);
+
+/**
+ * Finish layout compilation and build the layout from the items fed so
+ * far; the compiler still needs to be cleaned up afterwards.
+ *
+ * @param cmpl  Compiler to build the layout with.
+ *
+ * @return Dynamically allocated layout, or NULL if failed; the error code
+ *         is stored in the compiler.
+ */
+extern hidrd_layout *hidrd_layout_cmpl_finish(hidrd_layout_cmpl *cmpl);
+
+/**
+ * Retrieve a layout compiler error message.
+ *
+ * @param cmpl  Compiler to retrieve error message from.
+ *
+ * @return Dynamically allocated error message, empty if there was no
+ *         error, or NULL if failed to allocate memory.
+ */
+extern char *hidrd_layout_cmpl_errmsg(const hidrd_layout_cmpl *cmpl);
+
+/**
+ * Cleanup a layout compiler.
+ *
+ * @param cmpl  Compiler to cleanup.
+ */
+extern void hidrd_layout_cmpl_clnp(hidrd_layout_cmpl *cmpl);
+
+/**
+ * Compile a layout from a source item stream.
+ *
+ * @param src   Source to read items from, until the end.
+ * @param perr  Location for a dynamically allocated error message pointer,
+ *              in case the compilation failed, or for a dynamically
+ *              allocated empty string otherwise; could be NULL.
+ *
+ * @return Dynamically allocated layout, or NULL if failed.
+ */
+extern hidrd_layout *hidrd_layout_compile(hidrd_src *src, char **perr);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_CMPL_H__ */
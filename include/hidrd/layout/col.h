@@ -0,0 +1,117 @@
+/** @file
+ * @brief HID report descriptor - report layout - column extraction
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_COL_H__
+#define __HIDRD_LAYOUT_COL_H__
+
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Column extraction kernel */
+typedef enum hidrd_report_col_kern {
+    HIDRD_REPORT_COL_KERN_AUTO,     /**< Best kernel supported by the CPU */
+    HIDRD_REPORT_COL_KERN_SCALAR,   /**< Portable scalar kernel */
+    HIDRD_REPORT_COL_KERN_SSE2,     /**< SSE2 kernel */
+    HIDRD_REPORT_COL_KERN_AVX2,     /**< AVX2 kernel */
+} hidrd_report_col_kern;
+
+/** Number of column extraction kernels, including the automatic one */
+#define HIDRD_REPORT_COL_KERN_NUM   4
+
+/**
+ * Check if a column extraction kernel is valid.
+ *
+ * @param kern  Kernel to check.
+ *
+ * @return True if the kernel is valid, false otherwise.
+ */
+static inline bool
+hidrd_report_col_kern_valid(hidrd_report_col_kern kern)
+{
+    return kern < HIDRD_REPORT_COL_KERN_NUM;
+}
+
+/**
+ * Get a column extraction kernel name.
+ *
+ * @param kern  Kernel to get the name of.
+ *
+ * @return Constant kernel name.
+ */
+extern const char *hidrd_report_col_kern_name(hidrd_report_col_kern kern);
+
+/**
+ * Check if a column extraction kernel is supported by the build and the
+ * running CPU.
+ *
+ * @param kern  Kernel to check.
+ *
+ * @return True if the kernel is supported, false otherwise.
+ */
+extern bool hidrd_report_col_kern_supported(hidrd_report_col_kern kern);
+
+/**
+ * Get the best column extraction kernel supported by the build and the
+ * running CPU.
+ *
+ * @return The best supported kernel, never HIDRD_REPORT_COL_KERN_AUTO.
+ */
+extern hidrd_report_col_kern hidrd_report_col_kern_best(void);
+
+/**
+ * Extract values of a field from a batch of reports of the same ID and
+ * direction into a column buffer.
+ *
+ * Byte-aligned fields of 8-, 16- and packed 12-bit values are extracted
+ * with the specified kernel, except 12-bit ones with SSE2, which use the
+ * scalar kernel, same as all other fields. Values are converted the same
+ * way hidrd_report_decode_dir does.
+ *
+ * @param layout    Layout the field belongs to.
+ * @param field     Field to extract.
+ * @param kern      Kernel to use; must be supported.
+ * @param buf       Buffer with the first report, starting with the report
+ *                  ID, if the layout uses IDs.
+ * @param stride    Distance between report starts in bytes, at least
+ *                  the report size.
+ * @param num       Number of reports in the batch.
+ * @param col       Output column buffer, num rows of field->count values
+ *                  each.
+ */
+extern void hidrd_report_col_extract(const hidrd_layout        *layout,
+                                     const hidrd_layout_field  *field,
+                                     hidrd_report_col_kern      kern,
+                                     const void                *buf,
+                                     size_t                     stride,
+                                     size_t                     num,
+                                     int32_t                   *col);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_COL_H__ */
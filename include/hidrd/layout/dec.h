@@ -0,0 +1,129 @@
+/** @file
+ * @brief HID report descriptor - report layout - report decoder
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_DEC_H__
+#define __HIDRD_LAYOUT_DEC_H__
+
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Calculate the maximum number of values in a report of a layout, i.e.
+ * the size of a value list sufficient for decoding any report.
+ *
+ * @param layout    Layout to calculate the number for.
+ *
+ * @return Maximum number of report values.
+ */
+extern size_t hidrd_layout_get_value_max(const hidrd_layout *layout);
+
+/**
+ * Decode a report of specified direction.
+ *
+ * Each field value is stored at the field value index (value_idx) plus
+ * the value number; values of signed fields (with negative logical
+ * minimum) are sign-extended, 32-bit unsigned values are stored as is.
+ *
+ * @param layout    Layout to decode the report with.
+ * @param dir       Report direction.
+ * @param buf       Report bytes, starting with the report ID, if the
+ *                  layout uses IDs.
+ * @param len       Report length in bytes; could be longer than the
+ *                  report.
+ * @param values    Output value list, at least report->value_num long.
+ *
+ * @return The decoded report, or NULL if the report ID is unknown or the
+ *         report is too short.
+ */
+extern const hidrd_layout_report *hidrd_report_decode_dir(
+                                        const hidrd_layout *layout,
+                                        hidrd_layout_dir    dir,
+                                        const void         *buf,
+                                        size_t              len,
+                                        int32_t            *values);
+
+/**
+ * Decode an input report.
+ *
+ * @param layout    Layout to decode the report with.
+ * @param buf       Report bytes, starting with the report ID, if the
+ *                  layout uses IDs.
+ * @param len       Report length in bytes.
+ * @param values    Output value list, at least report->value_num long.
+ *
+ * @return The decoded report, or NULL if the report ID is unknown or the
+ *         report is too short.
+ *
+ * @sa hidrd_report_decode_dir
+ */
+static inline const hidrd_layout_report *
+hidrd_report_decode(const hidrd_layout *layout,
+                    const void         *buf,
+                    size_t              len,
+                    int32_t            *values)
+{
+    return hidrd_report_decode_dir(layout, HIDRD_LAYOUT_DIR_INPUT,
+                                   buf, len, values);
+}
+
+/**
+ * Decode a batch of reports of specified direction, laid out back to back
+ * in a buffer, each exactly as long as its layout says.
+ *
+ * @param layout        Layout to decode the reports with.
+ * @param dir           Report direction.
+ * @param buf           Buffer containing the reports.
+ * @param size          Buffer size in bytes.
+ * @param num           Maximum number of reports to decode.
+ * @param values        Output value list, num rows of value_stride values
+ *                      each; each row receives values of one report.
+ * @param value_stride  Output value list row length, should be at least
+ *                      hidrd_layout_get_value_max(layout).
+ * @param report_list   Output report list, num entries long, receiving a
+ *                      pointer to each decoded report; could be NULL.
+ * @param psize         Location for the number of bytes consumed; could
+ *                      be NULL.
+ *
+ * @return Number of decoded reports; less than num if the buffer ended, or
+ *         an unknown or truncated report was encountered.
+ */
+extern size_t hidrd_report_decode_batch(
+                                const hidrd_layout         *layout,
+                                hidrd_layout_dir            dir,
+                                const void                 *buf,
+                                size_t                      size,
+                                size_t                      num,
+                                int32_t                    *values,
+                                size_t                      value_stride,
+                                const hidrd_layout_report **report_list,
+                                size_t                     *psize);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_DEC_H__ */
@@ -0,0 +1,97 @@
+/** @file
+ * @brief HID report descriptor - report layout - report encoding
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_ENC_H__
+#define __HIDRD_LAYOUT_ENC_H__
+
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Usage value pair */
+typedef struct hidrd_report_usage_value {
+    hidrd_usage usage;  /**< Usage */
+    int32_t     value;  /**< Value */
+} hidrd_report_usage_value;
+
+/**
+ * Encode a report from a value list, laid out the same way
+ * hidrd_report_decode_dir outputs it.
+ *
+ * Values of variable fields are clamped to the field logical minimum and
+ * maximum; values of array fields (usage indices) are stored as is and
+ * constant fields are zeroed.
+ *
+ * @param layout    Layout to encode the report with.
+ * @param report    Report to encode.
+ * @param values    Value list, report->value_num long.
+ * @param buf       Output buffer.
+ * @param size      Output buffer size.
+ *
+ * @return Number of bytes written, including the report ID, if the layout
+ *         uses IDs, or zero, if the buffer is too small.
+ */
+extern size_t hidrd_report_encode_values(
+                                const hidrd_layout         *layout,
+                                const hidrd_layout_report  *report,
+                                const int32_t              *values,
+                                void                       *buf,
+                                size_t                      size);
+
+/**
+ * Encode a report from a list of usage value pairs.
+ *
+ * A pair with a variable field usage sets the corresponding field value,
+ * clamped to the field logical minimum and maximum. A pair with an array
+ * field usage and a non-zero value puts the usage index into the next
+ * free array slot. Unset values and free array slots are zeroed, as are
+ * constant fields. Pairs with usages not found in the report are ignored.
+ *
+ * @param layout    Layout to encode the report with.
+ * @param dir       Report direction.
+ * @param id        Report ID; zero if the layout doesn't use IDs.
+ * @param list      Usage value pair list.
+ * @param num       Number of pairs in the list.
+ * @param buf       Output buffer.
+ * @param size      Output buffer size.
+ *
+ * @return Number of bytes written, including the report ID, if the layout
+ *         uses IDs, or zero, if the report is not found or the buffer is
+ *         too small.
+ */
+extern size_t hidrd_report_encode(const hidrd_layout             *layout,
+                                  hidrd_layout_dir                dir,
+                                  uint8_t                         id,
+                                  const hidrd_report_usage_value *list,
+                                  size_t                          num,
+                                  void                           *buf,
+                                  size_t                          size);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_ENC_H__ */
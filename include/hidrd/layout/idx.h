@@ -0,0 +1,179 @@
+/** @file
+ * @brief HID report descriptor - report layout - usage index
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_IDX_H__
+#define __HIDRD_LAYOUT_IDX_H__
+
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Log2 of the number of usages in an index hash block */
+#define HIDRD_LAYOUT_IDX_BLOCK_LOG2         8
+
+/**
+ * Maximum number of hash blocks a usage range is referenced from; wider
+ * ranges are kept on a separate list, checked on every lookup.
+ */
+#define HIDRD_LAYOUT_IDX_RANGE_BLOCK_MAX    16
+
+/** Report index matching any report in an index lookup */
+#define HIDRD_LAYOUT_IDX_REPORT_ANY         UINT32_MAX
+
+/** Usage index entry: a usage interval within a field */
+typedef struct hidrd_layout_idx_ent {
+    hidrd_usage min;        /**< Minimum usage */
+    hidrd_usage max;        /**< Maximum usage */
+    uint32_t    report_idx; /**< Report index in the layout report list */
+    uint32_t    field_idx;  /**< Field index in the layout field list */
+    uint32_t    idx;        /**< Index of the minimum usage in the field
+                                 usage list */
+} hidrd_layout_idx_ent;
+
+/** Usage index hash reference to an entry */
+typedef struct hidrd_layout_idx_ref {
+    uint32_t    block;      /**< Usage block (usage shifted right by
+                                 HIDRD_LAYOUT_IDX_BLOCK_LOG2) */
+    uint32_t    ent_idx;    /**< Entry index */
+} hidrd_layout_idx_ref;
+
+/**
+ * Usage index of a compiled layout, mapping usages to field locations.
+ *
+ * Usage ranges are stored as intervals and hashed by the blocks of
+ * 2^HIDRD_LAYOUT_IDX_BLOCK_LOG2 usages they cover, so a lookup checks a
+ * single short bucket on average. Like the layout, the index is a single
+ * contiguous memory block without any pointers, consisting of this header
+ * followed by the bucket start, reference, wide range and entry lists at
+ * the specified offsets. It can be freed with free(3) and shared
+ * read-only between threads.
+ */
+typedef struct hidrd_layout_idx {
+    uint32_t    size;           /**< Size of the whole block, in bytes */
+    uint32_t    field_num;      /**< Number of indexed layout fields */
+    uint32_t    bucket_log2;    /**< Log2 of the number of buckets */
+    uint32_t    bucket_off;     /**< Bucket start list offset, in bytes;
+                                     the list has a reference index for
+                                     each bucket, plus the end index */
+    uint32_t    ref_off;        /**< Reference list offset, in bytes */
+    uint32_t    ref_num;        /**< Number of references */
+    uint32_t    wide_off;       /**< Wide range entry index list offset,
+                                     in bytes */
+    uint32_t    wide_num;       /**< Number of wide range entries */
+    uint32_t    ent_off;        /**< Entry list offset, in bytes */
+    uint32_t    ent_num;        /**< Number of entries */
+} hidrd_layout_idx;
+
+/** Usage location */
+typedef struct hidrd_layout_loc {
+    uint32_t    field_idx;  /**< Field index in the layout field list */
+    uint32_t    idx;        /**< Usage index in the field usage list; the
+                                 value index for variable fields, and the
+                                 value minus the logical minimum for
+                                 array fields */
+} hidrd_layout_loc;
+
+/**
+ * Build a usage index of a layout.
+ *
+ * Usages of variable fields are indexed only as far as the field has
+ * values for them.
+ *
+ * @param layout    Layout to build the index of.
+ *
+ * @return Dynamically allocated index, or NULL if failed to allocate
+ *         memory.
+ */
+extern hidrd_layout_idx *hidrd_layout_idx_new(const hidrd_layout *layout);
+
+/**
+ * Check if a usage index is valid.
+ *
+ * @param idx   Index to check.
+ *
+ * @return True if the index is valid, false otherwise.
+ */
+extern bool hidrd_layout_idx_valid(const hidrd_layout_idx *idx);
+
+/**
+ * Delete (free) a usage index.
+ *
+ * @param idx   Index to delete, could be NULL.
+ */
+extern void hidrd_layout_idx_delete(hidrd_layout_idx *idx);
+
+/**
+ * Lookup locations of a usage.
+ *
+ * @param idx           Index to lookup in.
+ * @param report_idx    Index of the report to lookup in, or
+ *                      HIDRD_LAYOUT_IDX_REPORT_ANY to lookup in all.
+ * @param usage         Usage to lookup, e.g. made with
+ *                      hidrd_usage_compose.
+ * @param list          Output location list; could be NULL if num is zero.
+ * @param num           Maximum number of locations to output.
+ *
+ * @return Total number of locations found, in no particular order; could
+ *         be greater than num, in which case only num are output.
+ */
+extern size_t hidrd_layout_idx_lookup(const hidrd_layout_idx   *idx,
+                                      uint32_t                  report_idx,
+                                      hidrd_usage               usage,
+                                      hidrd_layout_loc         *list,
+                                      size_t                    num);
+
+/**
+ * Lookup locations of a usage within a report.
+ *
+ * @param idx       Index to lookup in.
+ * @param layout    Layout the index was built of.
+ * @param report    Report to lookup in.
+ * @param usage     Usage to lookup.
+ * @param list      Output location list; could be NULL if num is zero.
+ * @param num       Maximum number of locations to output.
+ *
+ * @return Total number of locations found.
+ *
+ * @sa hidrd_layout_idx_lookup
+ */
+static inline size_t
+hidrd_layout_idx_lookup_report(const hidrd_layout_idx      *idx,
+                               const hidrd_layout          *layout,
+                               const hidrd_layout_report   *report,
+                               hidrd_usage                  usage,
+                               hidrd_layout_loc            *list,
+                               size_t                       num)
+{
+    return hidrd_layout_idx_lookup(
+                idx, report - hidrd_layout_get_report_list(layout),
+                usage, list, num);
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_IDX_H__ */
@@ -0,0 +1,321 @@
+/** @file
+ * @brief HID report descriptor - report layout
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_INST_H__
+#define __HIDRD_LAYOUT_INST_H__
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "hidrd/usage/all.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Report direction */
+typedef enum hidrd_layout_dir {
+    HIDRD_LAYOUT_DIR_INPUT,     /**< Input report */
+    HIDRD_LAYOUT_DIR_OUTPUT,    /**< Output report */
+    HIDRD_LAYOUT_DIR_FEATURE    /**< Feature report */
+} hidrd_layout_dir;
+
+/** Number of report directions */
+#define HIDRD_LAYOUT_DIR_NUM    3
+
+/**
+ * Check if a report direction is valid.
+ *
+ * @param dir   Direction to check.
+ *
+ * @return True if the direction is valid, false otherwise.
+ */
+static inline bool
+hidrd_layout_dir_valid(hidrd_layout_dir dir)
+{
+    return dir < HIDRD_LAYOUT_DIR_NUM;
+}
+
+/** Number of possible report IDs, including zero for "no ID" */
+#define HIDRD_LAYOUT_ID_NUM     256
+
+/** Maximum field value size, in bits */
+#define HIDRD_LAYOUT_FIELD_SIZE_MAX 32
+
+/** Maximum report size, in bytes, excluding the report ID byte */
+#define HIDRD_LAYOUT_REPORT_SIZE_MAX    16384
+
+/** Report map entry value meaning "no such report" */
+#define HIDRD_LAYOUT_REPORT_NONE    UINT16_MAX
+
+/**
+ * Field flags; the lower bits match the Input/Output/Feature item data
+ * bits.
+ */
+typedef enum hidrd_layout_field_flag {
+    HIDRD_LAYOUT_FIELD_FLAG_CONSTANT        = 1 << 0,   /**< Constant */
+    HIDRD_LAYOUT_FIELD_FLAG_VARIABLE        = 1 << 1,   /**< Variable,
+                                                             not array */
+    HIDRD_LAYOUT_FIELD_FLAG_RELATIVE        = 1 << 2,   /**< Relative */
+    HIDRD_LAYOUT_FIELD_FLAG_WRAP            = 1 << 3,   /**< Wrap */
+    HIDRD_LAYOUT_FIELD_FLAG_NON_LINEAR      = 1 << 4,   /**< Non-linear */
+    HIDRD_LAYOUT_FIELD_FLAG_NO_PREFERRED    = 1 << 5,   /**< No preferred
+                                                             state */
+    HIDRD_LAYOUT_FIELD_FLAG_NULL_STATE      = 1 << 6,   /**< Null state */
+    HIDRD_LAYOUT_FIELD_FLAG_VOLATILE        = 1 << 7,   /**< Volatile */
+    HIDRD_LAYOUT_FIELD_FLAG_BUFFERED_BYTES  = 1 << 8,   /**< Buffered
+                                                             bytes */
+    HIDRD_LAYOUT_FIELD_FLAG_SIGNED          = 1 << 16,  /**< Values are
+                                                             signed, i.e.
+                                                             logical
+                                                             minimum is
+                                                             negative */
+} hidrd_layout_field_flag;
+
+/** Mask of field flags coming from the main item data */
+#define HIDRD_LAYOUT_FIELD_FLAG_ITEM_MASK   0xFFFF
+
+/**
+ * Usage list entry - a single usage, or an inclusive usage range, coming
+ * from a Usage Minimum/Usage Maximum pair.
+ */
+typedef struct hidrd_layout_usage {
+    uint32_t    min;    /**< First usage (hidrd_usage) */
+    uint32_t    max;    /**< Last usage (hidrd_usage), equal to the first
+                             one for a single usage */
+} hidrd_layout_usage;
+
+/** Report field - a single Input, Output or Feature item */
+typedef struct hidrd_layout_field {
+    uint32_t    flags;              /**< Flags (hidrd_layout_field_flag) */
+    uint32_t    report_idx;         /**< Containing report index */
+    uint32_t    bit_off;            /**< Offset of the first value from the
+                                         report start, excluding the report
+                                         ID byte, in bits */
+    uint32_t    bit_size;           /**< Single value size in bits
+                                         (Report Size) */
+    uint32_t    count;              /**< Number of values
+                                         (Report Count) */
+    uint32_t    value_idx;          /**< Index of the first field value in
+                                         the report value list */
+    int32_t     logical_minimum;    /**< Logical minimum */
+    int32_t     logical_maximum;    /**< Logical maximum */
+    int32_t     physical_minimum;   /**< Physical minimum */
+    int32_t     physical_maximum;   /**< Physical maximum */
+    uint32_t    unit;               /**< Unit (hidrd_unit) */
+    int32_t     unit_exponent;      /**< Unit exponent item value */
+    uint32_t    usage_idx;          /**< Index of the first usage list
+                                         entry in the layout usage list */
+    uint32_t    usage_num;          /**< Number of usage list entries */
+} hidrd_layout_field;
+
+/** Report - all fields of one direction with one report ID */
+typedef struct hidrd_layout_report {
+    uint8_t     id;         /**< Report ID, or zero if IDs are not used */
+    uint8_t     dir;        /**< Direction (hidrd_layout_dir) */
+    uint16_t    reserved;   /**< Reserved, zero */
+    uint32_t    bit_size;   /**< Report size in bits, excluding the
+                                 report ID byte */
+    uint32_t    field_idx;  /**< Index of the first field in the layout
+                                 field list */
+    uint32_t    field_num;  /**< Number of fields */
+    uint32_t    value_num;  /**< Number of values in all fields */
+} hidrd_layout_report;
+
+/**
+ * Compiled report layout.
+ *
+ * The layout is a single contiguous memory block without any pointers,
+ * consisting of this header followed by the report, field and usage lists
+ * at the specified offsets. It can be freed with free(3), copied with
+ * memcpy(3) and shared read-only between threads. Reports are sorted by
+ * direction and then by ID, fields belonging to a report follow each other
+ * in the report order.
+ */
+typedef struct hidrd_layout {
+    uint32_t    size;           /**< Size of the whole block, in bytes */
+    uint32_t    ids;            /**< Non-zero if report IDs are used */
+    uint32_t    report_off;     /**< Report list offset, in bytes */
+    uint32_t    report_num;     /**< Number of reports */
+    uint32_t    field_off;      /**< Field list offset, in bytes */
+    uint32_t    field_num;      /**< Number of fields */
+    uint32_t    usage_off;      /**< Usage list offset, in bytes */
+    uint32_t    usage_num;      /**< Number of usage list entries */
+    /** Report index map, indexed by direction and report ID */
+    uint16_t    report_map[HIDRD_LAYOUT_DIR_NUM][HIDRD_LAYOUT_ID_NUM];
+} hidrd_layout;
+
+/**
+ * Check if a layout is valid.
+ *
+ * @param layout    Layout to check.
+ *
+ * @return True if the layout is valid, false otherwise.
+ */
+extern bool hidrd_layout_valid(const hidrd_layout *layout);
+
+/**
+ * Delete (free) a layout.
+ *
+ * @param layout    Layout to delete, could be NULL.
+ */
+extern void hidrd_layout_delete(hidrd_layout *layout);
+
+/**
+ * Retrieve layout report list.
+ *
+ * @param layout    Layout to retrieve report list from.
+ *
+ * @return Report list, layout->report_num entries long.
+ */
+static inline const hidrd_layout_report *
+hidrd_layout_get_report_list(const hidrd_layout *layout)
+{
+    return (const hidrd_layout_report *)
+                ((const uint8_t *)layout + layout->report_off);
+}
+
+/**
+ * Retrieve layout field list.
+ *
+ * @param layout    Layout to retrieve field list from.
+ *
+ * @return Field list, layout->field_num entries long.
+ */
+static inline const hidrd_layout_field *
+hidrd_layout_get_field_list(const hidrd_layout *layout)
+{
+    return (const hidrd_layout_field *)
+                ((const uint8_t *)layout + layout->field_off);
+}
+
+/**
+ * Retrieve layout usage list.
+ *
+ * @param layout    Layout to retrieve usage list from.
+ *
+ * @return Usage list, layout->usage_num entries long.
+ */
+static inline const hidrd_layout_usage *
+hidrd_layout_get_usage_list(const hidrd_layout *layout)
+{
+    return (const hidrd_layout_usage *)
+                ((const uint8_t *)layout + layout->usage_off);
+}
+
+/**
+ * Lookup a report by direction and ID, in constant time.
+ *
+ * @param layout    Layout to lookup in.
+ * @param dir       Report direction.
+ * @param id        Report ID, zero if IDs are not used.
+ *
+ * @return The report, or NULL if not found.
+ */
+static inline const hidrd_layout_report *
+hidrd_layout_lookup(const hidrd_layout *layout,
+                    hidrd_layout_dir    dir,
+                    uint8_t             id)
+{
+    uint16_t    idx;
+
+    assert(hidrd_layout_dir_valid(dir));
+
+    idx = layout->report_map[dir][id];
+
+    return (idx == HIDRD_LAYOUT_REPORT_NONE)
+                ? NULL
+                : hidrd_layout_get_report_list(layout) + idx;
+}
+
+/**
+ * Retrieve report field list.
+ *
+ * @param layout    Layout containing the report.
+ * @param report    Report to retrieve field list from.
+ *
+ * @return Report field list, report->field_num entries long.
+ */
+static inline const hidrd_layout_field *
+hidrd_layout_report_get_field_list(const hidrd_layout          *layout,
+                                   const hidrd_layout_report   *report)
+{
+    return hidrd_layout_get_field_list(layout) + report->field_idx;
+}
+
+/**
+ * Calculate report size in bytes, including the report ID byte, if any.
+ *
+ * @param layout    Layout containing the report.
+ * @param report    Report to calculate size of.
+ *
+ * @return Report size in bytes.
+ */
+static inline size_t
+hidrd_layout_report_get_bytes(const hidrd_layout           *layout,
+                              const hidrd_layout_report    *report)
+{
+    return (layout->ids ? 1 : 0) + (report->bit_size + 7) / 8;
+}
+
+/**
+ * Retrieve field usage list.
+ *
+ * @param layout    Layout containing the field.
+ * @param field     Field to retrieve usage list from.
+ *
+ * @return Field usage list, field->usage_num entries long.
+ */
+static inline const hidrd_layout_usage *
+hidrd_layout_field_get_usage_list(const hidrd_layout       *layout,
+                                  const hidrd_layout_field *field)
+{
+    return hidrd_layout_get_usage_list(layout) + field->usage_idx;
+}
+
+/**
+ * Retrieve a usage from a field usage list by index, expanding ranges.
+ *
+ * For variable fields an index past the end of the list maps to the last
+ * usage, as the HID specification requires; for array fields the index is
+ * the value minus the logical minimum, and is not clamped.
+ *
+ * @param layout    Layout containing the field.
+ * @param field     Field to retrieve usage from.
+ * @param idx       Usage index.
+ * @param pusage    Location for the usage; could be NULL.
+ *
+ * @return True if the usage was found, false otherwise.
+ */
+extern bool hidrd_layout_field_get_usage(const hidrd_layout        *layout,
+                                         const hidrd_layout_field  *field,
+                                         uint32_t                   idx,
+                                         hidrd_usage               *pusage);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_INST_H__ */
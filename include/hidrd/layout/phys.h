@@ -0,0 +1,151 @@
+/** @file
+ * @brief HID report descriptor - report layout - physical value conversion
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_PHYS_H__
+#define __HIDRD_LAYOUT_PHYS_H__
+
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of fractional bits in fixed-point physical values */
+#define HIDRD_LAYOUT_PHYS_FX_FRAC   16
+
+/**
+ * Physical value conversion factors of a field.
+ *
+ * A physical value, in the base units of the field unit (i.e. with the
+ * unit exponent applied), is computed from a logical value as
+ * value * scale + offset, or, in fixed point with
+ * HIDRD_LAYOUT_PHYS_FX_FRAC fractional bits, as
+ * (value * mul + add) >> shift.
+ */
+typedef struct hidrd_layout_phys {
+    double      scale;  /**< Physical units per logical unit */
+    double      offset; /**< Physical value at logical zero */
+    int64_t     mul;    /**< Fixed-point multiplier */
+    int64_t     add;    /**< Fixed-point addend, including rounding */
+    uint32_t    shift;  /**< Fixed-point right shift */
+    bool        fx;     /**< True if the fixed-point factors are
+                             usable, false if the values would overflow */
+    bool        uns;    /**< True if the values are unsigned */
+    int32_t     exp;    /**< Decimal unit exponent */
+    uint32_t    unit;   /**< Unit (hidrd_unit) */
+} hidrd_layout_phys;
+
+/**
+ * Decode a Unit Exponent item value into a decimal exponent: values from
+ * 0 to 15 are taken as the specification's 4-bit codes, other values as
+ * plain signed integers.
+ *
+ * @param value Unit Exponent item value.
+ *
+ * @return Decimal exponent.
+ */
+extern int32_t hidrd_layout_phys_exp(int32_t value);
+
+/**
+ * Compute physical value conversion factors of a field.
+ *
+ * The physical range maps to the logical range linearly; a zero physical
+ * range, or one equal to the logical range, is taken as the logical
+ * range, as specified.
+ *
+ * @param phys  Location for the factors.
+ * @param field Field to compute the factors for.
+ */
+extern void hidrd_layout_phys_init(hidrd_layout_phys           *phys,
+                                   const hidrd_layout_field    *field);
+
+/**
+ * Compute physical value conversion factors of every field of a layout.
+ *
+ * @param layout    Layout to compute the factors for.
+ *
+ * @return Dynamically allocated factor list, indexed the same as the
+ *         layout field list, to be freed with free(3), or NULL if failed
+ *         to allocate memory.
+ */
+extern hidrd_layout_phys *hidrd_layout_phys_list_new(
+                                        const hidrd_layout *layout);
+
+/**
+ * Convert a single logical value to a physical value.
+ *
+ * @param phys  Conversion factors.
+ * @param value Logical value, as produced by the report decoder.
+ *
+ * @return Physical value.
+ */
+static inline double
+hidrd_layout_phys_conv_one(const hidrd_layout_phys *phys, int32_t value)
+{
+    return (phys->uns ? (double)(uint32_t)value : (double)value) *
+           phys->scale + phys->offset;
+}
+
+/**
+ * Convert a series of logical values to physical values.
+ *
+ * @param phys      Conversion factors.
+ * @param values    Logical values, as produced by the report decoder or
+ *                  column extraction.
+ * @param stride    Distance between the logical values, in values; e.g.
+ *                  1 for a column, or the value stride of a batch.
+ * @param num       Number of values to convert.
+ * @param out       Output physical value list.
+ */
+extern void hidrd_layout_phys_conv(const hidrd_layout_phys *phys,
+                                   const int32_t           *values,
+                                   size_t                   stride,
+                                   size_t                   num,
+                                   double                  *out);
+
+/**
+ * Convert a series of logical values to fixed-point physical values, with
+ * HIDRD_LAYOUT_PHYS_FX_FRAC fractional bits.
+ *
+ * @param phys      Conversion factors.
+ * @param values    Logical values, as produced by the report decoder or
+ *                  column extraction.
+ * @param stride    Distance between the logical values, in values.
+ * @param num       Number of values to convert.
+ * @param out       Output fixed-point physical value list.
+ *
+ * @return True if converted, false if the fixed-point factors are not
+ *         usable for the field.
+ */
+extern bool hidrd_layout_phys_conv_fx(const hidrd_layout_phys  *phys,
+                                      const int32_t            *values,
+                                      size_t                    stride,
+                                      size_t                    num,
+                                      int64_t                  *out);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_PHYS_H__ */
@@ -0,0 +1,191 @@
+/** @file
+ * @brief HID report descriptor - report layout - decoding program
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_PROG_H__
+#define __HIDRD_LAYOUT_PROG_H__
+
+#include "hidrd/util/buf.h"
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Decoding program format version */
+#define HIDRD_LAYOUT_PROG_VERSION   1
+
+/** Report index returned by a failed program run */
+#define HIDRD_LAYOUT_PROG_FAIL      UINT32_MAX
+
+/**
+ * Decoding program operation code.
+ *
+ * Each instruction is an operation code byte followed by its operands,
+ * stored little-endian and unaligned. The program operates on a 64-bit
+ * word register, loaded from the report data, and a value register,
+ * stored to the value list.
+ */
+typedef enum hidrd_layout_prog_op {
+    HIDRD_LAYOUT_PROG_OP_FAIL,  /**< Stop, failing to decode */
+    HIDRD_LAYOUT_PROG_OP_END,   /**< u16 report index: stop, the report
+                                     is decoded */
+    HIDRD_LAYOUT_PROG_OP_BR_ID, /**< u8 ID, u32 target: jump to the target
+                                     code offset if the report ID
+                                     matches */
+    HIDRD_LAYOUT_PROG_OP_CHK,   /**< u16 length: fail if the report data
+                                     is shorter than the length */
+    HIDRD_LAYOUT_PROG_OP_LD,    /**< u16 offset: load the word from the
+                                     report data byte offset, zero-padded
+                                     past the data end */
+    HIDRD_LAYOUT_PROG_OP_EXT,   /**< u8 shift, u8 size: set the value to
+                                     the word bits at the shift */
+    HIDRD_LAYOUT_PROG_OP_SEXT,  /**< u8 size: sign-extend the value from
+                                     the size in bits */
+    HIDRD_LAYOUT_PROG_OP_SCALE, /**< s32 logical minimum, s32 physical
+                                     minimum, s32 numerator, s32
+                                     denominator: map the value from the
+                                     logical to the physical range */
+    HIDRD_LAYOUT_PROG_OP_ST,    /**< u16 slot: store the value to the
+                                     value list */
+} hidrd_layout_prog_op;
+
+/** Number of decoding program operation codes */
+#define HIDRD_LAYOUT_PROG_OP_NUM    (HIDRD_LAYOUT_PROG_OP_ST + 1)
+
+/** Decoding program compilation flags */
+typedef enum hidrd_layout_prog_flag {
+    /** Map values to physical ranges, where specified */
+    HIDRD_LAYOUT_PROG_FLAG_PHYSICAL = 1 << 0,
+} hidrd_layout_prog_flag;
+
+/**
+ * Report decoding program.
+ *
+ * A linear bytecode translation of a layout: a report ID dispatch for
+ * each direction, followed by straight-line code extracting every value
+ * of every report. Like the layout, the program is a single contiguous
+ * memory block without any pointers, consisting of this header followed
+ * by the code at the specified offset. It can be freed with free(3),
+ * stored and loaded as is, and shared read-only between threads.
+ */
+typedef struct hidrd_layout_prog {
+    uint32_t    size;       /**< Size of the whole block, in bytes */
+    uint32_t    version;    /**< Format version
+                                 (HIDRD_LAYOUT_PROG_VERSION) */
+    uint32_t    flags;      /**< Compilation flags
+                                 (hidrd_layout_prog_flag) */
+    uint32_t    ids;        /**< Non-zero if report IDs are used */
+    uint32_t    value_max;  /**< Maximum number of values in a report */
+    uint32_t    code_off;   /**< Code offset, in bytes */
+    uint32_t    code_len;   /**< Code length, in bytes */
+    /** Entry code offsets, indexed by direction */
+    uint32_t    entry[HIDRD_LAYOUT_DIR_NUM];
+} hidrd_layout_prog;
+
+/**
+ * Compile a decoding program from a layout.
+ *
+ * @param layout    Layout to compile.
+ * @param flags     Compilation flags (hidrd_layout_prog_flag).
+ *
+ * @return Dynamically allocated program, or NULL if failed (see errno in
+ *         this case): EFBIG if the layout doesn't fit the program
+ *         operands, or ENOMEM if failed to allocate memory.
+ */
+extern hidrd_layout_prog *hidrd_layout_prog_new(
+                                        const hidrd_layout *layout,
+                                        uint32_t            flags);
+
+/**
+ * Check if a decoding program is valid, i.e. is safe to run; programs
+ * loaded from external storage must be checked before running.
+ *
+ * @param prog  Program to check.
+ *
+ * @return True if the program is valid, false otherwise.
+ */
+extern bool hidrd_layout_prog_valid(const hidrd_layout_prog *prog);
+
+/**
+ * Delete (free) a decoding program.
+ *
+ * @param prog  Program to delete, could be NULL.
+ */
+extern void hidrd_layout_prog_delete(hidrd_layout_prog *prog);
+
+/**
+ * Retrieve decoding program code.
+ *
+ * @param prog  Program to retrieve code from.
+ *
+ * @return Program code.
+ */
+static inline const uint8_t *
+hidrd_layout_prog_get_code(const hidrd_layout_prog *prog)
+{
+    return (const uint8_t *)prog + prog->code_off;
+}
+
+/**
+ * Decode a report by running a decoding program.
+ *
+ * Produces the same values as hidrd_report_decode_dir, unless the
+ * program was compiled with HIDRD_LAYOUT_PROG_FLAG_PHYSICAL.
+ *
+ * @param prog      Program to run.
+ * @param dir       Report direction.
+ * @param buf       Report buffer, starting with the report ID byte, if
+ *                  report IDs are used.
+ * @param len       Report buffer length.
+ * @param values    Output value list, with room for at least
+ *                  prog->value_max values.
+ *
+ * @return Decoded report index in the layout report list, or
+ *         HIDRD_LAYOUT_PROG_FAIL if the report ID is unknown or the
+ *         report is too short.
+ */
+extern uint32_t hidrd_layout_prog_run(const hidrd_layout_prog  *prog,
+                                      hidrd_layout_dir          dir,
+                                      const void               *buf,
+                                      size_t                    len,
+                                      int32_t                  *values);
+
+/**
+ * Disassemble a decoding program into human-readable text, one
+ * instruction per line.
+ *
+ * @param prog  Program to disassemble.
+ * @param buf   Buffer to append the text to.
+ *
+ * @return True if disassembled successfully, false if failed to allocate
+ *         memory.
+ */
+extern bool hidrd_layout_prog_disasm(const hidrd_layout_prog   *prog,
+                                     hidrd_buf                 *buf);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_PROG_H__ */
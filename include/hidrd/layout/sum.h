@@ -0,0 +1,178 @@
+/** @file
+ * @brief HID report descriptor - report layout - report size summary
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_LAYOUT_SUM_H__
+#define __HIDRD_LAYOUT_SUM_H__
+
+#include "hidrd/util/buf.h"
+#include "hidrd/item.h"
+#include "hidrd/strm/src/inst.h"
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Report size summary error code */
+typedef enum hidrd_layout_sum_err {
+    HIDRD_LAYOUT_SUM_ERR_NONE,      /**< No error */
+    HIDRD_LAYOUT_SUM_ERR_ALLOC,     /**< Memory allocation failure */
+    HIDRD_LAYOUT_SUM_ERR_POP,       /**< Pop without Push */
+    HIDRD_LAYOUT_SUM_ERR_REPORT_ID  /**< Invalid report ID */
+} hidrd_layout_sum_err;
+
+/** Report size summary global item state */
+typedef struct hidrd_layout_sum_state {
+    uint32_t    report_size;    /**< Report size */
+    uint32_t    report_count;   /**< Report count */
+    uint8_t     report_id;      /**< Report ID */
+} hidrd_layout_sum_state;
+
+/**
+ * Report size summary - report IDs and sizes, collected in a single pass
+ * over an item stream, without building a layout.
+ */
+typedef struct hidrd_layout_sum {
+    hidrd_layout_sum_state  state;      /**< Current global state */
+    hidrd_buf               stack;      /**< Pushed global states */
+    bool                    ids;        /**< Report IDs are used */
+    /** Report sizes in bits, indexed by direction and report ID */
+    uint64_t                bits[HIDRD_LAYOUT_DIR_NUM][HIDRD_LAYOUT_ID_NUM];
+    hidrd_layout_sum_err    err;        /**< Last error code */
+} hidrd_layout_sum;
+
+/**
+ * Initialize a report size summary.
+ *
+ * @param sum   Summary to initialize.
+ */
+extern void hidrd_layout_sum_init(hidrd_layout_sum *sum);
+
+/**
+ * Check if a report size summary is valid.
+ *
+ * @param sum   Summary to check.
+ *
+ * @return True if the summary is valid, false otherwise.
+ */
+extern bool hidrd_layout_sum_valid(const hidrd_layout_sum *sum);
+
+/**
+ * Feed an item to a report size summary.
+ *
+ * @param sum   Summary to feed the item to.
+ * @param item  Item to feed.
+ *
+ * @return True if the item was processed successfully, false otherwise;
+ *         the error code is stored in the summary.
+ */
+extern bool hidrd_layout_sum_put(hidrd_layout_sum  *sum,
+                                 const hidrd_item  *item);
+
+/**
+ * Retrieve a report size summary error message.
+ *
+ * @param sum   Summary to retrieve error message from.
+ *
+ * @return Dynamically allocated error message, empty if there was no
+ *         error, or NULL if failed to allocate memory.
+ */
+extern char *hidrd_layout_sum_errmsg(const hidrd_layout_sum *sum);
+
+/**
+ * Cleanup a report size summary.
+ *
+ * @param sum   Summary to cleanup.
+ */
+extern void hidrd_layout_sum_clnp(hidrd_layout_sum *sum);
+
+/**
+ * Retrieve a report size in bytes, including the report ID byte, if
+ * report IDs are used.
+ *
+ * @param sum   Summary to retrieve the size from.
+ * @param dir   Report direction.
+ * @param id    Report ID, zero if IDs are not used.
+ *
+ * @return Report size in bytes, or zero if there is no such report.
+ */
+static inline size_t
+hidrd_layout_sum_get_bytes(const hidrd_layout_sum  *sum,
+                           hidrd_layout_dir         dir,
+                           uint8_t                  id)
+{
+    uint64_t    bits;
+
+    assert(hidrd_layout_dir_valid(dir));
+
+    bits = sum->bits[dir][id];
+    return bits == 0 ? 0 : (sum->ids ? 1 : 0) + (bits + 7) / 8;
+}
+
+/**
+ * Retrieve the maximum report size of a direction in bytes, including
+ * the report ID byte, if report IDs are used.
+ *
+ * @param sum   Summary to retrieve the size from.
+ * @param dir   Report direction.
+ *
+ * @return Maximum report size in bytes, or zero if there are no reports.
+ */
+extern size_t hidrd_layout_sum_get_max_bytes(const hidrd_layout_sum *sum,
+                                             hidrd_layout_dir        dir);
+
+/**
+ * Format a report size summary as text, one "key=value" line per report,
+ * plus the maximum report size per direction.
+ *
+ * @param sum   Summary to format.
+ * @param buf   Buffer to append the text to.
+ *
+ * @return True if formatted successfully, false if failed to allocate
+ *         memory.
+ */
+extern bool hidrd_layout_sum_format(const hidrd_layout_sum *sum,
+                                    hidrd_buf              *buf);
+
+/**
+ * Summarize report sizes of a source item stream.
+ *
+ * @param sum   Summary to initialize and fill; needs to be cleaned up if
+ *              succeeded.
+ * @param src   Source to read items from, until the end.
+ * @param perr  Location for a dynamically allocated error message pointer,
+ *              in case the summary failed, or for a dynamically
+ *              allocated empty string otherwise; could be NULL.
+ *
+ * @return True if summarized successfully, false otherwise.
+ */
+extern bool hidrd_layout_summarize(hidrd_layout_sum    *sum,
+                                   hidrd_src           *src,
+                                   char               **perr);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_LAYOUT_SUM_H__ */
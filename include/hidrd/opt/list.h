@@ -72,6 +72,19 @@ extern size_t hidrd_opt_list_len(const hidrd_opt *list);
 extern const hidrd_opt *hidrd_opt_list_lkp(const hidrd_opt *list,
                                            const char      *name);
 
+/**
+ * Check if an option list was produced from a specification list, i.e.
+ * has exactly one option per specification, in the specification order.
+ *
+ * @param list      Option list array pointer.
+ * @param spec_list Option specification list to check against.
+ *
+ * @return True if the option list matches the specification list, false
+ *         otherwise.
+ */
+extern bool hidrd_opt_list_spec_valid(const hidrd_opt          *list,
+                                      const hidrd_opt_spec     *spec_list);
+
 /**
  * Get a boolean option value.
  *
@@ -116,6 +129,56 @@ extern int32_t hidrd_opt_list_get_s32(const hidrd_opt  *list,
 extern uint32_t hidrd_opt_list_get_u32(const hidrd_opt *list,
                                        const char      *name);
 
+/**
+ * Get a boolean option value by its specification index, in constant time;
+ * the list must be parsed against the specification list.
+ *
+ * @param list  Option list array pointer.
+ * @param idx   Index of the option specification.
+ *
+ * @return Option value.
+ */
+extern bool hidrd_opt_list_get_boolean_at(const hidrd_opt *list,
+                                          size_t           idx);
+
+/**
+ * Get a string option value by its specification index, in constant time;
+ * the list must be parsed against the specification list.
+ *
+ * @param list  Option list array pointer.
+ * @param idx   Index of the option specification.
+ *
+ * @return Option value.
+ */
+extern const char *hidrd_opt_list_get_string_at(const hidrd_opt *list,
+                                                size_t           idx);
+
+/**
+ * Get a signed 32-bit integer option value by its specification index,
+ * in constant time; the list must be parsed against the specification
+ * list.
+ *
+ * @param list  Option list array pointer.
+ * @param idx   Index of the option specification.
+ *
+ * @return Option value.
+ */
+extern int32_t hidrd_opt_list_get_s32_at(const hidrd_opt *list,
+                                         size_t           idx);
+
+/**
+ * Get an unsigned 32-bit integer option value by its specification index,
+ * in constant time; the list must be parsed against the specification
+ * list.
+ *
+ * @param list  Option list array pointer.
+ * @param idx   Index of the option specification.
+ *
+ * @return Option value.
+ */
+extern uint32_t hidrd_opt_list_get_u32_at(const hidrd_opt *list,
+                                          size_t           idx);
+
 /**
  * Parse a token pair list representation of an option list.
  *
@@ -123,7 +186,8 @@ extern uint32_t hidrd_opt_list_get_u32(const hidrd_opt *list,
  * @param tkns_list Option token pair list to format.
  *
  * @return Dynamically allocated option list with names and string values
- *         referenced from the token pair list or specification list; will
+ *         referenced from the token pair list or specification list, one
+ *         option per specification, in the specification order; will
  *         return NULL if failed to parse or allocate memory.
  */
 extern hidrd_opt *hidrd_opt_list_parse_tkns_list(
@@ -145,6 +209,22 @@ extern hidrd_opt *hidrd_opt_list_parse_tkns_list(
 extern hidrd_opt *hidrd_opt_list_parse(const hidrd_opt_spec    *spec_list,
                                        char                    *buf);
 
+/**
+ * Compile a string representation of an option list into a
+ * self-contained option list, which can be used to initialize any number
+ * of instances without parsing the string again.
+ *
+ * @param spec_list Option specification list to apply.
+ * @param str       String representation of the option list.
+ *
+ * @return Dynamically allocated option list, which doesn't reference the
+ *         original string and is freed with a single free(), one option
+ *         per specification, in the specification order; will return
+ *         NULL if failed to parse or allocate memory.
+ */
+extern hidrd_opt *hidrd_opt_list_compile(const hidrd_opt_spec  *spec_list,
+                                         const char            *str);
+
 /**
  * Format a token pair list representation of an option list.
  *
@@ -69,6 +69,32 @@ extern hidrd_snk *hidrd_snk_new(const hidrd_snk_type   *type,
                                 size_t                 *psize,
                                 ...);
 
+/**
+ * Initialize an instance of specified sink type with specified arguments,
+ * in caller-provided storage; no memory is allocated for the instance
+ * itself.
+ *
+ * @param mem   Storage for the instance, at least type->size bytes,
+ *              suitably aligned for the instance structure.
+ * @param type  Sink type to initialize instance of.
+ * @param perr  Location for a dynamically allocated error message pointer,
+ *              in case the initialization failed, or for a dynamically
+ *              allocated empty string otherwise; could be NULL.
+ * @param pbuf  Location of sink buffer pointer.
+ * @param psize Location of sink buffer size.
+ * @param ...   Sink type-specific initialization arguments.
+ *
+ * @return Opened (initialized) instance of specified sink type, located at
+ *         mem, or NULL, if failed to initialize; the instance must be
+ *         cleaned up with hidrd_snk_clnp, not deleted.
+ */
+extern hidrd_snk *hidrd_snk_init_mem(void                   *mem,
+                                     const hidrd_snk_type   *type,
+                                     char                  **perr,
+                                     void                  **pbuf,
+                                     size_t                 *psize,
+                                     ...);
+
 #ifdef HIDRD_WITH_OPT
 /**
  * Create (allocate and initialize) an instance of specified sink type with
@@ -92,6 +118,86 @@ extern hidrd_snk *hidrd_snk_new_opts(const hidrd_snk_type  *type,
                                      void                 **pbuf,
                                      size_t                *psize,
                                      const char            *opts);
+
+/**
+ * Initialize an instance of specified sink type with specified options, in
+ * caller-provided storage; the option string parsing allocates temporary
+ * memory.
+ *
+ * @param mem   Storage for the instance, at least type->size bytes,
+ *              suitably aligned for the instance structure.
+ * @param type  Sink type to initialize instance of.
+ * @param perr  Location for a dynamically allocated error message pointer,
+ *              in case the initialization failed, or for a dynamically
+ *              allocated empty string otherwise; could be NULL.
+ * @param pbuf  Location of sink buffer pointer.
+ * @param psize Location of sink buffer size.
+ * @param opts  Option string: each option is a name/value pair separated by
+ *              equals sign, with surrounding space removed; options are
+ *              separated by comma.
+ *
+ * @return Opened (initialized) instance of specified sink type, located at
+ *         mem, or NULL, if failed to initialize; the instance must be
+ *         cleaned up with hidrd_snk_clnp, not deleted.
+ */
+extern hidrd_snk *hidrd_snk_init_mem_opts(void                   *mem,
+                                          const hidrd_snk_type   *type,
+                                          char                  **perr,
+                                          void                  **pbuf,
+                                          size_t                 *psize,
+                                          const char             *opts);
+
+/**
+ * Create (allocate and initialize) an instance of specified sink type with
+ * a compiled option list.
+ *
+ * @param type      Sink type to create instance of.
+ * @param perr      Location for a dynamically allocated error message
+ *                  pointer, in case the creation failed, or for a
+ *                  dynamically allocated empty string otherwise; could be
+ *                  NULL.
+ * @param pbuf      Location of sink buffer pointer.
+ * @param psize     Location of sink buffer size.
+ * @param opt_list  Option list compiled against the type option
+ *                  specification list, see hidrd_opt_list_compile; could
+ *                  be reused for any number of instances.
+ *
+ * @return Opened (allocated and initialized) instance of specified sink
+ *         type, or NULL, if failed to allocate or initialize.
+ */
+extern hidrd_snk *hidrd_snk_new_opt_list(const hidrd_snk_type   *type,
+                                         char                  **perr,
+                                         void                  **pbuf,
+                                         size_t                 *psize,
+                                         const hidrd_opt        *opt_list);
+
+/**
+ * Initialize an instance of specified sink type with a compiled option
+ * list, in caller-provided storage.
+ *
+ * @param mem       Storage for the instance, at least type->size bytes,
+ *                  suitably aligned for the instance structure.
+ * @param type      Sink type to initialize instance of.
+ * @param perr      Location for a dynamically allocated error message
+ *                  pointer, in case the initialization failed, or for a
+ *                  dynamically allocated empty string otherwise; could be
+ *                  NULL.
+ * @param pbuf      Location of sink buffer pointer.
+ * @param psize     Location of sink buffer size.
+ * @param opt_list  Option list compiled against the type option
+ *                  specification list, see hidrd_opt_list_compile; could
+ *                  be reused for any number of instances.
+ *
+ * @return Opened (initialized) instance of specified sink type, located at
+ *         mem, or NULL, if failed to initialize; the instance must be
+ *         cleaned up with hidrd_snk_clnp, not deleted.
+ */
+extern hidrd_snk *hidrd_snk_init_mem_opt_list(void                   *mem,
+                                              const hidrd_snk_type   *type,
+                                              char                  **perr,
+                                              void                  **pbuf,
+                                              size_t                 *psize,
+                                              const hidrd_opt        *opt_list);
 #endif /* HIDRD_WITH_OPT */
 
 /**
@@ -123,6 +229,15 @@ extern bool hidrd_snk_flush(hidrd_snk *snk);
  */
 extern char *hidrd_snk_errmsg(const hidrd_snk *snk);
 
+/**
+ * Cleanup a sink instance - free any internal data, but don't free the
+ * instance itself; use for instances initialized in caller-provided
+ * storage.
+ *
+ * @param snk  Sink instance to cleanup.
+ */
+extern void hidrd_snk_clnp(hidrd_snk *snk);
+
 /**
  * Delete (cleanup and free) a sink instance.
  *
@@ -70,6 +70,32 @@ extern hidrd_src *hidrd_src_new(const hidrd_src_type   *type,
                                 size_t                  size,
                                 ...);
 
+/**
+ * Initialize an instance of specified source type with specified arguments,
+ * in caller-provided storage; no memory is allocated for the instance
+ * itself.
+ *
+ * @param mem   Storage for the instance, at least type->size bytes,
+ *              suitably aligned for the instance structure.
+ * @param type  Source type to initialize instance of.
+ * @param perr  Location for a dynamically allocated error message pointer,
+ *              in case the initialization failed, or for a dynamically
+ *              allocated empty string otherwise; could be NULL.
+ * @param buf   Source buffer pointer.
+ * @param size  Source buffer size.
+ * @param ...   Source type-specific initialization arguments.
+ *
+ * @return Opened (initialized) instance of specified source type, located at
+ *         mem, or NULL, if failed to initialize; the instance must be
+ *         cleaned up with hidrd_src_clnp, not deleted.
+ */
+extern hidrd_src *hidrd_src_init_mem(void                   *mem,
+                                     const hidrd_src_type   *type,
+                                     char                  **perr,
+                                     const void             *buf,
+                                     size_t                  size,
+                                     ...);
+
 #ifdef HIDRD_WITH_OPT
 /**
  * Create (allocate and initialize) an instance of specified source type
@@ -93,6 +119,86 @@ extern hidrd_src *hidrd_src_new_opts(const hidrd_src_type  *type,
                                      const void            *buf,
                                      size_t                 size,
                                      const char            *opts);
+
+/**
+ * Initialize an instance of specified source type with specified options, in
+ * caller-provided storage; the option string parsing allocates temporary
+ * memory.
+ *
+ * @param mem   Storage for the instance, at least type->size bytes,
+ *              suitably aligned for the instance structure.
+ * @param type  Source type to initialize instance of.
+ * @param perr  Location for a dynamically allocated error message pointer,
+ *              in case the initialization failed, or for a dynamically
+ *              allocated empty string otherwise; could be NULL.
+ * @param buf   Source buffer pointer.
+ * @param size  Source buffer size.
+ * @param opts  Option string: each option is a name/value pair separated by
+ *              equals sign, with surrounding space removed; options are
+ *              separated by comma.
+ *
+ * @return Opened (initialized) instance of specified source type, located at
+ *         mem, or NULL, if failed to initialize; the instance must be
+ *         cleaned up with hidrd_src_clnp, not deleted.
+ */
+extern hidrd_src *hidrd_src_init_mem_opts(void                   *mem,
+                                          const hidrd_src_type   *type,
+                                          char                  **perr,
+                                          const void             *buf,
+                                          size_t                  size,
+                                          const char             *opts);
+
+/**
+ * Create (allocate and initialize) an instance of specified source type with
+ * a compiled option list.
+ *
+ * @param type      Source type to create instance of.
+ * @param perr      Location for a dynamically allocated error message
+ *                  pointer, in case the creation failed, or for a
+ *                  dynamically allocated empty string otherwise; could be
+ *                  NULL.
+ * @param buf       Source buffer pointer.
+ * @param size      Source buffer size.
+ * @param opt_list  Option list compiled against the type option
+ *                  specification list, see hidrd_opt_list_compile; could
+ *                  be reused for any number of instances.
+ *
+ * @return Opened (allocated and initialized) instance of specified source
+ *         type, or NULL, if failed to allocate or initialize.
+ */
+extern hidrd_src *hidrd_src_new_opt_list(const hidrd_src_type   *type,
+                                         char                  **perr,
+                                         const void             *buf,
+                                         size_t                  size,
+                                         const hidrd_opt        *opt_list);
+
+/**
+ * Initialize an instance of specified source type with a compiled option
+ * list, in caller-provided storage.
+ *
+ * @param mem       Storage for the instance, at least type->size bytes,
+ *                  suitably aligned for the instance structure.
+ * @param type      Source type to initialize instance of.
+ * @param perr      Location for a dynamically allocated error message
+ *                  pointer, in case the initialization failed, or for a
+ *                  dynamically allocated empty string otherwise; could be
+ *                  NULL.
+ * @param buf       Source buffer pointer.
+ * @param size      Source buffer size.
+ * @param opt_list  Option list compiled against the type option
+ *                  specification list, see hidrd_opt_list_compile; could
+ *                  be reused for any number of instances.
+ *
+ * @return Opened (initialized) instance of specified source type, located at
+ *         mem, or NULL, if failed to initialize; the instance must be
+ *         cleaned up with hidrd_src_clnp, not deleted.
+ */
+extern hidrd_src *hidrd_src_init_mem_opt_list(void                   *mem,
+                                              const hidrd_src_type   *type,
+                                              char                  **perr,
+                                              const void             *buf,
+                                              size_t                  size,
+                                              const hidrd_opt        *opt_list);
 #endif /* HIDRD_WITH_OPT */
 
 /**
@@ -145,6 +251,15 @@ extern bool hidrd_src_error(const hidrd_src *src);
  */
 extern char *hidrd_src_errmsg(const hidrd_src *src);
 
+/**
+ * Cleanup a source instance - free any internal data, but don't free the
+ * instance itself; use for instances initialized in caller-provided
+ * storage.
+ *
+ * @param src  Source instance to cleanup.
+ */
+extern void hidrd_src_clnp(hidrd_src *src);
+
 /**
  * Delete (cleanup and free) a source instance.
  *
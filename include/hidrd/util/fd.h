@@ -57,6 +57,22 @@ extern bool hidrd_fd_read_whole(int fd, void **pbuf, size_t *psize);
  */
 extern bool hidrd_fd_write_whole(int fd, const void *buf, size_t size);
 
+/**
+ * Atomically replace a file with the buffer contents, by writing a
+ * temporary file next to it and renaming it over; the file is created if
+ * it doesn't exist.
+ *
+ * @param path  Path of the file to replace.
+ * @param buf   Pointer to the buffer to write to the file.
+ * @param size  Size of the buffer to write to the file.
+ *
+ * @return True if replaced successfully, false otherwise (see errno in
+ *         this case).
+ */
+extern bool hidrd_fd_replace_whole(const char  *path,
+                                   const void  *buf,
+                                   size_t       size);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
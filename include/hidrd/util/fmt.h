@@ -27,6 +27,7 @@
 
 #include <stdbool.h>
 #include <stdarg.h>
+#include "hidrd/util/buf.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -60,6 +61,30 @@ extern bool hidrd_fmtpva(char             **pstr,
                          hidrd_fmt_type     type,
                          va_list           *pap);
 
+/**
+ * Format a string according to format type into a reusable scratch buffer,
+ * without allocating memory once the buffer has grown enough; va_list
+ * pointer version.
+ *
+ * @param buf   Scratch buffer to format into; its contents are replaced.
+ * @param pstr  Location for the resulting string pointer; will point to
+ *              the scratch buffer contents, to the argument string itself
+ *              for HIDRD_FMT_TYPE_STRDUP, or will be NULL for
+ *              HIDRD_FMT_TYPE_NULL. Valid until the next buffer use, or
+ *              until the argument is freed, respectively.
+ * @param type  Format type.
+ * @param pap   Pointer to a va_list containing format arguments; owned
+ *              strings are freed even if formatting fails.
+ *
+ * @return True if formatted successfully, false otherwise.
+ *
+ * @sa hidrd_fmt_type
+ */
+extern bool hidrd_fmtpva_buf(hidrd_buf         *buf,
+                             const char       **pstr,
+                             hidrd_fmt_type     type,
+                             va_list           *pap);
+
 /**
  * Free format arguments for a specified format, if needed.
  *
@@ -33,6 +33,84 @@
 extern "C" {
 #endif
 
+/**
+ * Hexadecimal character class flag of a digit; the digit value is in the
+ * low nibble.
+ */
+#define HIDRD_HEX_CHR_DIGIT     0x10
+/** Hexadecimal character class of whitespace ("C" locale) */
+#define HIDRD_HEX_CHR_SPACE     0x20
+/** Hexadecimal character class of any other character */
+#define HIDRD_HEX_CHR_INVALID   0x00
+
+/** Hexadecimal character class table, indexed by unsigned character */
+extern const uint8_t hidrd_hex_chr_class_list[256];
+
+/** Hexadecimal digit tables: upper case, then lower case */
+extern const char hidrd_hex_digit_list[2][16];
+
+/**
+ * Retrieve a hexadecimal character class.
+ *
+ * @param c Character to classify.
+ *
+ * @return Character class: HIDRD_HEX_CHR_DIGIT with the digit value,
+ *         HIDRD_HEX_CHR_SPACE, or HIDRD_HEX_CHR_INVALID.
+ */
+static inline uint8_t
+hidrd_hex_chr_class(char c)
+{
+    return hidrd_hex_chr_class_list[(uint8_t)c];
+}
+
+/**
+ * Convert a byte to two hexadecimal characters.
+ *
+ * @param str   Character buffer to write to, at least two long.
+ * @param b     Byte to convert.
+ * @param lower True to use lower case digits, false for upper case.
+ *
+ * @return Pointer past the written characters.
+ */
+static inline char *
+hidrd_hex_byte_to_chrs(char *str, uint8_t b, bool lower)
+{
+    assert(str != NULL);
+    str[0] = hidrd_hex_digit_list[lower][b >> 4];
+    str[1] = hidrd_hex_digit_list[lower][b & 0xF];
+    return str + 2;
+}
+
+/** Hexadecimal decoding error code */
+typedef enum hidrd_hex_dec_err {
+    HIDRD_HEX_DEC_ERR_NONE,     /**< No error */
+    HIDRD_HEX_DEC_ERR_CHAR,     /**< Invalid character encountered */
+    HIDRD_HEX_DEC_ERR_SIZE,     /**< Output buffer is too small */
+} hidrd_hex_dec_err;
+
+/**
+ * Decode hexadecimal characters into a buffer, skipping whitespace.
+ * Digits are paired into bytes regardless of whitespace in between; an
+ * odd last digit makes the high nibble of the last byte.
+ *
+ * @param buf   Output buffer pointer.
+ * @param size  Output buffer size.
+ * @param plen  Location for number of decoded bytes; could be NULL.
+ * @param str   Characters to decode.
+ * @param len   Number of characters to decode.
+ * @param ppos  Location for the offset of the character an error occurred
+ *              at (the invalid character, or the digit which didn't fit),
+ *              or of the end of the characters on success; could be NULL.
+ *
+ * @return Decoding error code.
+ */
+extern hidrd_hex_dec_err hidrd_hex_buf_from_chrs(void          *buf,
+                                                 size_t         size,
+                                                 size_t        *plen,
+                                                 const char    *str,
+                                                 size_t         len,
+                                                 size_t        *ppos);
+
 /**
  * Parse a hexadecimal string into a buffer.
  *
@@ -49,6 +127,18 @@ extern bool hidrd_hex_buf_from_str(void        *buf,
                                    size_t      *plen,
                                    const char  *str);
 
+/**
+ * Convert a buffer to hexadecimal characters in a caller buffer, without
+ * allocating memory or terminating the result.
+ *
+ * @param str   Character buffer to write to, at least (size * 2) long.
+ * @param buf   Pointer to buffer to format.
+ * @param size  Size of the buffer to format.
+ *
+ * @return Number of characters written, i.e. (size * 2).
+ */
+extern size_t hidrd_hex_buf_to_chrs(char *str, const void *buf, size_t size);
+
 /**
  * Convert a buffer to a hexadecimal string.
  *
@@ -0,0 +1,119 @@
+/** @file
+ * @brief HID report descriptor - utilities - string memoization cache
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_UTIL_MEMO_H__
+#define __HIDRD_UTIL_MEMO_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of memo cache slots, log 2 */
+#define HIDRD_MEMO_SIZE_LOG2    6
+
+/** Number of memo cache slots */
+#define HIDRD_MEMO_SIZE         (1 << HIDRD_MEMO_SIZE_LOG2)
+
+/** Memo cache slot */
+typedef struct hidrd_memo_slot {
+    uint32_t    kind;   /**< Caller-defined string kind */
+    uint32_t    key;    /**< Caller-defined key, e.g. usage or unit value */
+    char       *str;    /**< Memoized string, or NULL if the slot is free */
+} hidrd_memo_slot;
+
+/**
+ * Memo cache - a bounded, direct-mapped cache of strings, keyed by a
+ * (kind, key) pair; a newer string evicts an older one from the same slot.
+ * Strings of different kinds (below HIDRD_MEMO_SIZE) with the same key
+ * never share a slot, so putting one doesn't evict the others.
+ */
+typedef struct hidrd_memo {
+    hidrd_memo_slot list[HIDRD_MEMO_SIZE];  /**< Slot list */
+} hidrd_memo;
+
+/**
+ * Initialize a memo cache.
+ *
+ * @param memo  Memo cache to initialize.
+ */
+extern void hidrd_memo_init(hidrd_memo *memo);
+
+/**
+ * Check if a memo cache is valid.
+ *
+ * @param memo  Memo cache to check.
+ *
+ * @return True if the memo cache is valid, false otherwise.
+ */
+extern bool hidrd_memo_valid(const hidrd_memo *memo);
+
+/**
+ * Cleanup a memo cache, freeing all the memoized strings.
+ *
+ * @param memo  Memo cache to cleanup.
+ */
+extern void hidrd_memo_clnp(hidrd_memo *memo);
+
+/**
+ * Lookup a memoized string.
+ *
+ * @param memo  Memo cache to lookup in.
+ * @param kind  String kind.
+ * @param key   String key.
+ *
+ * @return Memoized string, valid until the next hidrd_memo_put or
+ *         hidrd_memo_clnp call, or NULL if not found.
+ */
+extern const char *hidrd_memo_get(const hidrd_memo *memo,
+                                  uint32_t          kind,
+                                  uint32_t          key);
+
+/**
+ * Memoize a string, taking over it and evicting whatever occupied its
+ * slot.
+ *
+ * @param memo  Memo cache to put into.
+ * @param kind  String kind.
+ * @param key   String key.
+ * @param str   Dynamically allocated string to take over; could be NULL
+ *              to simplify allocation failure handling, in which case
+ *              nothing is memoized.
+ *
+ * @return The memoized string, valid until the next hidrd_memo_put or
+ *         hidrd_memo_clnp call, or NULL if @e str was NULL.
+ */
+extern const char *hidrd_memo_put(hidrd_memo   *memo,
+                                  uint32_t      kind,
+                                  uint32_t      key,
+                                  char         *str);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_UTIL_MEMO_H__ */
@@ -217,6 +217,88 @@ extern bool hidrd_num_s8_from_str(int8_t           *pnum,
                                   hidrd_num_bmrk    bmrk,
                                   hidrd_num_base    base);
 
+/**
+ * Convert a string to an unsigned 32-bit integer, detecting the base and
+ * the base mark type in a single scan.
+ *
+ * Accepts decimal ("10"), prefixed hexadecimal ("0xA") and suffixed
+ * hexadecimal ("Ah") representations, optionally surrounded by space.
+ *
+ * @param pnum  Location for the converted number; could be NULL.
+ * @param str   String to convert from.
+ * @param pbmrk Location for the detected base mark type; could be NULL.
+ * @param pbase Location for the detected number base; could be NULL.
+ *
+ * @return True if the string was valid and converted successfully, false
+ *         otherwise.
+ */
+extern bool hidrd_num_u32_from_any_str(uint32_t        *pnum,
+                                       const char      *str,
+                                       hidrd_num_bmrk  *pbmrk,
+                                       hidrd_num_base  *pbase);
+
+/**
+ * Convert a string to a signed 32-bit integer, detecting the base and the
+ * base mark type in a single scan.
+ *
+ * Accepts decimal ("-10"), prefixed hexadecimal ("-0xA") and suffixed
+ * hexadecimal ("-Ah") representations, optionally surrounded by space.
+ *
+ * @param pnum  Location for the converted number; could be NULL.
+ * @param str   String to convert from.
+ * @param pbmrk Location for the detected base mark type; could be NULL.
+ * @param pbase Location for the detected number base; could be NULL.
+ *
+ * @return True if the string was valid and converted successfully, false
+ *         otherwise.
+ */
+extern bool hidrd_num_s32_from_any_str(int32_t         *pnum,
+                                       const char      *str,
+                                       hidrd_num_bmrk  *pbmrk,
+                                       hidrd_num_base  *pbase);
+
+/**
+ * Size of a buffer sufficient for any 32-bit integer string representation,
+ * including the terminating zero (as in "-0x80000000").
+ */
+#define HIDRD_NUM_STR_SIZE  12
+
+/**
+ * Convert an unsigned 32-bit integer to a string in a caller buffer,
+ * without allocating memory.
+ *
+ * @param buf   Buffer to write the string to, at least HIDRD_NUM_STR_SIZE
+ *              bytes long.
+ * @param num   The number to convert.
+ * @param bmrk  Number base mark type.
+ * @param base  Number base to convert to, must be specified (not
+ *              HIDRD_NUM_BASE_NONE).
+ *
+ * @return Length of the string written, excluding terminating zero.
+ */
+extern size_t hidrd_num_u32_to_buf(char            *buf,
+                                   uint32_t         num,
+                                   hidrd_num_bmrk   bmrk,
+                                   hidrd_num_base   base);
+
+/**
+ * Convert a signed 32-bit integer to a string in a caller buffer, without
+ * allocating memory.
+ *
+ * @param buf   Buffer to write the string to, at least HIDRD_NUM_STR_SIZE
+ *              bytes long.
+ * @param num   The number to convert.
+ * @param bmrk  Number base mark type.
+ * @param base  Number base to convert to, must be specified (not
+ *              HIDRD_NUM_BASE_NONE).
+ *
+ * @return Length of the string written, excluding terminating zero.
+ */
+extern size_t hidrd_num_s32_to_buf(char            *buf,
+                                   int32_t          num,
+                                   hidrd_num_bmrk   bmrk,
+                                   hidrd_num_base   base);
+
 /**
  * Convert an unsigned 32-bit integer to a string.
  *
@@ -0,0 +1,127 @@
+/** @file
+ * @brief HID report descriptor - utilities - sysfs descriptor scanning
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_UTIL_SYSFS_H__
+#define __HIDRD_UTIL_SYSFS_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <dirent.h>
+#include "hidrd/util/buf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default sysfs scanning root: the hidraw device class directory */
+#define HIDRD_SYSFS_ROOT    "/sys/class/hidraw"
+
+/**
+ * sysfs report descriptor scanner.
+ *
+ * Scans the "ROOT/NAME/device/report_descriptor" files, in NAME order,
+ * reading each into the same buffer.
+ */
+typedef struct hidrd_sysfs_scan {
+    char               *root;       /**< Root directory path */
+    struct dirent     **ent_list;   /**< Sorted root directory entries */
+    size_t              ent_num;    /**< Number of root directory
+                                         entries */
+    size_t              ent_idx;    /**< Index of the next root directory
+                                         entry to scan */
+    const char         *name;       /**< Root directory entry name of the
+                                         last descriptor scanned, or NULL */
+    hidrd_buf           path;       /**< Zero-terminated path of the last
+                                         descriptor scanned */
+    hidrd_buf           desc;       /**< Last descriptor read; the buffer
+                                         is reused for each descriptor */
+    uint16_t            vid;        /**< Last descriptor device vendor ID,
+                                         or zero if unknown */
+    uint16_t            pid;        /**< Last descriptor device product
+                                         ID, or zero if unknown */
+    int                 err;        /**< Error number of the last scanning
+                                         failure, or zero */
+} hidrd_sysfs_scan;
+
+/**
+ * Parse a HID device name, as used in sysfs, e.g. "0003:256C:006E.0001"
+ * (bus, vendor ID, product ID and instance number).
+ *
+ * @param name  Name to parse; must not have anything after the instance
+ *              number.
+ * @param pvid  Location for the vendor ID; could be NULL.
+ * @param ppid  Location for the product ID; could be NULL.
+ *
+ * @return True if the name is a HID device name, false otherwise.
+ */
+extern bool hidrd_sysfs_dev_id(const char  *name,
+                               uint16_t    *pvid,
+                               uint16_t    *ppid);
+
+/**
+ * Open a sysfs report descriptor scanner.
+ *
+ * @param scan  Scanner to open.
+ * @param root  Root directory path, e.g. HIDRD_SYSFS_ROOT.
+ *
+ * @return True if opened successfully, false otherwise (see errno in this
+ *         case).
+ */
+extern bool hidrd_sysfs_scan_open(hidrd_sysfs_scan *scan, const char *root);
+
+/**
+ * Check if a sysfs report descriptor scanner is valid.
+ *
+ * @param scan  Scanner to check.
+ *
+ * @return True if the scanner is valid, false otherwise.
+ */
+extern bool hidrd_sysfs_scan_valid(const hidrd_sysfs_scan *scan);
+
+/**
+ * Scan the next report descriptor, reading it into the scanner buffer;
+ * root directory entries without a report descriptor are skipped.
+ *
+ * @param scan  Scanner to scan with.
+ *
+ * @return True if the next descriptor was read, false if there are no
+ *         more descriptors, or reading failed; scan->err is set to the
+ *         error number, and scan->path to the descriptor path in the
+ *         latter case. Scanning can be continued after a failure.
+ */
+extern bool hidrd_sysfs_scan_next(hidrd_sysfs_scan *scan);
+
+/**
+ * Close a sysfs report descriptor scanner.
+ *
+ * @param scan  Scanner to close.
+ */
+extern void hidrd_sysfs_scan_close(hidrd_sysfs_scan *scan);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_UTIL_SYSFS_H__ */
@@ -417,6 +417,19 @@ hidrd_unit_void(hidrd_unit unit)
  */
 extern char *hidrd_unit_to_expr(hidrd_unit unit, hidrd_tkn_hmnz_cap cap);
 
+/**
+ * Convert an expression string, as produced by hidrd_unit_to_expr, to a
+ * unit. Exponent names are matched case-insensitively and the first known
+ * system having all of them is picked, as some names (e.g. "seconds")
+ * belong to several systems.
+ *
+ * @param punit Location for the resulting unit; could be NULL.
+ * @param expr  Expression string to convert.
+ *
+ * @return True if the expression was valid, false otherwise.
+ */
+extern bool hidrd_unit_from_expr(hidrd_unit *punit, const char *expr);
+
 #endif /* HIDRD_WITH_TOKENS */
 
 #ifdef __cplusplus
@@ -0,0 +1,192 @@
+/** @file
+ * @brief HID report descriptor - utilities - usbmon capture scanning
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __HIDRD_UTIL_USBMON_H__
+#define __HIDRD_UTIL_USBMON_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "hidrd/util/buf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of outstanding GET_DESCRIPTOR requests tracked; the
+ * oldest is forgotten when a new one doesn't fit.
+ */
+#define HIDRD_USBMON_PEND_NUM   64
+
+/**
+ * Amount of mapped capture scanned, after which the memory it occupies is
+ * released.
+ */
+#define HIDRD_USBMON_DROP_SIZE  (16 * 1024 * 1024)
+
+/** usbmon capture file format */
+typedef enum hidrd_usbmon_fmt {
+    HIDRD_USBMON_FMT_TEXT,      /**< usbmon text interface output, in
+                                     either the "t" or the "u" format */
+    HIDRD_USBMON_FMT_PCAP,      /**< pcap file with Linux USB headers, as
+                                     written by tcpdump */
+    HIDRD_USBMON_FMT_PCAPNG,    /**< pcapng file with Linux USB headers, as
+                                     written by Wireshark */
+} hidrd_usbmon_fmt;
+
+/** Outstanding GET_DESCRIPTOR request */
+typedef struct hidrd_usbmon_pend {
+    uint64_t    id;         /**< URB ID */
+    uint16_t    bus;        /**< Bus number */
+    uint8_t     dev;        /**< Device address */
+    uint8_t     type;       /**< Requested descriptor type, zero if the
+                                 slot is free */
+    uint16_t    iface;      /**< Interface number (wIndex) */
+} hidrd_usbmon_pend;
+
+/** Device IDs, as seen in a device descriptor */
+typedef struct hidrd_usbmon_dev {
+    uint16_t    bus;        /**< Bus number */
+    uint8_t     dev;        /**< Device address */
+    uint16_t    vid;        /**< Vendor ID */
+    uint16_t    pid;        /**< Product ID */
+} hidrd_usbmon_dev;
+
+/**
+ * usbmon capture report descriptor scanner.
+ *
+ * Scans a capture sequentially, matching GET_DESCRIPTOR(Report) control
+ * request submissions to their completions, and returning the report
+ * descriptors received. Device vendor and product IDs are taken from the
+ * GET_DESCRIPTOR(Device) completions seen before, if any. Memory use
+ * doesn't depend on the capture size: mapped capture pages are released
+ * as they are scanned.
+ */
+typedef struct hidrd_usbmon_scan {
+    void               *map;        /**< Mapped capture file, or NULL */
+    size_t              map_size;   /**< Mapped capture file size */
+    const uint8_t      *ptr;        /**< Capture contents */
+    size_t              size;       /**< Capture contents size */
+    size_t              pos;        /**< Next record offset */
+    size_t              drop_pos;   /**< Offset up to which the mapped
+                                         capture memory was released */
+    hidrd_usbmon_fmt    fmt;        /**< Capture format */
+    bool                swap;       /**< True if pcap(ng) numbers need
+                                         byte-swapping */
+    uint32_t            link;       /**< pcap link type */
+    uint16_t           *if_list;    /**< pcapng section interface link
+                                         types */
+    size_t              if_num;     /**< Number of pcapng section
+                                         interfaces */
+
+    hidrd_usbmon_pend   pend_list[HIDRD_USBMON_PEND_NUM];
+                                    /**< Outstanding requests */
+    size_t              pend_next;  /**< Next request slot to reuse */
+    hidrd_usbmon_dev   *dev_list;   /**< Known device IDs */
+    size_t              dev_num;    /**< Number of known device IDs */
+    hidrd_buf           buf;        /**< Text data decoding buffer; reused
+                                         for each descriptor */
+
+    const void         *desc;       /**< Last descriptor scanned */
+    size_t              desc_size;  /**< Last descriptor size */
+    uint16_t            bus;        /**< Last descriptor bus number */
+    uint8_t             dev;        /**< Last descriptor device address */
+    uint16_t            iface;      /**< Last descriptor interface
+                                         number */
+    uint16_t            vid;        /**< Last descriptor device vendor ID,
+                                         or zero if unknown */
+    uint16_t            pid;        /**< Last descriptor device product
+                                         ID, or zero if unknown */
+    size_t              trunc_num;  /**< Number of report descriptors
+                                         skipped, because they were not
+                                         captured completely */
+    int                 err;        /**< Error number of the scanning
+                                         failure, or zero */
+} hidrd_usbmon_scan;
+
+/**
+ * Initialize a usbmon capture report descriptor scanner over a capture
+ * in memory; the capture format is detected from its contents.
+ *
+ * @param scan  Scanner to initialize.
+ * @param ptr   Capture contents; must stay available until the scanner
+ *              is closed.
+ * @param size  Capture contents size.
+ *
+ * @return True if initialized successfully, false otherwise (see errno
+ *         in this case).
+ */
+extern bool hidrd_usbmon_scan_init(hidrd_usbmon_scan   *scan,
+                                   const void          *ptr,
+                                   size_t               size);
+
+/**
+ * Open a usbmon capture report descriptor scanner over a capture file,
+ * mapping it into memory.
+ *
+ * @param scan  Scanner to open.
+ * @param path  Capture file path.
+ *
+ * @return True if opened successfully, false otherwise (see errno in this
+ *         case).
+ */
+extern bool hidrd_usbmon_scan_open(hidrd_usbmon_scan *scan,
+                                   const char *path);
+
+/**
+ * Check if a usbmon capture report descriptor scanner is valid.
+ *
+ * @param scan  Scanner to check.
+ *
+ * @return True if the scanner is valid, false otherwise.
+ */
+extern bool hidrd_usbmon_scan_valid(const hidrd_usbmon_scan *scan);
+
+/**
+ * Scan the next report descriptor; text capture lines which can't be
+ * parsed are skipped.
+ *
+ * @param scan  Scanner to scan with.
+ *
+ * @return True if the next descriptor was found, false if there are no
+ *         more descriptors, or scanning failed; scan->err is set to the
+ *         error number in the latter case, EINVAL if the capture is
+ *         invalid, and the scanning can't be continued.
+ */
+extern bool hidrd_usbmon_scan_next(hidrd_usbmon_scan *scan);
+
+/**
+ * Close a usbmon capture report descriptor scanner, unmapping the
+ * capture file, if any.
+ *
+ * @param scan  Scanner to close.
+ */
+extern void hidrd_usbmon_scan_close(hidrd_usbmon_scan *scan);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __HIDRD_UTIL_USBMON_H__ */
@@ -27,5 +27,6 @@
 const hidrd_fmt hidrd_code  = {
     .name   = "code",
     .desc   = "source code",
+    .src    = &hidrd_code_src,
     .snk    = &hidrd_code_snk
 };
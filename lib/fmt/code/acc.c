@@ -0,0 +1,306 @@
+/** @file
+ * @brief HID report descriptor - source code sink - report accessors
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "acc.h"
+
+/** Generic bit field reading function template, takes the prefix */
+static const char code_acc_bits_get_fmt[] =
+"static inline uint32_t\n"
+"%s_bits_get(const uint8_t *report, uint32_t bit, uint32_t size)\n"
+"{\n"
+"    const uint8_t  *p      = report + (bit >> 3);\n"
+"    uint32_t        shift  = bit & 7;\n"
+"    uint32_t        n      = (shift + size + 7) >> 3;\n"
+"    uint64_t        v      = 0;\n"
+"    uint32_t        i;\n"
+"\n"
+"    for (i = 0; i < n; i++)\n"
+"        v |= (uint64_t)p[i] << (i * 8);\n"
+"\n"
+"    return (uint32_t)((v >> shift) & (((uint64_t)1 << size) - 1));\n"
+"}\n"
+"\n";
+
+/** Generic bit field writing function template, takes the prefix */
+static const char code_acc_bits_set_fmt[] =
+"static inline void\n"
+"%s_bits_set(uint8_t *report, uint32_t bit, uint32_t size, "
+"uint32_t value)\n"
+"{\n"
+"    uint8_t    *p      = report + (bit >> 3);\n"
+"    uint32_t    shift  = bit & 7;\n"
+"    uint32_t    n      = (shift + size + 7) >> 3;\n"
+"    uint64_t    mask   = (((uint64_t)1 << size) - 1) << shift;\n"
+"    uint64_t    v      = ((uint64_t)value << shift) & mask;\n"
+"    uint32_t    i;\n"
+"\n"
+"    for (i = 0; i < n; i++, mask >>= 8, v >>= 8)\n"
+"        p[i] = (uint8_t)((p[i] & ~mask) | v);\n"
+"}\n"
+"\n";
+
+bool
+code_acc_prefix_valid(const char *prefix)
+{
+    const char *p;
+
+    if (prefix == NULL || *prefix == '\0' || isdigit((unsigned char)*prefix))
+        return false;
+
+    for (p = prefix; *p != '\0'; p++)
+        if (!isalnum((unsigned char)*p) && *p != '_')
+            return false;
+
+    return true;
+}
+
+
+/**
+ * Output a value bit offset expression, relative to the report buffer
+ * start, including the report ID byte.
+ *
+ * @param buf       Buffer to append the expression to.
+ * @param layout    Layout the field belongs to.
+ * @param field     Field the value belongs to.
+ *
+ * @return True if output successfully, false if failed to allocate memory.
+ */
+static bool
+code_acc_add_bit(hidrd_buf                 *buf,
+                 const hidrd_layout        *layout,
+                 const hidrd_layout_field  *field)
+{
+    uint32_t    bit = (layout->ids ? 8 : 0) + field->bit_off;
+
+    return (field->count > 1)
+            ? hidrd_buf_add_printf(buf, "%u + idx * %u",
+                                   bit, field->bit_size)
+            : hidrd_buf_add_printf(buf, "%u", bit);
+}
+
+
+/**
+ * Output accessor functions for a single field.
+ *
+ * @param buf       Buffer to append the code to.
+ * @param prefix    Lower case name prefix, including report direction and
+ *                  ID.
+ * @param uprefix   Upper case name prefix, including report direction and
+ *                  ID.
+ * @param bprefix   Bit field function name prefix.
+ * @param layout    Layout the field belongs to.
+ * @param field     Field to output accessors for.
+ * @param idx       Field index in the report.
+ *
+ * @return True if output successfully, false if failed to allocate memory.
+ */
+static bool
+code_acc_add_field(hidrd_buf                   *buf,
+                   const char                  *prefix,
+                   const char                  *uprefix,
+                   const char                  *bprefix,
+                   const hidrd_layout          *layout,
+                   const hidrd_layout_field    *field,
+                   uint32_t                     idx)
+{
+    const hidrd_layout_usage   *usage;
+    bool                        sgnd;
+    const char                 *idx_arg;
+
+    sgnd = (field->flags & HIDRD_LAYOUT_FIELD_FLAG_SIGNED) &&
+           field->bit_size < 32;
+    idx_arg = (field->count > 1) ? ", uint32_t idx" : "";
+
+    /* Describe the field */
+    if (!hidrd_buf_add_printf(buf, "/* Field %u: %s, %u x %u bit",
+                              idx,
+                              (field->flags &
+                               HIDRD_LAYOUT_FIELD_FLAG_VARIABLE)
+                                ? "variable" : "array",
+                              field->count, field->bit_size))
+        return false;
+    if (field->usage_num > 0)
+    {
+        usage = hidrd_layout_field_get_usage_list(layout, field);
+        if (!((usage->min == usage->max)
+                ? hidrd_buf_add_printf(buf, ", usage 0x%08X",
+                                       usage->min)
+                : hidrd_buf_add_printf(buf, ", usage 0x%08X-0x%08X",
+                                       usage->min, usage->max)))
+            return false;
+    }
+    if (field->usage_num > 1 && !hidrd_buf_add_str(buf, ", ..."))
+        return false;
+    if (!hidrd_buf_add_printf(buf, ", logical %d..%d */\n",
+                              field->logical_minimum,
+                              field->logical_maximum))
+        return false;
+
+    if (field->count > 1 &&
+        !hidrd_buf_add_printf(buf, "#define %s_F%u_COUNT %u\n\n",
+                              uprefix, idx, field->count))
+        return false;
+
+    /* Output the getter */
+    if (!hidrd_buf_add_printf(buf,
+                              "static inline %s\n"
+                              "%s_f%u_get(const uint8_t *report%s)\n"
+                              "{\n",
+                              sgnd ? "int32_t" : "uint32_t",
+                              prefix, idx, idx_arg))
+        return false;
+    if (!(sgnd
+            ? hidrd_buf_add_printf(buf, "    return (int32_t)(%s_bits_get(",
+                                   bprefix)
+            : hidrd_buf_add_printf(buf, "    return %s_bits_get(",
+                                   bprefix)))
+        return false;
+    if (!hidrd_buf_add_str(buf, "report, ") ||
+        !code_acc_add_bit(buf, layout, field))
+        return false;
+    if (!(sgnd
+            ? hidrd_buf_add_printf(buf, ", %u) ^ 0x%Xu) - 0x%X;\n",
+                                   field->bit_size,
+                                   1u << (field->bit_size - 1),
+                                   1u << (field->bit_size - 1))
+            : hidrd_buf_add_printf(buf, ", %u);\n", field->bit_size)))
+        return false;
+    if (!hidrd_buf_add_str(buf, "}\n\n"))
+        return false;
+
+    /* Output the setter */
+    if (!hidrd_buf_add_printf(buf,
+                              "static inline void\n"
+                              "%s_f%u_set(uint8_t *report%s, %s value)\n"
+                              "{\n"
+                              "    %s_bits_set(report, ",
+                              prefix, idx, idx_arg,
+                              sgnd ? "int32_t" : "uint32_t",
+                              bprefix) ||
+        !code_acc_add_bit(buf, layout, field) ||
+        !hidrd_buf_add_printf(buf, ", %u, %svalue);\n"
+                                   "}\n\n",
+                              field->bit_size,
+                              sgnd ? "(uint32_t)" : ""))
+        return false;
+
+    return true;
+}
+
+
+bool
+code_acc_add(hidrd_buf *buf, const char *prefix, const hidrd_layout *layout)
+{
+    static const char  *dir_name_list[HIDRD_LAYOUT_DIR_NUM] = {
+        [HIDRD_LAYOUT_DIR_INPUT]    = "input",
+        [HIDRD_LAYOUT_DIR_OUTPUT]   = "output",
+        [HIDRD_LAYOUT_DIR_FEATURE]  = "feature",
+    };
+    bool                        result      = false;
+    char                       *rprefix     = NULL;
+    char                       *uprefix     = NULL;
+    char                       *p;
+    hidrd_layout_dir            dir;
+    unsigned int                id;
+    const hidrd_layout_report  *report;
+    const hidrd_layout_field   *field;
+    uint32_t                    i;
+    int                         rc;
+
+    assert(buf != NULL);
+    assert(code_acc_prefix_valid(prefix));
+    assert(hidrd_layout_valid(layout));
+
+    if (!hidrd_buf_add_printf(buf, code_acc_bits_get_fmt, prefix) ||
+        !hidrd_buf_add_printf(buf, code_acc_bits_set_fmt, prefix))
+        goto cleanup;
+
+    for (dir = 0; dir < HIDRD_LAYOUT_DIR_NUM; dir++)
+        for (id = 0; id < HIDRD_LAYOUT_ID_NUM; id++)
+        {
+            report = hidrd_layout_lookup(layout, dir, id);
+            if (report == NULL)
+                continue;
+
+            /* Format the report name prefixes */
+            free(rprefix);
+            free(uprefix);
+            uprefix = NULL;
+            rc = layout->ids
+                    ? asprintf(&rprefix, "%s_%s_%u",
+                               prefix, dir_name_list[dir], id)
+                    : asprintf(&rprefix, "%s_%s",
+                               prefix, dir_name_list[dir]);
+            if (rc < 0)
+            {
+                rprefix = NULL;
+                goto cleanup;
+            }
+            uprefix = strdup(rprefix);
+            if (uprefix == NULL)
+                goto cleanup;
+            for (p = uprefix; *p != '\0'; p++)
+                *p = toupper((unsigned char)*p);
+
+            /* Output the report macros */
+            if (layout->ids
+                    ? !hidrd_buf_add_printf(buf,
+                                            "/* %c%s report %u */\n"
+                                            "#define %s_ID %u\n",
+                                            toupper(*dir_name_list[dir]),
+                                            dir_name_list[dir] + 1, id,
+                                            uprefix, id)
+                    : !hidrd_buf_add_printf(buf, "/* %c%s report */\n",
+                                            toupper(*dir_name_list[dir]),
+                                            dir_name_list[dir] + 1))
+                goto cleanup;
+            if (!hidrd_buf_add_printf(
+                        buf, "#define %s_SIZE %zu\n\n",
+                        uprefix,
+                        hidrd_layout_report_get_bytes(layout, report)))
+                goto cleanup;
+
+            /* Output non-constant field accessors */
+            field = hidrd_layout_report_get_field_list(layout, report);
+            for (i = 0; i < report->field_num; i++, field++)
+                if (!(field->flags & HIDRD_LAYOUT_FIELD_FLAG_CONSTANT) &&
+                    !code_acc_add_field(buf, rprefix, uprefix, prefix,
+                                        layout, field, i))
+                    goto cleanup;
+        }
+
+    result = true;
+
+cleanup:
+
+    free(uprefix);
+    free(rprefix);
+
+    return result;
+}
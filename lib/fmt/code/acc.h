@@ -0,0 +1,64 @@
+/** @file
+ * @brief HID report descriptor - source code sink - report accessors
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __CODE_ACC_H__
+#define __CODE_ACC_H__
+
+#include <stdbool.h>
+#include "hidrd/util/buf.h"
+#include "hidrd/layout/inst.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Check if a string is a valid accessor name prefix, i.e. a C identifier.
+ *
+ * @param prefix    Prefix to check.
+ *
+ * @return True if the prefix is valid, false otherwise.
+ */
+extern bool code_acc_prefix_valid(const char *prefix);
+
+/**
+ * Output report definition macros and bit-accessor inline functions for
+ * each report of a layout.
+ *
+ * @param buf       Buffer to append the code to.
+ * @param prefix    Name prefix for the generated functions and macros
+ *                  (lower case for functions, upper case for macros).
+ * @param layout    Layout to generate the accessors for.
+ *
+ * @return True if output successfully, false if failed to allocate memory.
+ */
+extern bool code_acc_add(hidrd_buf             *buf,
+                         const char            *prefix,
+                         const hidrd_layout    *layout);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* __CODE_ACC_H__ */
@@ -22,22 +22,48 @@
  * @author Nikolai Kondrashov <spbnick@gmail.com>
  */
 
+#include <string.h>
 #include "hidrd/cfg.h"
 #include "hidrd/util/buf.h"
+#include "hidrd/layout/cmpl.h"
 #include "hidrd/fmt/code/snk.h"
+#include "acc.h"
 
 static bool
 hidrd_code_snk_init(hidrd_snk *snk, char **perr,
                     size_t tabstop, bool indent,
-                    bool comments, bool comments_comments)
+                    bool comments, bool comments_comments,
+                    bool accessors, const char *prefix)
 {
     hidrd_code_snk_inst    *code_snk    = (hidrd_code_snk_inst *)snk;
+    char                   *prefix_dup;
+
+    if (!code_acc_prefix_valid(prefix))
+    {
+        if (perr != NULL)
+            *perr = strdup("invalid accessor name prefix");
+        return false;
+    }
+
+    prefix_dup = strdup(prefix);
+    if (prefix_dup == NULL)
+    {
+        if (perr != NULL)
+            *perr = strdup("memory allocation failure");
+        return false;
+    }
 
     if (!hidrd_spec_snk_init(snk, perr, tabstop, false, comments_comments))
+    {
+        free(prefix_dup);
         return false;
+    }
 
     code_snk->indent = indent;
     code_snk->comments = comments;
+    code_snk->accessors = accessors;
+    code_snk->prefix = prefix_dup;
+    code_snk->err = NULL;
 
     return true;
 }
@@ -51,34 +77,65 @@ hidrd_code_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
     bool    comments            = (va_arg(ap, int) != 0);
     bool    comments_comments   = (va_arg(ap, int) != 0);
 
+    /* Report accessors are only available through the options */
     return hidrd_code_snk_init(snk, perr,
-                               tabstop, indent, comments, comments_comments);
+                               tabstop, indent, comments, comments_comments,
+                               false, "hid");
 }
 
 
 #ifdef HIDRD_WITH_OPT
+/** Option indexes into the specification list */
+enum {
+    OPT_TABSTOP,
+    OPT_INDENT,
+    OPT_COMMENTS,
+    OPT_COMMENTS_COMMENTS,
+    OPT_ACCESSORS,
+    OPT_PREFIX,
+    OPT_NUM
+};
+
 static const hidrd_opt_spec hidrd_code_snk_opts_spec[] = {
-    {.name  = "tabstop",
-     .type  = HIDRD_OPT_TYPE_U32,
-     .req   = false,
-     .dflt  = {.u32 = 4},
-     .desc  = "number of spaces per tab"},
-    {.name  = "indent",
-     .type  = HIDRD_OPT_TYPE_BOOLEAN,
-     .req   = false,
-     .dflt  = {.boolean = false},
-     .desc  = "indent item data according to descriptor structure"},
-    {.name  = "comments",
-     .type  = HIDRD_OPT_TYPE_BOOLEAN,
-     .req   = false,
-     .dflt  = {.boolean = true},
-     .desc  = "enable comments in specification example format"},
-    {.name  = "comments_comments",
-     .type  = HIDRD_OPT_TYPE_BOOLEAN,
-     .req   = false,
-     .dflt  = {.boolean = false},
-     .desc  = "enable comments in specification example format comments"},
-    {.name  = NULL}
+    [OPT_TABSTOP] =
+        {.name  = "tabstop",
+         .type  = HIDRD_OPT_TYPE_U32,
+         .req   = false,
+         .dflt  = {.u32 = 4},
+         .desc  = "number of spaces per tab"},
+    [OPT_INDENT] =
+        {.name  = "indent",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {.boolean = false},
+         .desc  = "indent item data according to descriptor structure"},
+    [OPT_COMMENTS] =
+        {.name  = "comments",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {.boolean = true},
+         .desc  = "enable comments in specification example format"},
+    [OPT_COMMENTS_COMMENTS] =
+        {.name  = "comments_comments",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {.boolean = false},
+         .desc  = "enable comments in specification example format comments"},
+    [OPT_ACCESSORS] =
+        {.name  = "accessors",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {.boolean = false},
+         .desc  = "wrap the descriptor into an array definition and add "
+                  "report bit field accessor functions"},
+    [OPT_PREFIX] =
+        {.name  = "prefix",
+         .type  = HIDRD_OPT_TYPE_STRING,
+         .req   = false,
+         .dflt  = {.string = "hid"},
+         .desc  = "descriptor array and accessor name prefix"},
+    [OPT_NUM] =
+        {.name  = NULL}
 };
 
 static bool
@@ -86,10 +143,12 @@ hidrd_code_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
 {
     return hidrd_code_snk_init(
                 snk, perr,
-                hidrd_opt_list_get_u32(list, "tabstop"),
-                hidrd_opt_list_get_boolean(list, "indent"),
-                hidrd_opt_list_get_boolean(list, "comments"),
-                hidrd_opt_list_get_boolean(list, "comments_comments"));
+                hidrd_opt_list_get_u32_at(list, OPT_TABSTOP),
+                hidrd_opt_list_get_boolean_at(list, OPT_INDENT),
+                hidrd_opt_list_get_boolean_at(list, OPT_COMMENTS),
+                hidrd_opt_list_get_boolean_at(list, OPT_COMMENTS_COMMENTS),
+                hidrd_opt_list_get_boolean_at(list, OPT_ACCESSORS),
+                hidrd_opt_list_get_string_at(list, OPT_PREFIX));
 }
 #endif /* HIDRD_WITH_OPT */
 
@@ -97,7 +156,11 @@ hidrd_code_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
 static bool
 hidrd_code_snk_valid(const hidrd_snk *snk)
 {
+    const hidrd_code_snk_inst  *code_snk    = (const hidrd_code_snk_inst *)
+                                                snk;
+
     return (snk->type->size >= sizeof(hidrd_code_snk_inst)) &&
+           code_acc_prefix_valid(code_snk->prefix) &&
            hidrd_spec_snk_valid(snk);
 }
 
@@ -118,6 +181,19 @@ hidrd_code_snk_flush(hidrd_snk *snk)
     hidrd_buf                       buf         = HIDRD_BUF_EMPTY;
     uint8_t                        *item_p;
     size_t                          item_size;
+    hidrd_layout_cmpl               cmpl;
+    bool                            cmpl_init   = false;
+    hidrd_layout                   *layout      = NULL;
+    char                           *text        = NULL;
+    size_t                          text_len    = 0;
+    const char                     *line;
+    const char                     *line_end;
+    char                           *buf_ptr;
+    size_t                          buf_len;
+
+    /* Forget the previous flush error */
+    free(code_snk->err);
+    code_snk->err = NULL;
 
     if (snk->pbuf != NULL)
     {
@@ -192,22 +268,117 @@ hidrd_code_snk_flush(hidrd_snk *snk)
         hidrd_buf_reset(&buf);
     }
 
+    /* If only the descriptor bytes are requested */
+    if (!code_snk->accessors)
+    {
+        /* Render the table */
+        result = hidrd_ttbl_render((char **)snk->pbuf, snk->psize, tbl,
+                                   spec_snk->tabstop);
+        goto cleanup;
+    }
+
+    /* Compile the report layout from the same items */
+    if (!hidrd_layout_cmpl_init(&cmpl))
+        goto cleanup;
+    cmpl_init = true;
+    for (p = list->ptr, l = 0; l < list->len; p++, l++)
+        if (p->item != NULL && !hidrd_layout_cmpl_put(&cmpl, p->item))
+            break;
+    if (l >= list->len)
+        layout = hidrd_layout_cmpl_finish(&cmpl);
+    if (layout == NULL)
+    {
+        if (cmpl.err != HIDRD_LAYOUT_CMPL_ERR_ALLOC)
+        {
+            free(code_snk->err);
+            code_snk->err = hidrd_layout_cmpl_errmsg(&cmpl);
+        }
+        goto cleanup;
+    }
+
     /* Render the table */
-    result = hidrd_ttbl_render((char **)snk->pbuf, snk->psize, tbl,
-                               spec_snk->tabstop);
+    if (!hidrd_ttbl_render(&text, &text_len, tbl, spec_snk->tabstop))
+        goto cleanup;
+
+    /* Output the descriptor array, indenting the table */
+    if (!hidrd_buf_add_printf(&buf,
+                              "#include <stdint.h>\n"
+                              "\n"
+                              "static const uint8_t %s_desc[] = {\n",
+                              code_snk->prefix))
+        goto cleanup;
+    for (line = text; line < text + text_len; line = line_end)
+    {
+        line_end = memchr(line, '\n', text + text_len - line);
+        line_end = (line_end == NULL) ? text + text_len : line_end + 1;
+        if (!hidrd_buf_add_span(&buf, ' ', spec_snk->tabstop) ||
+            !hidrd_buf_add_ptr(&buf, line, line_end - line))
+            goto cleanup;
+    }
+    if (!hidrd_buf_add_str(&buf, "};\n\n"))
+        goto cleanup;
+
+    /* Output the accessors */
+    if (!code_acc_add(&buf, code_snk->prefix, layout))
+        goto cleanup;
+
+    /* Remove the trailing empty line */
+    hidrd_buf_del(&buf, 1);
+
+    hidrd_buf_retention(&buf);
+    hidrd_buf_disown(&buf, (void **)&buf_ptr, &buf_len, NULL);
+    if (snk->pbuf != NULL)
+        *snk->pbuf = buf_ptr;
+    else
+        free(buf_ptr);
+    if (snk->psize != NULL)
+        *snk->psize = buf_len;
+
+    result = true;
 
 cleanup:
 
+    free(text);
+    hidrd_layout_delete(layout);
+    if (cmpl_init)
+        hidrd_layout_cmpl_clnp(&cmpl);
     hidrd_buf_clnp(&buf);
     hidrd_ttbl_delete(tbl);
 
-    spec_snk->err = result ? HIDRD_SPEC_SNK_ERR_NONE
-                           : HIDRD_SPEC_SNK_ERR_ALLOC;
+    spec_snk->err = (result || code_snk->err != NULL)
+                        ? HIDRD_SPEC_SNK_ERR_NONE
+                        : HIDRD_SPEC_SNK_ERR_ALLOC;
 
     return result;
 }
 
 
+static char *
+hidrd_code_snk_errmsg(const hidrd_snk *snk)
+{
+    const hidrd_code_snk_inst  *code_snk    = (const hidrd_code_snk_inst *)
+                                                snk;
+
+    return (code_snk->err != NULL)
+                ? strdup(code_snk->err)
+                : hidrd_spec_snk_errmsg(snk);
+}
+
+
+static void
+hidrd_code_snk_clnp(hidrd_snk *snk)
+{
+    hidrd_code_snk_inst    *code_snk    = (hidrd_code_snk_inst *)snk;
+
+    free(code_snk->err);
+    code_snk->err = NULL;
+    free(code_snk->prefix);
+    code_snk->prefix = NULL;
+
+    hidrd_spec_snk_clnp(snk);
+}
+
+
 const hidrd_snk_type hidrd_code_snk = {
     .size       = sizeof(hidrd_code_snk_inst),
     .initv      = hidrd_code_snk_initv,
@@ -216,10 +387,10 @@ const hidrd_snk_type hidrd_code_snk = {
     .opts_spec  = hidrd_code_snk_opts_spec,
 #endif
     .valid      = hidrd_code_snk_valid,
-    .errmsg     = hidrd_spec_snk_errmsg,
+    .errmsg     = hidrd_code_snk_errmsg,
     .put        = hidrd_spec_snk_put,
     .flush      = hidrd_code_snk_flush,
-    .clnp       = hidrd_spec_snk_clnp,
+    .clnp       = hidrd_code_snk_clnp,
 };
 
 
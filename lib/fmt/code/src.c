@@ -0,0 +1,450 @@
+/** @file
+ * @brief HID report descriptor - source code source
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <string.h>
+#include "hidrd/util/hex.h"
+#include "hidrd/fmt/code/src.h"
+
+static bool
+hidrd_code_src_valid(const hidrd_src *src)
+{
+    const hidrd_code_src_inst  *code_src   =
+                                        (const hidrd_code_src_inst *)src;
+
+    return (src->type->size >= sizeof(hidrd_code_src_inst)) &&
+           (code_src->pos <= src->size) &&
+           (code_src->line_pos <= code_src->pos) &&
+           (code_src->len <= sizeof(code_src->buf));
+}
+
+
+static char *
+hidrd_code_src_errmsg(const hidrd_src *src)
+{
+    const hidrd_code_src_inst  *code_src   =
+                                    (const hidrd_code_src_inst *)src;
+    const char                 *msg;
+
+    switch (code_src->err)
+    {
+        case HIDRD_CODE_SRC_ERR_NONE:
+            msg = "";
+            break;
+        case HIDRD_CODE_SRC_ERR_TOKEN:
+            msg = "unexpected token";
+            break;
+        case HIDRD_CODE_SRC_ERR_NUM:
+            msg = "invalid byte literal";
+            break;
+        case HIDRD_CODE_SRC_ERR_COMMENT:
+            msg = "unterminated comment";
+            break;
+        case HIDRD_CODE_SRC_ERR_ARRAY:
+            msg = "array initializer not found or unterminated";
+            break;
+        case HIDRD_CODE_SRC_ERR_SHORT:
+            msg = "incomplete item";
+            break;
+        case HIDRD_CODE_SRC_ERR_INVALID:
+            msg = "invalid item";
+            break;
+        default:
+            assert(!"Unknown error code");
+            return NULL;
+    }
+
+    return strdup(msg);
+}
+
+
+static size_t
+hidrd_code_src_getpos(const hidrd_src *src)
+{
+    const hidrd_code_src_inst  *code_src    = (hidrd_code_src_inst *)src;
+    size_t                      col         = code_src->pos -
+                                              code_src->line_pos;
+
+    return (code_src->line > 0xFFFF ? 0xFFFF : (code_src->line << 16)) |
+           (col > 0xFFFF ? 0xFFFF : col);
+}
+
+
+static char *
+hidrd_code_src_fmtpos(const hidrd_src *src, size_t pos)
+{
+    char       *str;
+    size_t      line    = (pos >> 16) & 0xFFFF;
+    size_t      col     = pos & 0xFFFF;
+    char        line_buf[16];
+    char        col_buf[16];
+
+    (void)src;
+
+    if (line >= 0xFFFF)
+        snprintf(line_buf, sizeof(line_buf), ">= 65536");
+    else
+        snprintf(line_buf, sizeof(line_buf), "%zu", line + 1);
+
+    if (col >= 0xFFFF)
+        snprintf(col_buf, sizeof(col_buf), ">= 65536");
+    else
+        snprintf(col_buf, sizeof(col_buf), "%zu", col + 1);
+
+    if (asprintf(&str, "line %s, column %s", line_buf, col_buf) < 0)
+        return NULL;
+
+    return str;
+}
+
+
+/**
+ * Fail reading a source code source at the current position.
+ *
+ * @param code_src  Source code source instance to fail.
+ * @param err       Error code to set.
+ *
+ * @return Always false.
+ */
+static bool
+hidrd_code_src_fail(hidrd_code_src_inst *code_src, hidrd_code_src_err err)
+{
+    code_src->src.error = true;
+    code_src->err = err;
+    return false;
+}
+
+
+/**
+ * Check if a character can be a part of a C identifier or number.
+ *
+ * @param c Character to check.
+ *
+ * @return True if the character can be a part of an identifier or number.
+ */
+static bool
+hidrd_code_src_isword(uint8_t c)
+{
+    return (c >= '0' && c <= '9') ||
+           (c >= 'a' && c <= 'z') ||
+           (c >= 'A' && c <= 'Z') ||
+           c == '_' || c == '.';
+}
+
+
+/**
+ * Skip whitespace, comments and preprocessor directives in the source
+ * buffer, tracking the line.
+ *
+ * @param code_src  Source code source instance to skip for.
+ *
+ * @return True if skipped successfully, false if an unterminated comment
+ *         is encountered. Error is set in the latter case.
+ */
+static bool
+hidrd_code_src_skip(hidrd_code_src_inst *code_src)
+{
+    const uint8_t  *buf     = (const uint8_t *)code_src->src.buf;
+    size_t          size    = code_src->src.size;
+    size_t          pos     = code_src->pos;
+    uint8_t         c;
+
+    while (pos < size)
+    {
+        c = buf[pos];
+        if (c == '\n')
+        {
+            pos++;
+            code_src->line++;
+            code_src->line_pos = pos;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r' ||
+                 c == '\v' || c == '\f')
+            pos++;
+        else if (c == '/' && pos + 1 < size && buf[pos + 1] == '*')
+        {
+            code_src->pos = pos;
+            for (pos += 2;
+                 pos + 1 < size && !(buf[pos] == '*' && buf[pos + 1] == '/');
+                 pos++)
+                if (buf[pos] == '\n')
+                {
+                    code_src->line++;
+                    code_src->line_pos = pos + 1;
+                }
+            if (pos + 1 >= size)
+                return hidrd_code_src_fail(code_src,
+                                           HIDRD_CODE_SRC_ERR_COMMENT);
+            pos += 2;
+        }
+        else if ((c == '/' && pos + 1 < size && buf[pos + 1] == '/') ||
+                 c == '#')
+        {
+            /* Skip line comment or preprocessor directive,
+             * honoring line continuations */
+            for (pos++;
+                 pos < size &&
+                 !(buf[pos] == '\n' && buf[pos - 1] != '\\');
+                 pos++)
+                if (buf[pos] == '\n')
+                {
+                    code_src->line++;
+                    code_src->line_pos = pos + 1;
+                }
+        }
+        else
+            break;
+    }
+
+    code_src->pos = pos;
+    return true;
+}
+
+
+/**
+ * Locate the start of the byte list: either the first byte literal of a
+ * bare list, or the opening brace of the first array initializer, in
+ * which case the position is moved past it.
+ *
+ * @param code_src  Source code source instance to locate the start for.
+ *
+ * @return True if located successfully or the buffer contains no tokens,
+ *         false otherwise. Error is set in the latter case.
+ */
+static bool
+hidrd_code_src_start(hidrd_code_src_inst *code_src)
+{
+    const uint8_t  *buf     = (const uint8_t *)code_src->src.buf;
+    size_t          size    = code_src->src.size;
+    uint8_t         c;
+    uint8_t         q;
+
+    code_src->started = true;
+
+    if (!hidrd_code_src_skip(code_src))
+        return false;
+
+    /* Empty or bare list */
+    if (code_src->pos >= size ||
+        (buf[code_src->pos] >= '0' && buf[code_src->pos] <= '9'))
+        return true;
+
+    /* Skip the declaration up to the initializer */
+    while (true)
+    {
+        if (!hidrd_code_src_skip(code_src))
+            return false;
+        if (code_src->pos >= size)
+            return hidrd_code_src_fail(code_src, HIDRD_CODE_SRC_ERR_ARRAY);
+
+        c = buf[code_src->pos++];
+        if (c == '{')
+            break;
+        if (c != '"' && c != '\'')
+            continue;
+
+        /* Skip a string or a character literal */
+        for (q = c; code_src->pos < size; code_src->pos++)
+        {
+            c = buf[code_src->pos];
+            if (c == q || c == '\n')
+                break;
+            if (c == '\\' && code_src->pos + 1 < size)
+                code_src->pos++;
+        }
+        if (code_src->pos >= size || c != q)
+            return hidrd_code_src_fail(code_src, HIDRD_CODE_SRC_ERR_TOKEN);
+        code_src->pos++;
+    }
+
+    code_src->depth = 1;
+    return true;
+}
+
+
+/**
+ * Read an integer literal from the source buffer.
+ *
+ * @param code_src  Source code source instance to read the literal from.
+ * @param pbyte     Location for the byte value read.
+ *
+ * @return True if read successfully, false otherwise. Error is set in the
+ *         latter case.
+ */
+static bool
+hidrd_code_src_num(hidrd_code_src_inst *code_src, uint8_t *pbyte)
+{
+    const uint8_t  *buf     = (const uint8_t *)code_src->src.buf;
+    size_t          size    = code_src->src.size;
+    size_t          pos     = code_src->pos;
+    uint32_t        base    = 10;
+    uint32_t        num     = 0;
+    uint32_t        digit;
+    size_t          len     = 0;
+    uint8_t         c;
+
+    if (buf[pos] == '0' && pos + 1 < size &&
+        (buf[pos + 1] == 'x' || buf[pos + 1] == 'X'))
+    {
+        base = 16;
+        pos += 2;
+    }
+    else if (buf[pos] == '0')
+        base = 8;
+
+    for (; pos < size; pos++, len++)
+    {
+        c = buf[pos];
+        if (base == 16)
+        {
+            digit = hidrd_hex_chr_class(c);
+            if (!(digit & HIDRD_HEX_CHR_DIGIT))
+                break;
+            digit &= 0xF;
+        }
+        else if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else
+            break;
+
+        if (digit >= base)
+            return hidrd_code_src_fail(code_src, HIDRD_CODE_SRC_ERR_NUM);
+        num = num * base + digit;
+        if (num > UINT8_MAX)
+            return hidrd_code_src_fail(code_src, HIDRD_CODE_SRC_ERR_NUM);
+    }
+
+    /* Skip integer suffix */
+    for (; pos < size &&
+           (buf[pos] == 'u' || buf[pos] == 'U' ||
+            buf[pos] == 'l' || buf[pos] == 'L');
+         pos++);
+
+    if (len == 0 || (pos < size && hidrd_code_src_isword(buf[pos])))
+        return hidrd_code_src_fail(code_src, HIDRD_CODE_SRC_ERR_NUM);
+
+    code_src->pos = pos;
+    *pbyte = num;
+    return true;
+}
+
+
+/**
+ * Read a byte from the source buffer into the decoded buffer, skipping
+ * the separators following it, so the position points to the next byte.
+ *
+ * @param code_src  Source code source instance to read the byte for.
+ *
+ * @return True if read successfully, false if end of the byte list is
+ *         reached or an error occurred. Error is set in the latter case.
+ */
+static bool
+hidrd_code_src_get_byte(hidrd_code_src_inst *code_src)
+{
+    const uint8_t  *buf     = (const uint8_t *)code_src->src.buf;
+    size_t          size    = code_src->src.size;
+    uint8_t         c;
+
+    if (!code_src->started && !hidrd_code_src_start(code_src))
+        return false;
+
+    while (!code_src->ended)
+    {
+        if (!hidrd_code_src_skip(code_src))
+            return false;
+
+        if (code_src->pos >= size)
+        {
+            if (code_src->depth > 0)
+                return hidrd_code_src_fail(code_src,
+                                           HIDRD_CODE_SRC_ERR_ARRAY);
+            code_src->ended = true;
+            break;
+        }
+
+        c = buf[code_src->pos];
+        if (c >= '0' && c <= '9')
+        {
+            if (!hidrd_code_src_num(code_src,
+                                    code_src->buf + code_src->len))
+                return false;
+            code_src->len++;
+            /* Skip trailing separators */
+            return hidrd_code_src_skip(code_src);
+        }
+        else if (c == ',')
+            code_src->pos++;
+        else if (c == '{' && code_src->depth > 0)
+        {
+            code_src->pos++;
+            code_src->depth++;
+        }
+        else if (c == '}' && code_src->depth > 0)
+        {
+            code_src->pos++;
+            if (--code_src->depth == 0)
+                code_src->ended = true;
+        }
+        else
+            return hidrd_code_src_fail(code_src, HIDRD_CODE_SRC_ERR_TOKEN);
+    }
+
+    return false;
+}
+
+
+static const hidrd_item *
+hidrd_code_src_get(hidrd_src *src)
+{
+    hidrd_code_src_inst    *code_src    = (hidrd_code_src_inst *)src;
+
+    while (!hidrd_item_fits(code_src->buf, code_src->len, NULL)) {
+        if (!hidrd_code_src_get_byte(code_src)) {
+            if (code_src->len > 0 && !src->error) {
+                src->error = true;
+                code_src->err = HIDRD_CODE_SRC_ERR_SHORT;
+            }
+            return NULL;
+        }
+    }
+
+    if (!hidrd_item_valid(code_src->buf))
+    {
+        src->error = true;
+        code_src->err = HIDRD_CODE_SRC_ERR_INVALID;
+        return NULL;
+    }
+
+    code_src->len = 0;
+    return code_src->buf;
+}
+
+
+const hidrd_src_type hidrd_code_src = {
+    .size   = sizeof(hidrd_code_src_inst),
+    .valid  = hidrd_code_src_valid,
+    .getpos = hidrd_code_src_getpos,
+    .fmtpos = hidrd_code_src_fmtpos,
+    .errmsg = hidrd_code_src_errmsg,
+    .get    = hidrd_code_src_get,
+};
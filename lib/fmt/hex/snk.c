@@ -22,6 +22,7 @@
  * @author Nikolai Kondrashov <spbnick@gmail.com>
  */
 
+#include "hidrd/util/hex.h"
 #include "hidrd/fmt/hex/snk.h"
 
 static bool
@@ -50,13 +51,21 @@ hidrd_hex_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
 
 
 #ifdef HIDRD_WITH_OPT
+/** Option indexes into the specification list */
+enum {
+    OPT_WIDTH,
+    OPT_NUM
+};
+
 const hidrd_opt_spec hidrd_hex_snk_opts_spec[] = {
-    {.name  = "width",
-     .type  = HIDRD_OPT_TYPE_U32,
-     .req   = false,
-     .dflt  = {.u32 = 16},
-     .desc  = "number of bytes per line"},
-    {.name  = NULL}
+    [OPT_WIDTH] =
+        {.name  = "width",
+         .type  = HIDRD_OPT_TYPE_U32,
+         .req   = false,
+         .dflt  = {.u32 = 16},
+         .desc  = "number of bytes per line"},
+    [OPT_NUM] =
+        {.name  = NULL}
 };
 
 bool
@@ -64,7 +73,7 @@ hidrd_hex_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
 {
     return hidrd_hex_snk_init(
                 snk, perr,
-                hidrd_opt_list_get_u32(list, "width"));
+                hidrd_opt_list_get_u32_at(list, OPT_WIDTH));
 }
 #endif /* HIDRD_WITH_OPT */
 
@@ -110,18 +119,26 @@ hidrd_hex_snk_put(hidrd_snk *snk, const hidrd_item *item)
     hidrd_hex_snk_inst *hex_snk     = (hidrd_hex_snk_inst *)snk;
     size_t              n;
     const uint8_t      *p;
+    char               *c;
 
     assert(hidrd_item_valid(item));
 
-    for (p = item, n = hidrd_item_get_size(item); n > 0; p++, n--) {
-        if (!hidrd_buf_add_printf(&hex_snk->buf, " %.2hhx", *p) ||
-            (hex_snk->width != 0 &&
-             (++hex_snk->bytes % hex_snk->width == 0) &&
-             !hidrd_buf_add_str(&hex_snk->buf, "\n"))) {
-            hex_snk->err = HIDRD_HEX_SNK_ERR_ALLOC;
-            return false;
-        }
+    n = hidrd_item_get_size(item);
+
+    /* Each byte takes a space, two digits and possibly a newline */
+    if (!hidrd_buf_grow(&hex_snk->buf, hex_snk->buf.len + n * 4)) {
+        hex_snk->err = HIDRD_HEX_SNK_ERR_ALLOC;
+        return false;
+    }
+
+    c = (char *)hex_snk->buf.ptr + hex_snk->buf.len;
+    for (p = item; n > 0; p++, n--) {
+        *c++ = ' ';
+        c = hidrd_hex_byte_to_chrs(c, *p, true);
+        if (hex_snk->width != 0 && ++hex_snk->bytes % hex_snk->width == 0)
+            *c++ = '\n';
     }
+    hex_snk->buf.len = c - (char *)hex_snk->buf.ptr;
 
     return true;
 }
@@ -153,7 +170,8 @@ hidrd_hex_snk_flush(hidrd_snk *snk)
             hex_snk->err = HIDRD_HEX_SNK_ERR_ALLOC;
             goto cleanup;
         }
-        memcpy(new_buf, hex_snk->buf.ptr, new_size);
+        if (new_size > 0)
+            memcpy(new_buf, hex_snk->buf.ptr, new_size);
         free(*snk->pbuf);
         *snk->pbuf = new_buf;
         new_buf = NULL;
@@ -177,11 +195,8 @@ hidrd_hex_snk_clnp(hidrd_snk *snk)
 {
     hidrd_hex_snk_inst   *hex_snk   = (hidrd_hex_snk_inst *)snk;
 
-    /* If the user owns the buffer */
-    if (snk->pbuf != NULL)
-        hidrd_buf_init(&hex_snk->buf);
-    else
-        hidrd_buf_clnp(&hex_snk->buf);
+    /* The user gets a copy of the buffer on flush */
+    hidrd_buf_clnp(&hex_snk->buf);
 
     hex_snk->bytes  = 0;
     hex_snk->err    = HIDRD_HEX_SNK_ERR_NONE;
@@ -24,7 +24,7 @@
 
 #include <errno.h>
 #include <string.h>
-#include <ctype.h>
+#include "hidrd/util/hex.h"
 #include "hidrd/fmt/hex/src.h"
 
 static bool
@@ -111,7 +111,40 @@ hidrd_hex_src_fmtpos(const hidrd_src *src, size_t pos)
 
 
 /**
- * Read a byte from the source buffer into the decoded buffer.
+ * Skip whitespace in the source buffer, tracking the line and column.
+ *
+ * @param hex_src   The hex dump source instance to skip whitespace for.
+ * @param pos       Buffer position to start at.
+ *
+ * @return Buffer position of the first non-whitespace character, or the
+ *         buffer size.
+ */
+static size_t
+hidrd_hex_src_skip_space(hidrd_hex_src_inst *hex_src, size_t pos)
+{
+    const uint8_t  *buf     = (const uint8_t *)hex_src->src.buf;
+    size_t          size    = hex_src->src.size;
+
+    for (; pos < size &&
+           hidrd_hex_chr_class(buf[pos]) == HIDRD_HEX_CHR_SPACE;
+         pos++)
+    {
+        if (buf[pos] == '\n')
+        {
+            hex_src->line++;
+            hex_src->col = 0;
+        }
+        else
+            hex_src->col++;
+    }
+
+    return pos;
+}
+
+
+/**
+ * Read a byte from the source buffer into the decoded buffer, skipping
+ * the whitespace following it, so the position points to the next byte.
  *
  * @param hex_src   The hex dump source instance to read the byte for.
  *
@@ -121,58 +154,50 @@ hidrd_hex_src_fmtpos(const hidrd_src *src, size_t pos)
 static bool
 hidrd_hex_src_get_byte(hidrd_hex_src_inst *hex_src)
 {
-    hidrd_src  *src = &hex_src->src;
-    size_t      pos     = hex_src->pos;
-    uint8_t     byte    = 0;
-    size_t      len     = 0;
-    uint8_t     c;
-    uint8_t     nibble;
-
-    while (true) {
-        if (pos >= src->size) {
-            hex_src->pos = pos;
-            if (len == 0)
-                return false;
-            else
-                break;
-        }
-        c = ((uint8_t *)src->buf)[pos];
-        if (isxdigit(c)) {
-            if (len >= 8) {
-                src->error = true;
-                hex_src->err = HIDRD_HEX_SRC_ERR_NUM;
-                return false;
-            }
-            if (c >= 'a') {
-                nibble = c - 'a' + 10;
-            } else if (c >= 'A') {
-                nibble = c - 'A' + 10;
-            } else {
-                nibble = c - '0';
-            }
-            byte = (byte << 4) | nibble;
-            len += 4;
-            hex_src->col++;
-        } else if (isspace(c)) {
-            hex_src->pos = pos;
-            if (c == '\n') {
-                hex_src->line++;
-                hex_src->col = 0;
-            } else {
-                hex_src->col++;
-            }
-            if (len > 0)
-                break;
-        } else {
+    hidrd_src      *src     = &hex_src->src;
+    const uint8_t  *buf     = (const uint8_t *)src->buf;
+    size_t          size    = src->size;
+    size_t          pos     = hex_src->pos;
+    uint8_t         byte    = 0;
+    size_t          len     = 0;
+    uint8_t         cls     = HIDRD_HEX_CHR_INVALID;
+
+    /* Skip leading whitespace */
+    pos = hidrd_hex_src_skip_space(hex_src, pos);
+    hex_src->pos = pos;
+    if (pos >= size)
+        return false;
+
+    /* Read the digits */
+    for (; pos < size &&
+           ((cls = hidrd_hex_chr_class(buf[pos])) & HIDRD_HEX_CHR_DIGIT);
+         pos++)
+    {
+        if (len >= 8)
+        {
             hex_src->pos = pos;
             src->error = true;
-            hex_src->err = HIDRD_HEX_SRC_ERR_CHAR;
+            hex_src->err = HIDRD_HEX_SRC_ERR_NUM;
             return false;
         }
-        pos++;
+        byte = (byte << 4) | (cls & 0xF);
+        len += 4;
+        hex_src->col++;
+    }
+
+    hex_src->pos = pos;
+    if (pos < size && cls != HIDRD_HEX_CHR_SPACE)
+    {
+        src->error = true;
+        hex_src->err = HIDRD_HEX_SRC_ERR_CHAR;
+        return false;
     }
 
     hex_src->buf[hex_src->len++] = byte;
+
+    /* Skip trailing whitespace */
+    hex_src->pos = hidrd_hex_src_skip_space(hex_src, pos);
+
     return true;
 }
 
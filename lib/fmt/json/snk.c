@@ -0,0 +1,928 @@
+/** @file
+ * @brief HID report descriptor - JSON stream sink
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <inttypes.h>
+#include "hidrd/util/hex.h"
+#include "hidrd/util/str.h"
+#include "hidrd/fmt/json/snk.h"
+
+/** Group codes, stored in the open group stack */
+typedef enum json_snk_group {
+    JSON_SNK_GROUP_COLLECTION,  /**< Collection / end collection */
+    JSON_SNK_GROUP_PUSH,        /**< Push / pop */
+    JSON_SNK_GROUP_SET          /**< Delimiter open / close */
+} json_snk_group;
+
+/** Group element names, indexed by group code */
+static const char *json_snk_group_name_list[] = {
+    [JSON_SNK_GROUP_COLLECTION] = "collection",
+    [JSON_SNK_GROUP_PUSH]       = "push",
+    [JSON_SNK_GROUP_SET]        = "set"
+};
+
+/** Unmatched group end element names, indexed by group code */
+static const char *json_snk_group_end_name_list[] = {
+    [JSON_SNK_GROUP_COLLECTION] = "end_collection",
+    [JSON_SNK_GROUP_PUSH]       = "pop",
+    [JSON_SNK_GROUP_SET]        = "end_set"
+};
+
+/** Memoized string kinds */
+typedef enum json_snk_memo_kind {
+    JSON_SNK_MEMO_PAGE,     /**< Usage page token or hex */
+    JSON_SNK_MEMO_USAGE_ID, /**< Current page usage ID token or hex */
+    JSON_SNK_MEMO_USAGE     /**< Other page usage token or hex */
+} json_snk_memo_kind;
+
+/*
+ * Format a value as a lowercase token or a decimal number, if there is no
+ * token for it, or as a decimal number only, if tokens are disabled.
+ */
+#define TOKEN_OR_DEC(_type, _value) \
+    (json_snk->tokens                                                   \
+        ? HIDRD_NUM_TO_ALT_STR2_1(_type, _value, token, lc, dec)        \
+        : hidrd_##_type##_to_dec(_value))
+
+
+static bool
+hidrd_json_snk_init(hidrd_snk *snk, char **perr, bool format, bool tokens)
+{
+    hidrd_json_snk_inst    *json_snk    = (hidrd_json_snk_inst *)snk;
+
+    json_snk->format        = format;
+    json_snk->tokens        = tokens;
+    hidrd_buf_init(&json_snk->buf);
+    hidrd_buf_init(&json_snk->groups);
+    hidrd_buf_init(&json_snk->pages);
+    json_snk->usage_page    = HIDRD_USAGE_PAGE_UNDEFINED;
+    json_snk->first         = true;
+    hidrd_memo_init(&json_snk->memo);
+    json_snk->err           = HIDRD_JSON_SNK_ERR_NONE;
+
+    if (perr != NULL)
+        *perr = strdup("");
+
+    return true;
+}
+
+
+static bool
+hidrd_json_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
+{
+    bool    format  = (va_arg(ap, int) != 0);
+    bool    tokens  = (va_arg(ap, int) != 0);
+
+    return hidrd_json_snk_init(snk, perr, format, tokens);
+}
+
+
+#ifdef HIDRD_WITH_OPT
+/** Option indexes into the specification list */
+enum {
+    OPT_FORMAT,
+    OPT_TOKENS,
+    OPT_NUM
+};
+
+static const hidrd_opt_spec hidrd_json_snk_opts_spec[] = {
+    [OPT_FORMAT] =
+        {.name  = "format",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {
+             .boolean = true
+         },
+         .desc  = "format JSON output"},
+    [OPT_TOKENS] =
+        {.name  = "tokens",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {
+             .boolean = true
+         },
+         .desc  = "output symbolic tokens instead of numbers"},
+    [OPT_NUM] =
+        {.name  = NULL}
+};
+
+static bool
+hidrd_json_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
+{
+    return hidrd_json_snk_init(
+                snk, perr,
+                hidrd_opt_list_get_boolean_at(list, OPT_FORMAT),
+                hidrd_opt_list_get_boolean_at(list, OPT_TOKENS));
+}
+#endif /* HIDRD_WITH_OPT */
+
+
+static bool
+hidrd_json_snk_valid(const hidrd_snk *snk)
+{
+    const hidrd_json_snk_inst  *json_snk    =
+                                    (const hidrd_json_snk_inst *)snk;
+
+    return (snk->type->size >= sizeof(hidrd_json_snk_inst)) &&
+           hidrd_buf_valid(&json_snk->buf) &&
+           hidrd_buf_valid(&json_snk->groups) &&
+           hidrd_buf_valid(&json_snk->pages) &&
+           (json_snk->pages.len % sizeof(hidrd_usage_page)) == 0 &&
+           hidrd_memo_valid(&json_snk->memo);
+}
+
+
+static char *
+hidrd_json_snk_errmsg(const hidrd_snk *snk)
+{
+    const hidrd_json_snk_inst  *json_snk    =
+                                    (const hidrd_json_snk_inst *)snk;
+    const char                 *msg;
+
+    switch (json_snk->err)
+    {
+        case HIDRD_JSON_SNK_ERR_NONE:
+            msg = "";
+            break;
+        case HIDRD_JSON_SNK_ERR_ALLOC:
+            msg = "memory allocation failure";
+            break;
+        default:
+            assert(!"Unknown error code");
+            return NULL;
+    }
+
+    return strdup(msg);
+}
+
+
+/**
+ * Output a line break and indentation for the specified nesting level,
+ * if formatting is enabled.
+ *
+ * @param json_snk  JSON sink instance.
+ * @param buf       Buffer to output to.
+ * @param level     Nesting level, zero for the descriptor array brackets.
+ *
+ * @return True if output successfully, false if failed to allocate
+ *         memory.
+ */
+static bool
+json_snk_newline(hidrd_json_snk_inst *json_snk, hidrd_buf *buf, size_t level)
+{
+    if (!json_snk->format)
+        return true;
+
+    return hidrd_buf_add_char(buf, '\n') &&
+           hidrd_buf_add_span(buf, ' ', level * 2);
+}
+
+
+/**
+ * Output a quoted string; the string is expected to contain no characters
+ * requiring escaping, which is true for tokens and numbers.
+ */
+static bool
+json_snk_str(hidrd_json_snk_inst *json_snk, const char *str)
+{
+    return hidrd_buf_add_char(&json_snk->buf, '"') &&
+           hidrd_buf_add_str(&json_snk->buf, str) &&
+           hidrd_buf_add_char(&json_snk->buf, '"');
+}
+
+
+/** Output a dynamically allocated quoted string and free it */
+static bool
+json_snk_str_own(hidrd_json_snk_inst *json_snk, char *str)
+{
+    bool    result;
+
+    if (str == NULL)
+        return false;
+
+    result = json_snk_str(json_snk, str);
+    free(str);
+
+    return result;
+}
+
+
+/** Output a quoted hex string of a data buffer */
+static bool
+json_snk_hex(hidrd_json_snk_inst *json_snk, const void *data, size_t size)
+{
+    hidrd_buf      *buf = &json_snk->buf;
+    const uint8_t  *p   = (const uint8_t *)data;
+    char           *c;
+
+    if (!hidrd_buf_grow(buf, buf->len + size * 2 + 2))
+        return false;
+
+    c = (char *)buf->ptr + buf->len;
+    *c++ = '"';
+    for (; size > 0; p++, size--)
+        c = hidrd_hex_byte_to_chrs(c, *p, false);
+    *c++ = '"';
+    buf->len = c - (char *)buf->ptr;
+
+    return true;
+}
+
+
+/**
+ * Output an object member name, preceded by a separator, if it is not the
+ * first member.
+ */
+static bool
+json_snk_member(hidrd_json_snk_inst    *json_snk,
+                bool                    first,
+                const char             *name)
+{
+    hidrd_buf  *buf  = &json_snk->buf;
+
+    return (first ||
+            hidrd_buf_add_str(buf, json_snk->format ? ", " : ",")) &&
+           hidrd_buf_add_char(buf, '"') &&
+           hidrd_buf_add_str(buf, name) &&
+           hidrd_buf_add_str(buf, json_snk->format ? "\": " : "\":");
+}
+
+
+/**
+ * Start an element: output a separator, if it is not the first one at
+ * this level, indentation, opening brace and the element name, leaving
+ * the output at the element value.
+ */
+static bool
+json_snk_element(hidrd_json_snk_inst *json_snk, const char *name)
+{
+    bool    first   = json_snk->first;
+
+    json_snk->first = false;
+
+    return (first || hidrd_buf_add_char(&json_snk->buf, ',')) &&
+           json_snk_newline(json_snk, &json_snk->buf,
+                            json_snk->groups.len + 1) &&
+           hidrd_buf_add_char(&json_snk->buf, '{') &&
+           json_snk_member(json_snk, true, name);
+}
+
+
+/** Output a complete element with a signed numeric value */
+static bool
+json_snk_s32(hidrd_json_snk_inst *json_snk, const char *name, int32_t value)
+{
+    return json_snk_element(json_snk, name) &&
+           hidrd_buf_add_printf(&json_snk->buf, "%" PRId32 "}", value);
+}
+
+
+/** Output a complete element with an unsigned numeric value */
+static bool
+json_snk_u32(hidrd_json_snk_inst *json_snk, const char *name, uint32_t value)
+{
+    return json_snk_element(json_snk, name) &&
+           hidrd_buf_add_printf(&json_snk->buf, "%" PRIu32 "}", value);
+}
+
+
+/**
+ * Output a complete element with an object value of a short item tag
+ * (token or number) and data, for the items we don't interpret.
+ */
+static bool
+json_snk_short_tag(hidrd_json_snk_inst *json_snk,
+                   const char          *name,
+                   char                *tag,
+                   const hidrd_item    *item)
+{
+    if (!json_snk_element(json_snk, name) ||
+        !hidrd_buf_add_char(&json_snk->buf, '{') ||
+        !json_snk_member(json_snk, true, "tag"))
+    {
+        free(tag);
+        return false;
+    }
+
+    return json_snk_str_own(json_snk, tag) &&
+           json_snk_member(json_snk, false, "data") &&
+           json_snk_hex(json_snk,
+                        /* We promise we won't change it */
+                        hidrd_item_short_get_data((hidrd_item *)item),
+                        hidrd_item_short_get_data_bytes(item)) &&
+           hidrd_buf_add_str(&json_snk->buf, "}}");
+}
+
+
+/**
+ * Start a group: output the group element and open its item array.
+ *
+ * @param json_snk  JSON sink instance.
+ * @param group     Group code.
+ * @param type      Dynamically allocated collection type string to take
+ *                  over, or NULL for groups other than collection.
+ *
+ * @return True if output successfully, false otherwise.
+ */
+static bool
+json_snk_group_start(hidrd_json_snk_inst   *json_snk,
+                     json_snk_group         group,
+                     char                  *type)
+{
+    bool    first   = true;
+
+    if (!json_snk_element(json_snk, json_snk_group_name_list[group]) ||
+        !hidrd_buf_add_char(&json_snk->buf, '{'))
+        goto failure;
+
+    if (group == JSON_SNK_GROUP_COLLECTION)
+    {
+        if (!json_snk_member(json_snk, true, "type"))
+            goto failure;
+        if (!json_snk_str_own(json_snk, type))
+            return false;
+        first = false;
+    }
+
+    if (!json_snk_member(json_snk, first, "items") ||
+        !hidrd_buf_add_char(&json_snk->buf, '[') ||
+        !hidrd_buf_add_char(&json_snk->groups, group))
+        return false;
+
+    json_snk->first = true;
+
+    return true;
+
+failure:
+
+    free(type);
+    return false;
+}
+
+
+/**
+ * Close the innermost group item array and the group element.
+ *
+ * @param json_snk  JSON sink instance.
+ * @param buf       Buffer to output to.
+ * @param level     Nesting level of the group items.
+ * @param end       Closing string to output after the item array.
+ *
+ * @return True if output successfully, false otherwise.
+ */
+static bool
+json_snk_group_close(hidrd_json_snk_inst   *json_snk,
+                     hidrd_buf             *buf,
+                     size_t                 level,
+                     const char            *end)
+{
+    bool    first   = json_snk->first;
+
+    json_snk->first = false;
+
+    return (first || json_snk_newline(json_snk, buf, level - 1)) &&
+           hidrd_buf_add_char(buf, ']') &&
+           hidrd_buf_add_str(buf, end);
+}
+
+
+/**
+ * End a group: close the innermost group, if it matches, or output an
+ * unmatched group end element otherwise - the groups already output
+ * can't be broken.
+ */
+static bool
+json_snk_group_end(hidrd_json_snk_inst *json_snk, json_snk_group group)
+{
+    hidrd_buf  *groups  = &json_snk->groups;
+
+    if (groups->len == 0 ||
+        ((const uint8_t *)groups->ptr)[groups->len - 1] != group)
+        return json_snk_element(json_snk,
+                                json_snk_group_end_name_list[group]) &&
+               hidrd_buf_add_str(&json_snk->buf, "null}");
+
+    if (!json_snk_group_close(json_snk, &json_snk->buf,
+                              groups->len + 1, "}}"))
+        return false;
+
+    hidrd_buf_del(groups, 1);
+
+    return true;
+}
+
+
+static char *
+hidrd_usage_to_id_hex(hidrd_usage usage)
+{
+    return hidrd_usage_id_to_hex(hidrd_usage_get_id(usage));
+}
+
+
+/**
+ * Retrieve a string from the sink memo cache, formatting and memoizing it
+ * first, if missing.
+ *
+ * @param json_snk  JSON sink instance.
+ * @param kind      String kind.
+ * @param key       Usage page or usage value, depending on the kind.
+ *
+ * @return Memoized string, valid until the next call, or NULL if failed to
+ *         allocate memory.
+ */
+static const char *
+json_snk_memo(hidrd_json_snk_inst  *json_snk,
+              json_snk_memo_kind    kind,
+              uint32_t              key)
+{
+    const char *str;
+    char       *new_str;
+
+    str = hidrd_memo_get(&json_snk->memo, kind, key);
+    if (str != NULL)
+        return str;
+
+    switch (kind)
+    {
+        case JSON_SNK_MEMO_PAGE:
+            new_str = json_snk->tokens
+                        ? HIDRD_NUM_TO_ALT_STR2_1(usage_page,
+                                                  (hidrd_usage_page)key,
+                                                  token, lc, hex)
+                        : hidrd_usage_page_to_hex((hidrd_usage_page)key);
+            break;
+        case JSON_SNK_MEMO_USAGE_ID:
+            new_str = json_snk->tokens
+                        ? HIDRD_NUM_TO_ALT_STR2_1(usage, (hidrd_usage)key,
+                                                  token, lc, id_hex)
+                        : hidrd_usage_to_id_hex((hidrd_usage)key);
+            break;
+        case JSON_SNK_MEMO_USAGE:
+            new_str = json_snk->tokens
+                        ? HIDRD_NUM_TO_ALT_STR2_1(usage, (hidrd_usage)key,
+                                                  token, lc, hex)
+                        : hidrd_usage_to_hex((hidrd_usage)key);
+            break;
+        default:
+            assert(!"Unknown memoized string kind");
+            return NULL;
+    }
+
+    return hidrd_memo_put(&json_snk->memo, kind, key, new_str);
+}
+
+
+static bool
+json_snk_usage(hidrd_json_snk_inst *json_snk,
+               const char          *name,
+               hidrd_usage          usage)
+{
+    bool        local;
+    const char *str;
+
+    if (!hidrd_usage_defined_page(usage))
+        usage = hidrd_usage_set_page(usage, json_snk->usage_page);
+
+    local = (hidrd_usage_get_page(usage) == json_snk->usage_page);
+
+    str = json_snk_memo(json_snk,
+                        local ? JSON_SNK_MEMO_USAGE_ID : JSON_SNK_MEMO_USAGE,
+                        usage);
+
+    return str != NULL &&
+           json_snk_element(json_snk, name) &&
+           json_snk_str(json_snk, str) &&
+           hidrd_buf_add_char(&json_snk->buf, '}');
+}
+
+
+/** Main item bit names, for the bits set, indexed by bit number */
+static const char *json_snk_main_bit_name_list[] = {
+    "constant", "variable", "relative", "wrap", "non_linear",
+    "no_preferred", "null_state", "volatile", "buffered_bytes"
+};
+
+
+static bool
+json_snk_main_bitmap(hidrd_json_snk_inst   *json_snk,
+                     const char            *name,
+                     const hidrd_item      *item)
+{
+    bool    input   = (hidrd_item_main_get_tag(item) ==
+                       HIDRD_ITEM_MAIN_TAG_INPUT);
+    bool    first   = true;
+    uint8_t bit;
+
+    if (!json_snk_element(json_snk, name) ||
+        !hidrd_buf_add_char(&json_snk->buf, '['))
+        return false;
+
+    for (bit = 0; bit < 32; bit++)
+    {
+        if (!hidrd_item_main_get_bit(item, bit))
+            continue;
+
+        if (!first &&
+            !hidrd_buf_add_str(&json_snk->buf, json_snk->format ? ", " : ","))
+            return false;
+        first = false;
+
+        if (bit < sizeof(json_snk_main_bit_name_list) /
+                    sizeof(*json_snk_main_bit_name_list) &&
+            !(input && bit == 7))
+        {
+            if (!json_snk_str(json_snk, json_snk_main_bit_name_list[bit]))
+                return false;
+        }
+        else if (!hidrd_buf_add_printf(&json_snk->buf, "\"bit%hhu\"", bit))
+            return false;
+    }
+
+    return hidrd_buf_add_str(&json_snk->buf, "]}");
+}
+
+
+static bool
+json_snk_main(hidrd_json_snk_inst *json_snk, const hidrd_item *item)
+{
+    hidrd_item_main_tag tag;
+
+    assert(hidrd_item_main_valid(item));
+
+    switch (tag = hidrd_item_main_get_tag(item))
+    {
+        case HIDRD_ITEM_MAIN_TAG_COLLECTION:
+            return json_snk_group_start(
+                        json_snk, JSON_SNK_GROUP_COLLECTION,
+                        TOKEN_OR_DEC(item_collection_type,
+                                     hidrd_item_collection_get_type(item)));
+        case HIDRD_ITEM_MAIN_TAG_END_COLLECTION:
+            return json_snk_group_end(json_snk, JSON_SNK_GROUP_COLLECTION);
+        case HIDRD_ITEM_MAIN_TAG_INPUT:
+            return json_snk_main_bitmap(json_snk, "input", item);
+        case HIDRD_ITEM_MAIN_TAG_OUTPUT:
+            return json_snk_main_bitmap(json_snk, "output", item);
+        case HIDRD_ITEM_MAIN_TAG_FEATURE:
+            return json_snk_main_bitmap(json_snk, "feature", item);
+        default:
+            return json_snk_short_tag(json_snk, "main",
+                                      TOKEN_OR_DEC(item_main_tag, tag),
+                                      item);
+    }
+}
+
+
+/** Unit exponent names, indexed by nibble index minus one */
+static const char *json_snk_unit_exp_name_list[] = {
+    "length", "mass", "time", "temperature", "current", "luminous_intensity"
+};
+
+
+static bool
+json_snk_unit(hidrd_json_snk_inst *json_snk, const hidrd_item *item)
+{
+    hidrd_unit      unit    = hidrd_item_unit_get_value(item);
+    size_t          i;
+    hidrd_unit_exp  exp;
+
+    if (!json_snk_element(json_snk, "unit"))
+        return false;
+
+    /* If there are no units */
+    if (unit == HIDRD_UNIT_NONE)
+        return hidrd_buf_add_str(&json_snk->buf, "\"none\"}");
+
+    if (!hidrd_buf_add_char(&json_snk->buf, '{'))
+        return false;
+
+    /* If the unit is void or cannot be interpreted by our API */
+    if (hidrd_unit_void(unit) || !hidrd_unit_known(unit))
+        return json_snk_member(json_snk, true, "value") &&
+               json_snk_hex(json_snk,
+                            /* We promise we won't change it */
+                            hidrd_item_short_get_data((hidrd_item *)item),
+                            hidrd_item_short_get_data_bytes(item)) &&
+               hidrd_buf_add_str(&json_snk->buf, "}}");
+
+    if (!json_snk_member(json_snk, true, "system") ||
+        !json_snk_str_own(json_snk,
+                          TOKEN_OR_DEC(unit_system,
+                                       hidrd_unit_get_system(unit))))
+        return false;
+
+    for (i = 0; i < HIDRD_UNIT_NIBBLE_INDEX_EXP_NUM; i++)
+    {
+        exp = hidrd_unit_get_nibble(unit,
+                                    i + HIDRD_UNIT_NIBBLE_INDEX_EXP_MIN);
+        if (exp == HIDRD_UNIT_EXP_0)
+            continue;
+        if (!json_snk_member(json_snk, false,
+                             json_snk_unit_exp_name_list[i]) ||
+            !hidrd_buf_add_printf(&json_snk->buf, "%d",
+                                  hidrd_unit_exp_to_int(exp)))
+            return false;
+    }
+
+    return hidrd_buf_add_str(&json_snk->buf, "}}");
+}
+
+
+static bool
+json_snk_global(hidrd_json_snk_inst *json_snk, const hidrd_item *item)
+{
+    hidrd_item_global_tag   tag;
+
+    assert(hidrd_item_global_valid(item));
+
+    switch (tag = hidrd_item_global_get_tag(item))
+    {
+#define CASE_S32(_NAME, _name) \
+        case HIDRD_ITEM_GLOBAL_TAG_##_NAME:                             \
+            return json_snk_s32(json_snk, #_name,                       \
+                                hidrd_item_##_name##_get_value(item))
+#define CASE_U32(_NAME, _name) \
+        case HIDRD_ITEM_GLOBAL_TAG_##_NAME:                             \
+            return json_snk_u32(json_snk, #_name,                       \
+                                hidrd_item_##_name##_get_value(item))
+
+        CASE_S32(LOGICAL_MINIMUM, logical_minimum);
+        CASE_S32(LOGICAL_MAXIMUM, logical_maximum);
+        CASE_S32(PHYSICAL_MINIMUM, physical_minimum);
+        CASE_S32(PHYSICAL_MAXIMUM, physical_maximum);
+        CASE_S32(UNIT_EXPONENT, unit_exponent);
+        CASE_U32(REPORT_SIZE, report_size);
+        CASE_U32(REPORT_ID, report_id);
+        CASE_U32(REPORT_COUNT, report_count);
+
+#undef CASE_U32
+#undef CASE_S32
+
+        case HIDRD_ITEM_GLOBAL_TAG_UNIT:
+            return json_snk_unit(json_snk, item);
+
+        case HIDRD_ITEM_GLOBAL_TAG_USAGE_PAGE:
+            {
+                const char *str;
+
+                json_snk->usage_page = hidrd_item_usage_page_get_value(item);
+                str = json_snk_memo(json_snk, JSON_SNK_MEMO_PAGE,
+                                    json_snk->usage_page);
+
+                return str != NULL &&
+                       json_snk_element(json_snk, "usage_page") &&
+                       json_snk_str(json_snk, str) &&
+                       hidrd_buf_add_char(&json_snk->buf, '}');
+            }
+
+        case HIDRD_ITEM_GLOBAL_TAG_PUSH:
+            return hidrd_buf_add_ptr(&json_snk->pages,
+                                     &json_snk->usage_page,
+                                     sizeof(json_snk->usage_page)) &&
+                   json_snk_group_start(json_snk, JSON_SNK_GROUP_PUSH,
+                                        NULL);
+
+        case HIDRD_ITEM_GLOBAL_TAG_POP:
+            /* Pop the usage page, if possible */
+            if (json_snk->pages.len > 0)
+            {
+                memcpy(&json_snk->usage_page,
+                       (uint8_t *)json_snk->pages.ptr +
+                            json_snk->pages.len -
+                            sizeof(json_snk->usage_page),
+                       sizeof(json_snk->usage_page));
+                hidrd_buf_del(&json_snk->pages,
+                              sizeof(json_snk->usage_page));
+            }
+            return json_snk_group_end(json_snk, JSON_SNK_GROUP_PUSH);
+
+        default:
+            return json_snk_short_tag(json_snk, "global",
+                                      TOKEN_OR_DEC(item_global_tag, tag),
+                                      item);
+    }
+}
+
+
+static bool
+json_snk_local(hidrd_json_snk_inst *json_snk, const hidrd_item *item)
+{
+    hidrd_item_local_tag    tag;
+
+    assert(hidrd_item_local_valid(item));
+
+    switch (tag = hidrd_item_local_get_tag(item))
+    {
+#define CASE_U32(_NAME, _name) \
+        case HIDRD_ITEM_LOCAL_TAG_##_NAME:                              \
+            return json_snk_u32(json_snk, #_name,                       \
+                                hidrd_item_##_name##_get_value(item))
+
+        CASE_U32(DESIGNATOR_INDEX, designator_index);
+        CASE_U32(DESIGNATOR_MINIMUM, designator_minimum);
+        CASE_U32(DESIGNATOR_MAXIMUM, designator_maximum);
+        CASE_U32(STRING_INDEX, string_index);
+        CASE_U32(STRING_MINIMUM, string_minimum);
+        CASE_U32(STRING_MAXIMUM, string_maximum);
+
+#undef CASE_U32
+
+        case HIDRD_ITEM_LOCAL_TAG_USAGE:
+            return json_snk_usage(json_snk, "usage",
+                                  hidrd_item_usage_get_value(item));
+        case HIDRD_ITEM_LOCAL_TAG_USAGE_MINIMUM:
+            return json_snk_usage(json_snk, "usage_minimum",
+                                  hidrd_item_usage_minimum_get_value(item));
+        case HIDRD_ITEM_LOCAL_TAG_USAGE_MAXIMUM:
+            return json_snk_usage(json_snk, "usage_maximum",
+                                  hidrd_item_usage_maximum_get_value(item));
+
+        case HIDRD_ITEM_LOCAL_TAG_DELIMITER:
+            return (hidrd_item_delimiter_get_value(item) ==
+                    HIDRD_ITEM_DELIMITER_SET_OPEN)
+                        ? json_snk_group_start(json_snk,
+                                               JSON_SNK_GROUP_SET, NULL)
+                        : json_snk_group_end(json_snk, JSON_SNK_GROUP_SET);
+
+        default:
+            return json_snk_short_tag(json_snk, "local",
+                                      TOKEN_OR_DEC(item_local_tag, tag),
+                                      item);
+    }
+}
+
+
+static bool
+json_snk_short(hidrd_json_snk_inst *json_snk, const hidrd_item *item)
+{
+    assert(hidrd_item_short_valid(item));
+
+    switch (hidrd_item_short_get_type(item))
+    {
+        case HIDRD_ITEM_SHORT_TYPE_MAIN:
+            return json_snk_main(json_snk, item);
+        case HIDRD_ITEM_SHORT_TYPE_GLOBAL:
+            return json_snk_global(json_snk, item);
+        case HIDRD_ITEM_SHORT_TYPE_LOCAL:
+            return json_snk_local(json_snk, item);
+        default:
+            return json_snk_element(json_snk, "short") &&
+                   hidrd_buf_add_char(&json_snk->buf, '{') &&
+                   json_snk_member(json_snk, true, "type") &&
+                   json_snk_str_own(
+                        json_snk,
+                        TOKEN_OR_DEC(item_short_type,
+                                     hidrd_item_short_get_type(item))) &&
+                   json_snk_member(json_snk, false, "tag") &&
+                   hidrd_buf_add_printf(&json_snk->buf, "%u",
+                                        (unsigned int)
+                                        hidrd_item_short_get_tag(item)) &&
+                   json_snk_member(json_snk, false, "data") &&
+                   json_snk_hex(json_snk,
+                                /* We promise we won't change it */
+                                hidrd_item_short_get_data(
+                                    (hidrd_item *)item),
+                                hidrd_item_short_get_data_bytes(item)) &&
+                   hidrd_buf_add_str(&json_snk->buf, "}}");
+    }
+}
+
+
+static bool
+hidrd_json_snk_put(hidrd_snk *snk, const hidrd_item *item)
+{
+    hidrd_json_snk_inst    *json_snk    = (hidrd_json_snk_inst *)snk;
+    bool                    result;
+
+    assert(hidrd_item_valid(item));
+
+    if (hidrd_item_basic_get_format(item) == HIDRD_ITEM_BASIC_FORMAT_LONG)
+        result = json_snk_element(json_snk, "long") &&
+                 hidrd_buf_add_char(&json_snk->buf, '{') &&
+                 json_snk_member(json_snk, true, "tag") &&
+                 hidrd_buf_add_printf(&json_snk->buf, "%u",
+                                      (unsigned int)
+                                      hidrd_item_long_get_tag(item)) &&
+                 json_snk_member(json_snk, false, "data") &&
+                 json_snk_hex(json_snk,
+                              /* We promise we won't change it */
+                              hidrd_item_long_get_data((hidrd_item *)item),
+                              hidrd_item_long_get_data_size(item)) &&
+                 hidrd_buf_add_str(&json_snk->buf, "}}");
+    else
+        result = json_snk_short(json_snk, item);
+
+    if (!result)
+        json_snk->err = HIDRD_JSON_SNK_ERR_ALLOC;
+
+    return result;
+}
+
+
+static bool
+hidrd_json_snk_flush(hidrd_snk *snk)
+{
+    hidrd_json_snk_inst    *json_snk    = (hidrd_json_snk_inst *)snk;
+    bool                    success     = false;
+    bool                    first       = json_snk->first;
+    hidrd_buf               tail;
+    size_t                  level;
+    size_t                  new_size;
+    char                   *new_buf     = NULL;
+
+    hidrd_buf_init(&tail);
+
+    /* Close the unfinished groups, marking them as such */
+    for (level = json_snk->groups.len + 1; level > 1; level--)
+        if (!json_snk_group_close(json_snk, &tail, level,
+                                  json_snk->format
+                                    ? ", \"end\": false}}"
+                                    : ",\"end\":false}}"))
+            goto cleanup;
+
+    /* Close the descriptor array */
+    if ((!json_snk->first && !json_snk_newline(json_snk, &tail, 0)) ||
+        !hidrd_buf_add_char(&tail, ']') ||
+        (json_snk->format && !hidrd_buf_add_char(&tail, '\n')))
+        goto cleanup;
+
+    new_size = 1 + json_snk->buf.len + tail.len;
+
+    if (snk->pbuf != NULL)
+    {
+        new_buf = malloc(new_size);
+        if (new_buf == NULL)
+            goto cleanup;
+        new_buf[0] = '[';
+        if (json_snk->buf.len > 0)
+            memcpy(new_buf + 1, json_snk->buf.ptr, json_snk->buf.len);
+        memcpy(new_buf + 1 + json_snk->buf.len, tail.ptr, tail.len);
+        free(*snk->pbuf);
+        *snk->pbuf = new_buf;
+        new_buf = NULL;
+    }
+
+    if (snk->psize != NULL)
+        *snk->psize = new_size;
+
+    success = true;
+
+cleanup:
+
+    if (!success)
+        json_snk->err = HIDRD_JSON_SNK_ERR_ALLOC;
+    /* Output may continue after flushing */
+    json_snk->first = first;
+    free(new_buf);
+    hidrd_buf_clnp(&tail);
+
+    return success;
+}
+
+
+static void
+hidrd_json_snk_clnp(hidrd_snk *snk)
+{
+    hidrd_json_snk_inst    *json_snk    = (hidrd_json_snk_inst *)snk;
+
+    /* The user gets a copy of the buffer on flush */
+    hidrd_buf_clnp(&json_snk->buf);
+    hidrd_buf_clnp(&json_snk->groups);
+    hidrd_buf_clnp(&json_snk->pages);
+    hidrd_memo_clnp(&json_snk->memo);
+    json_snk->err = HIDRD_JSON_SNK_ERR_NONE;
+}
+
+
+const hidrd_snk_type hidrd_json_snk = {
+    .size       = sizeof(hidrd_json_snk_inst),
+    .initv      = hidrd_json_snk_initv,
+#ifdef HIDRD_WITH_OPT
+    .init_opts  = hidrd_json_snk_init_opts,
+    .opts_spec  = hidrd_json_snk_opts_spec,
+#endif
+    .valid      = hidrd_json_snk_valid,
+    .errmsg     = hidrd_json_snk_errmsg,
+    .put        = hidrd_json_snk_put,
+    .flush      = hidrd_json_snk_flush,
+    .clnp       = hidrd_json_snk_clnp,
+};
@@ -0,0 +1,1629 @@
+/** @file
+ * @brief HID report descriptor - JSON stream source
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <string.h>
+#include "hidrd/util/hex.h"
+#include "hidrd/util/dec.h"
+#include "hidrd/fmt/json/src.h"
+
+/** Group codes, stored in the open group stack */
+typedef enum json_src_group {
+    JSON_SRC_GROUP_COLLECTION,  /**< Collection / end collection */
+    JSON_SRC_GROUP_PUSH,        /**< Push / pop */
+    JSON_SRC_GROUP_SET          /**< Delimiter open / close */
+} json_src_group;
+
+/** Open group stack flag: the group end is marked missing */
+#define JSON_SRC_GROUP_FLAG_NO_END  0x80
+
+/** Token types */
+typedef enum json_src_tok {
+    JSON_SRC_TOK_ERROR,     /**< Invalid token, error is set */
+    JSON_SRC_TOK_END,       /**< End of input */
+    JSON_SRC_TOK_OBJ_BEGIN, /**< Object opening brace */
+    JSON_SRC_TOK_OBJ_END,   /**< Object closing brace */
+    JSON_SRC_TOK_ARR_BEGIN, /**< Array opening bracket */
+    JSON_SRC_TOK_ARR_END,   /**< Array closing bracket */
+    JSON_SRC_TOK_COLON,     /**< Name separator */
+    JSON_SRC_TOK_COMMA,     /**< Value separator */
+    JSON_SRC_TOK_STR,       /**< String, decoded into the str buffer */
+    JSON_SRC_TOK_NUM,       /**< Number, copied into the str buffer */
+    JSON_SRC_TOK_TRUE,      /**< "true" literal */
+    JSON_SRC_TOK_FALSE,     /**< "false" literal */
+    JSON_SRC_TOK_NULL       /**< "null" literal */
+} json_src_tok;
+
+/** Element handling result code */
+typedef enum json_src_rc {
+    JSON_SRC_RC_ERROR,      /**< An error occurred, error is set */
+    JSON_SRC_RC_ITEM,       /**< An item is ready */
+    JSON_SRC_RC_ENTER       /**< An item is ready and a group is
+                                 entered, the element is left open */
+} json_src_rc;
+
+
+static bool
+hidrd_json_src_init(hidrd_src *src, char **perr)
+{
+    hidrd_json_src_inst    *json_src    = (hidrd_json_src_inst *)src;
+
+    json_src->pos           = 0;
+    json_src->line          = 0;
+    json_src->line_pos      = 0;
+    hidrd_buf_init(&json_src->str);
+    hidrd_buf_init(&json_src->groups);
+    hidrd_buf_init(&json_src->pages);
+    json_src->usage_page    = HIDRD_USAGE_PAGE_UNDEFINED;
+    json_src->started       = false;
+    json_src->ended         = false;
+    json_src->first         = true;
+    json_src->err           = HIDRD_JSON_SRC_ERR_NONE;
+
+    if (perr != NULL)
+        *perr = strdup("");
+
+    return true;
+}
+
+
+static bool
+hidrd_json_src_initv(hidrd_src *src, char **perr, va_list ap)
+{
+    (void)ap;
+    return hidrd_json_src_init(src, perr);
+}
+
+
+static bool
+hidrd_json_src_valid(const hidrd_src *src)
+{
+    const hidrd_json_src_inst  *json_src    =
+                                    (const hidrd_json_src_inst *)src;
+
+    return (src->type->size >= sizeof(hidrd_json_src_inst)) &&
+           (json_src->pos <= src->size) &&
+           (json_src->line_pos <= json_src->pos) &&
+           hidrd_buf_valid(&json_src->str) &&
+           hidrd_buf_valid(&json_src->groups) &&
+           hidrd_buf_valid(&json_src->pages) &&
+           (json_src->pages.len % sizeof(hidrd_usage_page)) == 0;
+}
+
+
+static char *
+hidrd_json_src_errmsg(const hidrd_src *src)
+{
+    const hidrd_json_src_inst  *json_src    =
+                                    (const hidrd_json_src_inst *)src;
+    const char                 *msg;
+
+    switch (json_src->err)
+    {
+        case HIDRD_JSON_SRC_ERR_NONE:
+            msg = "";
+            break;
+        case HIDRD_JSON_SRC_ERR_ALLOC:
+            msg = "memory allocation failure";
+            break;
+        case HIDRD_JSON_SRC_ERR_SYNTAX:
+            msg = "invalid JSON syntax";
+            break;
+        case HIDRD_JSON_SRC_ERR_ELEMENT:
+            msg = "unknown element";
+            break;
+        case HIDRD_JSON_SRC_ERR_MEMBER:
+            msg = "unknown or missing element member";
+            break;
+        case HIDRD_JSON_SRC_ERR_VALUE:
+            msg = "invalid element value";
+            break;
+        case HIDRD_JSON_SRC_ERR_INVALID:
+            msg = "invalid item";
+            break;
+        default:
+            assert(!"Unknown error code");
+            return NULL;
+    }
+
+    return strdup(msg);
+}
+
+
+static size_t
+hidrd_json_src_getpos(const hidrd_src *src)
+{
+    const hidrd_json_src_inst  *json_src    = (hidrd_json_src_inst *)src;
+    size_t                      col         = json_src->pos -
+                                              json_src->line_pos;
+
+    return (json_src->line > 0xFFFF ? 0xFFFF : (json_src->line << 16)) |
+           (col > 0xFFFF ? 0xFFFF : col);
+}
+
+
+static char *
+hidrd_json_src_fmtpos(const hidrd_src *src, size_t pos)
+{
+    char       *str;
+    size_t      line    = (pos >> 16) & 0xFFFF;
+    size_t      col     = pos & 0xFFFF;
+    char        line_buf[16];
+    char        col_buf[16];
+
+    (void)src;
+
+    if (line >= 0xFFFF)
+        snprintf(line_buf, sizeof(line_buf), ">= 65536");
+    else
+        snprintf(line_buf, sizeof(line_buf), "%zu", line + 1);
+
+    if (col >= 0xFFFF)
+        snprintf(col_buf, sizeof(col_buf), ">= 65536");
+    else
+        snprintf(col_buf, sizeof(col_buf), "%zu", col + 1);
+
+    if (asprintf(&str, "line %s, column %s", line_buf, col_buf) < 0)
+        return NULL;
+
+    return str;
+}
+
+
+/**
+ * Set the source error.
+ *
+ * @param json_src  JSON source instance.
+ * @param err       Error code to set.
+ *
+ * @return Always false, for convenience.
+ */
+static bool
+json_src_fail(hidrd_json_src_inst *json_src, hidrd_json_src_err err)
+{
+    /* Keep the first error */
+    if (!json_src->src.error)
+    {
+        json_src->src.error = true;
+        json_src->err = err;
+    }
+    return false;
+}
+
+
+/**
+ * Read a string token from the source buffer into the str buffer,
+ * decoding escape sequences and zero-terminating.
+ *
+ * @param json_src  JSON source instance, positioned after the opening
+ *                  quote.
+ *
+ * @return True if read successfully, false otherwise, with error set.
+ */
+static bool
+json_src_next_str(hidrd_json_src_inst *json_src)
+{
+    const char *buf     = (const char *)json_src->src.buf;
+    size_t      size    = json_src->src.size;
+    size_t      pos     = json_src->pos;
+    size_t      start;
+    char        c;
+    uint8_t     code[2];
+
+    hidrd_buf_reset(&json_src->str);
+
+    while (true)
+    {
+        /* Copy a span of plain characters in one go */
+        for (start = pos;
+             pos < size && buf[pos] != '"' && buf[pos] != '\\' &&
+             (uint8_t)buf[pos] >= 0x20;
+             pos++);
+        if (pos > start &&
+            !hidrd_buf_add_ptr(&json_src->str, buf + start, pos - start))
+            return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_ALLOC);
+
+        json_src->pos = pos;
+        if (pos >= size || buf[pos] != '\\')
+            break;
+
+        /* Decode an escape sequence */
+        if (++pos >= size)
+            break;
+        switch (buf[pos++])
+        {
+            case '"':   c = '"';    break;
+            case '\\':  c = '\\';   break;
+            case '/':   c = '/';    break;
+            case 'b':   c = '\b';   break;
+            case 'f':   c = '\f';   break;
+            case 'n':   c = '\n';   break;
+            case 'r':   c = '\r';   break;
+            case 't':   c = '\t';   break;
+            case 'u':
+                /* Only ASCII is expected in descriptors */
+                if (size - pos < 4 ||
+                    hidrd_hex_buf_from_chrs(code, sizeof(code), NULL,
+                                            buf + pos, 4, NULL) !=
+                        HIDRD_HEX_DEC_ERR_NONE ||
+                    code[0] != 0 || code[1] >= 0x80)
+                    return json_src_fail(json_src,
+                                         HIDRD_JSON_SRC_ERR_SYNTAX);
+                c = code[1];
+                pos += 4;
+                break;
+            default:
+                return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+        }
+        if (!hidrd_buf_add_char(&json_src->str, c))
+            return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_ALLOC);
+    }
+
+    if (json_src->pos >= size || buf[json_src->pos] != '"')
+        return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+    json_src->pos++;
+
+    if (!hidrd_buf_add_char(&json_src->str, '\0'))
+        return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_ALLOC);
+
+    return true;
+}
+
+
+/**
+ * Read the next token from the source buffer.
+ *
+ * @param json_src  JSON source instance.
+ *
+ * @return Token type; JSON_SRC_TOK_ERROR if an error occurred, with error
+ *         set.
+ */
+static json_src_tok
+json_src_next(hidrd_json_src_inst *json_src)
+{
+    const char *buf     = (const char *)json_src->src.buf;
+    size_t      size    = json_src->src.size;
+    size_t      pos     = json_src->pos;
+    size_t      start;
+    char        c;
+
+    /* Skip whitespace */
+    for (; pos < size; pos++)
+    {
+        c = buf[pos];
+        if (c == '\n')
+        {
+            json_src->line++;
+            json_src->line_pos = pos + 1;
+        }
+        else if (c != ' ' && c != '\t' && c != '\r')
+            break;
+    }
+
+    json_src->pos = pos;
+    if (pos >= size)
+        return JSON_SRC_TOK_END;
+
+    switch (c = buf[pos])
+    {
+        case '{':
+            json_src->pos++;
+            return JSON_SRC_TOK_OBJ_BEGIN;
+        case '}':
+            json_src->pos++;
+            return JSON_SRC_TOK_OBJ_END;
+        case '[':
+            json_src->pos++;
+            return JSON_SRC_TOK_ARR_BEGIN;
+        case ']':
+            json_src->pos++;
+            return JSON_SRC_TOK_ARR_END;
+        case ':':
+            json_src->pos++;
+            return JSON_SRC_TOK_COLON;
+        case ',':
+            json_src->pos++;
+            return JSON_SRC_TOK_COMMA;
+        case '"':
+            json_src->pos++;
+            return json_src_next_str(json_src)
+                        ? JSON_SRC_TOK_STR
+                        : JSON_SRC_TOK_ERROR;
+        default:
+            break;
+    }
+
+    /* Numbers are verified by the element value parsers */
+    if (c == '-' || (c >= '0' && c <= '9'))
+    {
+        for (start = pos++;
+             pos < size &&
+             ((buf[pos] >= '0' && buf[pos] <= '9') ||
+              buf[pos] == '.' || buf[pos] == 'e' || buf[pos] == 'E' ||
+              buf[pos] == '+' || buf[pos] == '-');
+             pos++);
+        json_src->pos = pos;
+        hidrd_buf_reset(&json_src->str);
+        if (!hidrd_buf_add_ptr(&json_src->str, buf + start, pos - start) ||
+            !hidrd_buf_add_char(&json_src->str, '\0'))
+        {
+            json_src_fail(json_src, HIDRD_JSON_SRC_ERR_ALLOC);
+            return JSON_SRC_TOK_ERROR;
+        }
+        return JSON_SRC_TOK_NUM;
+    }
+
+#define LITERAL(_str, _TOK) \
+    do {                                                        \
+        if (size - pos >= sizeof(_str) - 1 &&                   \
+            memcmp(buf + pos, _str, sizeof(_str) - 1) == 0)     \
+        {                                                       \
+            json_src->pos += sizeof(_str) - 1;                  \
+            return JSON_SRC_TOK_##_TOK;                         \
+        }                                                       \
+    } while (0)
+
+    LITERAL("true", TRUE);
+    LITERAL("false", FALSE);
+    LITERAL("null", NULL);
+
+#undef LITERAL
+
+    json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+    return JSON_SRC_TOK_ERROR;
+}
+
+
+/**
+ * Read the next token and check it is of the expected type.
+ *
+ * @param json_src  JSON source instance.
+ * @param tok       Expected token type.
+ *
+ * @return True if the token matches, false otherwise, with error set.
+ */
+static bool
+json_src_expect(hidrd_json_src_inst *json_src, json_src_tok tok)
+{
+    return json_src_next(json_src) == tok ||
+           json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+}
+
+
+/**
+ * Read the next string token.
+ *
+ * @param json_src  JSON source instance.
+ *
+ * @return The decoded string, valid until the next token is read, or NULL
+ *         if failed, with error set.
+ */
+static const char *
+json_src_str(hidrd_json_src_inst *json_src)
+{
+    return json_src_expect(json_src, JSON_SRC_TOK_STR)
+                ? (const char *)json_src->str.ptr
+                : NULL;
+}
+
+
+/**
+ * Read the next number token.
+ *
+ * @param json_src  JSON source instance.
+ *
+ * @return The number string, valid until the next token is read, or NULL
+ *         if failed, with error set.
+ */
+static const char *
+json_src_num(hidrd_json_src_inst *json_src)
+{
+    return json_src_expect(json_src, JSON_SRC_TOK_NUM)
+                ? (const char *)json_src->str.ptr
+                : NULL;
+}
+
+
+/**
+ * Read the next hex data string token.
+ *
+ * @param json_src  JSON source instance.
+ * @param buf       Output buffer.
+ * @param size      Output buffer size.
+ * @param plen      Location for the decoded data length.
+ *
+ * @return True if read successfully, false otherwise, with error set.
+ */
+static bool
+json_src_data(hidrd_json_src_inst  *json_src,
+              void                 *buf,
+              size_t                size,
+              size_t               *plen)
+{
+    const char *str = json_src_str(json_src);
+
+    if (str == NULL)
+        return false;
+    if (!hidrd_hex_buf_from_str(buf, size, plen, str))
+        return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+    return true;
+}
+
+
+/**
+ * Read the next object member name and the following colon.
+ *
+ * @param json_src  JSON source instance, positioned after the object
+ *                  opening brace or the previous member value.
+ * @param pfirst    Location of the "first member" flag, reset on return.
+ * @param pname     Location for the member name, valid until the next
+ *                  token is read, or NULL if the object has ended.
+ *
+ * @return True if read successfully, false otherwise, with error set.
+ */
+static bool
+json_src_member(hidrd_json_src_inst    *json_src,
+                bool                   *pfirst,
+                const char            **pname)
+{
+    json_src_tok    tok     = json_src_next(json_src);
+
+    if (tok == JSON_SRC_TOK_OBJ_END)
+    {
+        *pname = NULL;
+        return true;
+    }
+
+    if (!*pfirst)
+    {
+        if (tok != JSON_SRC_TOK_COMMA)
+            return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+        tok = json_src_next(json_src);
+    }
+    *pfirst = false;
+
+    if (tok != JSON_SRC_TOK_STR)
+        return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+    *pname = (const char *)json_src->str.ptr;
+
+    return json_src_expect(json_src, JSON_SRC_TOK_COLON);
+}
+
+
+static bool
+json_src_push_state(hidrd_json_src_inst *json_src)
+{
+    return hidrd_buf_add_ptr(&json_src->pages,
+                             &json_src->usage_page,
+                             sizeof(json_src->usage_page)) ||
+           json_src_fail(json_src, HIDRD_JSON_SRC_ERR_ALLOC);
+}
+
+
+static void
+json_src_pop_state(hidrd_json_src_inst *json_src)
+{
+    /* Pop the usage page, if possible */
+    if (json_src->pages.len == 0)
+        return;
+
+    memcpy(&json_src->usage_page,
+           (uint8_t *)json_src->pages.ptr + json_src->pages.len -
+                sizeof(json_src->usage_page),
+           sizeof(json_src->usage_page));
+    hidrd_buf_del(&json_src->pages, sizeof(json_src->usage_page));
+}
+
+
+/**
+ * Initialize the item for a group start.
+ */
+static bool
+json_src_group_start(hidrd_json_src_inst   *json_src,
+                     json_src_group         group,
+                     hidrd_item_collection_type type)
+{
+    switch (group)
+    {
+        case JSON_SRC_GROUP_COLLECTION:
+            hidrd_item_collection_init(json_src->item, type);
+            return true;
+        case JSON_SRC_GROUP_PUSH:
+            hidrd_item_push_init(json_src->item);
+            return json_src_push_state(json_src);
+        case JSON_SRC_GROUP_SET:
+            hidrd_item_delimiter_init(json_src->item,
+                                      HIDRD_ITEM_DELIMITER_SET_OPEN);
+            return true;
+        default:
+            assert(!"Unknown group code");
+            return false;
+    }
+}
+
+
+/**
+ * Initialize the item for a group end.
+ */
+static void
+json_src_group_end(hidrd_json_src_inst *json_src, json_src_group group)
+{
+    switch (group)
+    {
+        case JSON_SRC_GROUP_COLLECTION:
+            hidrd_item_end_collection_init(json_src->item);
+            break;
+        case JSON_SRC_GROUP_PUSH:
+            json_src_pop_state(json_src);
+            hidrd_item_pop_init(json_src->item);
+            break;
+        case JSON_SRC_GROUP_SET:
+            hidrd_item_delimiter_init(json_src->item,
+                                      HIDRD_ITEM_DELIMITER_SET_CLOSE);
+            break;
+        default:
+            assert(!"Unknown group code");
+    }
+}
+
+
+/**
+ * Skip the next value, with any nested values.
+ *
+ * @param json_src  JSON source instance.
+ *
+ * @return True if skipped successfully, false otherwise, with error set.
+ */
+static bool
+json_src_skip(hidrd_json_src_inst *json_src)
+{
+    size_t  depth   = 0;
+
+    do {
+        switch (json_src_next(json_src))
+        {
+            case JSON_SRC_TOK_ERROR:
+                return false;
+            case JSON_SRC_TOK_END:
+                return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+            case JSON_SRC_TOK_OBJ_BEGIN:
+            case JSON_SRC_TOK_ARR_BEGIN:
+                depth++;
+                break;
+            case JSON_SRC_TOK_OBJ_END:
+            case JSON_SRC_TOK_ARR_END:
+                if (depth == 0)
+                    return json_src_fail(json_src,
+                                         HIDRD_JSON_SRC_ERR_SYNTAX);
+                depth--;
+                break;
+            default:
+                break;
+        }
+    } while (depth > 0);
+
+    return true;
+}
+
+
+/**
+ * Read a group element "type" member value.
+ *
+ * @param json_src  JSON source instance.
+ * @param ptype     Location for the collection type.
+ *
+ * @return True if read successfully, false otherwise, with error set.
+ */
+static bool
+json_src_group_type(hidrd_json_src_inst        *json_src,
+                    hidrd_item_collection_type *ptype)
+{
+    const char *str = json_src_str(json_src);
+
+    if (str == NULL)
+        return false;
+    if (!HIDRD_NUM_FROM_ALT_STR2(item_collection_type, ptype, str,
+                                 token, dec))
+        return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+    return true;
+}
+
+
+/**
+ * Read a group element "end" member value.
+ *
+ * @param json_src  JSON source instance.
+ * @param pend      Location for the "group end is present" flag.
+ *
+ * @return True if read successfully, false otherwise, with error set.
+ */
+static bool
+json_src_group_end_flag(hidrd_json_src_inst *json_src, bool *pend)
+{
+    json_src_tok    tok = json_src_next(json_src);
+
+    if (tok != JSON_SRC_TOK_TRUE && tok != JSON_SRC_TOK_FALSE)
+        return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+    *pend = (tok == JSON_SRC_TOK_TRUE);
+    return true;
+}
+
+
+/**
+ * Look up a collection type following the item array, as written by
+ * serializers sorting object member names, without consuming the array.
+ *
+ * Each such collection costs an extra scan of its contents, so nested
+ * ones are scanned once per enclosing collection with a trailing type.
+ *
+ * @param json_src  JSON source instance, positioned before the item
+ *                  array.
+ * @param ptype     Location for the collection type.
+ *
+ * @return True if found, false otherwise, with error set.
+ */
+static bool
+json_src_group_scan_type(hidrd_json_src_inst          *json_src,
+                         hidrd_item_collection_type   *ptype)
+{
+    size_t      pos         = json_src->pos;
+    size_t      line        = json_src->line;
+    size_t      line_pos    = json_src->line_pos;
+    bool        first       = false;
+    bool        typed       = false;
+    const char *name;
+
+    if (!json_src_skip(json_src))
+        return false;
+
+    while (true)
+    {
+        if (!json_src_member(json_src, &first, &name))
+            return false;
+        if (name == NULL)
+            break;
+        if (strcmp(name, "type") == 0)
+        {
+            if (!json_src_group_type(json_src, ptype))
+                return false;
+            typed = true;
+        }
+        else if (!json_src_skip(json_src))
+            return false;
+    }
+
+    if (!typed)
+        return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+
+    json_src->pos = pos;
+    json_src->line = line;
+    json_src->line_pos = line_pos;
+
+    return true;
+}
+
+
+/**
+ * Handle a group element value: an object with an optional "items"
+ * array, a "type" for collections and an optional "end", in any order.
+ * Enter the group if the array is present, or handle the element as an
+ * unmatched group start otherwise.
+ */
+static json_src_rc
+json_src_group_enter(hidrd_json_src_inst *json_src, json_src_group group)
+{
+    bool                        first   = true;
+    bool                        typed   = false;
+    bool                        end     = true;
+    hidrd_item_collection_type  type    = 0;
+    const char                 *name;
+
+    if (!json_src_expect(json_src, JSON_SRC_TOK_OBJ_BEGIN))
+        return JSON_SRC_RC_ERROR;
+
+    while (true)
+    {
+        if (!json_src_member(json_src, &first, &name))
+            return JSON_SRC_RC_ERROR;
+
+        if (name == NULL)
+        {
+            if (group == JSON_SRC_GROUP_COLLECTION && !typed)
+                break;
+            return json_src_group_start(json_src, group, type)
+                        ? JSON_SRC_RC_ITEM
+                        : JSON_SRC_RC_ERROR;
+        }
+
+        if (group == JSON_SRC_GROUP_COLLECTION &&
+            strcmp(name, "type") == 0)
+        {
+            if (!json_src_group_type(json_src, &type))
+                return JSON_SRC_RC_ERROR;
+            typed = true;
+            continue;
+        }
+
+        if (strcmp(name, "end") == 0)
+        {
+            if (!json_src_group_end_flag(json_src, &end))
+                return JSON_SRC_RC_ERROR;
+            continue;
+        }
+
+        if (strcmp(name, "items") != 0)
+            break;
+
+        if ((group == JSON_SRC_GROUP_COLLECTION && !typed &&
+             !json_src_group_scan_type(json_src, &type)) ||
+            !json_src_expect(json_src, JSON_SRC_TOK_ARR_BEGIN) ||
+            !json_src_group_start(json_src, group, type))
+            return JSON_SRC_RC_ERROR;
+
+        if (!hidrd_buf_add_char(&json_src->groups,
+                                group |
+                                (end ? 0 : JSON_SRC_GROUP_FLAG_NO_END)))
+        {
+            json_src_fail(json_src, HIDRD_JSON_SRC_ERR_ALLOC);
+            return JSON_SRC_RC_ERROR;
+        }
+
+        json_src->first = true;
+        return JSON_SRC_RC_ENTER;
+    }
+
+    json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+    return JSON_SRC_RC_ERROR;
+}
+
+
+/**
+ * Exit the innermost group, after its item array closing bracket:
+ * read the rest of the group element, including the optional "end"
+ * member, and initialize the group end item, unless it is marked missing.
+ *
+ * @param json_src  JSON source instance.
+ * @param pitem     Location for the "item is ready" flag.
+ *
+ * @return True if exited successfully, false otherwise, with error set.
+ */
+static bool
+json_src_group_exit(hidrd_json_src_inst *json_src, bool *pitem)
+{
+    uint8_t                     code;
+    json_src_group              group;
+    bool                        first   = false;
+    bool                        end;
+    hidrd_item_collection_type  type;
+    const char                 *name;
+
+    assert(json_src->groups.len > 0);
+    code = ((const uint8_t *)json_src->groups.ptr)[json_src->groups.len - 1];
+    hidrd_buf_del(&json_src->groups, 1);
+    group = code & ~JSON_SRC_GROUP_FLAG_NO_END;
+    end = !(code & JSON_SRC_GROUP_FLAG_NO_END);
+
+    while (true)
+    {
+        if (!json_src_member(json_src, &first, &name))
+            return false;
+        if (name == NULL)
+            break;
+        if (strcmp(name, "end") == 0)
+        {
+            if (!json_src_group_end_flag(json_src, &end))
+                return false;
+        }
+        /* A trailing type was looked up on entering the group already */
+        else if (group == JSON_SRC_GROUP_COLLECTION &&
+                 strcmp(name, "type") == 0)
+        {
+            if (!json_src_group_type(json_src, &type))
+                return false;
+        }
+        else
+            return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+    }
+
+    /* Close the element object */
+    if (!json_src_expect(json_src, JSON_SRC_TOK_OBJ_END))
+        return false;
+
+    if (end)
+        json_src_group_end(json_src, group);
+    *pitem = end;
+
+    return true;
+}
+
+
+#define ELEMENT(_name) \
+    json_src_rc                                                 \
+    json_src_element_##_name(hidrd_json_src_inst *json_src)
+
+#define ITEM_OR_ERROR(_expr) \
+    ((_expr) ? JSON_SRC_RC_ITEM : JSON_SRC_RC_ERROR)
+
+static ELEMENT(collection)
+{
+    return json_src_group_enter(json_src, JSON_SRC_GROUP_COLLECTION);
+}
+
+static ELEMENT(push)
+{
+    return json_src_group_enter(json_src, JSON_SRC_GROUP_PUSH);
+}
+
+static ELEMENT(set)
+{
+    return json_src_group_enter(json_src, JSON_SRC_GROUP_SET);
+}
+
+#define END_ELEMENT(_name, _GROUP) \
+    static ELEMENT(_name)                                       \
+    {                                                           \
+        if (!json_src_expect(json_src, JSON_SRC_TOK_NULL))      \
+            return JSON_SRC_RC_ERROR;                           \
+        json_src_group_end(json_src, JSON_SRC_GROUP_##_GROUP);  \
+        return JSON_SRC_RC_ITEM;                                \
+    }
+
+END_ELEMENT(end_collection, COLLECTION)
+END_ELEMENT(pop,            PUSH)
+END_ELEMENT(end_set,        SET)
+
+#define NUM_ELEMENT(_name, _t) \
+    static ELEMENT(_name)                                       \
+    {                                                           \
+        const char             *str     = json_src_num(json_src);   \
+        HIDRD_NUM_##_t##_TYPE   value;                          \
+                                                                \
+        if (str == NULL)                                        \
+            return JSON_SRC_RC_ERROR;                           \
+        if (!HIDRD_DEC_FROM_STR(_t, &value, str))               \
+        {                                                       \
+            json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);  \
+            return JSON_SRC_RC_ERROR;                           \
+        }                                                       \
+                                                                \
+        hidrd_item_##_name##_init(json_src->item, value);       \
+                                                                \
+        return JSON_SRC_RC_ITEM;                                \
+    }
+
+NUM_ELEMENT(logical_minimum,    s32)
+NUM_ELEMENT(logical_maximum,    s32)
+NUM_ELEMENT(physical_minimum,   s32)
+NUM_ELEMENT(physical_maximum,   s32)
+NUM_ELEMENT(unit_exponent,      s32)
+NUM_ELEMENT(report_size,        u32)
+NUM_ELEMENT(report_count,       u32)
+NUM_ELEMENT(report_id,          u8)
+NUM_ELEMENT(designator_index,   u32)
+NUM_ELEMENT(designator_minimum, u32)
+NUM_ELEMENT(designator_maximum, u32)
+NUM_ELEMENT(string_index,       u32)
+NUM_ELEMENT(string_minimum,     u32)
+NUM_ELEMENT(string_maximum,     u32)
+
+static ELEMENT(usage_page)
+{
+    const char         *str     = json_src_str(json_src);
+    hidrd_usage_page    value;
+
+    if (str == NULL)
+        return JSON_SRC_RC_ERROR;
+    if (!HIDRD_NUM_FROM_ALT_STR2(usage_page, &value, str, token, hex))
+    {
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+        return JSON_SRC_RC_ERROR;
+    }
+
+    json_src->usage_page = value;
+    hidrd_item_usage_page_init(json_src->item, value);
+
+    return JSON_SRC_RC_ITEM;
+}
+
+#define USAGE_ELEMENT(_name) \
+    static ELEMENT(_name)                                               \
+    {                                                                   \
+        const char     *str     = json_src_str(json_src);               \
+        hidrd_usage     value;                                          \
+                                                                        \
+        if (str == NULL)                                                \
+            return JSON_SRC_RC_ERROR;                                   \
+        if (!HIDRD_NUM_FROM_ALT_STR2(usage, &value, str, token, hex))   \
+        {                                                               \
+            json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);          \
+            return JSON_SRC_RC_ERROR;                                   \
+        }                                                               \
+                                                                        \
+        if (json_src->usage_page != HIDRD_USAGE_PAGE_UNDEFINED &&       \
+            hidrd_usage_get_page(value) == json_src->usage_page)        \
+            value = hidrd_usage_set_page(value,                         \
+                                         HIDRD_USAGE_PAGE_UNDEFINED);   \
+                                                                        \
+        hidrd_item_##_name##_init(json_src->item, value);               \
+                                                                        \
+        return JSON_SRC_RC_ITEM;                                        \
+    }
+
+USAGE_ELEMENT(usage)
+USAGE_ELEMENT(usage_minimum)
+USAGE_ELEMENT(usage_maximum)
+
+/** Main item bit names, indexed by bit number */
+typedef const char *json_src_bitmap_desc[9];
+
+static const json_src_bitmap_desc json_src_input_bmd = {
+    "constant", "variable", "relative", "wrap", "non_linear",
+    "no_preferred", "null_state", NULL, "buffered_bytes"
+};
+
+static const json_src_bitmap_desc json_src_output_bmd = {
+    "constant", "variable", "relative", "wrap", "non_linear",
+    "no_preferred", "null_state", "volatile", "buffered_bytes"
+};
+
+#define json_src_feature_bmd json_src_output_bmd
+
+/**
+ * Read a main item bitmap array of set bit names.
+ */
+static bool
+json_src_bitmap(hidrd_json_src_inst        *json_src,
+                uint32_t                   *pbitmap,
+                const json_src_bitmap_desc  bmd)
+{
+    uint32_t        bitmap  = 0;
+    bool            first   = true;
+    json_src_tok    tok;
+    const char     *name;
+    size_t          i;
+    char           *end;
+    unsigned long   bit;
+
+    if (!json_src_expect(json_src, JSON_SRC_TOK_ARR_BEGIN))
+        return false;
+
+    while ((tok = json_src_next(json_src)) != JSON_SRC_TOK_ARR_END)
+    {
+        if (!first)
+        {
+            if (tok != JSON_SRC_TOK_COMMA)
+                return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+            tok = json_src_next(json_src);
+        }
+        first = false;
+
+        if (tok != JSON_SRC_TOK_STR)
+            return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+        name = (const char *)json_src->str.ptr;
+
+        for (i = 0; i < sizeof(json_src_bitmap_desc) / sizeof(*bmd); i++)
+            if (bmd[i] != NULL && strcmp(bmd[i], name) == 0)
+                break;
+
+        if (i < sizeof(json_src_bitmap_desc) / sizeof(*bmd))
+            bitmap |= 1UL << i;
+        else if (strncmp(name, "bit", 3) == 0 &&
+                 name[3] >= '0' && name[3] <= '9' &&
+                 (bit = strtoul(name + 3, &end, 10)) < 32 &&
+                 *end == '\0')
+            bitmap |= 1UL << bit;
+        else
+            return json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+    }
+
+    *pbitmap = bitmap;
+    return true;
+}
+
+#define BITMAP_ELEMENT(_name) \
+    static ELEMENT(_name)                                       \
+    {                                                           \
+        uint32_t    bitmap;                                     \
+                                                                \
+        if (!json_src_bitmap(json_src, &bitmap,                 \
+                             json_src_##_name##_bmd))           \
+            return JSON_SRC_RC_ERROR;                           \
+                                                                \
+        hidrd_item_##_name##_init(json_src->item, bitmap);      \
+                                                                \
+        return JSON_SRC_RC_ITEM;                                \
+    }
+
+BITMAP_ELEMENT(input)
+BITMAP_ELEMENT(output)
+BITMAP_ELEMENT(feature)
+
+/** Unit exponent names, indexed by nibble index minus one */
+static const char *json_src_unit_exp_name_list[] = {
+    "length", "mass", "time", "temperature", "current", "luminous_intensity"
+};
+
+static ELEMENT(unit)
+{
+    hidrd_unit          unit    = HIDRD_UNIT_NONE;
+    uint32_t            value   = 0;
+    bool                first   = true;
+    const char         *name;
+    const char         *str;
+    size_t              i;
+    hidrd_unit_system   system;
+    hidrd_unit_exp      exp;
+
+    switch (json_src_next(json_src))
+    {
+        case JSON_SRC_TOK_STR:
+            if (strcmp((const char *)json_src->str.ptr, "none") != 0)
+            {
+                json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                return JSON_SRC_RC_ERROR;
+            }
+            break;
+        case JSON_SRC_TOK_OBJ_BEGIN:
+            while (true)
+            {
+                if (!json_src_member(json_src, &first, &name))
+                    return JSON_SRC_RC_ERROR;
+                if (name == NULL)
+                    break;
+
+                if (strcmp(name, "value") == 0)
+                {
+                    if (!json_src_data(json_src, &value, sizeof(value), NULL))
+                        return JSON_SRC_RC_ERROR;
+                    unit = hidrd_num_u32_from_le(&value);
+                    continue;
+                }
+
+                if (strcmp(name, "system") == 0)
+                {
+                    str = json_src_str(json_src);
+                    if (str == NULL)
+                        return JSON_SRC_RC_ERROR;
+                    if (!HIDRD_NUM_FROM_ALT_STR2(unit_system, &system, str,
+                                                 token, dec))
+                    {
+                        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                        return JSON_SRC_RC_ERROR;
+                    }
+                    unit = hidrd_unit_set_system(unit, system);
+                    continue;
+                }
+
+                for (i = 0; i < HIDRD_UNIT_NIBBLE_INDEX_EXP_NUM; i++)
+                    if (strcmp(name, json_src_unit_exp_name_list[i]) == 0)
+                        break;
+                if (i >= HIDRD_UNIT_NIBBLE_INDEX_EXP_NUM)
+                {
+                    json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+                    return JSON_SRC_RC_ERROR;
+                }
+                str = json_src_num(json_src);
+                if (str == NULL)
+                    return JSON_SRC_RC_ERROR;
+                if (!hidrd_unit_exp_from_dec(&exp, str))
+                {
+                    json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                    return JSON_SRC_RC_ERROR;
+                }
+                unit = hidrd_unit_set_nibble(
+                                unit, i + HIDRD_UNIT_NIBBLE_INDEX_EXP_MIN,
+                                exp);
+            }
+            break;
+        default:
+            json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+            return JSON_SRC_RC_ERROR;
+    }
+
+    hidrd_item_unit_init(json_src->item, unit);
+
+    return JSON_SRC_RC_ITEM;
+}
+
+/*
+ * Short item element of specified type we don't interpret: an object with
+ * a token or decimal "tag" and hex "data" members.
+ */
+#define SHORT_TAG_ELEMENT(_name) \
+    static ELEMENT(_name)                                               \
+    {                                                                   \
+        bool                        first   = true;                     \
+        bool                        tagged  = false;                    \
+        hidrd_item_##_name##_tag    tag     = 0;                        \
+        uint8_t                     data[4] = {0};                      \
+        size_t                      len     = 0;                        \
+        const char                 *name;                               \
+        const char                 *str;                                \
+                                                                        \
+        if (!json_src_expect(json_src, JSON_SRC_TOK_OBJ_BEGIN))         \
+            return JSON_SRC_RC_ERROR;                                   \
+                                                                        \
+        while (true)                                                    \
+        {                                                               \
+            if (!json_src_member(json_src, &first, &name))              \
+                return JSON_SRC_RC_ERROR;                               \
+            if (name == NULL)                                           \
+                break;                                                  \
+            if (strcmp(name, "data") == 0)                              \
+            {                                                           \
+                if (!json_src_data(json_src, data, sizeof(data), &len)) \
+                    return JSON_SRC_RC_ERROR;                           \
+            }                                                           \
+            else if (strcmp(name, "tag") == 0)                          \
+            {                                                           \
+                str = json_src_str(json_src);                           \
+                if (str == NULL)                                        \
+                    return JSON_SRC_RC_ERROR;                           \
+                if (!HIDRD_NUM_FROM_ALT_STR2(item_##_name##_tag,        \
+                                             &tag, str, token, dec))    \
+                {                                                       \
+                    json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);  \
+                    return JSON_SRC_RC_ERROR;                           \
+                }                                                       \
+                tagged = true;                                          \
+            }                                                           \
+            else                                                        \
+                break;                                                  \
+        }                                                               \
+                                                                        \
+        if (name != NULL || !tagged)                                    \
+        {                                                               \
+            json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);         \
+            return JSON_SRC_RC_ERROR;                                   \
+        }                                                               \
+                                                                        \
+        hidrd_item_##_name##_init(json_src->item, tag);                 \
+        memcpy(hidrd_item_short_get_data(json_src->item), data,         \
+               sizeof(data));                                           \
+        hidrd_item_short_set_data_size(                                 \
+                json_src->item,                                         \
+                hidrd_item_short_data_size_from_bytes(len));            \
+                                                                        \
+        return JSON_SRC_RC_ITEM;                                        \
+    }
+
+SHORT_TAG_ELEMENT(main)
+SHORT_TAG_ELEMENT(global)
+SHORT_TAG_ELEMENT(local)
+
+static ELEMENT(basic)
+{
+    bool                        first   = true;
+    bool                        sized   = false;
+    bool                        typed   = false;
+    bool                        tagged  = false;
+    hidrd_item_basic_data_bytes size    = 0;
+    hidrd_item_basic_type       type    = 0;
+    hidrd_item_basic_tag        tag     = 0;
+    uint8_t                     data[HIDRD_ITEM_BASIC_MAX_SIZE -
+                                     HIDRD_ITEM_BASIC_MIN_SIZE] = {0};
+    const char                 *name;
+    const char                 *str;
+
+    if (!json_src_expect(json_src, JSON_SRC_TOK_OBJ_BEGIN))
+        return JSON_SRC_RC_ERROR;
+
+    while (true)
+    {
+        if (!json_src_member(json_src, &first, &name))
+            return JSON_SRC_RC_ERROR;
+        if (name == NULL)
+            break;
+        if (strcmp(name, "data") == 0)
+        {
+            if (!json_src_data(json_src, data, sizeof(data), NULL))
+                return JSON_SRC_RC_ERROR;
+            continue;
+        }
+        if (strcmp(name, "size") == 0)
+        {
+            str = json_src_num(json_src);
+            if (str == NULL)
+                return JSON_SRC_RC_ERROR;
+            if (!hidrd_item_basic_data_bytes_from_dec(&size, str))
+            {
+                json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                return JSON_SRC_RC_ERROR;
+            }
+            sized = true;
+            continue;
+        }
+        if (strcmp(name, "type") == 0)
+        {
+            str = json_src_str(json_src);
+            if (str == NULL)
+                return JSON_SRC_RC_ERROR;
+            if (!HIDRD_NUM_FROM_ALT_STR2(item_basic_type, &type, str,
+                                         token, dec))
+            {
+                json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                return JSON_SRC_RC_ERROR;
+            }
+            typed = true;
+            continue;
+        }
+        if (strcmp(name, "tag") == 0)
+        {
+            str = json_src_num(json_src);
+            if (str == NULL)
+                return JSON_SRC_RC_ERROR;
+            if (!hidrd_item_basic_tag_from_dec(&tag, str))
+            {
+                json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                return JSON_SRC_RC_ERROR;
+            }
+            tagged = true;
+            continue;
+        }
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+        return JSON_SRC_RC_ERROR;
+    }
+
+    if (!sized || !typed || !tagged)
+    {
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+        return JSON_SRC_RC_ERROR;
+    }
+
+    hidrd_item_basic_init(json_src->item, type, tag,
+                          hidrd_item_basic_data_size_from_bytes(size));
+    memcpy(json_src->item + HIDRD_ITEM_BASIC_MIN_SIZE, data, sizeof(data));
+
+    return JSON_SRC_RC_ITEM;
+}
+
+static ELEMENT(short)
+{
+    bool                    first   = true;
+    bool                    typed   = false;
+    bool                    tagged  = false;
+    hidrd_item_short_type   type    = 0;
+    hidrd_item_short_tag    tag     = 0;
+    uint8_t                 data[4] = {0};
+    size_t                  len     = 0;
+    const char             *name;
+    const char             *str;
+
+    if (!json_src_expect(json_src, JSON_SRC_TOK_OBJ_BEGIN))
+        return JSON_SRC_RC_ERROR;
+
+    while (true)
+    {
+        if (!json_src_member(json_src, &first, &name))
+            return JSON_SRC_RC_ERROR;
+        if (name == NULL)
+            break;
+        if (strcmp(name, "data") == 0)
+        {
+            if (!json_src_data(json_src, data, sizeof(data), &len))
+                return JSON_SRC_RC_ERROR;
+            continue;
+        }
+        if (strcmp(name, "type") == 0)
+        {
+            str = json_src_str(json_src);
+            if (str == NULL)
+                return JSON_SRC_RC_ERROR;
+            if (!HIDRD_NUM_FROM_ALT_STR2(item_short_type, &type, str,
+                                         token, dec))
+            {
+                json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                return JSON_SRC_RC_ERROR;
+            }
+            typed = true;
+            continue;
+        }
+        if (strcmp(name, "tag") == 0)
+        {
+            str = json_src_num(json_src);
+            if (str == NULL)
+                return JSON_SRC_RC_ERROR;
+            if (!hidrd_item_short_tag_from_dec(&tag, str))
+            {
+                json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                return JSON_SRC_RC_ERROR;
+            }
+            tagged = true;
+            continue;
+        }
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+        return JSON_SRC_RC_ERROR;
+    }
+
+    if (!typed || !tagged)
+    {
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+        return JSON_SRC_RC_ERROR;
+    }
+
+    hidrd_item_short_init(json_src->item, type, tag);
+    memcpy(hidrd_item_short_get_data(json_src->item), data, sizeof(data));
+    hidrd_item_short_set_data_size(json_src->item,
+                                   hidrd_item_short_data_size_from_bytes(len));
+
+    return JSON_SRC_RC_ITEM;
+}
+
+static ELEMENT(long)
+{
+    bool                first   = true;
+    bool                tagged  = false;
+    hidrd_item_long_tag tag     = 0;
+    uint8_t             data[HIDRD_ITEM_LONG_DATA_SIZE_MAX];
+    size_t              len     = 0;
+    const char         *name;
+    const char         *str;
+
+    if (!json_src_expect(json_src, JSON_SRC_TOK_OBJ_BEGIN))
+        return JSON_SRC_RC_ERROR;
+
+    while (true)
+    {
+        if (!json_src_member(json_src, &first, &name))
+            return JSON_SRC_RC_ERROR;
+        if (name == NULL)
+            break;
+        if (strcmp(name, "data") == 0)
+        {
+            if (!json_src_data(json_src, data, sizeof(data), &len))
+                return JSON_SRC_RC_ERROR;
+            continue;
+        }
+        if (strcmp(name, "tag") == 0)
+        {
+            str = json_src_num(json_src);
+            if (str == NULL)
+                return JSON_SRC_RC_ERROR;
+            if (!hidrd_item_long_tag_from_dec(&tag, str))
+            {
+                json_src_fail(json_src, HIDRD_JSON_SRC_ERR_VALUE);
+                return JSON_SRC_RC_ERROR;
+            }
+            tagged = true;
+            continue;
+        }
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+        return JSON_SRC_RC_ERROR;
+    }
+
+    if (!tagged)
+    {
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_MEMBER);
+        return JSON_SRC_RC_ERROR;
+    }
+
+    hidrd_item_long_init(json_src->item, tag);
+    if (len > 0)
+        memcpy(hidrd_item_long_get_data(json_src->item), data, len);
+    hidrd_item_long_set_data_size(json_src->item, len);
+
+    return JSON_SRC_RC_ITEM;
+}
+
+#undef ELEMENT
+
+/** Element handler */
+typedef struct json_src_element_handler {
+    const char     *name;                               /**< Element name */
+    json_src_rc   (*handle)(hidrd_json_src_inst *);     /**< Element
+                                                             handling
+                                                             function */
+} json_src_element_handler;
+
+/** Element handler list, most frequent elements first */
+static const json_src_element_handler json_src_element_handler_list[] = {
+#define HANDLE(_name)   {.name      = #_name, \
+                         .handle    = json_src_element_##_name}
+    HANDLE(usage),
+    HANDLE(input),
+    HANDLE(report_size),
+    HANDLE(report_count),
+    HANDLE(logical_minimum),
+    HANDLE(logical_maximum),
+    HANDLE(usage_page),
+    HANDLE(collection),
+    HANDLE(usage_minimum),
+    HANDLE(usage_maximum),
+    HANDLE(output),
+    HANDLE(feature),
+    HANDLE(report_id),
+    HANDLE(physical_minimum),
+    HANDLE(physical_maximum),
+    HANDLE(unit_exponent),
+    HANDLE(unit),
+    HANDLE(push),
+    HANDLE(set),
+    HANDLE(end_collection),
+    HANDLE(pop),
+    HANDLE(end_set),
+    HANDLE(designator_index),
+    HANDLE(designator_minimum),
+    HANDLE(designator_maximum),
+    HANDLE(string_index),
+    HANDLE(string_minimum),
+    HANDLE(string_maximum),
+    HANDLE(main),
+    HANDLE(global),
+    HANDLE(local),
+    HANDLE(basic),
+    HANDLE(short),
+    HANDLE(long),
+#undef HANDLE
+};
+
+
+/**
+ * Read an element, after its opening brace.
+ *
+ * @param json_src  JSON source instance.
+ *
+ * @return Element handling result code.
+ */
+static json_src_rc
+json_src_element(hidrd_json_src_inst *json_src)
+{
+    const char                     *name;
+    size_t                          i;
+    const json_src_element_handler *handler;
+    json_src_rc                     rc;
+
+    name = json_src_str(json_src);
+    if (name == NULL)
+        return JSON_SRC_RC_ERROR;
+
+    for (i = 0, handler = json_src_element_handler_list;
+         i < sizeof(json_src_element_handler_list) /
+                sizeof(*json_src_element_handler_list);
+         i++, handler++)
+        if (strcmp(handler->name, name) == 0)
+            break;
+
+    if (i >= sizeof(json_src_element_handler_list) /
+                sizeof(*json_src_element_handler_list))
+    {
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_ELEMENT);
+        return JSON_SRC_RC_ERROR;
+    }
+
+    if (!json_src_expect(json_src, JSON_SRC_TOK_COLON))
+        return JSON_SRC_RC_ERROR;
+
+    rc = (*handler->handle)(json_src);
+
+    /* Close the element object, unless a group is entered */
+    if (rc == JSON_SRC_RC_ITEM &&
+        !json_src_expect(json_src, JSON_SRC_TOK_OBJ_END))
+        return JSON_SRC_RC_ERROR;
+
+    return rc;
+}
+
+
+static const hidrd_item *
+hidrd_json_src_get(hidrd_src *src)
+{
+    hidrd_json_src_inst    *json_src    = (hidrd_json_src_inst *)src;
+    json_src_tok            tok;
+    bool                    item;
+
+    if (src->error || json_src->ended)
+        return NULL;
+
+    /* Open the descriptor array, allowing empty input */
+    if (!json_src->started)
+    {
+        tok = json_src_next(json_src);
+        if (tok == JSON_SRC_TOK_END)
+        {
+            json_src->ended = true;
+            return NULL;
+        }
+        if (tok != JSON_SRC_TOK_ARR_BEGIN)
+        {
+            json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+            return NULL;
+        }
+        json_src->started = true;
+    }
+
+    while (true)
+    {
+        tok = json_src_next(json_src);
+
+        if (tok == JSON_SRC_TOK_ARR_END)
+        {
+            /* If it is the end of the descriptor array */
+            if (json_src->groups.len == 0)
+            {
+                json_src->ended = true;
+                if (json_src_next(json_src) != JSON_SRC_TOK_END)
+                    json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+                return NULL;
+            }
+
+            json_src->first = false;
+            if (!json_src_group_exit(json_src, &item))
+                return NULL;
+            if (item)
+                break;
+            continue;
+        }
+
+        if (!json_src->first)
+        {
+            if (tok != JSON_SRC_TOK_COMMA)
+            {
+                json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+                return NULL;
+            }
+            tok = json_src_next(json_src);
+        }
+        json_src->first = false;
+
+        if (tok != JSON_SRC_TOK_OBJ_BEGIN)
+        {
+            json_src_fail(json_src, HIDRD_JSON_SRC_ERR_SYNTAX);
+            return NULL;
+        }
+
+        if (json_src_element(json_src) == JSON_SRC_RC_ERROR)
+            return NULL;
+        break;
+    }
+
+    if (!hidrd_item_valid(json_src->item))
+    {
+        json_src_fail(json_src, HIDRD_JSON_SRC_ERR_INVALID);
+        return NULL;
+    }
+
+    return json_src->item;
+}
+
+
+static void
+hidrd_json_src_clnp(hidrd_src *src)
+{
+    hidrd_json_src_inst    *json_src    = (hidrd_json_src_inst *)src;
+
+    hidrd_buf_clnp(&json_src->str);
+    hidrd_buf_clnp(&json_src->groups);
+    hidrd_buf_clnp(&json_src->pages);
+}
+
+
+const hidrd_src_type hidrd_json_src = {
+    .size   = sizeof(hidrd_json_src_inst),
+    .initv  = hidrd_json_src_initv,
+    .valid  = hidrd_json_src_valid,
+    .getpos = hidrd_json_src_getpos,
+    .fmtpos = hidrd_json_src_fmtpos,
+    .errmsg = hidrd_json_src_errmsg,
+    .get    = hidrd_json_src_get,
+    .clnp   = hidrd_json_src_clnp,
+};
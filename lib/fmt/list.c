@@ -26,6 +26,8 @@
 #include "hidrd/fmt/cfg.h"
 #include "hidrd/fmt/natv.h"
 #include "hidrd/fmt/hex.h"
+#include "hidrd/fmt/sum.h"
+#include "hidrd/fmt/prog.h"
 #ifdef HIDRD_FMT_WITH_XML
 #include "hidrd/fmt/xml.h"
 #endif
@@ -35,12 +37,17 @@
 #ifdef HIDRD_FMT_WITH_CODE
 #include "hidrd/fmt/code.h"
 #endif
+#ifdef HIDRD_FMT_WITH_JSON
+#include "hidrd/fmt/json.h"
+#endif
 #include "hidrd/fmt/list.h"
 
 /** Supported format list, terminated by NULL */
 const hidrd_fmt *hidrd_fmt_list[]  = {
     &hidrd_natv,
     &hidrd_hex,
+    &hidrd_sum,
+    &hidrd_prog,
 #ifdef HIDRD_FMT_WITH_XML
     &hidrd_xml,
 #endif
@@ -49,6 +56,9 @@ const hidrd_fmt *hidrd_fmt_list[]  = {
 #endif
 #ifdef HIDRD_FMT_WITH_CODE
     &hidrd_code,
+#endif
+#ifdef HIDRD_FMT_WITH_JSON
+    &hidrd_json,
 #endif
     NULL
 };
@@ -0,0 +1,623 @@
+/** @file
+ * @brief HID report descriptor - native descriptor archive
+ *
+ * Copyright (C) 2009-2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hidrd/util/fd.h"
+#include "hidrd/fmt/natv/arc.h"
+
+/** Native descriptor archive builder entry */
+typedef struct hidrd_natv_arc_bld_ent {
+    uint64_t    hash;       /**< Name hash */
+    char       *name;       /**< Name copy */
+    size_t      name_len;   /**< Name length */
+    uint64_t    desc_hash;  /**< Native descriptor hash */
+    void       *desc;       /**< Native descriptor copy */
+    size_t      desc_size;  /**< Native descriptor size */
+    uint16_t    vid;        /**< Device vendor ID, or zero */
+    uint16_t    pid;        /**< Device product ID, or zero */
+} hidrd_natv_arc_bld_ent;
+
+/**
+ * Hash a name or a descriptor for the native descriptor archive (64-bit
+ * FNV-1a).
+ *
+ * @param buf   Buffer to hash.
+ * @param size  Buffer size.
+ *
+ * @return Buffer hash.
+ */
+static uint64_t
+hidrd_natv_arc_hash(const void *buf, size_t size)
+{
+    const uint8_t  *p       = (const uint8_t *)buf;
+    const uint8_t  *end     = p + size;
+    uint64_t        hash    = UINT64_C(0xCBF29CE484222325);
+
+    for (; p < end; p++)
+        hash = (hash ^ *p) * UINT64_C(0x100000001B3);
+
+    return hash;
+}
+
+
+/**
+ * Align an archive file offset to 8 bytes.
+ *
+ * @param off   Offset to align.
+ *
+ * @return Aligned offset.
+ */
+static inline size_t
+hidrd_natv_arc_align(size_t off)
+{
+    return (off + 7) & ~(size_t)7;
+}
+
+
+/**
+ * Retrieve the entry list of a loaded archive.
+ *
+ * @param arc   Archive to retrieve the entry list of.
+ *
+ * @return The entry list.
+ */
+static inline const hidrd_natv_arc_ent *
+hidrd_natv_arc_ent_list(const hidrd_natv_arc *arc)
+{
+    return (const hidrd_natv_arc_ent *)
+                ((const uint8_t *)arc->hdr + arc->hdr->ent_off);
+}
+
+
+bool
+hidrd_natv_arc_valid(const hidrd_natv_arc *arc)
+{
+    const hidrd_natv_arc_hdr   *hdr;
+
+    if (arc == NULL || arc->hdr == NULL ||
+        arc->size < sizeof(*arc->hdr))
+        return false;
+
+    hdr = arc->hdr;
+
+    return memcmp(hdr->magic, HIDRD_NATV_ARC_MAGIC,
+                  sizeof(HIDRD_NATV_ARC_MAGIC)) == 0 &&
+           hdr->version == HIDRD_NATV_ARC_VERSION &&
+           hdr->size == arc->size &&
+           hdr->ent_off >= sizeof(*hdr) &&
+           hdr->ent_off % 8 == 0 &&
+           hdr->ent_off <= hdr->size &&
+           hdr->ent_num <= (hdr->size - hdr->ent_off) /
+                                sizeof(hidrd_natv_arc_ent);
+}
+
+
+bool
+hidrd_natv_arc_load(hidrd_natv_arc *arc, const char *path)
+{
+    int         fd;
+    struct stat st;
+    void       *map;
+    int         orig_errno;
+
+    assert(arc != NULL);
+    assert(path != NULL);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &st) != 0)
+        goto fail;
+    if (st.st_size < (off_t)sizeof(hidrd_natv_arc_hdr) ||
+        st.st_size > (off_t)UINT32_MAX)
+    {
+        errno = EINVAL;
+        goto fail;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        goto fail;
+    close(fd);
+
+    arc->hdr = (const hidrd_natv_arc_hdr *)map;
+    arc->size = st.st_size;
+    if (!hidrd_natv_arc_valid(arc))
+    {
+        hidrd_natv_arc_unload(arc);
+        errno = EINVAL;
+        return false;
+    }
+
+    return true;
+
+fail:
+
+    orig_errno = errno;
+    close(fd);
+    errno = orig_errno;
+    return false;
+}
+
+
+void
+hidrd_natv_arc_unload(hidrd_natv_arc *arc)
+{
+    assert(arc != NULL);
+
+    if (arc->hdr != NULL)
+        munmap((void *)arc->hdr, arc->size);
+    arc->hdr = NULL;
+    arc->size = 0;
+}
+
+
+bool
+hidrd_natv_arc_ent_valid(const hidrd_natv_arc      *arc,
+                         const hidrd_natv_arc_ent  *ent)
+{
+    const char *base;
+
+    assert(hidrd_natv_arc_valid(arc));
+    assert(ent != NULL);
+
+    base = (const char *)arc->hdr;
+
+    return ent->name_off <= arc->size &&
+           ent->name_len < arc->size - ent->name_off &&
+           base[ent->name_off + ent->name_len] == '\0' &&
+           ent->desc_off <= arc->size &&
+           ent->desc_size <= arc->size - ent->desc_off;
+}
+
+
+const hidrd_natv_arc_ent *
+hidrd_natv_arc_get(const hidrd_natv_arc *arc, size_t idx)
+{
+    const hidrd_natv_arc_ent   *ent;
+
+    assert(hidrd_natv_arc_valid(arc));
+
+    if (idx >= arc->hdr->ent_num)
+        return NULL;
+
+    ent = hidrd_natv_arc_ent_list(arc) + idx;
+
+    return hidrd_natv_arc_ent_valid(arc, ent) ? ent : NULL;
+}
+
+
+const hidrd_natv_arc_ent *
+hidrd_natv_arc_lookup(const hidrd_natv_arc *arc, const char *name)
+{
+    const hidrd_natv_arc_ent   *ent_list;
+    const hidrd_natv_arc_ent   *ent;
+    size_t                      len;
+    uint64_t                    hash;
+    size_t                      lo;
+    size_t                      hi;
+    size_t                      mid;
+
+    assert(hidrd_natv_arc_valid(arc));
+    assert(name != NULL);
+
+    ent_list = hidrd_natv_arc_ent_list(arc);
+    len = strlen(name);
+    hash = hidrd_natv_arc_hash(name, len);
+
+    /* Find the first entry with the name hash */
+    for (lo = 0, hi = arc->hdr->ent_num; lo < hi;)
+    {
+        mid = lo + (hi - lo) / 2;
+        if (ent_list[mid].hash < hash)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    for (ent = ent_list + lo;
+         ent < ent_list + arc->hdr->ent_num && ent->hash == hash;
+         ent++)
+        if (ent->name_len == len &&
+            hidrd_natv_arc_ent_valid(arc, ent) &&
+            memcmp(hidrd_natv_arc_ent_name(arc, ent), name, len) == 0)
+            return ent;
+
+    return NULL;
+}
+
+
+const char *
+hidrd_natv_arc_ent_name(const hidrd_natv_arc       *arc,
+                        const hidrd_natv_arc_ent   *ent)
+{
+    assert(hidrd_natv_arc_ent_valid(arc, ent));
+    return (const char *)arc->hdr + ent->name_off;
+}
+
+
+const void *
+hidrd_natv_arc_ent_desc(const hidrd_natv_arc       *arc,
+                        const hidrd_natv_arc_ent   *ent)
+{
+    assert(hidrd_natv_arc_ent_valid(arc, ent));
+    return (const uint8_t *)arc->hdr + ent->desc_off;
+}
+
+
+hidrd_src *
+hidrd_natv_arc_src_new(const hidrd_natv_arc        *arc,
+                       const hidrd_natv_arc_ent    *ent,
+                       char                       **perr)
+{
+    assert(hidrd_natv_arc_ent_valid(arc, ent));
+    return hidrd_src_new(&hidrd_natv_src, perr,
+                         hidrd_natv_arc_ent_desc(arc, ent),
+                         ent->desc_size);
+}
+
+
+hidrd_src *
+hidrd_natv_arc_src_init(hidrd_natv_src_inst        *mem,
+                        const hidrd_natv_arc       *arc,
+                        const hidrd_natv_arc_ent   *ent)
+{
+    assert(mem != NULL);
+    assert(hidrd_natv_arc_ent_valid(arc, ent));
+    return hidrd_src_init_mem(mem, &hidrd_natv_src, NULL,
+                              hidrd_natv_arc_ent_desc(arc, ent),
+                              ent->desc_size);
+}
+
+
+void
+hidrd_natv_arc_bld_init(hidrd_natv_arc_bld *bld)
+{
+    assert(bld != NULL);
+    hidrd_buf_init(&bld->ent);
+}
+
+
+bool
+hidrd_natv_arc_bld_valid(const hidrd_natv_arc_bld *bld)
+{
+    return bld != NULL &&
+           hidrd_buf_valid(&bld->ent) &&
+           bld->ent.len % sizeof(hidrd_natv_arc_bld_ent) == 0;
+}
+
+
+bool
+hidrd_natv_arc_bld_add(hidrd_natv_arc_bld  *bld,
+                       const char          *name,
+                       const void          *desc,
+                       size_t               size,
+                       uint16_t             vid,
+                       uint16_t             pid)
+{
+    hidrd_natv_arc_bld_ent  ent;
+
+    assert(hidrd_natv_arc_bld_valid(bld));
+    assert(name != NULL);
+    assert(desc != NULL || size == 0);
+
+    ent.name_len = strlen(name);
+    ent.hash = hidrd_natv_arc_hash(name, ent.name_len);
+    ent.desc_hash = hidrd_natv_arc_hash(desc, size);
+    ent.desc_size = size;
+    ent.vid = vid;
+    ent.pid = pid;
+    ent.name = strdup(name);
+    ent.desc = malloc(size == 0 ? 1 : size);
+    if (ent.name == NULL || ent.desc == NULL ||
+        !hidrd_buf_add_ptr(&bld->ent, &ent, sizeof(ent)))
+    {
+        free(ent.name);
+        free(ent.desc);
+        return false;
+    }
+    if (size != 0)
+        memcpy(ent.desc, desc, size);
+
+    return true;
+}
+
+
+bool
+hidrd_natv_arc_bld_add_arc(hidrd_natv_arc_bld      *bld,
+                           const hidrd_natv_arc    *arc)
+{
+    const hidrd_natv_arc_ent   *ent;
+    size_t                      i;
+
+    assert(hidrd_natv_arc_bld_valid(bld));
+    assert(hidrd_natv_arc_valid(arc));
+
+    for (i = 0; i < arc->hdr->ent_num; i++)
+    {
+        ent = hidrd_natv_arc_get(arc, i);
+        if (ent == NULL)
+            continue;
+        if (!hidrd_natv_arc_bld_add(bld,
+                                    hidrd_natv_arc_ent_name(arc, ent),
+                                    hidrd_natv_arc_ent_desc(arc, ent),
+                                    ent->desc_size, ent->vid, ent->pid))
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Compare builder entry pointers by name hash, then by name, then by
+ * addition order.
+ *
+ * @param a First builder entry pointer location.
+ * @param b Second builder entry pointer location.
+ *
+ * @return Negative, zero or positive number, if the first entry is
+ *         ordered before, same as, or after the second one.
+ */
+static int
+hidrd_natv_arc_bld_ent_cmp_name(const void *a, const void *b)
+{
+    const hidrd_natv_arc_bld_ent   *x   =
+                                *(const hidrd_natv_arc_bld_ent * const *)a;
+    const hidrd_natv_arc_bld_ent   *y   =
+                                *(const hidrd_natv_arc_bld_ent * const *)b;
+    int                             r;
+
+    if (x->hash != y->hash)
+        return x->hash < y->hash ? -1 : 1;
+    r = strcmp(x->name, y->name);
+    if (r != 0)
+        return r;
+    return x < y ? -1 : (x > y);
+}
+
+
+/**
+ * Compare builder entry pointers by descriptor hash, then by descriptor,
+ * then by addition order.
+ *
+ * @param a First builder entry pointer location.
+ * @param b Second builder entry pointer location.
+ *
+ * @return Negative, zero or positive number, if the first entry is
+ *         ordered before, same as, or after the second one.
+ */
+static int
+hidrd_natv_arc_bld_ent_cmp_desc(const void *a, const void *b)
+{
+    const hidrd_natv_arc_bld_ent   *x   =
+                                *(const hidrd_natv_arc_bld_ent * const *)a;
+    const hidrd_natv_arc_bld_ent   *y   =
+                                *(const hidrd_natv_arc_bld_ent * const *)b;
+    int                             r;
+
+    if (x->desc_hash != y->desc_hash)
+        return x->desc_hash < y->desc_hash ? -1 : 1;
+    if (x->desc_size != y->desc_size)
+        return x->desc_size < y->desc_size ? -1 : 1;
+    r = memcmp(x->desc, y->desc, x->desc_size);
+    if (r != 0)
+        return r;
+    return x < y ? -1 : (x > y);
+}
+
+
+/**
+ * Check if two builder entries have the same descriptor.
+ *
+ * @param x First builder entry.
+ * @param y Second builder entry.
+ *
+ * @return True if the descriptors are the same, false otherwise.
+ */
+static bool
+hidrd_natv_arc_bld_ent_same_desc(const hidrd_natv_arc_bld_ent *x,
+                                 const hidrd_natv_arc_bld_ent *y)
+{
+    return x->desc_hash == y->desc_hash &&
+           x->desc_size == y->desc_size &&
+           memcmp(x->desc, y->desc, x->desc_size) == 0;
+}
+
+
+/**
+ * Build an archive file image from a native descriptor archive builder.
+ *
+ * @param bld   Builder to build the image from.
+ * @param psize Location for the image size.
+ *
+ * @return Dynamically allocated image, or NULL if failed (see errno in
+ *         this case).
+ */
+static void *
+hidrd_natv_arc_build(const hidrd_natv_arc_bld *bld, size_t *psize)
+{
+    const hidrd_natv_arc_bld_ent   *bld_list;
+    const hidrd_natv_arc_bld_ent  **name_list   = NULL;
+    const hidrd_natv_arc_bld_ent  **desc_list   = NULL;
+    uint32_t                       *desc_off    = NULL;
+    uint8_t                        *image       = NULL;
+    hidrd_natv_arc_hdr             *hdr;
+    hidrd_natv_arc_ent             *ent;
+    size_t                          bld_num;
+    size_t                          num;
+    size_t                          desc_num;
+    size_t                          off;
+    size_t                          i;
+
+    bld_list = (const hidrd_natv_arc_bld_ent *)bld->ent.ptr;
+    bld_num = bld->ent.len / sizeof(*bld_list);
+
+    name_list = malloc(sizeof(*name_list) * (bld_num + 1));
+    desc_list = malloc(sizeof(*desc_list) * (bld_num + 1));
+    desc_off = malloc(sizeof(*desc_off) * (bld_num + 1));
+    if (name_list == NULL || desc_list == NULL || desc_off == NULL)
+    {
+        errno = ENOMEM;
+        goto cleanup;
+    }
+
+    /* Order the entries by name, keeping the last added of the same */
+    for (i = 0; i < bld_num; i++)
+        name_list[i] = bld_list + i;
+    qsort(name_list, bld_num, sizeof(*name_list),
+          hidrd_natv_arc_bld_ent_cmp_name);
+    for (num = 0, i = 0; i < bld_num; i++)
+        if (i + 1 == bld_num ||
+            name_list[i]->hash != name_list[i + 1]->hash ||
+            strcmp(name_list[i]->name, name_list[i + 1]->name) != 0)
+            name_list[num++] = name_list[i];
+
+    /* Lay out the header, the entries and the names */
+    off = hidrd_natv_arc_align(sizeof(*hdr));
+    off += sizeof(*ent) * num;
+    for (i = 0; i < num; i++)
+        off += name_list[i]->name_len + 1;
+
+    /* Lay out the descriptors, once for each distinct one */
+    memcpy(desc_list, name_list, sizeof(*desc_list) * num);
+    qsort(desc_list, num, sizeof(*desc_list),
+          hidrd_natv_arc_bld_ent_cmp_desc);
+    for (desc_num = 0, i = 0; i < num; i++)
+    {
+        if (i == 0 ||
+            !hidrd_natv_arc_bld_ent_same_desc(desc_list[i - 1],
+                                              desc_list[i]))
+        {
+            if (off > UINT32_MAX)
+                break;
+            desc_off[desc_list[i] - bld_list] = off;
+            off += desc_list[i]->desc_size;
+            desc_num++;
+        }
+        else
+            desc_off[desc_list[i] - bld_list] =
+                desc_off[desc_list[i - 1] - bld_list];
+    }
+    if (off > UINT32_MAX)
+    {
+        errno = EFBIG;
+        goto cleanup;
+    }
+
+    image = calloc(1, off);
+    if (image == NULL)
+    {
+        errno = ENOMEM;
+        goto cleanup;
+    }
+    *psize = off;
+
+    hdr = (hidrd_natv_arc_hdr *)image;
+    memcpy(hdr->magic, HIDRD_NATV_ARC_MAGIC, sizeof(HIDRD_NATV_ARC_MAGIC));
+    hdr->version = HIDRD_NATV_ARC_VERSION;
+    hdr->size = off;
+    hdr->ent_off = hidrd_natv_arc_align(sizeof(*hdr));
+    hdr->ent_num = num;
+    hdr->desc_num = desc_num;
+
+    /* Fill in the entries and copy the names and the descriptors */
+    ent = (hidrd_natv_arc_ent *)(image + hdr->ent_off);
+    off = hdr->ent_off + sizeof(*ent) * num;
+    for (i = 0; i < num; i++, ent++)
+    {
+        ent->hash = name_list[i]->hash;
+        ent->name_off = off;
+        ent->name_len = name_list[i]->name_len;
+        memcpy(image + off, name_list[i]->name, name_list[i]->name_len);
+        off += name_list[i]->name_len + 1;
+        ent->desc_off = desc_off[name_list[i] - bld_list];
+        ent->desc_size = name_list[i]->desc_size;
+        memcpy(image + ent->desc_off, name_list[i]->desc,
+               name_list[i]->desc_size);
+        ent->vid = name_list[i]->vid;
+        ent->pid = name_list[i]->pid;
+    }
+
+cleanup:
+
+    free(desc_off);
+    free(desc_list);
+    free(name_list);
+
+    return image;
+}
+
+
+bool
+hidrd_natv_arc_store(const hidrd_natv_arc_bld  *bld,
+                     const char                *path)
+{
+    bool    result;
+    void   *image;
+    size_t  size;
+    int     orig_errno;
+
+    assert(hidrd_natv_arc_bld_valid(bld));
+    assert(path != NULL);
+
+    image = hidrd_natv_arc_build(bld, &size);
+    if (image == NULL)
+        return false;
+
+    result = hidrd_fd_replace_whole(path, image, size);
+
+    orig_errno = errno;
+    free(image);
+    errno = orig_errno;
+
+    return result;
+}
+
+
+void
+hidrd_natv_arc_bld_clnp(hidrd_natv_arc_bld *bld)
+{
+    hidrd_natv_arc_bld_ent *p;
+    hidrd_natv_arc_bld_ent *end;
+
+    assert(hidrd_natv_arc_bld_valid(bld));
+
+    p = (hidrd_natv_arc_bld_ent *)bld->ent.ptr;
+    for (end = p + bld->ent.len / sizeof(*p); p < end; p++)
+    {
+        free(p->name);
+        free(p->desc);
+    }
+
+    hidrd_buf_clnp(&bld->ent);
+}
@@ -25,17 +25,26 @@
 #include "hidrd/fmt/natv/snk.h"
 
 static bool
-hidrd_natv_snk_init(hidrd_snk *snk, char **perr)
+hidrd_natv_snk_init(hidrd_snk *snk, char **perr, bool fixed)
 {
     hidrd_natv_snk_inst    *natv_snk    = (hidrd_natv_snk_inst *)snk;
 
     void   *buf     = (snk->pbuf != NULL) ? *snk->pbuf : NULL;
     size_t  size    = (snk->psize != NULL) ? *snk->psize : 0;
 
+    if (fixed && snk->pbuf == NULL)
+    {
+        if (perr != NULL)
+            *perr = strdup("fixed buffer mode requires a caller buffer");
+        return false;
+    }
+
     natv_snk->buf   = buf;
-    natv_snk->size  = size;
+    /* A fixed buffer is only a space to fill, not a stream to overwrite */
+    natv_snk->size  = fixed ? 0 : size;
     natv_snk->alloc = size;
     natv_snk->pos   = 0;
+    natv_snk->fixed = fixed;
     natv_snk->err   = HIDRD_NATV_SNK_ERR_NONE;
 
     if (perr != NULL)
@@ -49,10 +58,45 @@ static bool
 hidrd_natv_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
 {
     (void)ap;
-    return hidrd_natv_snk_init(snk, perr);
+    return hidrd_natv_snk_init(snk, perr, false);
+}
+
+
+static bool
+hidrd_natv_fixed_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
+{
+    (void)ap;
+    return hidrd_natv_snk_init(snk, perr, true);
 }
 
 
+#ifdef HIDRD_WITH_OPT
+/** Option indexes into the specification list */
+enum {
+    OPT_FIXED,
+    OPT_NUM
+};
+
+static const hidrd_opt_spec hidrd_natv_snk_opts_spec[] = {
+    [OPT_FIXED] =
+        {.name  = "fixed",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {.boolean = false},
+         .desc  = "write into the fixed output buffer, never reallocating"},
+    [OPT_NUM] =
+        {.name  = NULL}
+};
+
+static bool
+hidrd_natv_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
+{
+    return hidrd_natv_snk_init(snk, perr,
+                               hidrd_opt_list_get_boolean_at(list, OPT_FIXED));
+}
+#endif /* HIDRD_WITH_OPT */
+
+
 static bool
 hidrd_natv_snk_valid(const hidrd_snk *snk)
 {
@@ -61,7 +105,8 @@ hidrd_natv_snk_valid(const hidrd_snk *snk)
 
     return (snk->type->size >= sizeof(hidrd_natv_snk_inst)) &&
            (natv_snk->size == 0 || natv_snk->buf != NULL) &&
-           (natv_snk->pos <= natv_snk->size);
+           (natv_snk->pos <= natv_snk->size) &&
+           (!natv_snk->fixed || natv_snk->size <= natv_snk->alloc);
 }
 
 
@@ -80,6 +125,9 @@ hidrd_natv_snk_errmsg(const hidrd_snk *snk)
         case HIDRD_NATV_SNK_ERR_ALLOC:
             msg = "memory allocation failure";
             break;
+        case HIDRD_NATV_SNK_ERR_OVERFLOW:
+            msg = "output buffer overflow";
+            break;
         default:
             assert(!"Unknown error code");
             return NULL;
@@ -103,7 +151,15 @@ hidrd_natv_snk_put(hidrd_snk *snk, const hidrd_item *item)
     item_size = hidrd_item_get_size(item);
     new_pos = natv_snk->pos + item_size;
 
-    if (new_pos >= natv_snk->alloc)
+    if (natv_snk->fixed)
+    {
+        if (new_pos > natv_snk->alloc)
+        {
+            natv_snk->err = HIDRD_NATV_SNK_ERR_OVERFLOW;
+            return false;
+        }
+    }
+    else if (new_pos >= natv_snk->alloc)
     {
         new_alloc = (natv_snk->alloc < HIDRD_ITEM_MAX_SIZE * 2)
                         ? HIDRD_ITEM_MAX_SIZE * 4
@@ -136,8 +192,8 @@ hidrd_natv_snk_flush(hidrd_snk *snk)
     hidrd_natv_snk_inst    *natv_snk   = (hidrd_natv_snk_inst *)snk;
     void                   *new_buf;
 
-    /* Retention buffer, if needed */
-    if (natv_snk->alloc != natv_snk->size)
+    /* Retention buffer, if needed and allowed */
+    if (!natv_snk->fixed && natv_snk->alloc != natv_snk->size)
     {
         new_buf = realloc(natv_snk->buf, natv_snk->size);
         if (natv_snk->size != 0 && new_buf == NULL)
@@ -178,13 +234,28 @@ hidrd_natv_snk_clnp(hidrd_snk *snk)
 
 
 const hidrd_snk_type hidrd_natv_snk = {
-    .size   = sizeof(hidrd_natv_snk_inst),
-    .initv  = hidrd_natv_snk_initv,
-    .valid  = hidrd_natv_snk_valid,
-    .errmsg = hidrd_natv_snk_errmsg,
-    .put    = hidrd_natv_snk_put,
-    .flush  = hidrd_natv_snk_flush,
-    .clnp   = hidrd_natv_snk_clnp,
+    .size       = sizeof(hidrd_natv_snk_inst),
+    .initv      = hidrd_natv_snk_initv,
+#ifdef HIDRD_WITH_OPT
+    .init_opts  = hidrd_natv_snk_init_opts,
+    .opts_spec  = hidrd_natv_snk_opts_spec,
+#endif
+    .valid      = hidrd_natv_snk_valid,
+    .errmsg     = hidrd_natv_snk_errmsg,
+    .put        = hidrd_natv_snk_put,
+    .flush      = hidrd_natv_snk_flush,
+    .clnp       = hidrd_natv_snk_clnp,
+};
+
+
+const hidrd_snk_type hidrd_natv_fixed_snk = {
+    .size       = sizeof(hidrd_natv_snk_inst),
+    .initv      = hidrd_natv_fixed_snk_initv,
+    .valid      = hidrd_natv_snk_valid,
+    .errmsg     = hidrd_natv_snk_errmsg,
+    .put        = hidrd_natv_snk_put,
+    .flush      = hidrd_natv_snk_flush,
+    .clnp       = hidrd_natv_snk_clnp,
 };
 
 
@@ -23,8 +23,10 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <unistd.h>
 #include "hidrd/fmt/natv.h"
 
 typedef struct item_desc {
@@ -213,6 +215,21 @@ main(int argc, char **argv)
 
     const hidrd_item   *test_item;
 
+    hidrd_natv_src_inst src_mem;
+    hidrd_natv_snk_inst snk_mem;
+    hidrd_src          *mem_src         = NULL;
+    hidrd_snk          *mem_snk         = NULL;
+    void               *fixed_rd_buf    = NULL;
+    size_t              fixed_rd_len;
+
+    hidrd_natv_arc_bld          arc_bld;
+    bool                        arc_bld_init    = false;
+    hidrd_natv_arc              arc             = HIDRD_NATV_ARC_EMPTY;
+    const hidrd_natv_arc_ent   *arc_ent;
+    char                        arc_path[]      =
+                                        "/tmp/hidrd_natv_test.XXXXXX";
+    int                         arc_fd          = -1;
+
     char               *err             = NULL;
 
     (void)argc;
@@ -307,12 +324,157 @@ main(int argc, char **argv)
     hidrd_src_delete(src);
     src = NULL;
 
+    /*
+     * Write report descriptor to a fixed buffer with a sink in
+     * caller-provided storage.
+     */
+    fixed_rd_buf = malloc(orig_rd_len);
+    fixed_rd_len = orig_rd_len;
+    mem_snk = hidrd_snk_init_mem(&snk_mem, &hidrd_natv_fixed_snk, NULL,
+                                 &fixed_rd_buf, &fixed_rd_len);
+    if (mem_snk == NULL)
+        ERR_CLNP("Failed to initialize fixed native sink");
+    if ((void *)mem_snk != (void *)&snk_mem)
+        ERR_CLNP("Fixed native sink is not located in provided storage");
+
+    for (orig_item = item_list; orig_item->len != 0; orig_item++)
+        if (!hidrd_snk_put(mem_snk, orig_item->buf))
+            ERR_CLNP("Failed to put item #%zu into fixed native sink:\n%s",
+                     (orig_item - item_list),
+                     (err = hidrd_snk_errmsg(mem_snk)));
+
+    if (!hidrd_snk_flush(mem_snk))
+        ERR_CLNP("Failed to flush fixed native sink:\n%s",
+                 (err = hidrd_snk_errmsg(mem_snk)));
+    hidrd_snk_clnp(mem_snk);
+    mem_snk = NULL;
+
+    if (fixed_rd_len != orig_rd_len ||
+        memcmp(fixed_rd_buf, orig_rd_buf, orig_rd_len) != 0)
+    {
+        ERR("Fixed buffer resource descriptor doesn't match\n\n");
+        hexdump_cmp(stderr, true,
+                    orig_rd_buf, orig_rd_len, fixed_rd_buf, fixed_rd_len);
+        goto cleanup;
+    }
+
+    /*
+     * Overflow a fixed buffer one byte short of the descriptor.
+     */
+    fixed_rd_len = orig_rd_len - 1;
+    mem_snk = hidrd_snk_init_mem(&snk_mem, &hidrd_natv_fixed_snk, NULL,
+                                 &fixed_rd_buf, &fixed_rd_len);
+    if (mem_snk == NULL)
+        ERR_CLNP("Failed to initialize short fixed native sink");
+
+    for (orig_item = item_list; orig_item->len != 0; orig_item++)
+        if (!hidrd_snk_put(mem_snk, orig_item->buf))
+            break;
+    if (orig_item->len == 0 || orig_item[1].len != 0)
+        ERR_CLNP("Short fixed native sink didn't overflow on the last item");
+    if (snk_mem.err != HIDRD_NATV_SNK_ERR_OVERFLOW)
+        ERR_CLNP("Short fixed native sink has unexpected error code");
+    hidrd_snk_clnp(mem_snk);
+    mem_snk = NULL;
+
+    /*
+     * Read the fixed buffer back with a source in caller-provided storage.
+     */
+    mem_src = hidrd_src_init_mem(&src_mem, hidrd_natv.src, NULL,
+                                 fixed_rd_buf, orig_rd_len);
+    if (mem_src == NULL)
+        ERR_CLNP("Failed to initialize native source in provided storage");
+
+    for (orig_item = item_list; orig_item->len != 0; orig_item++)
+        if ((test_item = hidrd_src_get(mem_src)) == NULL ||
+            memcmp(test_item, orig_item->buf, orig_item->len) != 0)
+            ERR_CLNP("Item #%zu retrieved from the caller-storage source "
+                     "doesn't match the original",
+                     (orig_item - item_list + 1));
+    if (hidrd_src_get(mem_src) != NULL || hidrd_src_error(mem_src))
+        ERR_CLNP("The caller-storage source didn't end cleanly");
+    hidrd_src_clnp(mem_src);
+    mem_src = NULL;
+
+    /*
+     * Store the descriptor into an archive under two names, replacing
+     * one, and along with an empty one, then load the archive and read
+     * the descriptor back from it in place.
+     */
+    arc_fd = mkstemp(arc_path);
+    if (arc_fd < 0)
+        ERR_CLNP("Failed to create archive file");
+    close(arc_fd);
+
+    hidrd_natv_arc_bld_init(&arc_bld);
+    arc_bld_init = true;
+    if (!hidrd_natv_arc_bld_add(&arc_bld, "first", orig_rd_buf, 2,
+                                0x1234, 0x5678) ||
+        !hidrd_natv_arc_bld_add(&arc_bld, "second", orig_rd_buf,
+                                orig_rd_len, 0, 0) ||
+        !hidrd_natv_arc_bld_add(&arc_bld, "empty", NULL, 0, 0, 0) ||
+        !hidrd_natv_arc_bld_add(&arc_bld, "first", orig_rd_buf,
+                                orig_rd_len, 0x256C, 0x006E))
+        ERR_CLNP("Failed to add archive entries");
+    if (!hidrd_natv_arc_store(&arc_bld, arc_path))
+        ERR_CLNP("Failed to store archive");
+    hidrd_natv_arc_bld_clnp(&arc_bld);
+    arc_bld_init = false;
+
+    if (!hidrd_natv_arc_load(&arc, arc_path))
+        ERR_CLNP("Failed to load archive");
+    if (arc.hdr->ent_num != 3 || arc.hdr->desc_num != 2)
+        ERR_CLNP("Archive has unexpected number of entries "
+                 "or descriptors");
+    if (hidrd_natv_arc_lookup(&arc, "third") != NULL)
+        ERR_CLNP("Archive has unexpected entry found");
+
+    arc_ent = hidrd_natv_arc_lookup(&arc, "empty");
+    if (arc_ent == NULL || arc_ent->desc_size != 0)
+        ERR_CLNP("Empty archive entry is not found or not empty");
+
+    arc_ent = hidrd_natv_arc_lookup(&arc, "second");
+    if (arc_ent == NULL ||
+        hidrd_natv_arc_lookup(&arc, "first")->desc_off != arc_ent->desc_off)
+        ERR_CLNP("Archive entry descriptors are not shared");
+
+    arc_ent = hidrd_natv_arc_lookup(&arc, "first");
+    if (arc_ent->vid != 0x256C || arc_ent->pid != 0x006E ||
+        strcmp(hidrd_natv_arc_ent_name(&arc, arc_ent), "first") != 0)
+        ERR_CLNP("Archive entry is not replaced");
+
+    mem_src = hidrd_natv_arc_src_init(&src_mem, &arc, arc_ent);
+    if (mem_src == NULL)
+        ERR_CLNP("Failed to initialize archive entry source");
+    if (src_mem.src.buf != hidrd_natv_arc_ent_desc(&arc, arc_ent))
+        ERR_CLNP("Archive entry source doesn't read the archive in place");
+    for (orig_item = item_list; orig_item->len != 0; orig_item++)
+        if ((test_item = hidrd_src_get(mem_src)) == NULL ||
+            memcmp(test_item, orig_item->buf, orig_item->len) != 0)
+            ERR_CLNP("Item #%zu retrieved from the archive entry source "
+                     "doesn't match the original",
+                     (orig_item - item_list + 1));
+    if (hidrd_src_get(mem_src) != NULL || hidrd_src_error(mem_src))
+        ERR_CLNP("The archive entry source didn't end cleanly");
+    hidrd_src_clnp(mem_src);
+    mem_src = NULL;
+
     result = 0;
 
 cleanup:
 
+    if (mem_src != NULL)
+        hidrd_src_clnp(mem_src);
+    hidrd_natv_arc_unload(&arc);
+    if (arc_bld_init)
+        hidrd_natv_arc_bld_clnp(&arc_bld);
+    if (arc_fd >= 0)
+        unlink(arc_path);
+    if (mem_snk != NULL)
+        hidrd_snk_clnp(mem_snk);
     hidrd_src_delete(src);
     hidrd_snk_delete(snk);
+    free(fixed_rd_buf);
     free(test_rd_buf);
     free(orig_rd_buf);
     free(err);
@@ -0,0 +1,232 @@
+/** @file
+ * @brief HID report descriptor - report decoding program disassembly sink
+ *
+ * Copyright (C) 2014 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hidrd/cfg.h"
+#include "hidrd/layout/prog.h"
+#include "hidrd/fmt/prog/snk.h"
+
+static bool
+hidrd_prog_snk_init(hidrd_snk *snk, char **perr, bool physical)
+{
+    hidrd_prog_snk_inst    *prog_snk    = (hidrd_prog_snk_inst *)snk;
+
+    if (!hidrd_layout_cmpl_init(&prog_snk->cmpl))
+    {
+        if (perr != NULL)
+            *perr = strdup("memory allocation failure");
+        return false;
+    }
+
+    prog_snk->physical = physical;
+    prog_snk->err = HIDRD_PROG_SNK_ERR_NONE;
+
+    if (perr != NULL)
+        *perr = strdup("");
+
+    return true;
+}
+
+
+static bool
+hidrd_prog_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
+{
+    bool    physical    = (va_arg(ap, int) != 0);
+
+    return hidrd_prog_snk_init(snk, perr, physical);
+}
+
+
+#ifdef HIDRD_WITH_OPT
+/** Option indexes into the specification list */
+enum {
+    OPT_PHYSICAL,
+    OPT_NUM
+};
+
+static const hidrd_opt_spec hidrd_prog_snk_opts_spec[] = {
+    [OPT_PHYSICAL] =
+        {.name  = "physical",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {.boolean = false},
+         .desc  = "map values to physical ranges"},
+    [OPT_NUM] =
+        {.name  = NULL}
+};
+
+static bool
+hidrd_prog_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
+{
+    return hidrd_prog_snk_init(
+                snk, perr,
+                hidrd_opt_list_get_boolean_at(list, OPT_PHYSICAL));
+}
+#endif /* HIDRD_WITH_OPT */
+
+
+static bool
+hidrd_prog_snk_valid(const hidrd_snk *snk)
+{
+    const hidrd_prog_snk_inst  *prog_snk    =
+                                    (const hidrd_prog_snk_inst *)snk;
+
+    return (snk->type->size >= sizeof(hidrd_prog_snk_inst)) &&
+           hidrd_layout_cmpl_valid(&prog_snk->cmpl);
+}
+
+
+static char *
+hidrd_prog_snk_errmsg(const hidrd_snk *snk)
+{
+    const hidrd_prog_snk_inst  *prog_snk    =
+                                    (const hidrd_prog_snk_inst *)snk;
+    const char                 *msg;
+
+    switch (prog_snk->err)
+    {
+        case HIDRD_PROG_SNK_ERR_NONE:
+            msg = "";
+            break;
+        case HIDRD_PROG_SNK_ERR_ALLOC:
+            msg = "memory allocation failure";
+            break;
+        case HIDRD_PROG_SNK_ERR_CMPL:
+            return hidrd_layout_cmpl_errmsg(&prog_snk->cmpl);
+        case HIDRD_PROG_SNK_ERR_SIZE:
+            msg = "layout exceeds decoding program limits";
+            break;
+        default:
+            assert(!"Unknown error code");
+            return NULL;
+    }
+
+    return strdup(msg);
+}
+
+
+static bool
+hidrd_prog_snk_put(hidrd_snk *snk, const hidrd_item *item)
+{
+    hidrd_prog_snk_inst    *prog_snk    = (hidrd_prog_snk_inst *)snk;
+
+    assert(hidrd_item_valid(item));
+
+    if (!hidrd_layout_cmpl_put(&prog_snk->cmpl, item))
+    {
+        prog_snk->err = HIDRD_PROG_SNK_ERR_CMPL;
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool
+hidrd_prog_snk_flush(hidrd_snk *snk)
+{
+    bool                    result      = false;
+    hidrd_prog_snk_inst    *prog_snk    = (hidrd_prog_snk_inst *)snk;
+    hidrd_layout           *layout      = NULL;
+    hidrd_layout_prog      *prog        = NULL;
+    hidrd_buf               buf         = HIDRD_BUF_EMPTY;
+    void                   *ptr;
+    size_t                  len;
+
+    layout = hidrd_layout_cmpl_finish(&prog_snk->cmpl);
+    if (layout == NULL)
+    {
+        prog_snk->err = HIDRD_PROG_SNK_ERR_CMPL;
+        goto cleanup;
+    }
+
+    prog = hidrd_layout_prog_new(layout,
+                                 prog_snk->physical
+                                    ? HIDRD_LAYOUT_PROG_FLAG_PHYSICAL
+                                    : 0);
+    if (prog == NULL)
+    {
+        prog_snk->err = (errno == EFBIG)
+                            ? HIDRD_PROG_SNK_ERR_SIZE
+                            : HIDRD_PROG_SNK_ERR_ALLOC;
+        goto cleanup;
+    }
+
+    if (!hidrd_layout_prog_disasm(prog, &buf))
+    {
+        prog_snk->err = HIDRD_PROG_SNK_ERR_ALLOC;
+        goto cleanup;
+    }
+
+    hidrd_buf_disown(&buf, &ptr, &len, NULL);
+
+    if (snk->pbuf != NULL)
+    {
+        free(*snk->pbuf);
+        *snk->pbuf = ptr;
+    }
+    else
+        free(ptr);
+
+    if (snk->psize != NULL)
+        *snk->psize = len;
+
+    result = true;
+
+cleanup:
+
+    hidrd_buf_clnp(&buf);
+    hidrd_layout_prog_delete(prog);
+    hidrd_layout_delete(layout);
+
+    return result;
+}
+
+
+static void
+hidrd_prog_snk_clnp(hidrd_snk *snk)
+{
+    hidrd_prog_snk_inst    *prog_snk    = (hidrd_prog_snk_inst *)snk;
+
+    hidrd_layout_cmpl_clnp(&prog_snk->cmpl);
+    prog_snk->err = HIDRD_PROG_SNK_ERR_NONE;
+}
+
+
+const hidrd_snk_type hidrd_prog_snk = {
+    .size       = sizeof(hidrd_prog_snk_inst),
+    .initv      = hidrd_prog_snk_initv,
+#ifdef HIDRD_WITH_OPT
+    .init_opts  = hidrd_prog_snk_init_opts,
+    .opts_spec  = hidrd_prog_snk_opts_spec,
+#endif
+    .valid      = hidrd_prog_snk_valid,
+    .errmsg     = hidrd_prog_snk_errmsg,
+    .put        = hidrd_prog_snk_put,
+    .flush      = hidrd_prog_snk_flush,
+    .clnp       = hidrd_prog_snk_clnp,
+};
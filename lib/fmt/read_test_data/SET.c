@@ -0,0 +1,36 @@
+#include <stdint.h>
+
+static const uint8_t hid_desc[] = {
+    0xA9, 0x01,                     /*  Delimiter (Open),   */
+    0x0B, 0x01, 0x02, 0x00, 0x00,   /*  Usage (0201h),      */
+    0xA8                            /*  Delimiter (Close)   */
+};
+
+static inline uint32_t
+hid_bits_get(const uint8_t *report, uint32_t bit, uint32_t size)
+{
+    const uint8_t  *p      = report + (bit >> 3);
+    uint32_t        shift  = bit & 7;
+    uint32_t        n      = (shift + size + 7) >> 3;
+    uint64_t        v      = 0;
+    uint32_t        i;
+
+    for (i = 0; i < n; i++)
+        v |= (uint64_t)p[i] << (i * 8);
+
+    return (uint32_t)((v >> shift) & (((uint64_t)1 << size) - 1));
+}
+
+static inline void
+hid_bits_set(uint8_t *report, uint32_t bit, uint32_t size, uint32_t value)
+{
+    uint8_t    *p      = report + (bit >> 3);
+    uint32_t    shift  = bit & 7;
+    uint32_t    n      = (shift + size + 7) >> 3;
+    uint64_t    mask   = (((uint64_t)1 << size) - 1) << shift;
+    uint64_t    v      = ((uint64_t)value << shift) & mask;
+    uint32_t    i;
+
+    for (i = 0; i < n; i++, mask >>= 8, v >>= 8)
+        p[i] = (uint8_t)((p[i] & ~mask) | v);
+}
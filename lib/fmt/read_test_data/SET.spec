@@ -0,0 +1,3 @@
+Delimiter (Open),
+Local (tag:0h data:01020000h),
+Delimiter (Close)
@@ -0,0 +1,2 @@
+Main (tag:Ah data:01000000h),
+    Long (tag:FFh data:01020304h)
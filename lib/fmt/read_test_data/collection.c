@@ -0,0 +1,9 @@
+0x05, 0x0D,
+0x09, 0x02,
+0xA1, 0x01,
+    0x85, 0x07,
+    0x09, 0x20,
+    0xA0,
+        0x09, 0x42,
+    0xC0,
+0xC0
@@ -0,0 +1,9 @@
+Usage Page (Digitizer),     ; 05 0D - Digitizer (0Dh)
+Usage (Pen),                ; 09 02 - Pen (02h, application collection)
+Collection (Application),   ; A1 01
+    Report ID (7),          ; 85 07
+    Usage (Stylus),         ; 09 20 - Stylus (20h, application collection, logical collection)
+    Collection (Physical),  ; A0
+        Usage (Tip Switch), ; 09 42 - Tip switch (42h, momentary control)
+    End Collection,         ; C0
+End Collection              ; C0
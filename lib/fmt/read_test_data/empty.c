@@ -0,0 +1,3 @@
+/* Empty report descriptor */
+static const unsigned char hid_desc[] = {
+};
@@ -0,0 +1 @@
+0x47, 0x01, 0x01, 0x01, 0x01
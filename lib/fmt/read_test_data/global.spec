@@ -0,0 +1 @@
+Physical Maximum (16843009) ; 47 01 01 01 01
@@ -0,0 +1,33 @@
+/*
+ * Hand-written mouse report descriptor
+ * with mixed literal notation.
+ */
+#include <stdint.h>
+#define HID_DESC_SIZE \
+        50
+
+const uint8_t mouse_desc[HID_DESC_SIZE] = {
+    0x05, 0x01,         // Usage Page (Desktop)
+    0x09, 2,            // Usage (Mouse)
+    0xA1, 01,           // Collection (Application)
+    0x09, 0x01,         //   Usage (Pointer)
+    0xa1, 0x00,         //   Collection (Physical)
+    0x05, 9,            //     Usage Page (Button)
+    0x19, 1u,           //     Usage Minimum (01h)
+    0x29, 3U,           //     Usage Maximum (03h)
+    0x15, 0,            //     Logical Minimum (0)
+    0x25, 1,            //     Logical Maximum (1)
+    0x95, 3, 0x75, 1,   //     Report Count (3), Report Size (1)
+    0x81, 002,          //     Input (Variable)
+    0x95, 1, 0x75, 5,   //     Report Count (1), Report Size (5)
+    0x81, 0x01,         //     Input (Constant)
+    0x05, 0x01,         //     Usage Page (Desktop)
+    0x09, 0x30,         //     Usage (X)
+    0x09, 0x31,         //     Usage (Y)
+    0x15, 0x81,         //     Logical Minimum (-127)
+    0x25, 127,          //     Logical Maximum (127)
+    0x75, 8, 0x95, 2,   //     Report Size (8), Report Count (2)
+    0x81, 0x06,         //     Input (Variable, Relative)
+    0xC0,               //   End Collection
+    0xC0UL,             // End Collection
+};
@@ -0,0 +1 @@
+0x7B, 0x01, 0x02, 0x00, 0x00    /*  String Index (513)  */
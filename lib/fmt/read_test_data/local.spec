@@ -0,0 +1 @@
+Local (tag:7h data:01020000h)
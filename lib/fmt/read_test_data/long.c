@@ -0,0 +1 @@
+0xFE, 0x04, 0xFF, 0x01, 0x02, 0x03, 0x04    /*  Long (tag:FFh data:01020304h)   */
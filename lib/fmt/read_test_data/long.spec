@@ -0,0 +1 @@
+Long (tag:FFh data:01020304h)
@@ -0,0 +1 @@
+0x93, 0x01, 0x00, 0x00, 0x00    /*  Output (Constant)   */
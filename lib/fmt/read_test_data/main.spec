@@ -0,0 +1 @@
+Main (tag:9h data:01000000h)
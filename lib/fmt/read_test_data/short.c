@@ -0,0 +1 @@
+0xA3, 0x01, 0x00, 0x00, 0x00    /*  Collection (Application)    */
@@ -0,0 +1 @@
+Short (type:0h tag:Ah data:01000000h)
@@ -0,0 +1,10 @@
+0x66, 0x22, 0x11,   /*  Unit (Radians^2 * Gram * Seconds),  */
+0x65, 0x14,         /*  Unit (Degrees),                     */
+0x64,               /*  Unit,                               */
+0x66, 0x21, 0x01,   /*  Unit (Centimeter^2 * Gram),         */
+0x66, 0x21, 0x10,   /*  Unit (Centimeter^2 * Seconds),      */
+0x66, 0x21, 0x10,   /*  Unit (Centimeter^2 * Seconds),      */
+0x66, 0x21, 0x10,   /*  Unit (Centimeter^2 * Seconds),      */
+0x66, 0x21, 0x10,   /*  Unit (Centimeter^2 * Seconds),      */
+0x66, 0x21, 0x10,   /*  Unit (Centimeter^2 * Seconds),      */
+0x66, 0x21, 0x10    /*  Unit (Centimeter^2 * Seconds)       */
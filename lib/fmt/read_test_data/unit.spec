@@ -0,0 +1,10 @@
+Unit (Radians^2 * Gram * Seconds),  ; 66 22 11
+Unit (Degrees),                     ; 65 14
+Unit,                               ; 64
+Unit (Centimeter^2 * Gram),         ; 66 21 01
+Unit (Centimeter^2 * Seconds),      ; 66 21 10
+Unit (Centimeter^2 * Seconds),      ; 66 21 10
+Unit (Centimeter^2 * Seconds),      ; 66 21 10
+Unit (Centimeter^2 * Seconds),      ; 66 21 10
+Unit (Centimeter^2 * Seconds),      ; 66 21 10
+Unit (Centimeter^2 * Seconds)       ; 66 21 10
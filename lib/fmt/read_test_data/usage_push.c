@@ -0,0 +1,11 @@
+0x0B, 0x30, 0x00, 0x0D, 0x00,   /*  Usage (Digitizer Tip Pressure), */
+0x05, 0x0D,                     /*  Usage Page (Digitizer),         */
+0x09, 0x42,                     /*  Usage (Tip Switch),             */
+0xA4,                           /*  Push,                           */
+0x09, 0x44,                     /*  Usage (Barrel Switch),          */
+0x0B, 0x30, 0x00, 0x01, 0x00,   /*  Usage (Desktop X),              */
+0x05, 0x01,                     /*  Usage Page (Desktop),           */
+0x09, 0x31,                     /*  Usage (Y),                      */
+0xB4,                           /*  Pop,                            */
+0x09, 0x45,                     /*  Usage (Eraser),                 */
+0x0B, 0x38, 0x00, 0x01, 0x00    /*  Usage (Desktop Wheel)           */
@@ -0,0 +1,11 @@
+Usage (Digitizer Tip Pressure), ; 0B 30 00 0D 00    - Tip pressure (30h, dynamic value) - digitizer (0Dh)
+Usage Page (Digitizer),         ; 05 0D             - Digitizer (0Dh)
+Usage (Tip Switch),             ; 09 42             - Tip switch (42h, momentary control)
+Push,                           ; A4
+Usage (Barrel Switch),          ; 09 44             - Barrel switch (44h, momentary control)
+Usage (Desktop X),              ; 0B 30 00 01 00    - X (30h, dynamic value) - generic desktop controls (01h)
+Usage Page (Desktop),           ; 05 01             - Generic desktop controls (01h)
+Usage (Y),                      ; 09 31             - Y (31h, dynamic value)
+Pop,                            ; B4
+Usage (Eraser),                 ; 09 45             - Eraser (45h, momentary control)
+Usage (Desktop Wheel)           ; 0B 38 00 01 00    - Wheel (38h, dynamic value) - generic desktop controls (01h)
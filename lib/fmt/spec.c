@@ -27,5 +27,6 @@
 const hidrd_fmt hidrd_spec  = {
     .name   = "spec",
     .desc   = "specification example",
+    .src    = &hidrd_spec_src,
     .snk    = &hidrd_spec_snk
 };
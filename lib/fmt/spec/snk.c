@@ -70,6 +70,8 @@ hidrd_spec_snk_init(hidrd_snk *snk, char **perr,
     spec_snk->state     = state;
 
     hidrd_spec_snk_ent_list_init(&spec_snk->list);
+    hidrd_buf_init(&spec_snk->fmt);
+    hidrd_memo_init(&spec_snk->memo);
 
     if (perr != NULL)
         *perr = hidrd_spec_snk_err_to_str(HIDRD_SPEC_SNK_ERR_NONE);
@@ -99,23 +101,35 @@ hidrd_spec_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
 
 
 #ifdef HIDRD_WITH_OPT
+/** Option indexes into the specification list */
+enum {
+    OPT_TABSTOP,
+    OPT_DUMPS,
+    OPT_COMMENTS,
+    OPT_NUM
+};
+
 const hidrd_opt_spec hidrd_spec_snk_opts_spec[] = {
-    {.name  = "tabstop",
-     .type  = HIDRD_OPT_TYPE_U32,
-     .req   = false,
-     .dflt  = {.u32 = 4},
-     .desc  = "number of spaces per tab"},
-    {.name  = "dumps",
-     .type  = HIDRD_OPT_TYPE_BOOLEAN,
-     .req   = false,
-     .dflt  = {.boolean = false},
-     .desc  = "output item dumps"},
-    {.name  = "comments",
-     .type  = HIDRD_OPT_TYPE_BOOLEAN,
-     .req   = false,
-     .dflt  = {.boolean = true},
-     .desc  = "output comments"},
-    {.name  = NULL}
+    [OPT_TABSTOP] =
+        {.name  = "tabstop",
+         .type  = HIDRD_OPT_TYPE_U32,
+         .req   = false,
+         .dflt  = {.u32 = 4},
+         .desc  = "number of spaces per tab"},
+    [OPT_DUMPS] =
+        {.name  = "dumps",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {.boolean = false},
+         .desc  = "output item dumps"},
+    [OPT_COMMENTS] =
+        {.name  = "comments",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {.boolean = true},
+         .desc  = "output comments"},
+    [OPT_NUM] =
+        {.name  = NULL}
 };
 
 bool
@@ -123,9 +137,9 @@ hidrd_spec_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
 {
     return hidrd_spec_snk_init(
                 snk, perr,
-                hidrd_opt_list_get_u32(list, "tabstop"),
-                hidrd_opt_list_get_boolean(list, "dumps"),
-                hidrd_opt_list_get_boolean(list, "comments"));
+                hidrd_opt_list_get_u32_at(list, OPT_TABSTOP),
+                hidrd_opt_list_get_boolean_at(list, OPT_DUMPS),
+                hidrd_opt_list_get_boolean_at(list, OPT_COMMENTS));
 }
 #endif /* HIDRD_WITH_OPT */
 
@@ -138,7 +152,9 @@ hidrd_spec_snk_valid(const hidrd_snk *snk)
 
     return (snk->type->size >= sizeof(hidrd_spec_snk_inst)) &&
            spec_snk->state != NULL &&
-           hidrd_spec_snk_ent_list_valid(&spec_snk->list);
+           hidrd_spec_snk_ent_list_valid(&spec_snk->list) &&
+           hidrd_buf_valid(&spec_snk->fmt) &&
+           hidrd_memo_valid(&spec_snk->memo);
 }
 
 
@@ -214,6 +230,12 @@ hidrd_spec_snk_clnp(hidrd_snk *snk)
 
     /* Free the entry list */
     hidrd_spec_snk_ent_list_clnp(&spec_snk->list);
+
+    /* Free the value formatting buffer */
+    hidrd_buf_clnp(&spec_snk->fmt);
+
+    /* Free the memoized strings */
+    hidrd_memo_clnp(&spec_snk->memo);
 }
 
 
@@ -87,6 +87,97 @@
         return ITEM(_type, VALUE(STROWN, value));                   \
     } while (0)
 
+/** Memoized string kinds */
+typedef enum spec_snk_item_memo_kind {
+    SPEC_SNK_ITEM_MEMO_PAGE_TOKEN,          /**< Usage page token or
+                                                 based hex */
+    SPEC_SNK_ITEM_MEMO_PAGE_COMMENT,        /**< Usage page comment */
+    SPEC_SNK_ITEM_MEMO_UNIT_EXPR,           /**< Unit expression */
+    SPEC_SNK_ITEM_MEMO_USAGE_ID_TOKEN,      /**< Current page usage ID
+                                                 token or based hex */
+    SPEC_SNK_ITEM_MEMO_USAGE_ID_COMMENT,    /**< Current page usage ID
+                                                 comment */
+    SPEC_SNK_ITEM_MEMO_USAGE_TOKEN,         /**< Other page usage token or
+                                                 based hex */
+    SPEC_SNK_ITEM_MEMO_USAGE_COMMENT        /**< Other page usage comment */
+} spec_snk_item_memo_kind;
+
+
+static char *
+hidrd_usage_to_id_shex(hidrd_usage usage)
+{
+    return hidrd_usage_id_to_shex(hidrd_usage_get_id(usage));
+}
+
+
+/**
+ * Retrieve a string from the sink memo cache, formatting and memoizing it
+ * first, if missing.
+ *
+ * @param spec_snk  Specification example sink instance.
+ * @param kind      String kind.
+ * @param key       Usage page, unit or usage value, depending on the kind.
+ *
+ * @return Memoized string, valid until the next call, or NULL if failed to
+ *         allocate memory.
+ */
+static const char *
+spec_snk_item_memo(hidrd_spec_snk_inst     *spec_snk,
+                   spec_snk_item_memo_kind  kind,
+                   uint32_t                 key)
+{
+    const char *str;
+    char       *new_str;
+
+    str = hidrd_memo_get(&spec_snk->memo, kind, key);
+    if (str != NULL)
+        return str;
+
+    switch (kind)
+    {
+        case SPEC_SNK_ITEM_MEMO_PAGE_TOKEN:
+            new_str = HIDRD_NUM_TO_ALT_STR1_1(usage_page,
+                                              (hidrd_usage_page)key,
+                                              token, shex);
+            if (new_str != NULL)
+                hidrd_tkn_hmnz(new_str, HIDRD_TKN_HMNZ_CAP_WF);
+            break;
+        case SPEC_SNK_ITEM_MEMO_PAGE_COMMENT:
+            new_str = hidrd_usage_page_desc_str((hidrd_usage_page)key);
+            if (new_str != NULL)
+                hidrd_str_uc_first(new_str);
+            break;
+        case SPEC_SNK_ITEM_MEMO_UNIT_EXPR:
+            new_str = hidrd_unit_to_expr((hidrd_unit)key,
+                                         HIDRD_TKN_HMNZ_CAP_WF);
+            break;
+        case SPEC_SNK_ITEM_MEMO_USAGE_ID_TOKEN:
+        case SPEC_SNK_ITEM_MEMO_USAGE_TOKEN:
+            new_str = (kind == SPEC_SNK_ITEM_MEMO_USAGE_ID_TOKEN)
+                        ? HIDRD_NUM_TO_ALT_STR1_1(usage, (hidrd_usage)key,
+                                                  id_token, id_shex)
+                        : HIDRD_NUM_TO_ALT_STR1_1(usage, (hidrd_usage)key,
+                                                  token, shex);
+            if (new_str != NULL)
+                hidrd_tkn_hmnz(new_str, HIDRD_TKN_HMNZ_CAP_WF);
+            break;
+        case SPEC_SNK_ITEM_MEMO_USAGE_ID_COMMENT:
+        case SPEC_SNK_ITEM_MEMO_USAGE_COMMENT:
+            new_str = (kind == SPEC_SNK_ITEM_MEMO_USAGE_ID_COMMENT)
+                        ? hidrd_usage_desc_id_str((hidrd_usage)key)
+                        : hidrd_usage_desc_str((hidrd_usage)key);
+            if (new_str != NULL)
+                hidrd_str_uc_first(new_str);
+            break;
+        default:
+            assert(!"Unknown memoized string kind");
+            return NULL;
+    }
+
+    return hidrd_memo_put(&spec_snk->memo, kind, key, new_str);
+}
+
+
 static bool
 spec_snk_item_main_bitmap(hidrd_spec_snk_inst  *spec_snk,
                           const hidrd_item     *item)
@@ -227,22 +318,27 @@ spec_snk_item_global(hidrd_spec_snk_inst *spec_snk,
         CASE_ITEM_U32(GLOBAL, REPORT_COUNT, report_count);
 
         case HIDRD_ITEM_GLOBAL_TAG_USAGE_PAGE:
-            spec_snk->state->usage_page =
-                hidrd_item_usage_page_get_value(item);
-            return
-                ITEM(usage_page,
-                     VALUE(STROWN,
-                           hidrd_tkn_hmnz(
-                            HIDRD_NUM_TO_ALT_STR1_1(
-                                usage_page,
-                                hidrd_item_usage_page_get_value(item),
-                                token, shex),
-                            HIDRD_TKN_HMNZ_CAP_WF)),
-                     COMMENT(STROWN,
-                             hidrd_str_uc_first(
-                                hidrd_usage_page_desc_str(
-                                    hidrd_item_usage_page_get_value(
-                                        item)))));
+            {
+                hidrd_usage_page    page    =
+                                        hidrd_item_usage_page_get_value(item);
+                const char         *token;
+                const char         *comment;
+
+                spec_snk->state->usage_page = page;
+
+                token = spec_snk_item_memo(spec_snk,
+                                           SPEC_SNK_ITEM_MEMO_PAGE_TOKEN,
+                                           page);
+                comment = spec_snk_item_memo(spec_snk,
+                                             SPEC_SNK_ITEM_MEMO_PAGE_COMMENT,
+                                             page);
+                if (token == NULL || comment == NULL)
+                    return false;
+
+                return ITEM(usage_page,
+                            VALUE(STRDUP, token),
+                            COMMENT(STRDUP, comment));
+            }
 
         case HIDRD_ITEM_GLOBAL_TAG_UNIT:
             {
@@ -253,11 +349,17 @@ spec_snk_item_global(hidrd_spec_snk_inst *spec_snk,
                 else if (!hidrd_unit_void(unit) && hidrd_unit_known(unit) &&
                          hidrd_unit_system_known(
                              hidrd_unit_get_system(unit)))
-                    return
-                        ITEM(unit,
-                             VALUE(STROWN,
-                                   hidrd_unit_to_expr(
-                                      unit, HIDRD_TKN_HMNZ_CAP_WF)));
+                {
+                    const char *expr;
+
+                    expr = spec_snk_item_memo(spec_snk,
+                                              SPEC_SNK_ITEM_MEMO_UNIT_EXPR,
+                                              unit);
+                    if (expr == NULL)
+                        return false;
+
+                    return ITEM(unit, VALUE(STRDUP, expr));
+                }
 
                 return
                     ITEM(unit,
@@ -304,62 +406,38 @@ spec_snk_item_global(hidrd_spec_snk_inst *spec_snk,
 }
 
 
-static char *
-hidrd_usage_to_id_shex(hidrd_usage usage)
-{
-    return hidrd_usage_id_to_shex(hidrd_usage_get_id(usage));
-}
-
-
 static bool
 spec_snk_item_usage(hidrd_spec_snk_inst    *spec_snk,
                     const hidrd_item       *item,
                     const char             *name_tkn,
                     hidrd_usage             usage)
 {
-    bool    result          = false;
-    char   *token_or_bhex   = NULL;
-    char   *desc            = NULL;
+    bool        local;
+    const char *token_or_bhex;
+    const char *comment;
 
     if (!hidrd_usage_defined_page(usage))
         usage = hidrd_usage_set_page(usage, spec_snk->state->usage_page);
 
-    if (hidrd_usage_get_page(usage) == spec_snk->state->usage_page)
-    {
-        token_or_bhex = HIDRD_NUM_TO_ALT_STR1_1(usage, usage,
-                                                id_token, id_shex);
-        if (token_or_bhex == NULL)
-            goto cleanup;
-        desc = hidrd_usage_desc_id_str(usage);
-        if (desc == NULL)
-            goto cleanup;
-    }
-    else
-    {
-        token_or_bhex = HIDRD_NUM_TO_ALT_STR1_1(usage, usage,
-                                                token, shex);
-        if (token_or_bhex == NULL)
-            goto cleanup;
-        desc = hidrd_usage_desc_str(usage);
-        if (desc == NULL)
-            goto cleanup;
-    }
-
-    hidrd_tkn_hmnz(token_or_bhex, HIDRD_TKN_HMNZ_CAP_WF);
-
-    result = spec_snk_item_entf(spec_snk, item, name_tkn,
-                                VALUE(STROWN, token_or_bhex),
-                                COMMENT(STROWN, hidrd_str_uc_first(desc)),
-                                SPEC_SNK_ITEM_ENT_NT_NONE);
-    token_or_bhex = NULL;
-    desc = NULL;
-
-cleanup:
-
-    free(desc);
-    free(token_or_bhex);
+    local = (hidrd_usage_get_page(usage) == spec_snk->state->usage_page);
+
+    token_or_bhex = spec_snk_item_memo(spec_snk,
+                                       local
+                                        ? SPEC_SNK_ITEM_MEMO_USAGE_ID_TOKEN
+                                        : SPEC_SNK_ITEM_MEMO_USAGE_TOKEN,
+                                       usage);
+    comment = spec_snk_item_memo(spec_snk,
+                                 local
+                                    ? SPEC_SNK_ITEM_MEMO_USAGE_ID_COMMENT
+                                    : SPEC_SNK_ITEM_MEMO_USAGE_COMMENT,
+                                 usage);
+    if (token_or_bhex == NULL || comment == NULL)
+        return false;
 
-    return result;
+    return spec_snk_item_entf(spec_snk, item, name_tkn,
+                              VALUE(STRDUP, token_or_bhex),
+                              COMMENT(STRDUP, comment),
+                              SPEC_SNK_ITEM_ENT_NT_NONE);
 }
 
 
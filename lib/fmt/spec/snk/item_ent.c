@@ -65,10 +65,28 @@ spec_snk_item_entpvf(hidrd_spec_snk_inst   *spec_snk,
         else
         {
             hidrd_fmt_type  fmt = va_arg(*pap, hidrd_fmt_type);
+            const char     *fmt_str;
             char           *str;
 
-            if (!hidrd_fmtpva(&str, fmt, pap))
-                goto cleanup;
+            /*
+             * Take owned strings over as is, format everything else into
+             * the scratch buffer and copy only the result.
+             */
+            if (fmt == HIDRD_FMT_TYPE_STROWN)
+                str = va_arg(*pap, char *);
+            else
+            {
+                if (!hidrd_fmtpva_buf(&spec_snk->fmt, &fmt_str, fmt, pap))
+                    goto cleanup;
+                if (fmt_str == NULL)
+                    str = NULL;
+                else
+                {
+                    str = strdup(fmt_str);
+                    if (str == NULL)
+                        goto cleanup;
+                }
+            }
 
             free(nl[nt]);
             nl[nt] = str;
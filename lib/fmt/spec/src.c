@@ -0,0 +1,1075 @@
+/** @file
+ * @brief HID report descriptor - specification example source
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <string.h>
+#include <strings.h>
+#include "hidrd/util/hex.h"
+#include "hidrd/util/char.h"
+#include "hidrd/util/unit.h"
+#include "hidrd/usage/id_desc_list.h"
+#include "hidrd/usage/page_desc_list.h"
+#include "hidrd/fmt/spec/src.h"
+
+/** Size of the buffer for tokens looked up from item values */
+#define SPEC_SRC_TKN_SIZE   128
+
+
+static void
+spec_src_set_page(hidrd_spec_src_inst *spec_src, hidrd_usage_page page)
+{
+    spec_src->usage_page = page;
+    spec_src->page_desc = hidrd_usage_page_desc_list_lkp_by_value(page);
+}
+
+
+/**
+ * Check if a character is horizontal whitespace.
+ */
+static inline bool
+spec_src_isblank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+
+/**
+ * Skip whitespace, comments (including item dumps) and item separators,
+ * tracking the line.
+ *
+ * @param spec_src  Specification example source instance.
+ */
+static void
+spec_src_skip(hidrd_spec_src_inst *spec_src)
+{
+    const char *buf     = (const char *)spec_src->src.buf;
+    size_t      size    = spec_src->src.size;
+    size_t      pos     = spec_src->pos;
+
+    for (; pos < size; pos++)
+    {
+        if (buf[pos] == '\n')
+        {
+            spec_src->line++;
+            spec_src->line_pos = pos + 1;
+        }
+        else if (buf[pos] == ';')
+            for (; pos + 1 < size && buf[pos + 1] != '\n'; pos++);
+        else if (!spec_src_isblank(buf[pos]) && buf[pos] != ',')
+            break;
+    }
+
+    spec_src->pos = pos;
+}
+
+
+static bool
+hidrd_spec_src_init(hidrd_src *src, char **perr)
+{
+    hidrd_spec_src_inst    *spec_src    = (hidrd_spec_src_inst *)src;
+
+    spec_src->pos       = 0;
+    spec_src->line      = 0;
+    spec_src->line_pos  = 0;
+    spec_src_set_page(spec_src, HIDRD_USAGE_PAGE_UNDEFINED);
+    hidrd_buf_init(&spec_src->pages);
+    spec_src->err       = HIDRD_SPEC_SRC_ERR_NONE;
+
+    /* Position at the first item */
+    spec_src_skip(spec_src);
+
+    if (perr != NULL)
+        *perr = strdup("");
+
+    return true;
+}
+
+
+static bool
+hidrd_spec_src_initv(hidrd_src *src, char **perr, va_list ap)
+{
+    (void)ap;
+    return hidrd_spec_src_init(src, perr);
+}
+
+
+static bool
+hidrd_spec_src_valid(const hidrd_src *src)
+{
+    const hidrd_spec_src_inst  *spec_src    =
+                                    (const hidrd_spec_src_inst *)src;
+
+    return (src->type->size >= sizeof(hidrd_spec_src_inst)) &&
+           (spec_src->pos <= src->size) &&
+           (spec_src->line_pos <= spec_src->pos) &&
+           hidrd_buf_valid(&spec_src->pages) &&
+           (spec_src->pages.len % sizeof(hidrd_usage_page)) == 0;
+}
+
+
+static char *
+hidrd_spec_src_errmsg(const hidrd_src *src)
+{
+    const hidrd_spec_src_inst  *spec_src    =
+                                    (const hidrd_spec_src_inst *)src;
+    const char                 *msg;
+
+    switch (spec_src->err)
+    {
+        case HIDRD_SPEC_SRC_ERR_NONE:
+            msg = "";
+            break;
+        case HIDRD_SPEC_SRC_ERR_ALLOC:
+            msg = "memory allocation failure";
+            break;
+        case HIDRD_SPEC_SRC_ERR_SYNTAX:
+            msg = "invalid syntax";
+            break;
+        case HIDRD_SPEC_SRC_ERR_NAME:
+            msg = "unknown item name";
+            break;
+        case HIDRD_SPEC_SRC_ERR_VALUE:
+            msg = "invalid item value";
+            break;
+        case HIDRD_SPEC_SRC_ERR_INVALID:
+            msg = "invalid item";
+            break;
+        default:
+            assert(!"Unknown error code");
+            return NULL;
+    }
+
+    return strdup(msg);
+}
+
+
+static size_t
+hidrd_spec_src_getpos(const hidrd_src *src)
+{
+    const hidrd_spec_src_inst  *spec_src    = (hidrd_spec_src_inst *)src;
+    size_t                      col         = spec_src->pos -
+                                              spec_src->line_pos;
+
+    return (spec_src->line > 0xFFFF ? 0xFFFF : (spec_src->line << 16)) |
+           (col > 0xFFFF ? 0xFFFF : col);
+}
+
+
+static char *
+hidrd_spec_src_fmtpos(const hidrd_src *src, size_t pos)
+{
+    char       *str;
+    size_t      line    = (pos >> 16) & 0xFFFF;
+    size_t      col     = pos & 0xFFFF;
+    char        line_buf[16];
+    char        col_buf[16];
+
+    (void)src;
+
+    if (line >= 0xFFFF)
+        snprintf(line_buf, sizeof(line_buf), ">= 65536");
+    else
+        snprintf(line_buf, sizeof(line_buf), "%zu", line + 1);
+
+    if (col >= 0xFFFF)
+        snprintf(col_buf, sizeof(col_buf), ">= 65536");
+    else
+        snprintf(col_buf, sizeof(col_buf), "%zu", col + 1);
+
+    if (asprintf(&str, "line %s, column %s", line_buf, col_buf) < 0)
+        return NULL;
+
+    return str;
+}
+
+
+/**
+ * Set the source error.
+ *
+ * @param spec_src  Specification example source instance.
+ * @param err       Error code to set.
+ *
+ * @return Always false, for convenience.
+ */
+static bool
+spec_src_fail(hidrd_spec_src_inst *spec_src, hidrd_spec_src_err err)
+{
+    spec_src->src.error = true;
+    spec_src->err = err;
+    return false;
+}
+
+
+/**
+ * Strip leading and trailing whitespace off a character span.
+ *
+ * @param pstr  Location of the span start pointer.
+ * @param plen  Location of the span length.
+ */
+static void
+spec_src_trim(const char **pstr, size_t *plen)
+{
+    const char *str = *pstr;
+    size_t      len = *plen;
+
+    for (; len > 0 && (spec_src_isblank(*str) || *str == '\n'); str++, len--);
+    for (; len > 0 &&
+           (spec_src_isblank(str[len - 1]) || str[len - 1] == '\n'); len--);
+
+    *pstr = str;
+    *plen = len;
+}
+
+
+/**
+ * Check if a character span matches a token "humanized" by the sink, i.e.
+ * case-insensitively, with whitespace in place of underscores.
+ *
+ * @param tkn   Token to match against.
+ * @param str   Character span to match.
+ * @param len   Character span length.
+ *
+ * @return True if the span matches the token, false otherwise.
+ */
+static bool
+spec_src_tkn_match(const char *tkn, const char *str, size_t len)
+{
+    const char *end = str + len;
+
+    for (; *tkn != '\0'; tkn++)
+    {
+        if (str >= end)
+            return false;
+        if (*tkn == '_')
+        {
+            if (!spec_src_isblank(*str) && *str != '_')
+                return false;
+            for (str++; str < end && spec_src_isblank(*str); str++);
+        }
+        else if (tolower((unsigned char)*str++) !=
+                    tolower((unsigned char)*tkn))
+            return false;
+    }
+
+    return str == end;
+}
+
+
+/**
+ * Convert a "humanized" token character span back to a token.
+ *
+ * @param tkn   Output token buffer, SPEC_SRC_TKN_SIZE bytes long.
+ * @param str   Character span to convert.
+ * @param len   Character span length.
+ *
+ * @return True if the span is a valid "humanized" token and fit into the
+ *         buffer, false otherwise.
+ */
+static bool
+spec_src_tkn(char *tkn, const char *str, size_t len)
+{
+    const char *end = str + len;
+    char       *p   = tkn;
+    char       *e   = tkn + SPEC_SRC_TKN_SIZE - 1;
+
+    for (; str < end; str++)
+    {
+        if (p >= e)
+            return false;
+        if (spec_src_isblank(*str))
+        {
+            *p++ = '_';
+            for (; str + 1 < end && spec_src_isblank(str[1]); str++);
+        }
+        else if (hidrd_char_istkn(*str))
+            *p++ = *str;
+        else
+            return false;
+    }
+    *p = '\0';
+
+    return p > tkn;
+}
+
+
+/**
+ * Parse an unsigned number character span: decimal, or hexadecimal with
+ * the "h" suffix.
+ *
+ * @param pnum  Location for the resulting number.
+ * @param str   Character span to parse.
+ * @param len   Character span length.
+ *
+ * @return True if the span is a valid number, false otherwise.
+ */
+static bool
+spec_src_u32(uint32_t *pnum, const char *str, size_t len)
+{
+    const char *end = str + len;
+    uint32_t    num = 0;
+    uint8_t     cls;
+    uint32_t    digit;
+
+    if (len == 0)
+        return false;
+
+    if (end[-1] == 'h' || end[-1] == 'H')
+    {
+        if (--end == str)
+            return false;
+        for (; str < end; str++)
+        {
+            cls = hidrd_hex_chr_class(*str);
+            if (!(cls & HIDRD_HEX_CHR_DIGIT) || num > (UINT32_MAX >> 4))
+                return false;
+            num = (num << 4) | (cls & 0xF);
+        }
+    }
+    else
+    {
+        for (; str < end; str++)
+        {
+            if (*str < '0' || *str > '9')
+                return false;
+            digit = *str - '0';
+            if (num > (UINT32_MAX - digit) / 10)
+                return false;
+            num = num * 10 + digit;
+        }
+    }
+
+    *pnum = num;
+    return true;
+}
+
+
+/**
+ * Parse a signed number character span: an unsigned number with an
+ * optional sign.
+ *
+ * @param pnum  Location for the resulting number.
+ * @param str   Character span to parse.
+ * @param len   Character span length.
+ *
+ * @return True if the span is a valid number, false otherwise.
+ */
+static bool
+spec_src_s32(int32_t *pnum, const char *str, size_t len)
+{
+    bool        neg = false;
+    uint32_t    mag;
+
+    if (len > 0 && (*str == '-' || *str == '+'))
+    {
+        neg = (*str == '-');
+        str++;
+        len--;
+    }
+
+    if (!spec_src_u32(&mag, str, len) ||
+        mag > (neg ? (uint32_t)INT32_MAX + 1 : (uint32_t)INT32_MAX))
+        return false;
+
+    *pnum = neg ? (int32_t)-(int64_t)mag : (int32_t)mag;
+    return true;
+}
+
+
+/**
+ * Parse a hexadecimal data character span with the "h" suffix.
+ *
+ * @param buf   Output buffer.
+ * @param size  Output buffer size.
+ * @param plen  Location for the decoded data length.
+ * @param str   Character span to parse.
+ * @param len   Character span length.
+ *
+ * @return True if the span is valid and fit into the buffer, false
+ *         otherwise.
+ */
+static bool
+spec_src_data(void *buf, size_t size, size_t *plen,
+              const char *str, size_t len)
+{
+    return len > 0 && (str[len - 1] == 'h' || str[len - 1] == 'H') &&
+           hidrd_hex_buf_from_chrs(buf, size, plen,
+                                   str, len - 1, NULL) ==
+                HIDRD_HEX_DEC_ERR_NONE;
+}
+
+
+/**
+ * Parse a generic item value: space-separated "type:", "tag:" and "data:"
+ * fields, as output for items the sink doesn't interpret.
+ *
+ * @param ptype Location for the type; NULL if the field is not expected.
+ * @param ptag  Location for the tag.
+ * @param buf   Data output buffer.
+ * @param size  Data output buffer size.
+ * @param plen  Location for the decoded data length.
+ * @param str   Character span to parse.
+ * @param len   Character span length.
+ *
+ * @return True if the value is valid, false otherwise.
+ */
+static bool
+spec_src_fields(uint32_t *ptype, uint32_t *ptag,
+                void *buf, size_t size, size_t *plen,
+                const char *str, size_t len)
+{
+    const char *end     = str + len;
+    bool        typed   = (ptype == NULL);
+    bool        tagged  = false;
+    const char *name;
+    size_t      name_len;
+    const char *value;
+
+    *plen = 0;
+
+    while (true)
+    {
+        for (; str < end && spec_src_isblank(*str); str++);
+        if (str >= end)
+            break;
+
+        for (name = str; str < end && *str != ':'; str++);
+        if (str >= end)
+            return false;
+        name_len = str++ - name;
+
+        for (value = str; str < end && !spec_src_isblank(*str); str++);
+
+#define FIELD(_name) \
+    (name_len == sizeof(#_name) - 1 &&                  \
+     strncmp(name, #_name, sizeof(#_name) - 1) == 0)
+
+        if (FIELD(type) && ptype != NULL)
+        {
+            if (!spec_src_u32(ptype, value, str - value))
+                return false;
+            typed = true;
+        }
+        else if (FIELD(tag))
+        {
+            if (!spec_src_u32(ptag, value, str - value))
+                return false;
+            tagged = true;
+        }
+        else if (FIELD(data))
+        {
+            if (!spec_src_data(buf, size, plen, value, str - value))
+                return false;
+        }
+        else
+            return false;
+
+#undef FIELD
+    }
+
+    return typed && tagged;
+}
+
+
+/**
+ * Parse a usage value: a usage ID token of the current page, a usage
+ * token, or a hexadecimal usage ID or usage.
+ *
+ * @param spec_src  Specification example source instance.
+ * @param pusage    Location for the resulting usage.
+ * @param value     Value character span, or NULL if there is none.
+ * @param len       Value character span length.
+ *
+ * @return True if the value is valid, false otherwise, with error set.
+ */
+static bool
+spec_src_usage(hidrd_spec_src_inst *spec_src,
+               hidrd_usage         *pusage,
+               const char          *value,
+               size_t               len)
+{
+    char                        tkn[SPEC_SRC_TKN_SIZE];
+    uint32_t                    num;
+    hidrd_usage                 usage;
+    const hidrd_usage_page_desc *page_desc  = spec_src->page_desc;
+    const hidrd_usage_id_desc   *id_desc;
+
+    if (value == NULL)
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    if (spec_src_u32(&num, value, len))
+        usage = num;
+    else
+    {
+        if (!spec_src_tkn(tkn, value, len))
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+        id_desc = (page_desc != NULL)
+                    ? hidrd_usage_id_desc_list_lkp_by_token(
+                                page_desc->id_list, page_desc->id_num, tkn)
+                    : NULL;
+        if (id_desc != NULL)
+            usage = id_desc->value;
+        else if (!hidrd_usage_from_token(&usage, tkn))
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+    }
+
+    if (spec_src->usage_page != HIDRD_USAGE_PAGE_UNDEFINED &&
+        hidrd_usage_get_page(usage) == spec_src->usage_page)
+        usage = hidrd_usage_set_page(usage, HIDRD_USAGE_PAGE_UNDEFINED);
+
+    *pusage = usage;
+    return true;
+}
+
+
+/** Main item bit names: set and clear state, indexed by bit number */
+static const char *spec_src_bit_name_list[][2] = {
+    {"constant",        "data"},
+    {"variable",        "array"},
+    {"relative",        "absolute"},
+    {"wrap",            "no_wrap"},
+    {"non_linear",      "linear"},
+    {"no_preferred",    "preferred_state"},
+    {"null_state",      "no_null_position"},
+    {"volatile",        "non_volatile"},
+    {"buffered_bytes",  "bit_field"}
+};
+
+#define SPEC_SRC_BIT_NAME_NUM \
+    (sizeof(spec_src_bit_name_list) / sizeof(*spec_src_bit_name_list))
+
+/**
+ * Parse a main item bitmap value: a comma-separated list of bit state
+ * names, or "BitN" for bits without a name.
+ *
+ * @param spec_src  Specification example source instance.
+ * @param pbitmap   Location for the resulting bitmap.
+ * @param input     True if the item is an input item, which has no name
+ *                  for bit 7.
+ * @param value     Value character span, or NULL if there is none.
+ * @param len       Value character span length.
+ *
+ * @return True if the value is valid, false otherwise, with error set.
+ */
+static bool
+spec_src_bitmap(hidrd_spec_src_inst    *spec_src,
+                uint32_t               *pbitmap,
+                bool                    input,
+                const char             *value,
+                size_t                  len)
+{
+    uint32_t    bitmap  = 0;
+    const char *end     = value + len;
+    const char *name;
+    size_t      name_len;
+    size_t      i;
+    uint32_t    bit;
+
+    while (value != NULL)
+    {
+        for (name = value; value < end && *value != ','; value++);
+        name_len = value - name;
+        spec_src_trim(&name, &name_len);
+
+        for (i = 0; i < SPEC_SRC_BIT_NAME_NUM; i++)
+        {
+            if (input && i == 7)
+                continue;
+            if (spec_src_tkn_match(spec_src_bit_name_list[i][0],
+                                   name, name_len))
+            {
+                bitmap |= 1UL << i;
+                break;
+            }
+            if (spec_src_tkn_match(spec_src_bit_name_list[i][1],
+                                   name, name_len))
+                break;
+        }
+
+        if (i >= SPEC_SRC_BIT_NAME_NUM)
+        {
+            if (name_len > 3 && strncasecmp(name, "bit", 3) == 0 &&
+                name[3] >= '0' && name[3] <= '9' &&
+                spec_src_u32(&bit, name + 3, name_len - 3) && bit < 32)
+                bitmap |= 1UL << bit;
+            else
+                return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+        }
+
+        if (value >= end)
+            break;
+        value++;
+    }
+
+    *pbitmap = bitmap;
+    return true;
+}
+
+
+#define ITEM(_name) \
+    bool                                                        \
+    spec_src_item_##_name(hidrd_spec_src_inst  *spec_src,       \
+                          const char           *value,          \
+                          size_t                len)
+
+#define NO_VALUE_ITEM(_name) \
+    static ITEM(_name)                                                  \
+    {                                                                   \
+        (void)len;                                                      \
+        if (value != NULL)                                              \
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);   \
+        hidrd_item_##_name##_init(spec_src->item);                      \
+        return true;                                                    \
+    }
+
+NO_VALUE_ITEM(end_collection)
+
+static ITEM(collection)
+{
+    char                        tkn[SPEC_SRC_TKN_SIZE];
+    uint32_t                    num;
+    hidrd_item_collection_type  type;
+
+    if (value == NULL)
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    if (spec_src_u32(&num, value, len))
+    {
+        if (!hidrd_item_collection_type_valid(num))
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+        type = num;
+    }
+    else if (!spec_src_tkn(tkn, value, len) ||
+             !hidrd_item_collection_type_from_token(&type, tkn))
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    hidrd_item_collection_init(spec_src->item, type);
+
+    return true;
+}
+
+#define BITMAP_ITEM(_name, _input) \
+    static ITEM(_name)                                          \
+    {                                                           \
+        uint32_t    bitmap;                                     \
+                                                                \
+        if (!spec_src_bitmap(spec_src, &bitmap, _input,         \
+                             value, len))                       \
+            return false;                                       \
+                                                                \
+        hidrd_item_##_name##_init(spec_src->item, bitmap);      \
+                                                                \
+        return true;                                            \
+    }
+
+BITMAP_ITEM(input,      true)
+BITMAP_ITEM(output,     false)
+BITMAP_ITEM(feature,    false)
+
+#define NUM_ITEM(_name, _t) \
+    static ITEM(_name)                                                  \
+    {                                                                   \
+        HIDRD_NUM_##_t##_TYPE   num;                                    \
+                                                                        \
+        if (value == NULL || !spec_src_##_t(&num, value, len) ||        \
+            !hidrd_item_##_name##_value_valid(num))                     \
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);   \
+                                                                        \
+        hidrd_item_##_name##_init(spec_src->item, num);                 \
+                                                                        \
+        return true;                                                    \
+    }
+
+NUM_ITEM(logical_minimum,       s32)
+NUM_ITEM(logical_maximum,       s32)
+NUM_ITEM(physical_minimum,      s32)
+NUM_ITEM(physical_maximum,      s32)
+NUM_ITEM(unit_exponent,         s32)
+NUM_ITEM(report_size,           u32)
+NUM_ITEM(report_id,             u32)
+NUM_ITEM(report_count,          u32)
+NUM_ITEM(designator_index,      u32)
+NUM_ITEM(designator_minimum,    u32)
+NUM_ITEM(designator_maximum,    u32)
+NUM_ITEM(string_index,          u32)
+NUM_ITEM(string_minimum,        u32)
+NUM_ITEM(string_maximum,        u32)
+
+static ITEM(usage_page)
+{
+    char                tkn[SPEC_SRC_TKN_SIZE];
+    uint32_t            num;
+    hidrd_usage_page    page;
+
+    if (value == NULL)
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    if (spec_src_u32(&num, value, len))
+    {
+        if (!hidrd_item_usage_page_value_valid(num))
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+        page = num;
+    }
+    else if (!spec_src_tkn(tkn, value, len) ||
+             !hidrd_usage_page_from_token(&page, tkn))
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    spec_src_set_page(spec_src, page);
+    hidrd_item_usage_page_init(spec_src->item, page);
+
+    return true;
+}
+
+#define USAGE_ITEM(_name) \
+    static ITEM(_name)                                          \
+    {                                                           \
+        hidrd_usage usage;                                      \
+                                                                \
+        if (!spec_src_usage(spec_src, &usage, value, len))      \
+            return false;                                       \
+                                                                \
+        hidrd_item_##_name##_init(spec_src->item, usage);       \
+                                                                \
+        return true;                                            \
+    }
+
+USAGE_ITEM(usage)
+USAGE_ITEM(usage_minimum)
+USAGE_ITEM(usage_maximum)
+
+static ITEM(unit)
+{
+    uint32_t    data    = 0;
+    size_t      data_len;
+    char        expr[SPEC_SRC_TKN_SIZE];
+    hidrd_unit  unit;
+
+    if (value == NULL)
+        unit = HIDRD_UNIT_NONE;
+    else if (spec_src_data(&data, sizeof(data), &data_len, value, len))
+        unit = hidrd_num_u32_from_le(&data);
+    else
+    {
+        if (len >= sizeof(expr))
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+        memcpy(expr, value, len);
+        expr[len] = '\0';
+        if (!hidrd_unit_from_expr(&unit, expr))
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+    }
+
+    hidrd_item_unit_init(spec_src->item, unit);
+
+    return true;
+}
+
+static ITEM(push)
+{
+    (void)len;
+
+    if (value != NULL)
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    if (!hidrd_buf_add_ptr(&spec_src->pages,
+                           &spec_src->usage_page,
+                           sizeof(spec_src->usage_page)))
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_ALLOC);
+
+    hidrd_item_push_init(spec_src->item);
+
+    return true;
+}
+
+static ITEM(pop)
+{
+    hidrd_usage_page    page;
+
+    (void)len;
+
+    if (value != NULL)
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    /* Pop the usage page, if possible */
+    if (spec_src->pages.len > 0)
+    {
+        memcpy(&page,
+               (uint8_t *)spec_src->pages.ptr + spec_src->pages.len -
+                    sizeof(page),
+               sizeof(page));
+        hidrd_buf_del(&spec_src->pages, sizeof(page));
+        spec_src_set_page(spec_src, page);
+    }
+
+    hidrd_item_pop_init(spec_src->item);
+
+    return true;
+}
+
+static ITEM(delimiter)
+{
+    if (value != NULL && spec_src_tkn_match("open", value, len))
+        hidrd_item_delimiter_init(spec_src->item,
+                                  HIDRD_ITEM_DELIMITER_SET_OPEN);
+    else if (value != NULL && spec_src_tkn_match("close", value, len))
+        hidrd_item_delimiter_init(spec_src->item,
+                                  HIDRD_ITEM_DELIMITER_SET_CLOSE);
+    else
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    return true;
+}
+
+/*
+ * Short item of specified type the sink doesn't interpret, with
+ * hexadecimal "tag:" and "data:" fields.
+ */
+#define SHORT_TAG_ITEM(_name) \
+    static ITEM(_name)                                                  \
+    {                                                                   \
+        uint32_t    tag;                                                \
+        uint8_t     data[4] = {0};                                      \
+        size_t      data_len;                                           \
+                                                                        \
+        if (value == NULL ||                                            \
+            !spec_src_fields(NULL, &tag, data, sizeof(data), &data_len, \
+                             value, len) ||                             \
+            !hidrd_item_##_name##_tag_valid(tag) || data_len == 3)      \
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);   \
+                                                                        \
+        hidrd_item_##_name##_init(spec_src->item, tag);                 \
+        memcpy(hidrd_item_short_get_data(spec_src->item), data,         \
+               sizeof(data));                                           \
+        hidrd_item_short_set_data_size(                                 \
+                spec_src->item,                                         \
+                hidrd_item_short_data_size_from_bytes(data_len));       \
+                                                                        \
+        return true;                                                    \
+    }
+
+SHORT_TAG_ITEM(main)
+SHORT_TAG_ITEM(global)
+SHORT_TAG_ITEM(local)
+
+static ITEM(short)
+{
+    uint32_t    type;
+    uint32_t    tag;
+    uint8_t     data[4] = {0};
+    size_t      data_len;
+
+    if (value == NULL ||
+        !spec_src_fields(&type, &tag, data, sizeof(data), &data_len,
+                         value, len) ||
+        !hidrd_item_short_type_valid(type) ||
+        !hidrd_item_short_tag_valid(tag) || data_len == 3)
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    hidrd_item_short_init(spec_src->item, type, tag);
+    memcpy(hidrd_item_short_get_data(spec_src->item), data, sizeof(data));
+    hidrd_item_short_set_data_size(
+            spec_src->item, hidrd_item_short_data_size_from_bytes(data_len));
+
+    return true;
+}
+
+static ITEM(long)
+{
+    uint32_t    tag;
+    uint8_t     data[HIDRD_ITEM_LONG_DATA_SIZE_MAX];
+    size_t      data_len;
+
+    if (value == NULL ||
+        !spec_src_fields(NULL, &tag, data, sizeof(data), &data_len,
+                         value, len) ||
+        !hidrd_item_long_tag_valid(tag))
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_VALUE);
+
+    hidrd_item_long_init(spec_src->item, tag);
+    if (data_len > 0)
+        memcpy(hidrd_item_long_get_data(spec_src->item), data, data_len);
+    hidrd_item_long_set_data_size(spec_src->item, data_len);
+
+    return true;
+}
+
+#undef ITEM
+
+/** Item handler */
+typedef struct spec_src_item_handler {
+    const char *name;   /**< Item name token */
+    bool      (*fn)(hidrd_spec_src_inst    *spec_src,
+                    const char             *value,
+                    size_t                  len);
+                        /**< Item value handling function */
+} spec_src_item_handler;
+
+/** Item handler list, most frequent items first */
+static const spec_src_item_handler spec_src_item_handler_list[] = {
+#define HANDLE(_name)   {.name  = #_name, \
+                         .fn    = spec_src_item_##_name}
+    HANDLE(usage),
+    HANDLE(usage_page),
+    HANDLE(input),
+    HANDLE(report_size),
+    HANDLE(report_count),
+    HANDLE(logical_minimum),
+    HANDLE(logical_maximum),
+    HANDLE(collection),
+    HANDLE(end_collection),
+    HANDLE(output),
+    HANDLE(feature),
+    HANDLE(usage_minimum),
+    HANDLE(usage_maximum),
+    HANDLE(report_id),
+    HANDLE(physical_minimum),
+    HANDLE(physical_maximum),
+    HANDLE(unit_exponent),
+    HANDLE(unit),
+    HANDLE(push),
+    HANDLE(pop),
+    HANDLE(designator_index),
+    HANDLE(designator_minimum),
+    HANDLE(designator_maximum),
+    HANDLE(string_index),
+    HANDLE(string_minimum),
+    HANDLE(string_maximum),
+    HANDLE(delimiter),
+    HANDLE(main),
+    HANDLE(global),
+    HANDLE(local),
+    HANDLE(short),
+    HANDLE(long),
+#undef HANDLE
+};
+
+#define SPEC_SRC_ITEM_HANDLER_NUM \
+    (sizeof(spec_src_item_handler_list) / sizeof(*spec_src_item_handler_list))
+
+
+/**
+ * Read an item starting at the current (non-blank) position: a name,
+ * optionally followed by a parenthesized value.
+ *
+ * @param spec_src  Specification example source instance.
+ *
+ * @return True if the item was read into the item buffer, false
+ *         otherwise, with error set.
+ */
+static bool
+spec_src_item(hidrd_spec_src_inst *spec_src)
+{
+    const char                     *buf         =
+                                        (const char *)spec_src->src.buf;
+    size_t                          size        = spec_src->src.size;
+    size_t                          pos         = spec_src->pos;
+    const char                     *name;
+    size_t                          name_len;
+    const char                     *value       = NULL;
+    size_t                          value_len   = 0;
+    const spec_src_item_handler    *h;
+
+    /* Read the name */
+    for (name = buf + pos;
+         pos < size && (hidrd_char_istkn(buf[pos]) ||
+                        spec_src_isblank(buf[pos]));
+         pos++);
+    name_len = buf + pos - name;
+    spec_src_trim(&name, &name_len);
+    if (name_len == 0)
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_SYNTAX);
+
+    /* Read the value, if any, as is */
+    if (pos < size && buf[pos] == '(')
+    {
+        for (value = buf + ++pos; pos < size && buf[pos] != ')'; pos++)
+            if (buf[pos] == '\n')
+            {
+                spec_src->line++;
+                spec_src->line_pos = pos + 1;
+            }
+        if (pos >= size)
+            return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_SYNTAX);
+        value_len = buf + pos++ - value;
+        spec_src_trim(&value, &value_len);
+        if (value_len == 0)
+            value = NULL;
+    }
+
+    /* Only a separator, a comment or the line end may follow */
+    for (; pos < size && spec_src_isblank(buf[pos]); pos++);
+    if (pos < size && buf[pos] != ',' && buf[pos] != ';' && buf[pos] != '\n')
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_SYNTAX);
+    spec_src->pos = pos;
+
+    /* Lookup and call the item handler */
+    for (h = spec_src_item_handler_list;
+         h < spec_src_item_handler_list + SPEC_SRC_ITEM_HANDLER_NUM; h++)
+        if (spec_src_tkn_match(h->name, name, name_len))
+            break;
+    if (h >= spec_src_item_handler_list + SPEC_SRC_ITEM_HANDLER_NUM)
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_NAME);
+
+    if (!h->fn(spec_src, value, value_len))
+        return false;
+
+    if (!hidrd_item_valid(spec_src->item))
+        return spec_src_fail(spec_src, HIDRD_SPEC_SRC_ERR_INVALID);
+
+    return true;
+}
+
+
+static const hidrd_item *
+hidrd_spec_src_get(hidrd_src *src)
+{
+    hidrd_spec_src_inst    *spec_src    = (hidrd_spec_src_inst *)src;
+
+    if (spec_src->pos >= src->size || !spec_src_item(spec_src))
+        return NULL;
+
+    /* Position at the next item */
+    spec_src_skip(spec_src);
+
+    return spec_src->item;
+}
+
+
+static void
+hidrd_spec_src_clnp(hidrd_src *src)
+{
+    hidrd_spec_src_inst    *spec_src    = (hidrd_spec_src_inst *)src;
+
+    hidrd_buf_clnp(&spec_src->pages);
+}
+
+
+const hidrd_src_type hidrd_spec_src = {
+    .size   = sizeof(hidrd_spec_src_inst),
+    .initv  = hidrd_spec_src_initv,
+    .valid  = hidrd_spec_src_valid,
+    .getpos = hidrd_spec_src_getpos,
+    .fmtpos = hidrd_spec_src_fmtpos,
+    .errmsg = hidrd_spec_src_errmsg,
+    .get    = hidrd_spec_src_get,
+    .clnp   = hidrd_spec_src_clnp,
+};
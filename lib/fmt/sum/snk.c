@@ -0,0 +1,148 @@
+/** @file
+ * @brief HID report descriptor - report size summary sink
+ *
+ * Copyright (C) 2014 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include "hidrd/fmt/sum/snk.h"
+
+static bool
+hidrd_sum_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
+{
+    hidrd_sum_snk_inst *sum_snk = (hidrd_sum_snk_inst *)snk;
+
+    (void)ap;
+
+    hidrd_layout_sum_init(&sum_snk->sum);
+    sum_snk->err = HIDRD_SUM_SNK_ERR_NONE;
+
+    if (perr != NULL)
+        *perr = strdup("");
+
+    return true;
+}
+
+
+static bool
+hidrd_sum_snk_valid(const hidrd_snk *snk)
+{
+    const hidrd_sum_snk_inst   *sum_snk =
+                                    (const hidrd_sum_snk_inst *)snk;
+
+    return (snk->type->size >= sizeof(hidrd_sum_snk_inst)) &&
+           hidrd_layout_sum_valid(&sum_snk->sum);
+}
+
+
+static char *
+hidrd_sum_snk_errmsg(const hidrd_snk *snk)
+{
+    const hidrd_sum_snk_inst   *sum_snk =
+                                    (const hidrd_sum_snk_inst *)snk;
+    const char                 *msg;
+
+    switch (sum_snk->err)
+    {
+        case HIDRD_SUM_SNK_ERR_NONE:
+            msg = "";
+            break;
+        case HIDRD_SUM_SNK_ERR_ALLOC:
+            msg = "memory allocation failure";
+            break;
+        case HIDRD_SUM_SNK_ERR_SUM:
+            return hidrd_layout_sum_errmsg(&sum_snk->sum);
+        default:
+            assert(!"Unknown error code");
+            return NULL;
+    }
+
+    return strdup(msg);
+}
+
+
+static bool
+hidrd_sum_snk_put(hidrd_snk *snk, const hidrd_item *item)
+{
+    hidrd_sum_snk_inst *sum_snk = (hidrd_sum_snk_inst *)snk;
+
+    assert(hidrd_item_valid(item));
+
+    if (!hidrd_layout_sum_put(&sum_snk->sum, item))
+    {
+        sum_snk->err = HIDRD_SUM_SNK_ERR_SUM;
+        return false;
+    }
+
+    return true;
+}
+
+
+static bool
+hidrd_sum_snk_flush(hidrd_snk *snk)
+{
+    hidrd_sum_snk_inst *sum_snk = (hidrd_sum_snk_inst *)snk;
+    hidrd_buf           buf     = HIDRD_BUF_EMPTY;
+    void               *ptr;
+    size_t              len;
+
+    if (!hidrd_layout_sum_format(&sum_snk->sum, &buf))
+    {
+        hidrd_buf_clnp(&buf);
+        sum_snk->err = HIDRD_SUM_SNK_ERR_ALLOC;
+        return false;
+    }
+
+    hidrd_buf_disown(&buf, &ptr, &len, NULL);
+
+    if (snk->pbuf != NULL)
+    {
+        free(*snk->pbuf);
+        *snk->pbuf = ptr;
+    }
+    else
+        free(ptr);
+
+    if (snk->psize != NULL)
+        *snk->psize = len;
+
+    return true;
+}
+
+
+static void
+hidrd_sum_snk_clnp(hidrd_snk *snk)
+{
+    hidrd_sum_snk_inst *sum_snk = (hidrd_sum_snk_inst *)snk;
+
+    hidrd_layout_sum_clnp(&sum_snk->sum);
+    sum_snk->err = HIDRD_SUM_SNK_ERR_NONE;
+}
+
+
+const hidrd_snk_type hidrd_sum_snk = {
+    .size       = sizeof(hidrd_sum_snk_inst),
+    .initv      = hidrd_sum_snk_initv,
+    .valid      = hidrd_sum_snk_valid,
+    .errmsg     = hidrd_sum_snk_errmsg,
+    .put        = hidrd_sum_snk_put,
+    .flush      = hidrd_sum_snk_flush,
+    .clnp       = hidrd_sum_snk_clnp,
+};
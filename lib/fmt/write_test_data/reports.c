@@ -0,0 +1,212 @@
+#include <stdint.h>
+
+static const uint8_t hid_desc[] = {
+    0x05, 0x01,         /*  Usage Page (Desktop),               */
+    0x09, 0x02,         /*  Usage (Mouse),                      */
+    0xA1, 0x01,         /*  Collection (Application),           */
+    0x85, 0x01,         /*      Report ID (1),                  */
+    0x09, 0x01,         /*      Usage (Pointer),                */
+    0xA1, 0x00,         /*      Collection (Physical),          */
+    0x05, 0x09,         /*          Usage Page (Button),        */
+    0x19, 0x01,         /*          Usage Minimum (01h),        */
+    0x29, 0x03,         /*          Usage Maximum (03h),        */
+    0x15, 0x00,         /*          Logical Minimum (0),        */
+    0x25, 0x01,         /*          Logical Maximum (1),        */
+    0x95, 0x03,         /*          Report Count (3),           */
+    0x75, 0x01,         /*          Report Size (1),            */
+    0x81, 0x02,         /*          Input (Variable),           */
+    0x95, 0x01,         /*          Report Count (1),           */
+    0x75, 0x05,         /*          Report Size (5),            */
+    0x81, 0x03,         /*          Input (Constant, Variable), */
+    0x05, 0x01,         /*          Usage Page (Desktop),       */
+    0x09, 0x30,         /*          Usage (X),                  */
+    0x09, 0x31,         /*          Usage (Y),                  */
+    0x15, 0x81,         /*          Logical Minimum (-127),     */
+    0x25, 0x7F,         /*          Logical Maximum (127),      */
+    0x75, 0x08,         /*          Report Size (8),            */
+    0x95, 0x02,         /*          Report Count (2),           */
+    0x81, 0x06,         /*          Input (Variable, Relative), */
+    0xC0,               /*      End Collection,                 */
+    0xC0,               /*  End Collection,                     */
+    0x05, 0x01,         /*  Usage Page (Desktop),               */
+    0x09, 0x06,         /*  Usage (Keyboard),                   */
+    0xA1, 0x01,         /*  Collection (Application),           */
+    0x85, 0x02,         /*      Report ID (2),                  */
+    0x05, 0x07,         /*      Usage Page (Keyboard),          */
+    0x19, 0xE0,         /*      Usage Minimum (KB Leftcontrol), */
+    0x29, 0xE7,         /*      Usage Maximum (KB Right GUI),   */
+    0x15, 0x00,         /*      Logical Minimum (0),            */
+    0x25, 0x01,         /*      Logical Maximum (1),            */
+    0x75, 0x01,         /*      Report Size (1),                */
+    0x95, 0x08,         /*      Report Count (8),               */
+    0x81, 0x02,         /*      Input (Variable),               */
+    0x95, 0x01,         /*      Report Count (1),               */
+    0x75, 0x08,         /*      Report Size (8),                */
+    0x81, 0x01,         /*      Input (Constant),               */
+    0x95, 0x05,         /*      Report Count (5),               */
+    0x75, 0x01,         /*      Report Size (1),                */
+    0x05, 0x08,         /*      Usage Page (LED),               */
+    0x19, 0x01,         /*      Usage Minimum (01h),            */
+    0x29, 0x05,         /*      Usage Maximum (05h),            */
+    0x91, 0x02,         /*      Output (Variable),              */
+    0x95, 0x01,         /*      Report Count (1),               */
+    0x75, 0x03,         /*      Report Size (3),                */
+    0x91, 0x01,         /*      Output (Constant),              */
+    0x95, 0x06,         /*      Report Count (6),               */
+    0x75, 0x08,         /*      Report Size (8),                */
+    0x15, 0x00,         /*      Logical Minimum (0),            */
+    0x26, 0xFF, 0x00,   /*      Logical Maximum (255),          */
+    0x05, 0x07,         /*      Usage Page (Keyboard),          */
+    0x19, 0x00,         /*      Usage Minimum (None),           */
+    0x2A, 0xFF, 0x00,   /*      Usage Maximum (FFh),            */
+    0x81, 0x00,         /*      Input,                          */
+    0xC0,               /*  End Collection,                     */
+    0x06, 0x00, 0xFF,   /*  Usage Page (FF00h),                 */
+    0x09, 0x01,         /*  Usage (01h),                        */
+    0xA1, 0x01,         /*  Collection (Application),           */
+    0x85, 0x03,         /*      Report ID (3),                  */
+    0xA4,               /*      Push,                           */
+    0x15, 0x00,         /*      Logical Minimum (0),            */
+    0x25, 0xFF,         /*      Logical Maximum (-1),           */
+    0x75, 0x08,         /*      Report Size (8),                */
+    0x95, 0x04,         /*      Report Count (4),               */
+    0x09, 0x02,         /*      Usage (02h),                    */
+    0xB1, 0x02,         /*      Feature (Variable),             */
+    0xB4,               /*      Pop,                            */
+    0xC0                /*  End Collection                      */
+};
+
+static inline uint32_t
+hid_bits_get(const uint8_t *report, uint32_t bit, uint32_t size)
+{
+    const uint8_t  *p      = report + (bit >> 3);
+    uint32_t        shift  = bit & 7;
+    uint32_t        n      = (shift + size + 7) >> 3;
+    uint64_t        v      = 0;
+    uint32_t        i;
+
+    for (i = 0; i < n; i++)
+        v |= (uint64_t)p[i] << (i * 8);
+
+    return (uint32_t)((v >> shift) & (((uint64_t)1 << size) - 1));
+}
+
+static inline void
+hid_bits_set(uint8_t *report, uint32_t bit, uint32_t size, uint32_t value)
+{
+    uint8_t    *p      = report + (bit >> 3);
+    uint32_t    shift  = bit & 7;
+    uint32_t    n      = (shift + size + 7) >> 3;
+    uint64_t    mask   = (((uint64_t)1 << size) - 1) << shift;
+    uint64_t    v      = ((uint64_t)value << shift) & mask;
+    uint32_t    i;
+
+    for (i = 0; i < n; i++, mask >>= 8, v >>= 8)
+        p[i] = (uint8_t)((p[i] & ~mask) | v);
+}
+
+/* Input report 1 */
+#define HID_INPUT_1_ID 1
+#define HID_INPUT_1_SIZE 4
+
+/* Field 0: variable, 3 x 1 bit, usage 0x00090001-0x00090003, logical 0..1 */
+#define HID_INPUT_1_F0_COUNT 3
+
+static inline uint32_t
+hid_input_1_f0_get(const uint8_t *report, uint32_t idx)
+{
+    return hid_bits_get(report, 8 + idx * 1, 1);
+}
+
+static inline void
+hid_input_1_f0_set(uint8_t *report, uint32_t idx, uint32_t value)
+{
+    hid_bits_set(report, 8 + idx * 1, 1, value);
+}
+
+/* Field 2: variable, 2 x 8 bit, usage 0x00010030, ..., logical -127..127 */
+#define HID_INPUT_1_F2_COUNT 2
+
+static inline int32_t
+hid_input_1_f2_get(const uint8_t *report, uint32_t idx)
+{
+    return (int32_t)(hid_bits_get(report, 16 + idx * 8, 8) ^ 0x80u) - 0x80;
+}
+
+static inline void
+hid_input_1_f2_set(uint8_t *report, uint32_t idx, int32_t value)
+{
+    hid_bits_set(report, 16 + idx * 8, 8, (uint32_t)value);
+}
+
+/* Input report 2 */
+#define HID_INPUT_2_ID 2
+#define HID_INPUT_2_SIZE 9
+
+/* Field 0: variable, 8 x 1 bit, usage 0x000700E0-0x000700E7, logical 0..1 */
+#define HID_INPUT_2_F0_COUNT 8
+
+static inline uint32_t
+hid_input_2_f0_get(const uint8_t *report, uint32_t idx)
+{
+    return hid_bits_get(report, 8 + idx * 1, 1);
+}
+
+static inline void
+hid_input_2_f0_set(uint8_t *report, uint32_t idx, uint32_t value)
+{
+    hid_bits_set(report, 8 + idx * 1, 1, value);
+}
+
+/* Field 2: array, 6 x 8 bit, usage 0x00070000-0x000700FF, logical 0..255 */
+#define HID_INPUT_2_F2_COUNT 6
+
+static inline uint32_t
+hid_input_2_f2_get(const uint8_t *report, uint32_t idx)
+{
+    return hid_bits_get(report, 24 + idx * 8, 8);
+}
+
+static inline void
+hid_input_2_f2_set(uint8_t *report, uint32_t idx, uint32_t value)
+{
+    hid_bits_set(report, 24 + idx * 8, 8, value);
+}
+
+/* Output report 2 */
+#define HID_OUTPUT_2_ID 2
+#define HID_OUTPUT_2_SIZE 2
+
+/* Field 0: variable, 5 x 1 bit, usage 0x00080001-0x00080005, logical 0..1 */
+#define HID_OUTPUT_2_F0_COUNT 5
+
+static inline uint32_t
+hid_output_2_f0_get(const uint8_t *report, uint32_t idx)
+{
+    return hid_bits_get(report, 8 + idx * 1, 1);
+}
+
+static inline void
+hid_output_2_f0_set(uint8_t *report, uint32_t idx, uint32_t value)
+{
+    hid_bits_set(report, 8 + idx * 1, 1, value);
+}
+
+/* Feature report 3 */
+#define HID_FEATURE_3_ID 3
+#define HID_FEATURE_3_SIZE 5
+
+/* Field 0: variable, 4 x 8 bit, usage 0xFF000002, logical 0..255 */
+#define HID_FEATURE_3_F0_COUNT 4
+
+static inline uint32_t
+hid_feature_3_f0_get(const uint8_t *report, uint32_t idx)
+{
+    return hid_bits_get(report, 8 + idx * 8, 8);
+}
+
+static inline void
+hid_feature_3_f0_set(uint8_t *report, uint32_t idx, uint32_t value)
+{
+    hid_bits_set(report, 8 + idx * 8, 8, value);
+}
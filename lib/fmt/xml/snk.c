@@ -32,7 +32,12 @@
 
 
 static bool
-hidrd_xml_snk_init(hidrd_snk *snk, char **perr, bool format, const char *schema)
+hidrd_xml_snk_init(hidrd_snk   *snk,
+                   char       **perr,
+                   bool         format,
+                   const char  *schema,
+                   bool         comments,
+                   bool         tokens)
 {
     bool                    result      = false;
     hidrd_xml_snk_inst     *xml_snk     = (hidrd_xml_snk_inst *)snk;
@@ -92,12 +97,16 @@ hidrd_xml_snk_init(hidrd_snk *snk, char **perr, bool format, const char *schema)
     xmlDocSetRootElement(doc, root);
 
     /* Initialize the sink */
-    xml_snk->schema = own_schema;
-    xml_snk->format = format;
-    xml_snk->state  = state;
-    xml_snk->doc    = doc;
-    xml_snk->prnt   = root;
-    xml_snk->err    = strdup("");
+    xml_snk->schema     = own_schema;
+    xml_snk->format     = format;
+    xml_snk->comments   = comments;
+    xml_snk->tokens     = tokens;
+    xml_snk->state      = state;
+    xml_snk->doc        = doc;
+    xml_snk->prnt       = root;
+    xml_snk->err        = strdup("");
+    hidrd_buf_init(&xml_snk->fmt);
+    hidrd_memo_init(&xml_snk->memo);
 
     own_schema  = NULL;
     state       = NULL;
@@ -128,31 +137,60 @@ hidrd_xml_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
     bool        format  = (va_arg(ap, int) != 0);
     const char *schema  = va_arg(ap, const char *);
 
-    return hidrd_xml_snk_init(snk, perr, format, schema);
+    /* The lean output is only available through the options */
+    return hidrd_xml_snk_init(snk, perr, format, schema, true, true);
 }
 
 
 #ifdef HIDRD_WITH_OPT
+/** Option indexes into the specification list */
+enum {
+    OPT_FORMAT,
+    OPT_SCHEMA,
+    OPT_COMMENTS,
+    OPT_TOKENS,
+    OPT_NUM
+};
+
 static const hidrd_opt_spec hidrd_xml_snk_opts_spec[] = {
-    {.name  = "format",
-     .type  = HIDRD_OPT_TYPE_BOOLEAN,
-     .req   = false,
-     .dflt  = {
-         .boolean = true
-     },
-     .desc  = "format XML output"},
-    {.name  = "schema",
-     .type  = HIDRD_OPT_TYPE_STRING,
-     .req   = false,
-     .dflt  = {
+    [OPT_FORMAT] =
+        {.name  = "format",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {
+             .boolean = true
+         },
+         .desc  = "format XML output"},
+    [OPT_SCHEMA] =
+        {.name  = "schema",
+         .type  = HIDRD_OPT_TYPE_STRING,
+         .req   = false,
+         .dflt  = {
 #ifdef NDEBUG
-         .string = ""
+             .string = ""
 #else
-         .string = HIDRD_XML_SCHEMA_PATH
+             .string = HIDRD_XML_SCHEMA_PATH
 #endif
-     },
-     .desc  = "path to a schema file for output validation"},
-    {.name  = NULL}
+         },
+         .desc  = "path to a schema file for output validation"},
+    [OPT_COMMENTS] =
+        {.name  = "comments",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {
+             .boolean = true
+         },
+         .desc  = "output usage page and usage description comments"},
+    [OPT_TOKENS] =
+        {.name  = "tokens",
+         .type  = HIDRD_OPT_TYPE_BOOLEAN,
+         .req   = false,
+         .dflt  = {
+             .boolean = true
+         },
+         .desc  = "output symbolic tokens instead of numbers"},
+    [OPT_NUM] =
+        {.name  = NULL}
 };
 
 static bool
@@ -160,8 +198,10 @@ hidrd_xml_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
 {
     return hidrd_xml_snk_init(
                 snk, perr,
-                hidrd_opt_list_get_boolean(list, "format"),
-                hidrd_opt_list_get_string(list, "schema"));
+                hidrd_opt_list_get_boolean_at(list, OPT_FORMAT),
+                hidrd_opt_list_get_string_at(list, OPT_SCHEMA),
+                hidrd_opt_list_get_boolean_at(list, OPT_COMMENTS),
+                hidrd_opt_list_get_boolean_at(list, OPT_TOKENS));
 }
 #endif /* HIDRD_WITH_OPT */
 
@@ -174,6 +214,8 @@ hidrd_xml_snk_valid(const hidrd_snk *snk)
     return snk->type->size >= sizeof(hidrd_xml_snk_inst) &&
            xml_snk->state != NULL &&
            xml_snk->doc != NULL &&
+           hidrd_buf_valid(&xml_snk->fmt) &&
+           hidrd_memo_valid(&xml_snk->memo) &&
            xml_snk->prnt != NULL;
 }
 
@@ -296,6 +338,12 @@ hidrd_xml_snk_clnp(hidrd_snk *snk)
     /* Free the schema file path */
     free(xml_snk->schema);
     xml_snk->schema = NULL;
+
+    /* Free the value formatting buffer */
+    hidrd_buf_clnp(&xml_snk->fmt);
+
+    /* Free the memoized strings */
+    hidrd_memo_clnp(&xml_snk->memo);
 }
 
 
@@ -57,23 +57,19 @@ xml_snk_element_set_attrpv(hidrd_xml_snk_inst  *xml_snk,
                            hidrd_fmt_type       fmt,
                            va_list             *pap)
 {
-    char       *value;
-    xmlAttrPtr  attr;
+    const char *value;
 
     assert(xml_snk->cur != NULL);
 
-    if (!hidrd_fmtpva(&value, fmt, pap))
+    if (!hidrd_fmtpva_buf(&xml_snk->fmt, &value, fmt, pap))
     {
         XML_ERR("failed to format \"%s\" element \"%s\" attribute value",
                 (const char *)xml_snk->cur->name, name);
         return false;
     }
 
-    attr = xmlSetProp(xml_snk->cur, BAD_CAST name, BAD_CAST value);
-
-    free(value);
-
-    return (attr != NULL);
+    return (xmlSetProp(xml_snk->cur,
+                       BAD_CAST name, BAD_CAST value) != NULL);
 }
 
 
@@ -82,11 +78,11 @@ xml_snk_element_add_contentpv(hidrd_xml_snk_inst   *xml_snk,
                               hidrd_fmt_type        fmt,
                               va_list               *pap)
 {
-    char   *content;
+    const char *content;
 
     assert(xml_snk->cur != NULL);
 
-    if (!hidrd_fmtpva(&content, fmt, pap))
+    if (!hidrd_fmtpva_buf(&xml_snk->fmt, &content, fmt, pap))
     {
         XML_ERR("failed to format \"%s\" element content",
                 (const char *)xml_snk->cur->name);
@@ -95,8 +91,6 @@ xml_snk_element_add_contentpv(hidrd_xml_snk_inst   *xml_snk,
 
     xmlNodeAddContent(xml_snk->cur, BAD_CAST content);
 
-    free(content);
-
     return true;
 }
 
@@ -106,12 +100,12 @@ xml_snk_element_add_commentpv(hidrd_xml_snk_inst   *xml_snk,
                               hidrd_fmt_type        fmt,
                               va_list              *pap)
 {
-    char       *content;
+    const char *content;
     xmlNodePtr  comment;
 
     assert(xml_snk->cur != NULL);
 
-    if (!hidrd_fmtpva(&content, fmt, pap))
+    if (!hidrd_fmtpva_buf(&xml_snk->fmt, &content, fmt, pap))
     {
         XML_ERR("failed to format \"%s\" element comment",
                 (const char *)xml_snk->cur->name);
@@ -119,7 +113,6 @@ xml_snk_element_add_commentpv(hidrd_xml_snk_inst   *xml_snk,
     }
 
     comment = xmlNewDocComment(xml_snk->doc, BAD_CAST content);
-    free(content);
     if (comment == NULL)
         return false;
 
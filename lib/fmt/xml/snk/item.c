@@ -48,6 +48,15 @@
 #define GROUP_END(_name) \
     xml_snk_group_end(xml_snk, #_name)
 
+/*
+ * Format a value as a lowercase token or a decimal number, if there is no
+ * token for it, or as a decimal number only, if tokens are disabled.
+ */
+#define TOKEN_OR_DEC(_type, _value) \
+    (xml_snk->tokens                                                    \
+        ? HIDRD_NUM_TO_ALT_STR2_1(_type, _value, token, lc, dec)        \
+        : hidrd_##_type##_to_dec(_value))
+
 #define CASE_SIMPLE_S32(_TYPE, _NAME, _name) \
     case HIDRD_ITEM_##_TYPE##_TAG_##_NAME:                              \
         return ADD_SIMPLE(                                              \
@@ -64,6 +73,94 @@
                             hidrd_item_##_name##_get_value(item)))
 
 
+/** Memoized string kinds */
+typedef enum xml_snk_item_memo_kind {
+    XML_SNK_ITEM_MEMO_PAGE_TOKEN,       /**< Usage page token or hex */
+    XML_SNK_ITEM_MEMO_PAGE_COMMENT,     /**< Usage page comment */
+    XML_SNK_ITEM_MEMO_USAGE_ID_TOKEN,   /**< Current page usage ID token
+                                             or hex */
+    XML_SNK_ITEM_MEMO_USAGE_ID_COMMENT, /**< Current page usage ID
+                                             comment, empty if none */
+    XML_SNK_ITEM_MEMO_USAGE_TOKEN,      /**< Other page usage token or
+                                             hex */
+    XML_SNK_ITEM_MEMO_USAGE_COMMENT     /**< Other page usage comment,
+                                             empty if none */
+} xml_snk_item_memo_kind;
+
+
+static char *
+hidrd_usage_to_id_hex(hidrd_usage usage)
+{
+    return hidrd_usage_id_to_hex(hidrd_usage_get_id(usage));
+}
+
+
+/**
+ * Retrieve a string from the sink memo cache, formatting and memoizing it
+ * first, if missing.
+ *
+ * @param xml_snk   XML sink instance.
+ * @param kind      String kind.
+ * @param key       Usage page or usage value, depending on the kind.
+ *
+ * @return Memoized string, valid until the next call, or NULL if failed to
+ *         allocate memory.
+ */
+static const char *
+xml_snk_item_memo(hidrd_xml_snk_inst       *xml_snk,
+                  xml_snk_item_memo_kind    kind,
+                  uint32_t                  key)
+{
+    const char *str;
+    char       *new_str;
+
+    str = hidrd_memo_get(&xml_snk->memo, kind, key);
+    if (str != NULL)
+        return str;
+
+    switch (kind)
+    {
+        case XML_SNK_ITEM_MEMO_PAGE_TOKEN:
+            new_str = xml_snk->tokens
+                        ? HIDRD_NUM_TO_ALT_STR2_1(usage_page,
+                                                  (hidrd_usage_page)key,
+                                                  token, lc, hex)
+                        : hidrd_usage_page_to_hex((hidrd_usage_page)key);
+            break;
+        case XML_SNK_ITEM_MEMO_PAGE_COMMENT:
+            new_str = hidrd_usage_page_desc_str((hidrd_usage_page)key);
+            if (new_str != NULL)
+                new_str = hidrd_str_apada(hidrd_str_uc_first(new_str));
+            break;
+        case XML_SNK_ITEM_MEMO_USAGE_ID_TOKEN:
+            new_str = xml_snk->tokens
+                        ? HIDRD_NUM_TO_ALT_STR2_1(usage, (hidrd_usage)key,
+                                                  token, lc, id_hex)
+                        : hidrd_usage_to_id_hex((hidrd_usage)key);
+            break;
+        case XML_SNK_ITEM_MEMO_USAGE_TOKEN:
+            new_str = xml_snk->tokens
+                        ? HIDRD_NUM_TO_ALT_STR2_1(usage, (hidrd_usage)key,
+                                                  token, lc, hex)
+                        : hidrd_usage_to_hex((hidrd_usage)key);
+            break;
+        case XML_SNK_ITEM_MEMO_USAGE_ID_COMMENT:
+        case XML_SNK_ITEM_MEMO_USAGE_COMMENT:
+            new_str = (kind == XML_SNK_ITEM_MEMO_USAGE_ID_COMMENT)
+                        ? hidrd_usage_desc_id_str((hidrd_usage)key)
+                        : hidrd_usage_desc_str((hidrd_usage)key);
+            if (new_str != NULL && *new_str != '\0')
+                new_str = hidrd_str_apada(hidrd_str_uc_first(new_str));
+            break;
+        default:
+            assert(!"Unknown memoized string kind");
+            return NULL;
+    }
+
+    return hidrd_memo_put(&xml_snk->memo, kind, key, new_str);
+}
+
+
 static bool
 xml_snk_item_main_bitmap(hidrd_xml_snk_inst    *xml_snk,
                          const hidrd_item      *item)
@@ -128,49 +225,37 @@ xml_snk_item_main(hidrd_xml_snk_inst   *xml_snk,
             return GROUP_START(
                     COLLECTION,
                     ATTR(type, STROWN,
-                         HIDRD_NUM_TO_ALT_STR2_1(
+                         TOKEN_OR_DEC(
                              item_collection_type,
-                             hidrd_item_collection_get_type(item),
-                             token, lc, dec)));
+                             hidrd_item_collection_get_type(item))));
         case HIDRD_ITEM_MAIN_TAG_END_COLLECTION:
             return GROUP_END(COLLECTION);
 
         case HIDRD_ITEM_MAIN_TAG_INPUT:
         case HIDRD_ITEM_MAIN_TAG_OUTPUT:
         case HIDRD_ITEM_MAIN_TAG_FEATURE:
-            {
-                char   *token;
-                bool    result;
-
-                assert(hidrd_item_main_tag_known(tag));
+            /* Element names are fixed by the schema - no lookup needed */
+            if (!xml_snk_element_add(
+                    xml_snk, true,
+                    (tag == HIDRD_ITEM_MAIN_TAG_INPUT)
+                        ? "input"
+                        : (tag == HIDRD_ITEM_MAIN_TAG_OUTPUT)
+                            ? "output"
+                            : "feature",
+                    XML_SNK_ELEMENT_NT_NONE))
+                return false;
 
-                token = hidrd_item_main_tag_to_token(tag);
-                assert(token != NULL || errno != 0);
-                if (token == NULL)
-                {
-                    XML_ERR("failed to allocate a main tag token");
-                    return false;
-                }
-                token = hidrd_str_lc(token);
-                result = xml_snk_element_add(xml_snk, true, token,
-                                             XML_SNK_ELEMENT_NT_NONE);
-                free(token);
-                if (!result)
-                    return false;
+            if (!xml_snk_item_main_bitmap(xml_snk, item))
+                return false;
 
-                if (!xml_snk_item_main_bitmap(xml_snk, item))
-                    return false;
+            xml_snk->prnt = xml_snk->prnt->parent;
 
-                xml_snk->prnt = xml_snk->prnt->parent;
+            return true;
 
-                return true;
-            }
         default:
             return ADD_SIMPLE(
                     main,
-                    ATTR(tag, STROWN,
-                         HIDRD_NUM_TO_ALT_STR2_1(
-                             item_main_tag, tag, token, lc, dec)),
+                    ATTR(tag, STROWN, TOKEN_OR_DEC(item_main_tag, tag)),
                     CONTENT(
                         HEX,
                         /* We promise we won't change it */
@@ -190,10 +275,8 @@ xml_snk_item_unit_generic(hidrd_xml_snk_inst   *xml_snk,
 
     if (!xml_snk_element_add(xml_snk, true, "generic",
                      ATTR(system, STROWN,
-                          HIDRD_NUM_TO_ALT_STR2_1(
-                              unit_system,
-                              hidrd_unit_get_system(unit),
-                              token, lc, dec)),
+                          TOKEN_OR_DEC(unit_system,
+                                       hidrd_unit_get_system(unit))),
                      XML_SNK_ELEMENT_NT_NONE))
         goto cleanup;
 
@@ -404,21 +487,40 @@ xml_snk_item_global(hidrd_xml_snk_inst *xml_snk,
             return xml_snk_item_unit(xml_snk, item);
 
         case HIDRD_ITEM_GLOBAL_TAG_USAGE_PAGE:
-            xml_snk->state->usage_page =
-                hidrd_item_usage_page_get_value(item);
-            return ADD_SIMPLE(
-                    usage_page,
-                    CONTENT(STROWN,
-                            HIDRD_NUM_TO_ALT_STR2_1(
-                                usage_page,
-                                hidrd_item_usage_page_get_value(item),
-                                token, lc, hex)),
-                    COMMENT(STROWN,
-                            hidrd_str_apada(
-                                hidrd_str_uc_first(
-                                    hidrd_usage_page_desc_str(
-                                        hidrd_item_usage_page_get_value(
-                                            item))))));
+            {
+                hidrd_usage_page    page    =
+                                        hidrd_item_usage_page_get_value(item);
+                const char         *token;
+                const char         *comment;
+
+                xml_snk->state->usage_page = page;
+
+                token = xml_snk_item_memo(xml_snk,
+                                          XML_SNK_ITEM_MEMO_PAGE_TOKEN,
+                                          page);
+                if (token == NULL)
+                {
+                    XML_ERR("failed to format usage page");
+                    return false;
+                }
+
+                /* Skip description lookup if comments are disabled */
+                if (!xml_snk->comments)
+                    return ADD_SIMPLE(usage_page, CONTENT(STRDUP, token));
+
+                comment = xml_snk_item_memo(xml_snk,
+                                            XML_SNK_ITEM_MEMO_PAGE_COMMENT,
+                                            page);
+                if (comment == NULL)
+                {
+                    XML_ERR("failed to format usage page");
+                    return false;
+                }
+
+                return ADD_SIMPLE(usage_page,
+                                  CONTENT(STRDUP, token),
+                                  COMMENT(STRDUP, comment));
+            }
 
         case HIDRD_ITEM_GLOBAL_TAG_PUSH:
             {
@@ -453,9 +555,7 @@ xml_snk_item_global(hidrd_xml_snk_inst *xml_snk,
         default:
             return ADD_SIMPLE(
                     global,
-                    ATTR(tag, STROWN,
-                         HIDRD_NUM_TO_ALT_STR2_1(
-                             item_global_tag, tag, token, lc, dec)),
+                    ATTR(tag, STROWN, TOKEN_OR_DEC(item_global_tag, tag)),
                     CONTENT(HEX,
                             /* We promise we won't change it */
                             hidrd_item_short_get_data((hidrd_item *)item)),
@@ -464,71 +564,57 @@ xml_snk_item_global(hidrd_xml_snk_inst *xml_snk,
 }
 
 
-static char *
-hidrd_usage_to_id_hex(hidrd_usage usage)
-{
-    return hidrd_usage_id_to_hex(hidrd_usage_get_id(usage));
-}
-
-
 static bool
 xml_snk_item_usage(hidrd_xml_snk_inst  *xml_snk,
                    const char          *name,
                    hidrd_usage          usage)
 {
-    bool    success         = false;
-    char   *token_or_hex    = NULL;
-    char   *desc            = NULL;
+    bool        local;
+    const char *token_or_hex;
+    const char *comment;
 
     if (!hidrd_usage_defined_page(usage))
         usage = hidrd_usage_set_page(usage, xml_snk->state->usage_page);
 
-    if (hidrd_usage_get_page(usage) == xml_snk->state->usage_page)
-    {
-        token_or_hex = HIDRD_NUM_TO_ALT_STR2_1(usage, usage,
-                                               token, lc, id_hex);
-        if (token_or_hex == NULL)
-            XML_ERR_CLNP("failed to convert usage to string");
-        desc = hidrd_usage_desc_id_str(usage);
-        if (desc == NULL)
-            XML_ERR_CLNP("failed to format usage description");
-    }
-    else
-    {
-        token_or_hex = HIDRD_NUM_TO_ALT_STR2_1(usage, usage,
-                                               token, lc, hex);
-        if (token_or_hex == NULL)
-            XML_ERR_CLNP("failed to convert usage to string");
-        desc = hidrd_usage_desc_str(usage);
-        if (desc == NULL)
-            XML_ERR_CLNP("failed to format usage description");
-    }
+    local = (hidrd_usage_get_page(usage) == xml_snk->state->usage_page);
 
-    if (*desc == '\0')
+    token_or_hex = xml_snk_item_memo(xml_snk,
+                                     local
+                                        ? XML_SNK_ITEM_MEMO_USAGE_ID_TOKEN
+                                        : XML_SNK_ITEM_MEMO_USAGE_TOKEN,
+                                     usage);
+    if (token_or_hex == NULL)
     {
-        success = xml_snk_element_add(xml_snk, false, name,
-                                      CONTENT(STROWN, token_or_hex),
-                                      XML_SNK_ELEMENT_NT_NONE);
-        token_or_hex = NULL;
+        XML_ERR("failed to convert usage to string");
+        return false;
     }
-    else
+
+    /* Skip description lookup if comments are disabled */
+    if (!xml_snk->comments)
+        return xml_snk_element_add(xml_snk, false, name,
+                                   CONTENT(STRDUP, token_or_hex),
+                                   XML_SNK_ELEMENT_NT_NONE);
+
+    comment = xml_snk_item_memo(xml_snk,
+                                local
+                                    ? XML_SNK_ITEM_MEMO_USAGE_ID_COMMENT
+                                    : XML_SNK_ITEM_MEMO_USAGE_COMMENT,
+                                usage);
+    if (comment == NULL)
     {
-        success = xml_snk_element_add(xml_snk, false, name,
-                                      CONTENT(STROWN, token_or_hex),
-                                      COMMENT(STROWN,
-                                              hidrd_str_apada(
-                                                hidrd_str_uc_first(desc))),
-                                      XML_SNK_ELEMENT_NT_NONE);
-        token_or_hex = NULL;
-        desc = NULL;
+        XML_ERR("failed to format usage description");
+        return false;
     }
 
-cleanup:
-
-    free(desc);
-    free(token_or_hex);
-
-    return success;
+    if (*comment == '\0')
+        return xml_snk_element_add(xml_snk, false, name,
+                                   CONTENT(STRDUP, token_or_hex),
+                                   XML_SNK_ELEMENT_NT_NONE);
+    else
+        return xml_snk_element_add(xml_snk, false, name,
+                                   CONTENT(STRDUP, token_or_hex),
+                                   COMMENT(STRDUP, comment),
+                                   XML_SNK_ELEMENT_NT_NONE);
 }
 
 
@@ -572,9 +658,7 @@ xml_snk_item_local(hidrd_xml_snk_inst  *xml_snk,
         default:
             return ADD_SIMPLE(
                     local,
-                    ATTR(tag, STROWN,
-                         HIDRD_NUM_TO_ALT_STR2_1(
-                             item_local_tag, tag, token, lc, dec)),
+                    ATTR(tag, STROWN, TOKEN_OR_DEC(item_local_tag, tag)),
                     CONTENT(HEX,
                             /* We promise we won't change it */
                             hidrd_item_short_get_data((hidrd_item *)item)),
@@ -600,10 +684,8 @@ xml_snk_item_short(hidrd_xml_snk_inst  *xml_snk,
         default:
             return ADD_SIMPLE(short,
                     ATTR(type, STROWN,
-                         HIDRD_NUM_TO_ALT_STR2_1(
-                             item_short_type,
-                             hidrd_item_short_get_type(item),
-                             token, lc, dec)),
+                         TOKEN_OR_DEC(item_short_type,
+                                      hidrd_item_short_get_type(item))),
                     ATTR(tag, STROWN,
                          hidrd_item_short_tag_to_dec(
                              hidrd_item_short_get_tag(item))),
@@ -637,10 +719,8 @@ xml_snk_item_basic(hidrd_xml_snk_inst  *xml_snk,
         default:
             return ADD_SIMPLE(basic,
                     ATTR(type, STROWN,
-                         HIDRD_NUM_TO_ALT_STR2_1(
-                             item_basic_type,
-                             hidrd_item_basic_get_type(item),
-                             token, lc, dec)),
+                         TOKEN_OR_DEC(item_basic_type,
+                                      hidrd_item_basic_get_type(item))),
                     ATTR(tag, STROWN,
                          hidrd_item_basic_tag_to_dec(
                              hidrd_item_basic_get_tag(item))),
@@ -67,12 +67,17 @@ hidrd_xml_src_init(hidrd_src *src, char **perr, const char *schema)
     if (root == NULL)
         XML_ERR_CLNP("root element not found");
 
+    /* Intern the attribute names for matching */
+    if (!xml_src_element_props_init(xml_src, doc))
+        XML_ERR_CLNP("failed to intern attribute names");
+
     /* Initialize the source */
     xml_src->doc    = doc;
     xml_src->prnt   = NULL;
     xml_src->cur    = root;
     xml_src->state  = state;
     xml_src->err    = strdup("");
+    xml_src->content = NULL;
 
     /* Own the resources */
     doc = NULL;
@@ -104,22 +109,30 @@ hidrd_xml_src_initv(hidrd_src *src, char **perr, va_list ap)
 
 
 #ifdef HIDRD_WITH_OPT
+/** Option indexes into the specification list */
+enum {
+    OPT_SCHEMA,
+    OPT_NUM
+};
+
 static const hidrd_opt_spec hidrd_xml_src_opts_spec[] = {
-    {.name  = "schema",
-     .type  = HIDRD_OPT_TYPE_STRING,
-     .req   = false,
-     .dflt  = {
-         .string = HIDRD_XML_SCHEMA_PATH
-     },
-     .desc  = "path to a schema file for input validation"},
-    {.name  = NULL}
+    [OPT_SCHEMA] =
+        {.name  = "schema",
+         .type  = HIDRD_OPT_TYPE_STRING,
+         .req   = false,
+         .dflt  = {
+             .string = HIDRD_XML_SCHEMA_PATH
+         },
+         .desc  = "path to a schema file for input validation"},
+    [OPT_NUM] =
+        {.name  = NULL}
 };
 
 static bool
 hidrd_xml_src_init_opts(hidrd_src *src, char **perr, const hidrd_opt *list)
 {
     return hidrd_xml_src_init(src, perr,
-                              hidrd_opt_list_get_string(list, "schema"));
+                              hidrd_opt_list_get_string_at(list, OPT_SCHEMA));
 }
 #endif /* HIDRD_WITH_OPT */
 
@@ -181,8 +194,12 @@ hidrd_xml_src_get(hidrd_src *src)
 
     XML_ERR_FUNC_BACKUP_DECL;
 
-    free(xml_src->err);
-    xml_src->err = strdup("");
+    /* Reset the error message, unless it's empty already */
+    if (xml_src->err == NULL || *xml_src->err != '\0')
+    {
+        free(xml_src->err);
+        xml_src->err = strdup("");
+    }
 
     XML_ERR_FUNC_SET(&xml_src->err);
 
@@ -275,6 +292,10 @@ hidrd_xml_src_clnp(hidrd_src *src)
     free(xml_src->err);
     xml_src->err = NULL;
 
+    /* Free the content copy, if there is any */
+    xmlFree(xml_src->content);
+    xml_src->content = NULL;
+
     /* Free the document, if there is any */
     if (xml_src->doc != NULL)
     {
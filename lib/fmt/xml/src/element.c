@@ -22,6 +22,7 @@
  * @author Nikolai Kondrashov <spbnick@gmail.com>
  */
 
+#include <stddef.h>
 #include "hidrd/util/hex.h"
 #include "hidrd/util/str.h"
 #include "element.h"
@@ -62,15 +63,151 @@ xml_src_element_pop_state(hidrd_xml_src_inst *xml_src)
 }
 
 
+/** Element attribute (property) description */
+typedef struct xml_src_element_prop_desc {
+    const char *name;   /**< Attribute name */
+    size_t      off;    /**< Value offset in xml_src_element_props */
+} xml_src_element_prop_desc;
+
+/** Element attribute description list, in the interned name order */
+static const xml_src_element_prop_desc
+                xml_src_element_prop_desc_list[HIDRD_XML_SRC_PROP_NUM] = {
+#define PROP(_name) \
+    {.name = #_name, .off = offsetof(xml_src_element_props, _name)}
+    PROP(size),
+    PROP(type),
+    PROP(tag),
+    PROP(open),
+    PROP(system),
+#undef PROP
+};
+
+
+bool
+xml_src_element_props_init(hidrd_xml_src_inst *xml_src, xmlDocPtr doc)
+{
+    xmlDictPtr  dict;
+    size_t      i;
+
+    assert(xml_src != NULL);
+    assert(doc != NULL);
+
+    dict = doc->dict;
+    for (i = 0; i < HIDRD_XML_SRC_PROP_NUM; i++)
+    {
+        if (dict == NULL)
+            xml_src->prop_name[i] =
+                BAD_CAST xml_src_element_prop_desc_list[i].name;
+        else
+        {
+            xml_src->prop_name[i] =
+                xmlDictLookup(dict,
+                              BAD_CAST xml_src_element_prop_desc_list[i].name,
+                              -1);
+            if (xml_src->prop_name[i] == NULL)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+void
+xml_src_element_props_retr(const hidrd_xml_src_inst    *xml_src,
+                           xmlNodePtr                   e,
+                           xml_src_element_props       *props)
+{
+    bool        interned;
+    xmlAttrPtr  attr;
+    size_t      i;
+    xmlNodePtr  text;
+    const char *value;
+
+    assert(xml_src != NULL);
+    assert(e != NULL);
+    assert(props != NULL);
+
+    memset(props, 0, sizeof(*props));
+
+    /* Names parsed into a dictionary are interned there as well */
+    interned = (xml_src->doc->dict != NULL);
+
+    for (attr = e->properties; attr != NULL; attr = attr->next)
+    {
+        for (i = 0; i < HIDRD_XML_SRC_PROP_NUM; i++)
+            if (interned
+                    ? attr->name == xml_src->prop_name[i]
+                    : xmlStrEqual(attr->name, xml_src->prop_name[i]))
+                break;
+        if (i >= HIDRD_XML_SRC_PROP_NUM)
+            continue;
+
+        /* Only a value of a single text node can be read in place */
+        text = attr->children;
+        if (text == NULL)
+            value = "";
+        else if (text->type == XML_TEXT_NODE && text->next == NULL &&
+                 text->content != NULL)
+            value = (const char *)text->content;
+        else
+            value = NULL;
+
+        *(const char **)((char *)props +
+                         xml_src_element_prop_desc_list[i].off) = value;
+    }
+}
+
+
+const char *
+xml_src_element_content(hidrd_xml_src_inst *xml_src, xmlNodePtr e)
+{
+    xmlNodePtr  node;
+    xmlNodePtr  text    = NULL;
+
+    assert(xml_src != NULL);
+    assert(e != NULL);
+
+    xmlFree(xml_src->content);
+    xml_src->content = NULL;
+
+    /*
+     * Look for a single text node, skipping comments and processing
+     * instructions, such as the comments written by the XML sink
+     */
+    for (node = e->children; node != NULL; node = node->next)
+    {
+        if (node->type == XML_COMMENT_NODE || node->type == XML_PI_NODE)
+            continue;
+        if (text != NULL ||
+            (node->type != XML_TEXT_NODE &&
+             node->type != XML_CDATA_SECTION_NODE) ||
+            node->content == NULL)
+            break;
+        text = node;
+    }
+
+    if (node == NULL)
+        return (text == NULL) ? "" : (const char *)text->content;
+
+    /* Fall back to concatenating the content of all the text nodes */
+    xml_src->content = xmlNodeGetContent(e);
+
+    return (const char *)xml_src->content;
+}
+
+
 static ELEMENT(basic)
 {
     xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;
-    char       *data_str    = NULL;
+    const char *data_str    = NULL;
 
     ELEMENT_PROP_DECL(item_basic_data_bytes,    size);
     ELEMENT_PROP_DECL(item_basic_type,          type);
     ELEMENT_PROP_DECL(item_basic_tag,           tag);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR(item_basic_data_bytes,    size,   dec);
     ELEMENT_PROP_RETR_ALT2(item_basic_type,     type,   token, dec);
     ELEMENT_PROP_RETR(item_basic_tag,           tag,    dec);
@@ -78,7 +215,7 @@ static ELEMENT(basic)
     hidrd_item_basic_init(item, type, tag,
                           hidrd_item_basic_data_size_from_bytes(size));
 
-    data_str = (char *)xmlNodeGetContent(e);
+    data_str = xml_src_element_content(xml_src, e);
     if (data_str == NULL)
         ELEMENT_CONTENT_RETR_ERR_CLNP("basic");
     memset(item + HIDRD_ITEM_BASIC_MIN_SIZE, 0,
@@ -96,29 +233,26 @@ static ELEMENT(basic)
 
 cleanup:
 
-    xmlFree(data_str);
-    ELEMENT_PROP_CLNP(tag);
-    ELEMENT_PROP_CLNP(type);
-    ELEMENT_PROP_CLNP(size);
-
     return result_rc;
 }
 
 static ELEMENT(short)
 {
     xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;
-    char               *data_str    = NULL;
+    const char         *data_str    = NULL;
     size_t              data_len;
 
     ELEMENT_PROP_DECL(item_short_type,  type);
     ELEMENT_PROP_DECL(item_short_tag,   tag);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR_ALT2(item_short_type, type, token, dec);
     ELEMENT_PROP_RETR(item_short_tag, tag, dec);
 
     hidrd_item_short_init(item, type, tag);
 
-    data_str = (char *)xmlNodeGetContent(e);
+    data_str = xml_src_element_content(xml_src, e);
     if (data_str == NULL)
         ELEMENT_CONTENT_RETR_ERR_CLNP("short");
     memset(hidrd_item_short_get_data(item), 0,
@@ -138,26 +272,24 @@ static ELEMENT(short)
 
 cleanup:
 
-    xmlFree(data_str);
-    ELEMENT_PROP_CLNP(tag);
-    ELEMENT_PROP_CLNP(type);
-
     return result_rc;
 }
 
 static ELEMENT(main)
 {
     xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;
-    char               *data_str    = NULL;
+    const char         *data_str    = NULL;
     size_t              data_len;
 
     ELEMENT_PROP_DECL(item_main_tag, tag);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR_ALT2(item_main_tag, tag, token, dec);
 
     hidrd_item_main_init(item, tag);
 
-    data_str = (char *)xmlNodeGetContent(e);
+    data_str = xml_src_element_content(xml_src, e);
     if (data_str == NULL)
         ELEMENT_CONTENT_RETR_ERR_CLNP("main");
     memset(hidrd_item_short_get_data(item), 0,
@@ -177,25 +309,24 @@ static ELEMENT(main)
 
 cleanup:
 
-    xmlFree(data_str);
-    ELEMENT_PROP_CLNP(tag);
-
     return result_rc;
 }
 
 static ELEMENT(global)
 {
     xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;
-    char               *data_str    = NULL;
+    const char         *data_str    = NULL;
     size_t              data_len;
 
     ELEMENT_PROP_DECL(item_global_tag, tag);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR_ALT2(item_global_tag, tag, token, dec);
 
     hidrd_item_global_init(item, tag);
 
-    data_str = (char *)xmlNodeGetContent(e);
+    data_str = xml_src_element_content(xml_src, e);
     if (data_str == NULL)
         ELEMENT_CONTENT_RETR_ERR_CLNP("global");
     memset(hidrd_item_short_get_data(item), 0,
@@ -215,19 +346,16 @@ static ELEMENT(global)
 
 cleanup:
 
-    xmlFree(data_str);
-    ELEMENT_PROP_CLNP(tag);
-
     return result_rc;
 }
 
 static ELEMENT(usage_page)
 {
     xml_src_element_rc      result_rc   = XML_SRC_ELEMENT_RC_ERROR;
-    char                   *value_str   = NULL;
+    const char             *value_str   = NULL;
     hidrd_usage_page        value;
 
-    value_str = (char *)xmlNodeGetContent(e);
+    value_str = xml_src_element_content(xml_src, e);
     if (value_str == NULL)
         ELEMENT_CONTENT_RETR_ERR_CLNP("usage_page");
     if (!HIDRD_NUM_FROM_ALT_STR2(usage_page, &value, value_str, token, hex))
@@ -241,8 +369,6 @@ static ELEMENT(usage_page)
 
 cleanup:
 
-    xmlFree(value_str);
-
     return result_rc;
 }
 
@@ -288,16 +414,18 @@ static ELEMENT_EXIT(PUSH)
 static ELEMENT(local)
 {
     xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;
-    char               *data_str    = NULL;
+    const char         *data_str    = NULL;
     size_t              data_len;
 
     ELEMENT_PROP_DECL(item_local_tag,    tag);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR_ALT2(item_local_tag, tag, token, dec);
 
     hidrd_item_local_init(item, tag);
 
-    data_str = (char *)xmlNodeGetContent(e);
+    data_str = xml_src_element_content(xml_src, e);
     if (data_str == NULL)
         ELEMENT_CONTENT_RETR_ERR_CLNP("local");
     memset(hidrd_item_short_get_data(item), 0,
@@ -317,9 +445,6 @@ static ELEMENT(local)
 
 cleanup:
 
-    xmlFree(data_str);
-    ELEMENT_PROP_CLNP(tag);
-
     return result_rc;
 }
 
@@ -328,7 +453,9 @@ static ELEMENT(collection)
     xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;
 
     ELEMENT_PROP_DECL(item_collection_type, type);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR_ALT2(item_collection_type, type, token, dec);
 
     hidrd_item_collection_init(item, type);
@@ -337,7 +464,6 @@ static ELEMENT(collection)
 
 cleanup:
 
-    ELEMENT_PROP_CLNP(type);
     return result_rc;
 }
 
@@ -353,7 +479,9 @@ static ELEMENT(COLLECTION)
     xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;
 
     ELEMENT_PROP_DECL(item_collection_type, type);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR_ALT2(item_collection_type, type, token, dec);
 
     hidrd_item_collection_init(item, type);
@@ -362,7 +490,6 @@ static ELEMENT(COLLECTION)
 
 cleanup:
 
-    ELEMENT_PROP_CLNP(type);
     return result_rc;
 }
 
@@ -377,10 +504,10 @@ static ELEMENT_EXIT(COLLECTION)
     ELEMENT(_name)                                                      \
     {                                                                   \
         xml_src_element_rc      result_rc   = XML_SRC_ELEMENT_RC_ERROR; \
-        char                   *value_str   = NULL;                     \
+        const char             *value_str   = NULL;                     \
         HIDRD_NUM_##_t##_TYPE   value;                                  \
                                                                         \
-        value_str = (char *)xmlNodeGetContent(e);                       \
+        value_str = xml_src_element_content(xml_src, e);                \
         if (value_str == NULL)                                          \
             ELEMENT_CONTENT_RETR_ERR_CLNP(#_name);                      \
         if (!HIDRD_DEC_FROM_STR(_t, &value, value_str))                 \
@@ -392,8 +519,6 @@ static ELEMENT_EXIT(COLLECTION)
                                                                         \
     cleanup:                                                            \
                                                                         \
-        xmlFree(value_str);                                             \
-                                                                        \
         return result_rc;                                               \
     }
 
@@ -410,10 +535,10 @@ static NUM_ELEMENT(report_id,          u8)
     ELEMENT(_name)                                                      \
     {                                                                   \
         xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;     \
-        char               *value_str   = NULL;                         \
+        const char         *value_str   = NULL;                         \
         hidrd_usage         value;                                      \
                                                                         \
-        value_str = (char *)xmlNodeGetContent(e);                       \
+        value_str = xml_src_element_content(xml_src, e);                \
         if (value_str == NULL)                                          \
             ELEMENT_CONTENT_RETR_ERR_CLNP(#_name);                      \
         if (!HIDRD_NUM_FROM_ALT_STR2(usage, &value, value_str,          \
@@ -431,8 +556,6 @@ static NUM_ELEMENT(report_id,          u8)
                                                                         \
     cleanup:                                                            \
                                                                         \
-        xmlFree(value_str);                                             \
-                                                                        \
         return result_rc;                                               \
     }
 
@@ -452,7 +575,9 @@ static ELEMENT(delimiter)
     xml_src_element_rc  result_rc   = XML_SRC_ELEMENT_RC_ERROR;
 
     ELEMENT_PROP_DECL(item_delimiter_set, open);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR(item_delimiter_set, open,   bool_str);
 
     hidrd_item_delimiter_init(item, open);
@@ -461,7 +586,6 @@ static ELEMENT(delimiter)
 
 cleanup:
 
-    ELEMENT_PROP_CLNP(open);
     return result_rc;
 }
 
@@ -484,16 +608,18 @@ static ELEMENT_EXIT(SET)
 static ELEMENT(long)
 {
     xml_src_element_rc  result_rc       = XML_SRC_ELEMENT_RC_ERROR;
-    char               *data_str        = NULL;
+    const char         *data_str        = NULL;
     size_t              data_len;
 
     ELEMENT_PROP_DECL(item_long_tag,    tag);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR(item_long_tag,    tag,    dec);
 
     hidrd_item_long_init(item, tag);
 
-    data_str = (char *)xmlNodeGetContent(e);
+    data_str = xml_src_element_content(xml_src, e);
     if (data_str == NULL)
         ELEMENT_CONTENT_RETR_ERR_CLNP("long");
     memset(hidrd_item_long_get_data(item), 0,
@@ -512,9 +638,6 @@ static ELEMENT(long)
 
 cleanup:
 
-    xmlFree(data_str);
-    ELEMENT_PROP_CLNP(tag);
-
     return result_rc;
 }
 
@@ -113,6 +113,15 @@ typedef xml_src_element_rc xml_src_element_fn(hidrd_xml_src_inst   *xml_src,
                                    hidrd_item          *item,   \
                                    xmlNodePtr           e)
 
+/** In-place element attribute (property) values, NULL if missing */
+typedef struct xml_src_element_props {
+    const char *size;   /**< "size" attribute value */
+    const char *type;   /**< "type" attribute value */
+    const char *tag;    /**< "tag" attribute value */
+    const char *open;   /**< "open" attribute value */
+    const char *system; /**< "system" attribute value */
+} xml_src_element_props;
+
 /**
  * Generate element property variable declarations.
  *
@@ -120,9 +129,21 @@ typedef xml_src_element_rc xml_src_element_fn(hidrd_xml_src_inst   *xml_src,
  * @param _name Property name token.
  */
 #define ELEMENT_PROP_DECL(_type, _name) \
-    char           *_name##_str = NULL; \
     hidrd_##_type   _name
 
+/**
+ * Generate element property value list declaration.
+ */
+#define ELEMENT_PROPS_DECL \
+    xml_src_element_props   props
+
+/**
+ * Generate element property value list retrieval, walking the element
+ * attributes once.
+ */
+#define ELEMENT_PROPS_RETR \
+    xml_src_element_props_retr(xml_src, e, &props)
+
 /**
  * Generate element property value retrieval from a single representation.
  *
@@ -132,10 +153,9 @@ typedef xml_src_element_rc xml_src_element_fn(hidrd_xml_src_inst   *xml_src,
  */
 #define ELEMENT_PROP_RETR(_type, _name, _repr) \
     do {                                                        \
-        _name##_str = (char *)xmlGetProp(e, BAD_CAST #_name);   \
-        if (_name##_str == NULL)                                \
+        if (props._name == NULL)                                \
             ELEMENT_PROP_RETR_ERR_CLNP(#_name);                 \
-        if (!hidrd_##_type##_from_##_repr(&_name, _name##_str)) \
+        if (!hidrd_##_type##_from_##_repr(&_name, props._name)) \
             ELEMENT_PROP_PRSE_ERR_CLNP(#_name);                 \
     } while (0)
 
@@ -151,21 +171,51 @@ typedef xml_src_element_rc xml_src_element_fn(hidrd_xml_src_inst   *xml_src,
  */
 #define ELEMENT_PROP_RETR_ALT2(_type, _name, _repr1, _repr2) \
     do {                                                            \
-        _name##_str = (char *)xmlGetProp(e, BAD_CAST #_name);       \
-        if (_name##_str == NULL)                                    \
+        if (props._name == NULL)                                    \
             ELEMENT_PROP_RETR_ERR_CLNP(#_name);                     \
-        if (!HIDRD_NUM_FROM_ALT_STR2(_type, &_name, _name##_str,    \
+        if (!HIDRD_NUM_FROM_ALT_STR2(_type, &_name, props._name,    \
                                      _repr1, _repr2))               \
             ELEMENT_PROP_PRSE_ERR_CLNP(#_name);                     \
     } while (0)
 
 /**
- * Generate element property cleanup code (a call to xmlFree).
+ * Intern the element attribute names in a document dictionary.
  *
- * @param _name Property name token.
+ * @param xml_src   XML source instance to store the interned names in.
+ * @param doc       Document to be read by the source.
+ *
+ * @return True if interned successfully, false otherwise.
+ */
+extern bool xml_src_element_props_init(hidrd_xml_src_inst  *xml_src,
+                                       xmlDocPtr            doc);
+
+/**
+ * Retrieve element attribute values in place, walking the attribute list
+ * once. The values point into the document.
+ *
+ * @param xml_src   XML source instance.
+ * @param e         Element to retrieve attribute values of.
+ * @param props     Location for the attribute values; values of missing
+ *                  attributes, or attributes which cannot be read in
+ *                  place, are set to NULL.
+ */
+extern void xml_src_element_props_retr(const hidrd_xml_src_inst *xml_src,
+                                       xmlNodePtr                e,
+                                       xml_src_element_props    *props);
+
+/**
+ * Retrieve element text content, reading it in place from the only child
+ * text node, not counting comments and processing instructions, if
+ * possible.
+ *
+ * @param xml_src   XML source instance; keeps the content copy, if one is
+ *                  needed, until the next call.
+ * @param e         Element to retrieve content of.
+ *
+ * @return Element content, or NULL if failed.
  */
-#define ELEMENT_PROP_CLNP(_name) \
-    xmlFree(_name##_str)
+extern const char *xml_src_element_content(hidrd_xml_src_inst  *xml_src,
+                                           xmlNodePtr           e);
 
 /**
  * Handle an element.
@@ -54,13 +54,14 @@ MBMD(input,  &mbd0, &mbd1, &mbd2, &mbd3, &mbd4, &mbd5, &mbd6, NULL,  &mbd8);
 MBMD(output, &mbd0, &mbd1, &mbd2, &mbd3, &mbd4, &mbd5, &mbd6, &mbd7, &mbd8);
 #define feature_bmd output_bmd
 
-static bool parse_bitmap_element(uint32_t                  *pbitmap,
+static bool parse_bitmap_element(hidrd_xml_src_inst        *xml_src,
+                                 uint32_t                  *pbitmap,
                                  xmlNodePtr                 e,
                                  const main_bitmap_desc     bmd)
 {
     bool        result      = false;
     uint32_t    bitmap      = 0;
-    char       *data_str    = NULL;
+    const char *data_str;
     bool        data;
     bool        matched;
     size_t      i;
@@ -71,15 +72,13 @@ static bool parse_bitmap_element(uint32_t                  *pbitmap,
         if (e->type != XML_ELEMENT_NODE)
             continue;
 
-        data_str = (char *)xmlNodeGetContent(e);
+        data_str = xml_src_element_content(xml_src, e);
         if (data_str == NULL)
             ELEMENT_CONTENT_RETR_ERR_CLNP((const char *)e->name);
         if (hidrd_str_isblank(data_str))
             data = true;
         else if (!hidrd_bool_from_str(&data, data_str))
             ELEMENT_CONTENT_PRSE_ERR_CLNP((const char *)e->name);
-        xmlFree(data_str);
-        data_str = NULL;
 
         for (matched = false; !matched; i++)
         {
@@ -110,8 +109,6 @@ static bool parse_bitmap_element(uint32_t                  *pbitmap,
 
 cleanup:
 
-    xmlFree(data_str);
-
     return result;
 }
 
@@ -120,9 +117,8 @@ cleanup:
     {                                                       \
         uint32_t    bitmap;                                 \
                                                             \
-        (void)xml_src;                                      \
-                                                            \
-        if (!parse_bitmap_element(&bitmap, e, _name##_bmd)) \
+        if (!parse_bitmap_element(xml_src, &bitmap,         \
+                                  e, _name##_bmd))          \
             return XML_SRC_ELEMENT_RC_ERROR;                \
                                                             \
         hidrd_item_##_name##_init(item, bitmap);            \
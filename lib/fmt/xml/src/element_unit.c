@@ -45,7 +45,8 @@ static const unit_system_desc  english_rotation_usd = {
 };
 
 static bool
-parse_unit_system_element(hidrd_unit               *punit,
+parse_unit_system_element(hidrd_xml_src_inst       *xml_src,
+                          hidrd_unit               *punit,
                           const unit_system_desc    usd,
                           xmlNodePtr                e)
 {
@@ -53,7 +54,7 @@ parse_unit_system_element(hidrd_unit               *punit,
     hidrd_unit      unit    = HIDRD_UNIT_NONE;
     size_t          i;
     bool            matched;
-    char           *exp_str = NULL;
+    const char     *exp_str;
     hidrd_unit_exp  exp;
 
     for (i = 0, e = e->children; e != NULL; e = e->next)
@@ -69,15 +70,13 @@ parse_unit_system_element(hidrd_unit               *punit,
             if (strcmp(usd[i], (const char *)e->name) != 0)
                 continue;
 
-            exp_str = (char *)xmlNodeGetContent(e);
+            exp_str = xml_src_element_content(xml_src, e);
             if (exp_str == NULL)
                 ELEMENT_CONTENT_RETR_ERR_CLNP((const char *)e->name);
             if (hidrd_str_isblank(exp_str))
                 exp = HIDRD_UNIT_EXP_1;
             else if (!hidrd_unit_exp_from_dec(&exp, exp_str))
                 ELEMENT_CONTENT_PRSE_ERR_CLNP((const char *)e->name);
-            xmlFree(exp_str);
-            exp_str = NULL;
 
             unit = hidrd_unit_set_nibble(
                             unit,
@@ -94,23 +93,25 @@ parse_unit_system_element(hidrd_unit               *punit,
 
 cleanup:
 
-    xmlFree(exp_str);
-
     return result;
 }
 
 
 static bool
-parse_unit_system_gen_element(hidrd_unit *punit, xmlNodePtr e)
+parse_unit_system_gen_element(hidrd_xml_src_inst   *xml_src,
+                              hidrd_unit           *punit,
+                              xmlNodePtr            e)
 {
     bool        result  = false;
     hidrd_unit  unit;
     
     ELEMENT_PROP_DECL(unit_system, system);
+    ELEMENT_PROPS_DECL;
 
+    ELEMENT_PROPS_RETR;
     ELEMENT_PROP_RETR_ALT2(unit_system, system, token, dec);
 
-    if (!parse_unit_system_element(&unit, generic_usd, e))
+    if (!parse_unit_system_element(xml_src, &unit, generic_usd, e))
         goto cleanup;
 
     unit = hidrd_unit_set_system(unit, system);
@@ -122,8 +123,6 @@ parse_unit_system_gen_element(hidrd_unit *punit, xmlNodePtr e)
 
 cleanup:
 
-    ELEMENT_PROP_CLNP(system);
-
     return result;
 }
 
@@ -140,7 +139,8 @@ static const unit_system_desc
 };
 
 static bool
-parse_unit_system_spec_element(hidrd_unit          *punit,
+parse_unit_system_spec_element(hidrd_xml_src_inst  *xml_src,
+                               hidrd_unit          *punit,
                                hidrd_unit_system    system,
                                xmlNodePtr           e)
 {
@@ -150,7 +150,7 @@ parse_unit_system_spec_element(hidrd_unit          *punit,
     assert(hidrd_unit_system_known(system));
 
     if (!parse_unit_system_element(
-                &unit,
+                xml_src, &unit,
                 *known_system_list[system - HIDRD_UNIT_SYSTEM_KNOWN_MIN],
                 e))
         return false;
@@ -165,13 +165,15 @@ parse_unit_system_spec_element(hidrd_unit          *punit,
 
 
 static bool
-parse_unit_value_element(hidrd_unit *punit, xmlNodePtr e)
+parse_unit_value_element(hidrd_xml_src_inst    *xml_src,
+                         hidrd_unit            *punit,
+                         xmlNodePtr             e)
 {
     bool        result      = false;
     uint32_t    unit        = 0;
-    char       *data_str    = NULL;
+    const char *data_str;
 
-    data_str = (char *)xmlNodeGetContent(e);
+    data_str = xml_src_element_content(xml_src, e);
     if (data_str == NULL)
         ELEMENT_CONTENT_RETR_ERR_CLNP((const char *)e->name);
     if (!hidrd_hex_buf_from_str(&unit, sizeof(unit),
@@ -185,8 +187,6 @@ parse_unit_value_element(hidrd_unit *punit, xmlNodePtr e)
 
 cleanup:
 
-    xmlFree(data_str);
-
     return result;
 }
 
@@ -195,8 +195,6 @@ ELEMENT(unit)
 {
     hidrd_unit          unit;
 
-    (void)xml_src;
-
     /* Lookup first element */
     for (e = e->children;
          e != NULL && e->type != XML_ELEMENT_NODE;
@@ -216,18 +214,18 @@ ELEMENT(unit)
     }
     else if (MATCH(value))
     {
-        if (parse_unit_value_element(&unit, e))
+        if (parse_unit_value_element(xml_src, &unit, e))
             goto finish;
     }
     else if (MATCH(generic))
     {
-        if (parse_unit_system_gen_element(&unit, e))
+        if (parse_unit_system_gen_element(xml_src, &unit, e))
             goto finish;
     }
 #define MAP(_NAME, _name) \
     else if (MATCH(_name))                                              \
     {                                                                   \
-        if (parse_unit_system_spec_element(&unit,                       \
+        if (parse_unit_system_spec_element(xml_src, &unit,              \
                                            HIDRD_UNIT_SYSTEM_##_NAME,   \
                                            e))                          \
             goto finish;                                                \
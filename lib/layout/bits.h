@@ -0,0 +1,96 @@
+/** @file
+ * @brief HID report descriptor - report layout - report bit access
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#ifndef __LAYOUT_BITS_H__
+#define __LAYOUT_BITS_H__
+
+#include <stdint.h>
+#include <string.h>
+#include <endian.h>
+
+/**
+ * Load a little-endian 64-bit word from a buffer at specified byte offset,
+ * padding it with zeroes past the buffer end.
+ *
+ * @param buf   Buffer to load from.
+ * @param len   Buffer length.
+ * @param off   Offset of the first byte to load.
+ *
+ * @return The loaded word.
+ */
+static inline uint64_t
+layout_bits_load(const uint8_t *buf, size_t len, size_t off)
+{
+    uint64_t    word;
+    size_t      i;
+
+    if (off + sizeof(word) <= len)
+    {
+        memcpy(&word, buf + off, sizeof(word));
+        return le64toh(word);
+    }
+
+    for (word = 0, i = len; i > off; i--)
+        word = (word << 8) | buf[i - 1];
+
+    return word;
+}
+
+/**
+ * Store a value into a bit range of a buffer, keeping the surrounding
+ * bits intact.
+ *
+ * @param buf   Buffer to store to.
+ * @param len   Buffer length; the bit range must fit into it.
+ * @param bit   Offset of the first bit of the range.
+ * @param mask  Mask of the value bits, at most 32 bits wide.
+ * @param value Value to store; bits outside the mask are ignored.
+ */
+static inline void
+layout_bits_store(uint8_t  *buf,
+                  size_t    len,
+                  uint32_t  bit,
+                  uint64_t  mask,
+                  uint32_t  value)
+{
+    size_t      off     = bit >> 3;
+    unsigned    shift   = bit & 7;
+    uint64_t    word;
+    size_t      i;
+
+    word = layout_bits_load(buf, len, off);
+    word = (word & ~(mask << shift)) | ((value & mask) << shift);
+
+    if (off + sizeof(word) <= len)
+    {
+        word = htole64(word);
+        memcpy(buf + off, &word, sizeof(word));
+        return;
+    }
+
+    for (i = off; i < len; i++, word >>= 8)
+        buf[i] = (uint8_t)word;
+}
+
+#endif /* __LAYOUT_BITS_H__ */
@@ -0,0 +1,524 @@
+/** @file
+ * @brief HID report descriptor - report layout - on-disk cache
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hidrd/util/fd.h"
+#include "hidrd/layout/cache.h"
+#include "bits.h"
+
+/** Layout cache builder entry */
+typedef struct hidrd_layout_cache_bld_ent {
+    uint64_t        hash;       /**< Descriptor hash */
+    void           *desc;       /**< Native descriptor copy */
+    size_t          desc_size;  /**< Native descriptor size */
+    hidrd_layout   *layout;     /**< Layout copy */
+} hidrd_layout_cache_bld_ent;
+
+/**
+ * Align a cache file offset to 8 bytes.
+ *
+ * @param off   Offset to align.
+ *
+ * @return Aligned offset.
+ */
+static inline size_t
+hidrd_layout_cache_align(size_t off)
+{
+    return (off + 7) & ~(size_t)7;
+}
+
+
+uint64_t
+hidrd_layout_cache_hash(const void *desc, size_t size)
+{
+    const uint8_t  *p       = (const uint8_t *)desc;
+    uint64_t        hash    = UINT64_C(0x9E3779B97F4A7C15) ^ size;
+    size_t          off;
+
+    assert(desc != NULL || size == 0);
+
+    /* Mix a little-endian word at a time, zero-padding the last one */
+    for (off = 0; off < size; off += 8)
+    {
+        hash = (hash ^ layout_bits_load(p, size, off)) *
+               UINT64_C(0xFF51AFD7ED558CCD);
+        hash ^= hash >> 32;
+    }
+
+    hash ^= hash >> 33;
+    hash *= UINT64_C(0xC4CEB9FE1A85EC53);
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+
+/**
+ * Check if a list is within a cache file.
+ *
+ * @param hdr   Cache file header.
+ * @param off   List offset, in bytes.
+ * @param num   Number of list entries.
+ * @param size  Size of a list entry.
+ *
+ * @return True if the list is within the file, false otherwise.
+ */
+static bool
+hidrd_layout_cache_list_valid(const hidrd_layout_cache_hdr *hdr,
+                              uint32_t                      off,
+                              uint64_t                      num,
+                              size_t                        size)
+{
+    return off >= sizeof(*hdr) &&
+           off % 8 == 0 &&
+           off <= hdr->size &&
+           num <= (hdr->size - off) / size;
+}
+
+
+bool
+hidrd_layout_cache_valid(const hidrd_layout_cache *cache)
+{
+    const hidrd_layout_cache_hdr   *hdr;
+
+    if (cache == NULL || cache->hdr == NULL ||
+        cache->size < sizeof(*cache->hdr))
+        return false;
+
+    hdr = cache->hdr;
+
+    return memcmp(hdr->magic, HIDRD_LAYOUT_CACHE_MAGIC,
+                  sizeof(HIDRD_LAYOUT_CACHE_MAGIC)) == 0 &&
+           hdr->version == HIDRD_LAYOUT_CACHE_VERSION &&
+           hdr->size == cache->size &&
+           hdr->bucket_log2 < 32 &&
+           hidrd_layout_cache_list_valid(hdr, hdr->bucket_off,
+                                         (UINT64_C(1) <<
+                                          hdr->bucket_log2) + 1,
+                                         sizeof(uint32_t)) &&
+           hidrd_layout_cache_list_valid(hdr, hdr->ent_off, hdr->ent_num,
+                                         sizeof(hidrd_layout_cache_ent));
+}
+
+
+bool
+hidrd_layout_cache_load(hidrd_layout_cache *cache, const char *path)
+{
+    int         fd;
+    struct stat st;
+    void       *map;
+    int         orig_errno;
+
+    assert(cache != NULL);
+    assert(path != NULL);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &st) != 0)
+        goto fail;
+    if (st.st_size < (off_t)sizeof(hidrd_layout_cache_hdr) ||
+        st.st_size > (off_t)UINT32_MAX)
+    {
+        errno = EINVAL;
+        goto fail;
+    }
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        goto fail;
+    close(fd);
+
+    cache->hdr = (const hidrd_layout_cache_hdr *)map;
+    cache->size = st.st_size;
+    if (!hidrd_layout_cache_valid(cache))
+    {
+        hidrd_layout_cache_unload(cache);
+        errno = EINVAL;
+        return false;
+    }
+
+    return true;
+
+fail:
+
+    orig_errno = errno;
+    close(fd);
+    errno = orig_errno;
+    return false;
+}
+
+
+void
+hidrd_layout_cache_unload(hidrd_layout_cache *cache)
+{
+    assert(cache != NULL);
+
+    if (cache->hdr != NULL)
+        munmap((void *)cache->hdr, cache->size);
+    cache->hdr = NULL;
+    cache->size = 0;
+}
+
+
+/**
+ * Retrieve the layout of a cache entry, checking its bounds.
+ *
+ * @param cache Cache containing the entry.
+ * @param ent   Entry to retrieve the layout of.
+ *
+ * @return The layout, or NULL if the entry is invalid.
+ */
+static const hidrd_layout *
+hidrd_layout_cache_ent_layout(const hidrd_layout_cache     *cache,
+                              const hidrd_layout_cache_ent *ent)
+{
+    const hidrd_layout *layout;
+
+    if (ent->layout_off % 8 != 0 ||
+        ent->layout_off > cache->size ||
+        ent->layout_size > cache->size - ent->layout_off ||
+        ent->layout_size < sizeof(*layout))
+        return NULL;
+
+    layout = (const hidrd_layout *)
+                ((const uint8_t *)cache->hdr + ent->layout_off);
+
+    return (layout->size == ent->layout_size &&
+            hidrd_layout_valid(layout))
+                ? layout
+                : NULL;
+}
+
+
+/**
+ * Check if a cache entry is of a descriptor.
+ *
+ * @param cache Cache containing the entry.
+ * @param ent   Entry to check.
+ * @param hash  Descriptor hash.
+ * @param desc  Native descriptor.
+ * @param size  Native descriptor size.
+ *
+ * @return True if the entry is of the descriptor, false otherwise.
+ */
+static bool
+hidrd_layout_cache_ent_match(const hidrd_layout_cache      *cache,
+                             const hidrd_layout_cache_ent  *ent,
+                             uint64_t                       hash,
+                             const void                    *desc,
+                             size_t                         size)
+{
+    return ent->hash == hash &&
+           ent->desc_size == size &&
+           ent->desc_off <= cache->size &&
+           size <= cache->size - ent->desc_off &&
+           (size == 0 ||
+            memcmp((const uint8_t *)cache->hdr + ent->desc_off,
+                   desc, size) == 0);
+}
+
+
+const hidrd_layout *
+hidrd_layout_cache_lookup(const hidrd_layout_cache *cache,
+                          const void               *desc,
+                          size_t                    size)
+{
+    const hidrd_layout_cache_hdr   *hdr;
+    const uint32_t                 *bucket_list;
+    const hidrd_layout_cache_ent   *ent_list;
+    uint64_t                        hash;
+    uint32_t                        bucket;
+    uint32_t                        i;
+    uint32_t                        end;
+
+    assert(hidrd_layout_cache_valid(cache));
+    assert(desc != NULL || size == 0);
+
+    hdr = cache->hdr;
+    bucket_list = (const uint32_t *)((const uint8_t *)hdr + hdr->bucket_off);
+    ent_list = (const hidrd_layout_cache_ent *)
+                    ((const uint8_t *)hdr + hdr->ent_off);
+
+    hash = hidrd_layout_cache_hash(desc, size);
+    bucket = (uint32_t)(hash & ((UINT64_C(1) << hdr->bucket_log2) - 1));
+    end = bucket_list[bucket + 1];
+    if (end > hdr->ent_num)
+        return NULL;
+
+    for (i = bucket_list[bucket]; i < end; i++)
+        if (hidrd_layout_cache_ent_match(cache, ent_list + i,
+                                         hash, desc, size))
+            return hidrd_layout_cache_ent_layout(cache, ent_list + i);
+
+    return NULL;
+}
+
+
+void
+hidrd_layout_cache_bld_init(hidrd_layout_cache_bld *bld)
+{
+    assert(bld != NULL);
+    hidrd_buf_init(&bld->ent);
+}
+
+
+bool
+hidrd_layout_cache_bld_valid(const hidrd_layout_cache_bld *bld)
+{
+    return bld != NULL &&
+           hidrd_buf_valid(&bld->ent) &&
+           bld->ent.len % sizeof(hidrd_layout_cache_bld_ent) == 0;
+}
+
+
+bool
+hidrd_layout_cache_bld_add(hidrd_layout_cache_bld  *bld,
+                           const void              *desc,
+                           size_t                   size,
+                           const hidrd_layout      *layout)
+{
+    hidrd_layout_cache_bld_ent  ent;
+    hidrd_layout_cache_bld_ent *p;
+    hidrd_layout_cache_bld_ent *end;
+
+    assert(hidrd_layout_cache_bld_valid(bld));
+    assert(desc != NULL || size == 0);
+    assert(hidrd_layout_valid(layout));
+
+    ent.hash = hidrd_layout_cache_hash(desc, size);
+
+    /* Skip descriptors added already */
+    p = (hidrd_layout_cache_bld_ent *)bld->ent.ptr;
+    for (end = p + bld->ent.len / sizeof(*p); p < end; p++)
+        if (p->hash == ent.hash && p->desc_size == size &&
+            (size == 0 || memcmp(p->desc, desc, size) == 0))
+            return true;
+
+    ent.desc_size = size;
+    ent.desc = malloc(size == 0 ? 1 : size);
+    ent.layout = malloc(layout->size);
+    if (ent.desc == NULL || ent.layout == NULL ||
+        !hidrd_buf_add_ptr(&bld->ent, &ent, sizeof(ent)))
+    {
+        free(ent.desc);
+        free(ent.layout);
+        return false;
+    }
+    if (size != 0)
+        memcpy(ent.desc, desc, size);
+    memcpy(ent.layout, layout, layout->size);
+
+    return true;
+}
+
+
+bool
+hidrd_layout_cache_bld_add_cache(hidrd_layout_cache_bld    *bld,
+                                 const hidrd_layout_cache  *cache)
+{
+    const hidrd_layout_cache_hdr   *hdr;
+    const hidrd_layout_cache_ent   *ent;
+    const hidrd_layout_cache_ent   *end;
+    const hidrd_layout             *layout;
+
+    assert(hidrd_layout_cache_bld_valid(bld));
+    assert(hidrd_layout_cache_valid(cache));
+
+    hdr = cache->hdr;
+    ent = (const hidrd_layout_cache_ent *)
+            ((const uint8_t *)hdr + hdr->ent_off);
+    for (end = ent + hdr->ent_num; ent < end; ent++)
+    {
+        if (ent->desc_off > cache->size ||
+            ent->desc_size > cache->size - ent->desc_off)
+            continue;
+        layout = hidrd_layout_cache_ent_layout(cache, ent);
+        if (layout == NULL)
+            continue;
+        if (!hidrd_layout_cache_bld_add(bld,
+                                        (const uint8_t *)hdr +
+                                            ent->desc_off,
+                                        ent->desc_size, layout))
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Build a cache file image from a layout cache builder.
+ *
+ * @param bld   Builder to build the image from.
+ * @param psize Location for the image size.
+ *
+ * @return Dynamically allocated image, or NULL if failed (see errno in
+ *         this case).
+ */
+static void *
+hidrd_layout_cache_build(const hidrd_layout_cache_bld *bld, size_t *psize)
+{
+    const hidrd_layout_cache_bld_ent   *bld_list;
+    size_t                              num;
+    uint32_t                            log2;
+    size_t                              bucket_num;
+    size_t                              size;
+    uint8_t                            *image;
+    hidrd_layout_cache_hdr             *hdr;
+    uint32_t                           *bucket_list;
+    hidrd_layout_cache_ent             *ent_list;
+    hidrd_layout_cache_ent             *ent;
+    uint32_t                           *pos     = NULL;
+    size_t                              off;
+    size_t                              i;
+    uint32_t                            bucket;
+
+    bld_list = (const hidrd_layout_cache_bld_ent *)bld->ent.ptr;
+    num = bld->ent.len / sizeof(*bld_list);
+    for (log2 = 0; ((size_t)1 << log2) < num; log2++);
+    bucket_num = (size_t)1 << log2;
+
+    /* Lay out the file */
+    off = hidrd_layout_cache_align(sizeof(*hdr));
+    off = hidrd_layout_cache_align(off +
+                                   sizeof(uint32_t) * (bucket_num + 1));
+    off += sizeof(*ent_list) * num;
+    for (i = 0; i < num; i++)
+        off = hidrd_layout_cache_align(
+                    hidrd_layout_cache_align(off + bld_list[i].desc_size) +
+                    bld_list[i].layout->size);
+    if (off > UINT32_MAX)
+    {
+        errno = EFBIG;
+        return NULL;
+    }
+    size = off;
+
+    image = calloc(1, size);
+    pos = calloc(bucket_num + 1, sizeof(*pos));
+    if (image == NULL || pos == NULL)
+    {
+        free(image);
+        free(pos);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    hdr = (hidrd_layout_cache_hdr *)image;
+    memcpy(hdr->magic, HIDRD_LAYOUT_CACHE_MAGIC,
+           sizeof(HIDRD_LAYOUT_CACHE_MAGIC));
+    hdr->version = HIDRD_LAYOUT_CACHE_VERSION;
+    hdr->size = size;
+    hdr->bucket_log2 = log2;
+    hdr->bucket_off = hidrd_layout_cache_align(sizeof(*hdr));
+    hdr->ent_off = hidrd_layout_cache_align(
+                        hdr->bucket_off +
+                        sizeof(uint32_t) * (bucket_num + 1));
+    hdr->ent_num = num;
+    bucket_list = (uint32_t *)(image + hdr->bucket_off);
+    ent_list = (hidrd_layout_cache_ent *)(image + hdr->ent_off);
+
+    /* Count the entries of each bucket, then convert to start indexes */
+    for (i = 0; i < num; i++)
+        bucket_list[(bld_list[i].hash & (bucket_num - 1)) + 1]++;
+    for (i = 0; i < bucket_num; i++)
+        bucket_list[i + 1] += bucket_list[i];
+    memcpy(pos, bucket_list, sizeof(*pos) * bucket_num);
+
+    /* Place the entries and copy the blocks */
+    off = hdr->ent_off + sizeof(*ent_list) * num;
+    for (i = 0; i < num; i++)
+    {
+        bucket = bld_list[i].hash & (bucket_num - 1);
+        ent = ent_list + pos[bucket]++;
+        ent->hash = bld_list[i].hash;
+        ent->desc_off = off;
+        ent->desc_size = bld_list[i].desc_size;
+        memcpy(image + off, bld_list[i].desc, bld_list[i].desc_size);
+        off = hidrd_layout_cache_align(off + bld_list[i].desc_size);
+        ent->layout_off = off;
+        ent->layout_size = bld_list[i].layout->size;
+        memcpy(image + off, bld_list[i].layout, bld_list[i].layout->size);
+        off = hidrd_layout_cache_align(off + bld_list[i].layout->size);
+    }
+
+    free(pos);
+
+    *psize = size;
+    return image;
+}
+
+
+bool
+hidrd_layout_cache_store(const hidrd_layout_cache_bld  *bld,
+                         const char                    *path)
+{
+    bool    result;
+    void   *image;
+    size_t  size;
+    int     orig_errno;
+
+    assert(hidrd_layout_cache_bld_valid(bld));
+    assert(path != NULL);
+
+    image = hidrd_layout_cache_build(bld, &size);
+    if (image == NULL)
+        return false;
+
+    result = hidrd_fd_replace_whole(path, image, size);
+
+    orig_errno = errno;
+    free(image);
+    errno = orig_errno;
+
+    return result;
+}
+
+
+void
+hidrd_layout_cache_bld_clnp(hidrd_layout_cache_bld *bld)
+{
+    hidrd_layout_cache_bld_ent *p;
+    hidrd_layout_cache_bld_ent *end;
+
+    assert(hidrd_layout_cache_bld_valid(bld));
+
+    p = (hidrd_layout_cache_bld_ent *)bld->ent.ptr;
+    for (end = p + bld->ent.len / sizeof(*p); p < end; p++)
+    {
+        free(p->desc);
+        free(p->layout);
+    }
+
+    hidrd_buf_clnp(&bld->ent);
+}
@@ -0,0 +1,683 @@
+/** @file
+ * @brief HID report descriptor - report layout compiler
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "hidrd/layout/cmpl.h"
+
+/** Retrieve the number of entries in a compiler list buffer */
+#define LIST_NUM(_buf, _type) ((_buf)->len / sizeof(_type))
+
+/** Retrieve a compiler list buffer contents as a typed pointer */
+#define LIST_PTR(_buf, _type) ((_type *)(_buf)->ptr)
+
+
+bool
+hidrd_layout_cmpl_init(hidrd_layout_cmpl *cmpl)
+{
+    hidrd_layout_cmpl_state    *state;
+
+    assert(cmpl != NULL);
+
+    state = malloc(sizeof(*state));
+    if (state == NULL)
+        return false;
+    memset(state, 0, sizeof(*state));
+
+    memset(cmpl, 0, sizeof(*cmpl));
+    cmpl->state = state;
+    hidrd_buf_init(&cmpl->usage_buf);
+    hidrd_buf_init(&cmpl->report_buf);
+    hidrd_buf_init(&cmpl->field_buf);
+    memset(cmpl->report_map, 0xFF, sizeof(cmpl->report_map));
+    cmpl->err = HIDRD_LAYOUT_CMPL_ERR_NONE;
+
+    return true;
+}
+
+
+bool
+hidrd_layout_cmpl_valid(const hidrd_layout_cmpl *cmpl)
+{
+    return cmpl != NULL &&
+           cmpl->state != NULL &&
+           hidrd_buf_valid(&cmpl->usage_buf) &&
+           hidrd_buf_valid(&cmpl->report_buf) &&
+           hidrd_buf_valid(&cmpl->field_buf) &&
+           cmpl->usage_start <= LIST_NUM(&cmpl->usage_buf,
+                                         hidrd_layout_usage);
+}
+
+
+/**
+ * Add a usage list entry for the next main item.
+ *
+ * @param cmpl  Compiler to add the entry to.
+ * @param min   First usage.
+ * @param max   Last usage.
+ *
+ * @return True if added successfully, false otherwise.
+ */
+static bool
+hidrd_layout_cmpl_add_usage(hidrd_layout_cmpl  *cmpl,
+                            hidrd_usage         min,
+                            hidrd_usage         max)
+{
+    hidrd_layout_usage  usage;
+
+    /* Only the first usage of a delimiter set is used */
+    if (cmpl->delimiter &&
+        LIST_NUM(&cmpl->usage_buf, hidrd_layout_usage) >
+            cmpl->delimiter_num)
+        return true;
+
+    usage.min = (min <= max) ? min : max;
+    usage.max = (min <= max) ? max : min;
+
+    if (!hidrd_buf_add_ptr(&cmpl->usage_buf, &usage, sizeof(usage)))
+    {
+        cmpl->err = HIDRD_LAYOUT_CMPL_ERR_ALLOC;
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Resolve a local item usage against the current usage page.
+ *
+ * @param cmpl  Compiler to resolve in.
+ * @param usage Usage to resolve.
+ *
+ * @return Usage with a page.
+ */
+static hidrd_usage
+hidrd_layout_cmpl_usage(const hidrd_layout_cmpl *cmpl, hidrd_usage usage)
+{
+    return hidrd_usage_defined_page(usage)
+                ? usage
+                : hidrd_usage_set_page(usage, cmpl->state->usage_page);
+}
+
+
+static bool
+hidrd_layout_cmpl_local(hidrd_layout_cmpl  *cmpl,
+                        const hidrd_item   *item)
+{
+    switch (hidrd_item_local_get_tag(item))
+    {
+        case HIDRD_ITEM_LOCAL_TAG_USAGE:
+            {
+                hidrd_usage usage  = hidrd_layout_cmpl_usage(
+                                        cmpl,
+                                        hidrd_item_usage_get_value(item));
+
+                return hidrd_layout_cmpl_add_usage(cmpl, usage, usage);
+            }
+
+        case HIDRD_ITEM_LOCAL_TAG_USAGE_MINIMUM:
+            cmpl->usage_min = hidrd_layout_cmpl_usage(
+                                cmpl,
+                                hidrd_item_usage_minimum_get_value(item));
+            cmpl->usage_min_set = true;
+            break;
+
+        case HIDRD_ITEM_LOCAL_TAG_USAGE_MAXIMUM:
+            cmpl->usage_max = hidrd_layout_cmpl_usage(
+                                cmpl,
+                                hidrd_item_usage_maximum_get_value(item));
+            cmpl->usage_max_set = true;
+            break;
+
+        case HIDRD_ITEM_LOCAL_TAG_DELIMITER:
+            if (hidrd_item_delimiter_get_value(item) ==
+                HIDRD_ITEM_DELIMITER_SET_OPEN)
+            {
+                cmpl->delimiter = true;
+                cmpl->delimiter_num = LIST_NUM(&cmpl->usage_buf,
+                                               hidrd_layout_usage);
+            }
+            else
+                cmpl->delimiter = false;
+            break;
+
+        default:
+            break;
+    }
+
+    /* Add a complete usage range */
+    if (cmpl->usage_min_set && cmpl->usage_max_set)
+    {
+        cmpl->usage_min_set = false;
+        cmpl->usage_max_set = false;
+        return hidrd_layout_cmpl_add_usage(cmpl,
+                                           cmpl->usage_min,
+                                           cmpl->usage_max);
+    }
+
+    return true;
+}
+
+
+static bool
+hidrd_layout_cmpl_global(hidrd_layout_cmpl *cmpl,
+                         const hidrd_item  *item)
+{
+    hidrd_layout_cmpl_state    *state   = cmpl->state;
+
+    switch (hidrd_item_global_get_tag(item))
+    {
+        case HIDRD_ITEM_GLOBAL_TAG_USAGE_PAGE:
+            state->usage_page = hidrd_item_usage_page_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_LOGICAL_MINIMUM:
+            state->logical_minimum =
+                hidrd_item_logical_minimum_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_LOGICAL_MAXIMUM:
+            state->logical_maximum =
+                hidrd_item_logical_maximum_get_value(item);
+            state->logical_maximum_u = hidrd_item_short_get_unsigned(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_PHYSICAL_MINIMUM:
+            state->physical_minimum =
+                hidrd_item_physical_minimum_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_PHYSICAL_MAXIMUM:
+            state->physical_maximum =
+                hidrd_item_physical_maximum_get_value(item);
+            state->physical_maximum_u = hidrd_item_short_get_unsigned(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_UNIT_EXPONENT:
+            state->unit_exponent = hidrd_item_unit_exponent_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_UNIT:
+            state->unit = hidrd_item_unit_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_REPORT_SIZE:
+            state->report_size = hidrd_item_report_size_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_REPORT_COUNT:
+            state->report_count = hidrd_item_report_count_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_REPORT_ID:
+            {
+                uint32_t    id  = hidrd_item_report_id_get_value(item);
+
+                if (id == 0 || id >= HIDRD_LAYOUT_ID_NUM)
+                {
+                    cmpl->err = HIDRD_LAYOUT_CMPL_ERR_REPORT_ID;
+                    return false;
+                }
+                state->report_id = id;
+                cmpl->ids = true;
+            }
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_PUSH:
+            state = malloc(sizeof(*state));
+            if (state == NULL)
+            {
+                cmpl->err = HIDRD_LAYOUT_CMPL_ERR_ALLOC;
+                return false;
+            }
+            memcpy(state, cmpl->state, sizeof(*state));
+            state->prev = cmpl->state;
+            cmpl->state = state;
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_POP:
+            if (state->prev == NULL)
+            {
+                cmpl->err = HIDRD_LAYOUT_CMPL_ERR_POP;
+                return false;
+            }
+            cmpl->state = state->prev;
+            free(state);
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+
+/**
+ * Fix up a maximum value which was meant to be unsigned, i.e. which is
+ * below a non-negative minimum when interpreted as signed.
+ *
+ * @param min       Minimum value.
+ * @param max       Maximum value, signed interpretation.
+ * @param max_u     Maximum value, unsigned interpretation.
+ *
+ * @return Fixed maximum value.
+ */
+static int32_t
+hidrd_layout_cmpl_fix_max(int32_t min, int32_t max, uint32_t max_u)
+{
+    return (min >= 0 && max < min && max_u <= INT32_MAX)
+                ? (int32_t)max_u
+                : max;
+}
+
+
+/**
+ * Add a field for an Input, Output or Feature item.
+ *
+ * @param cmpl  Compiler to add the field to.
+ * @param dir   Field report direction.
+ * @param item  The main item.
+ *
+ * @return True if added successfully, false otherwise.
+ */
+static bool
+hidrd_layout_cmpl_add_field(hidrd_layout_cmpl  *cmpl,
+                            hidrd_layout_dir    dir,
+                            const hidrd_item   *item)
+{
+    const hidrd_layout_cmpl_state  *state   = cmpl->state;
+    uint16_t                        idx;
+    hidrd_layout_report            *report;
+    hidrd_layout_field              field;
+    uint64_t                        bits;
+    bool                            padding;
+    size_t                          usage_num;
+
+    /*
+     * Constant fields produce no values, so oversized ones are padding,
+     * only taking report bits, without a field
+     */
+    padding = state->report_size > HIDRD_LAYOUT_FIELD_SIZE_MAX;
+    if (padding && !(hidrd_item_short_get_unsigned(item) &
+                     HIDRD_LAYOUT_FIELD_FLAG_CONSTANT))
+    {
+        cmpl->err = HIDRD_LAYOUT_CMPL_ERR_REPORT_SIZE;
+        return false;
+    }
+
+    bits = (uint64_t)state->report_size * state->report_count;
+    if (bits == 0)
+        return true;
+
+    /* Lookup or add the report */
+    idx = cmpl->report_map[dir][state->report_id];
+    if (idx == HIDRD_LAYOUT_REPORT_NONE)
+    {
+        hidrd_layout_report new_report;
+
+        memset(&new_report, 0, sizeof(new_report));
+        new_report.id = state->report_id;
+        new_report.dir = dir;
+
+        if (!hidrd_buf_add_ptr(&cmpl->report_buf,
+                               &new_report, sizeof(new_report)))
+        {
+            cmpl->err = HIDRD_LAYOUT_CMPL_ERR_ALLOC;
+            return false;
+        }
+
+        idx = LIST_NUM(&cmpl->report_buf, hidrd_layout_report) - 1;
+        cmpl->report_map[dir][state->report_id] = idx;
+    }
+    report = LIST_PTR(&cmpl->report_buf, hidrd_layout_report) + idx;
+
+    if (bits > HIDRD_LAYOUT_REPORT_SIZE_MAX * 8 - report->bit_size)
+    {
+        cmpl->err = HIDRD_LAYOUT_CMPL_ERR_REPORT_LONG;
+        return false;
+    }
+
+    if (padding)
+    {
+        report->bit_size += bits;
+        return true;
+    }
+
+    usage_num = LIST_NUM(&cmpl->usage_buf, hidrd_layout_usage);
+
+    memset(&field, 0, sizeof(field));
+    field.flags = hidrd_item_short_get_unsigned(item) &
+                  HIDRD_LAYOUT_FIELD_FLAG_ITEM_MASK;
+    field.report_idx = idx;
+    field.bit_off = report->bit_size;
+    field.bit_size = state->report_size;
+    field.count = state->report_count;
+    field.value_idx = report->value_num;
+    field.logical_minimum = state->logical_minimum;
+    field.logical_maximum = hidrd_layout_cmpl_fix_max(
+                                state->logical_minimum,
+                                state->logical_maximum,
+                                state->logical_maximum_u);
+    field.physical_minimum = state->physical_minimum;
+    field.physical_maximum = hidrd_layout_cmpl_fix_max(
+                                state->physical_minimum,
+                                state->physical_maximum,
+                                state->physical_maximum_u);
+    field.unit = state->unit;
+    field.unit_exponent = state->unit_exponent;
+    field.usage_idx = cmpl->usage_start;
+    field.usage_num = usage_num - cmpl->usage_start;
+    if (field.logical_minimum < 0)
+        field.flags |= HIDRD_LAYOUT_FIELD_FLAG_SIGNED;
+
+    if (!hidrd_buf_add_ptr(&cmpl->field_buf, &field, sizeof(field)))
+    {
+        cmpl->err = HIDRD_LAYOUT_CMPL_ERR_ALLOC;
+        return false;
+    }
+
+    report->bit_size += bits;
+    report->field_num++;
+    report->value_num += field.count;
+
+    /* Keep the usages for the field */
+    cmpl->usage_start = usage_num;
+
+    return true;
+}
+
+
+static bool
+hidrd_layout_cmpl_main(hidrd_layout_cmpl   *cmpl,
+                       const hidrd_item    *item)
+{
+    bool    result  = true;
+    size_t  usage_num;
+
+    switch (hidrd_item_main_get_tag(item))
+    {
+        case HIDRD_ITEM_MAIN_TAG_INPUT:
+            result = hidrd_layout_cmpl_add_field(
+                        cmpl, HIDRD_LAYOUT_DIR_INPUT, item);
+            break;
+        case HIDRD_ITEM_MAIN_TAG_OUTPUT:
+            result = hidrd_layout_cmpl_add_field(
+                        cmpl, HIDRD_LAYOUT_DIR_OUTPUT, item);
+            break;
+        case HIDRD_ITEM_MAIN_TAG_FEATURE:
+            result = hidrd_layout_cmpl_add_field(
+                        cmpl, HIDRD_LAYOUT_DIR_FEATURE, item);
+            break;
+        default:
+            break;
+    }
+
+    /* Reset the local state, dropping any unused usages */
+    usage_num = LIST_NUM(&cmpl->usage_buf, hidrd_layout_usage);
+    hidrd_buf_del(&cmpl->usage_buf,
+                  (usage_num - cmpl->usage_start) *
+                  sizeof(hidrd_layout_usage));
+    cmpl->usage_min_set = false;
+    cmpl->usage_max_set = false;
+    cmpl->delimiter = false;
+
+    return result;
+}
+
+
+bool
+hidrd_layout_cmpl_put(hidrd_layout_cmpl    *cmpl,
+                      const hidrd_item     *item)
+{
+    assert(hidrd_layout_cmpl_valid(cmpl));
+    assert(hidrd_item_valid(item));
+
+    if (hidrd_item_basic_get_format(item) != HIDRD_ITEM_BASIC_FORMAT_SHORT)
+        return true;
+
+    switch (hidrd_item_short_get_type(item))
+    {
+        case HIDRD_ITEM_SHORT_TYPE_MAIN:
+            return hidrd_layout_cmpl_main(cmpl, item);
+        case HIDRD_ITEM_SHORT_TYPE_GLOBAL:
+            return hidrd_layout_cmpl_global(cmpl, item);
+        case HIDRD_ITEM_SHORT_TYPE_LOCAL:
+            return hidrd_layout_cmpl_local(cmpl, item);
+        default:
+            return true;
+    }
+}
+
+
+hidrd_layout *
+hidrd_layout_cmpl_finish(hidrd_layout_cmpl *cmpl)
+{
+    size_t                      report_num;
+    size_t                      field_num;
+    size_t                      usage_num;
+    size_t                      size;
+    hidrd_layout               *layout;
+    const hidrd_layout_report  *src_report_list;
+    hidrd_layout_report        *report_list;
+    const hidrd_layout_field   *src_field;
+    hidrd_layout_field         *field_list;
+    hidrd_layout_field         *field;
+    hidrd_layout_report        *report;
+    uint16_t                    new_idx[HIDRD_LAYOUT_DIR_NUM *
+                                        HIDRD_LAYOUT_ID_NUM];
+    size_t                      dir;
+    size_t                      id;
+    uint16_t                    idx;
+    size_t                      n;
+    uint32_t                    field_idx;
+
+    assert(hidrd_layout_cmpl_valid(cmpl));
+
+    report_num = LIST_NUM(&cmpl->report_buf, hidrd_layout_report);
+    field_num = LIST_NUM(&cmpl->field_buf, hidrd_layout_field);
+    usage_num = LIST_NUM(&cmpl->usage_buf, hidrd_layout_usage);
+
+    size = sizeof(*layout) +
+           report_num * sizeof(hidrd_layout_report) +
+           field_num * sizeof(hidrd_layout_field) +
+           usage_num * sizeof(hidrd_layout_usage);
+    if (size > UINT32_MAX)
+    {
+        cmpl->err = HIDRD_LAYOUT_CMPL_ERR_ALLOC;
+        return NULL;
+    }
+
+    layout = malloc(size);
+    if (layout == NULL)
+    {
+        cmpl->err = HIDRD_LAYOUT_CMPL_ERR_ALLOC;
+        return NULL;
+    }
+
+    layout->size = size;
+    layout->ids = cmpl->ids;
+    layout->report_off = sizeof(*layout);
+    layout->report_num = report_num;
+    layout->field_off = layout->report_off +
+                        report_num * sizeof(hidrd_layout_report);
+    layout->field_num = field_num;
+    layout->usage_off = layout->field_off +
+                        field_num * sizeof(hidrd_layout_field);
+    layout->usage_num = usage_num;
+    memset(layout->report_map, 0xFF, sizeof(layout->report_map));
+
+    src_report_list = LIST_PTR(&cmpl->report_buf, hidrd_layout_report);
+    report_list = (hidrd_layout_report *)hidrd_layout_get_report_list(
+                                                                layout);
+    field_list = (hidrd_layout_field *)hidrd_layout_get_field_list(layout);
+
+    /* Order reports by direction and ID, and allocate their fields */
+    for (n = 0, field_idx = 0, dir = 0; dir < HIDRD_LAYOUT_DIR_NUM; dir++)
+        for (id = 0; id < HIDRD_LAYOUT_ID_NUM; id++)
+        {
+            idx = cmpl->report_map[dir][id];
+            if (idx == HIDRD_LAYOUT_REPORT_NONE)
+                continue;
+            report = report_list + n;
+            *report = src_report_list[idx];
+            report->field_idx = field_idx;
+            field_idx += report->field_num;
+            /* Will be recounted while placing fields */
+            report->field_num = 0;
+            layout->report_map[dir][id] = n;
+            new_idx[idx] = n;
+            n++;
+        }
+
+    /* Place fields, keeping their order within each report */
+    for (src_field = LIST_PTR(&cmpl->field_buf, hidrd_layout_field);
+         src_field < LIST_PTR(&cmpl->field_buf, hidrd_layout_field) +
+                     field_num;
+         src_field++)
+    {
+        report = report_list + new_idx[src_field->report_idx];
+        field = field_list + report->field_idx + report->field_num++;
+        *field = *src_field;
+        field->report_idx = report - report_list;
+    }
+
+    if (usage_num > 0)
+        memcpy((hidrd_layout_usage *)hidrd_layout_get_usage_list(layout),
+               cmpl->usage_buf.ptr,
+               usage_num * sizeof(hidrd_layout_usage));
+
+    assert(hidrd_layout_valid(layout));
+
+    return layout;
+}
+
+
+char *
+hidrd_layout_cmpl_errmsg(const hidrd_layout_cmpl *cmpl)
+{
+    const char *msg;
+
+    assert(cmpl != NULL);
+
+    switch (cmpl->err)
+    {
+        case HIDRD_LAYOUT_CMPL_ERR_NONE:
+            msg = "";
+            break;
+        case HIDRD_LAYOUT_CMPL_ERR_ALLOC:
+            msg = "memory allocation failure";
+            break;
+        case HIDRD_LAYOUT_CMPL_ERR_POP:
+            msg = "Pop item without matching Push";
+            break;
+        case HIDRD_LAYOUT_CMPL_ERR_REPORT_ID:
+            msg = "invalid report ID";
+            break;
+        case HIDRD_LAYOUT_CMPL_ERR_REPORT_SIZE:
+            msg = "report size exceeds 32 bits";
+            break;
+        case HIDRD_LAYOUT_CMPL_ERR_REPORT_LONG:
+            msg = "report too long";
+            break;
+        default:
+            assert(!"Unknown error code");
+            return NULL;
+    }
+
+    return strdup(msg);
+}
+
+
+void
+hidrd_layout_cmpl_clnp(hidrd_layout_cmpl *cmpl)
+{
+    hidrd_layout_cmpl_state    *state;
+    hidrd_layout_cmpl_state    *prev_state;
+
+    assert(cmpl != NULL);
+
+    for (state = cmpl->state; state != NULL; state = prev_state)
+    {
+        prev_state = state->prev;
+        free(state);
+    }
+    cmpl->state = NULL;
+
+    hidrd_buf_clnp(&cmpl->usage_buf);
+    hidrd_buf_clnp(&cmpl->report_buf);
+    hidrd_buf_clnp(&cmpl->field_buf);
+}
+
+
+hidrd_layout *
+hidrd_layout_compile(hidrd_src *src, char **perr)
+{
+    hidrd_layout_cmpl   cmpl;
+    bool                cmpl_init   = false;
+    hidrd_layout       *layout      = NULL;
+    const hidrd_item   *item;
+    size_t              pos;
+    char               *err         = NULL;
+    char               *posstr      = NULL;
+
+    assert(hidrd_src_valid(src));
+
+    if (!hidrd_layout_cmpl_init(&cmpl))
+    {
+        err = strdup("memory allocation failure");
+        goto cleanup;
+    }
+    cmpl_init = true;
+
+    for (pos = hidrd_src_getpos(src);
+         (item = hidrd_src_get(src)) != NULL;
+         pos = hidrd_src_getpos(src))
+        if (!hidrd_layout_cmpl_put(&cmpl, item))
+        {
+            char   *msg = hidrd_layout_cmpl_errmsg(&cmpl);
+
+            posstr = hidrd_src_fmtpos(src, pos);
+            if (msg == NULL || posstr == NULL ||
+                asprintf(&err, "%s at %s", msg, posstr) < 0)
+                err = NULL;
+            free(msg);
+            goto cleanup;
+        }
+
+    if (hidrd_src_error(src))
+    {
+        err = hidrd_src_errmsg(src);
+        goto cleanup;
+    }
+
+    layout = hidrd_layout_cmpl_finish(&cmpl);
+    if (layout == NULL)
+        err = hidrd_layout_cmpl_errmsg(&cmpl);
+
+cleanup:
+
+    if (cmpl_init)
+        hidrd_layout_cmpl_clnp(&cmpl);
+
+    free(posstr);
+
+    if (perr != NULL)
+        *perr = (layout != NULL) ? strdup("") : err;
+    else
+        free(err);
+
+    return layout;
+}
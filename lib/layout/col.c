@@ -0,0 +1,492 @@
+/** @file
+ * @brief HID report descriptor - report layout - column extraction
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "hidrd/layout/col.h"
+#include "bits.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HIDRD_REPORT_COL_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * Aligned run kernel prototype: convert a run of byte-aligned values.
+ *
+ * @param p     First value byte.
+ * @param count Number of values.
+ * @param out   Output value list.
+ */
+typedef void (*hidrd_report_col_run_fn)(const uint8_t  *p,
+                                        size_t          count,
+                                        int32_t        *out);
+
+/** Aligned run kernel types */
+typedef enum hidrd_report_col_run {
+    HIDRD_REPORT_COL_RUN_U8,
+    HIDRD_REPORT_COL_RUN_S8,
+    HIDRD_REPORT_COL_RUN_U16,
+    HIDRD_REPORT_COL_RUN_S16,
+    HIDRD_REPORT_COL_RUN_U12,
+    HIDRD_REPORT_COL_RUN_S12,
+    HIDRD_REPORT_COL_RUN_NUM
+} hidrd_report_col_run;
+
+
+static void
+scalar_u8(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i < count; i++)
+        out[i] = p[i];
+}
+
+
+static void
+scalar_s8(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i < count; i++)
+        out[i] = (int8_t)p[i];
+}
+
+
+static void
+scalar_u16(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i < count; i++, p += 2)
+        out[i] = p[0] | (p[1] << 8);
+}
+
+
+static void
+scalar_s16(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i < count; i++, p += 2)
+        out[i] = (int16_t)(p[0] | (p[1] << 8));
+}
+
+
+/* Packed 12-bit values come in pairs of three bytes */
+static void
+scalar_u12(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i + 2 <= count; i += 2, p += 3)
+    {
+        out[i] = p[0] | ((p[1] & 0x0F) << 8);
+        out[i + 1] = (p[1] >> 4) | (p[2] << 4);
+    }
+
+    if (i < count)
+        out[i] = p[0] | ((p[1] & 0x0F) << 8);
+}
+
+
+static void
+scalar_s12(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i + 2 <= count; i += 2, p += 3)
+    {
+        out[i] = (int32_t)((uint32_t)(p[0] | (p[1] << 8)) << 20) >> 20;
+        out[i + 1] = (int32_t)((uint32_t)(p[1] | (p[2] << 8)) << 16) >> 20;
+    }
+
+    if (i < count)
+        out[i] = (int32_t)((uint32_t)(p[0] | (p[1] << 8)) << 20) >> 20;
+}
+
+
+#ifdef HIDRD_REPORT_COL_X86
+
+static void
+sse2_u8(const uint8_t *p, size_t count, int32_t *out)
+{
+    const __m128i   zero    = _mm_setzero_si128();
+    __m128i         v;
+    __m128i         lo;
+    __m128i         hi;
+    size_t          i;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        v = _mm_loadu_si128((const __m128i *)(p + i));
+        lo = _mm_unpacklo_epi8(v, zero);
+        hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128((__m128i *)(out + i),
+                         _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)(out + i + 4),
+                         _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i *)(out + i + 8),
+                         _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i *)(out + i + 12),
+                         _mm_unpackhi_epi16(hi, zero));
+    }
+
+    scalar_u8(p + i, count - i, out + i);
+}
+
+
+static void
+sse2_s8(const uint8_t *p, size_t count, int32_t *out)
+{
+    __m128i         v;
+    __m128i         lo;
+    __m128i         hi;
+    size_t          i;
+
+    /* Replicate each byte into a whole dword and shift it down */
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        v = _mm_loadu_si128((const __m128i *)(p + i));
+        lo = _mm_unpacklo_epi8(v, v);
+        hi = _mm_unpackhi_epi8(v, v);
+        _mm_storeu_si128((__m128i *)(out + i),
+                         _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 24));
+        _mm_storeu_si128((__m128i *)(out + i + 4),
+                         _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 24));
+        _mm_storeu_si128((__m128i *)(out + i + 8),
+                         _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 24));
+        _mm_storeu_si128((__m128i *)(out + i + 12),
+                         _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 24));
+    }
+
+    scalar_s8(p + i, count - i, out + i);
+}
+
+
+static void
+sse2_u16(const uint8_t *p, size_t count, int32_t *out)
+{
+    const __m128i   zero    = _mm_setzero_si128();
+    __m128i         v;
+    size_t          i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        v = _mm_loadu_si128((const __m128i *)(p + i * 2));
+        _mm_storeu_si128((__m128i *)(out + i),
+                         _mm_unpacklo_epi16(v, zero));
+        _mm_storeu_si128((__m128i *)(out + i + 4),
+                         _mm_unpackhi_epi16(v, zero));
+    }
+
+    scalar_u16(p + i * 2, count - i, out + i);
+}
+
+
+static void
+sse2_s16(const uint8_t *p, size_t count, int32_t *out)
+{
+    __m128i         v;
+    size_t          i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        v = _mm_loadu_si128((const __m128i *)(p + i * 2));
+        _mm_storeu_si128((__m128i *)(out + i),
+                         _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+        _mm_storeu_si128((__m128i *)(out + i + 4),
+                         _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+    }
+
+    scalar_s16(p + i * 2, count - i, out + i);
+}
+
+
+__attribute__((target("avx2"))) static void
+avx2_u8(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+        _mm256_storeu_si256(
+            (__m256i *)(out + i),
+            _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64((const __m128i *)(p + i))));
+
+    scalar_u8(p + i, count - i, out + i);
+}
+
+
+__attribute__((target("avx2"))) static void
+avx2_s8(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+        _mm256_storeu_si256(
+            (__m256i *)(out + i),
+            _mm256_cvtepi8_epi32(
+                _mm_loadl_epi64((const __m128i *)(p + i))));
+
+    scalar_s8(p + i, count - i, out + i);
+}
+
+
+__attribute__((target("avx2"))) static void
+avx2_u16(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+        _mm256_storeu_si256(
+            (__m256i *)(out + i),
+            _mm256_cvtepu16_epi32(
+                _mm_loadu_si128((const __m128i *)(p + i * 2))));
+
+    scalar_u16(p + i * 2, count - i, out + i);
+}
+
+
+__attribute__((target("avx2"))) static void
+avx2_s16(const uint8_t *p, size_t count, int32_t *out)
+{
+    size_t  i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+        _mm256_storeu_si256(
+            (__m256i *)(out + i),
+            _mm256_cvtepi16_epi32(
+                _mm_loadu_si128((const __m128i *)(p + i * 2))));
+
+    scalar_s16(p + i * 2, count - i, out + i);
+}
+
+/**
+ * Spread eight packed 12-bit values, taking exactly 12 bytes, into the
+ * low 16 bits of dwords, the odd values still shifted left by 4 bits.
+ *
+ * @param p     First value byte.
+ *
+ * @return The spread values.
+ */
+__attribute__((target("avx2"))) static inline __m256i
+avx2_spread12(const uint8_t *p)
+{
+    uint64_t    lo;
+    uint32_t    hi;
+
+    memcpy(&lo, p, sizeof(lo));
+    memcpy(&hi, p + sizeof(lo), sizeof(hi));
+
+    /* Pick the two bytes of each value, from both lane copies */
+    return _mm256_shuffle_epi8(
+                _mm256_broadcastsi128_si256(
+                    _mm_set_epi64x(hi, lo)),
+                _mm256_setr_epi8(0, 1, -1, -1, 1, 2, -1, -1,
+                                 3, 4, -1, -1, 4, 5, -1, -1,
+                                 6, 7, -1, -1, 7, 8, -1, -1,
+                                 9, 10, -1, -1, 10, 11, -1, -1));
+}
+
+
+__attribute__((target("avx2"))) static void
+avx2_u12(const uint8_t *p, size_t count, int32_t *out)
+{
+    const __m256i   shift   = _mm256_setr_epi32(0, 4, 0, 4, 0, 4, 0, 4);
+    const __m256i   mask    = _mm256_set1_epi32(0xFFF);
+    size_t          i;
+
+    for (i = 0; i + 8 <= count; i += 8, p += 12)
+        _mm256_storeu_si256(
+            (__m256i *)(out + i),
+            _mm256_and_si256(
+                _mm256_srlv_epi32(avx2_spread12(p), shift), mask));
+
+    scalar_u12(p, count - i, out + i);
+}
+
+
+__attribute__((target("avx2"))) static void
+avx2_s12(const uint8_t *p, size_t count, int32_t *out)
+{
+    const __m256i   shift   = _mm256_setr_epi32(20, 16, 20, 16,
+                                                20, 16, 20, 16);
+    size_t          i;
+
+    /* Move each sign bit to the top and shift the value down with it */
+    for (i = 0; i + 8 <= count; i += 8, p += 12)
+        _mm256_storeu_si256(
+            (__m256i *)(out + i),
+            _mm256_srai_epi32(
+                _mm256_sllv_epi32(avx2_spread12(p), shift), 20));
+
+    scalar_s12(p, count - i, out + i);
+}
+
+#endif /* HIDRD_REPORT_COL_X86 */
+
+
+/** Aligned run kernels, indexed by kernel and run type */
+static const hidrd_report_col_run_fn
+    hidrd_report_col_run_list[HIDRD_REPORT_COL_KERN_NUM]
+                             [HIDRD_REPORT_COL_RUN_NUM] = {
+    [HIDRD_REPORT_COL_KERN_SCALAR] =
+        {scalar_u8, scalar_s8, scalar_u16, scalar_s16,
+         scalar_u12, scalar_s12},
+#ifdef HIDRD_REPORT_COL_X86
+    /* SSE2 has no byte shuffle to unpack 12-bit values with */
+    [HIDRD_REPORT_COL_KERN_SSE2] =
+        {sse2_u8, sse2_s8, sse2_u16, sse2_s16,
+         scalar_u12, scalar_s12},
+    [HIDRD_REPORT_COL_KERN_AVX2] =
+        {avx2_u8, avx2_s8, avx2_u16, avx2_s16,
+         avx2_u12, avx2_s12},
+#endif
+};
+
+
+const char *
+hidrd_report_col_kern_name(hidrd_report_col_kern kern)
+{
+    assert(hidrd_report_col_kern_valid(kern));
+
+    switch (kern)
+    {
+        case HIDRD_REPORT_COL_KERN_AUTO:
+            return "auto";
+        case HIDRD_REPORT_COL_KERN_SCALAR:
+            return "scalar";
+        case HIDRD_REPORT_COL_KERN_SSE2:
+            return "sse2";
+        case HIDRD_REPORT_COL_KERN_AVX2:
+            return "avx2";
+        default:
+            assert(!"Unknown kernel");
+            return NULL;
+    }
+}
+
+
+bool
+hidrd_report_col_kern_supported(hidrd_report_col_kern kern)
+{
+    assert(hidrd_report_col_kern_valid(kern));
+
+    switch (kern)
+    {
+        case HIDRD_REPORT_COL_KERN_AUTO:
+        case HIDRD_REPORT_COL_KERN_SCALAR:
+            return true;
+#ifdef HIDRD_REPORT_COL_X86
+        case HIDRD_REPORT_COL_KERN_SSE2:
+            /* SSE2 is a part of the x86-64 baseline */
+            return true;
+        case HIDRD_REPORT_COL_KERN_AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+
+hidrd_report_col_kern
+hidrd_report_col_kern_best(void)
+{
+    if (hidrd_report_col_kern_supported(HIDRD_REPORT_COL_KERN_AVX2))
+        return HIDRD_REPORT_COL_KERN_AVX2;
+    if (hidrd_report_col_kern_supported(HIDRD_REPORT_COL_KERN_SSE2))
+        return HIDRD_REPORT_COL_KERN_SSE2;
+    return HIDRD_REPORT_COL_KERN_SCALAR;
+}
+
+
+void
+hidrd_report_col_extract(const hidrd_layout        *layout,
+                         const hidrd_layout_field  *field,
+                         hidrd_report_col_kern      kern,
+                         const void                *buf,
+                         size_t                     stride,
+                         size_t                     num,
+                         int32_t                   *col)
+{
+    const uint8_t              *data;
+    size_t                      len;
+    const hidrd_layout_report  *report;
+    bool                        sign;
+    hidrd_report_col_run_fn     run;
+    uint32_t                    size    = field->bit_size;
+    uint64_t                    mask    = (UINT64_C(1) << size) - 1;
+    unsigned int                ext     = 32 - size;
+    uint32_t                    bit;
+    uint32_t                    raw;
+    size_t                      i;
+    int32_t                    *value;
+    int32_t                    *end;
+
+    assert(layout != NULL);
+    assert(field != NULL);
+    assert(hidrd_report_col_kern_valid(kern));
+    assert(hidrd_report_col_kern_supported(kern));
+    assert(buf != NULL || num == 0);
+    assert(col != NULL || num == 0);
+
+    if (kern == HIDRD_REPORT_COL_KERN_AUTO)
+        kern = hidrd_report_col_kern_best();
+
+    report = hidrd_layout_get_report_list(layout) + field->report_idx;
+    assert(stride >= hidrd_layout_report_get_bytes(layout, report));
+    data = (const uint8_t *)buf + (layout->ids ? 1 : 0);
+    len = (report->bit_size + 7) / 8;
+    sign = (field->flags & HIDRD_LAYOUT_FIELD_FLAG_SIGNED) != 0;
+
+    /* Byte-aligned runs of bytes, words and packed 12-bit values */
+    if ((field->bit_off & 7) == 0 &&
+        (size == 8 || size == 16 || size == 12))
+    {
+        run = hidrd_report_col_run_list
+                [kern]
+                [(size == 8 ? HIDRD_REPORT_COL_RUN_U8
+                            : size == 16 ? HIDRD_REPORT_COL_RUN_U16
+                                         : HIDRD_REPORT_COL_RUN_U12) +
+                 sign];
+        data += field->bit_off >> 3;
+        for (i = 0; i < num; i++, data += stride, col += field->count)
+            run(data, field->count, col);
+        return;
+    }
+
+    /* Everything else */
+    for (i = 0; i < num; i++, data += stride, col += field->count)
+        for (value = col, end = col + field->count, bit = field->bit_off;
+             value < end; value++, bit += size)
+        {
+            raw = (layout_bits_load(data, len, bit >> 3) >> (bit & 7)) &
+                  mask;
+            *value = sign ? (int32_t)(raw << ext) >> ext : (int32_t)raw;
+        }
+}
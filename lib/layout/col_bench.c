@@ -0,0 +1,188 @@
+/** @file
+ * @brief HID report descriptor - report layout column extraction benchmark
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include <error.h>
+#include <stdio.h>
+#include <time.h>
+#include "hidrd/layout.h"
+
+/**
+ * Synthetic report descriptor, report ID 1: a 6-byte key array, 64
+ * signed bytes, 16 signed words and 16 signed 12-bit values.
+ */
+static const uint8_t bench_desc[] = {
+    0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x01,
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x06, 0x19, 0x00,
+    0x2A, 0xFF, 0x00, 0x81, 0x00,
+    0x15, 0x80, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x40, 0x09, 0x02, 0x81, 0x02,
+    0x16, 0x00, 0x80, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x10, 0x09, 0x03,
+    0x81, 0x02,
+    0x16, 0x00, 0xF8, 0x26, 0xFF, 0x07, 0x75, 0x0C, 0x95, 0x10, 0x09, 0x04,
+    0x81, 0x02,
+    0xC0,
+};
+
+/** Benchmarked field names, in layout order */
+static const char *bench_field_name_list[] = {
+    "6 x u8", "64 x s8", "16 x s16", "16 x s12",
+};
+
+
+/**
+ * Get monotonic time in seconds.
+ */
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+/**
+ * Compile the synthetic descriptor.
+ *
+ * @return Compiled layout.
+ */
+static hidrd_layout *
+compile(void)
+{
+    hidrd_layout_cmpl   cmpl;
+    hidrd_layout       *layout;
+    const uint8_t      *p;
+    size_t              item_size;
+
+    if (!hidrd_layout_cmpl_init(&cmpl))
+        error(1, 0, "Failed to initialize layout compiler");
+    for (p = bench_desc; p < bench_desc + sizeof(bench_desc);
+         p += item_size)
+    {
+        if (!hidrd_item_fits(p, bench_desc + sizeof(bench_desc) - p,
+                             &item_size))
+            error(1, 0, "Truncated benchmark descriptor");
+        if (!hidrd_layout_cmpl_put(&cmpl, p))
+            error(1, 0, "Failed to compile benchmark descriptor: %s",
+                  hidrd_layout_cmpl_errmsg(&cmpl));
+    }
+    layout = hidrd_layout_cmpl_finish(&cmpl);
+    if (layout == NULL)
+        error(1, 0, "Failed to finish benchmark descriptor layout: %s",
+              hidrd_layout_cmpl_errmsg(&cmpl));
+    hidrd_layout_cmpl_clnp(&cmpl);
+
+    return layout;
+}
+
+
+int
+main(int argc, char **argv)
+{
+    /* Default to a short run checking the kernels, for "make check" */
+    size_t                      report_num  = 1024;
+    size_t                      iter_num    = 1;
+    hidrd_layout               *layout;
+    const hidrd_layout_report  *report;
+    const hidrd_layout_field   *field;
+    size_t                      bytes;
+    uint8_t                    *buf;
+    int32_t                    *col;
+    int32_t                    *ref;
+    size_t                      f;
+    size_t                      i;
+    hidrd_report_col_kern       kern;
+    double                      start;
+    double                      time;
+
+    if (argc > 1)
+        report_num = strtoul(argv[1], NULL, 0);
+    if (argc > 2)
+        iter_num = strtoul(argv[2], NULL, 0);
+    if (report_num == 0 || iter_num == 0)
+        error(1, 0, "Usage: %s [REPORT_NUM [ITER_NUM]]",
+              argv[0]);
+
+    layout = compile();
+    report = hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_INPUT, 1);
+    bytes = hidrd_layout_report_get_bytes(layout, report);
+
+    /* Generate a synthetic report stream */
+    buf = malloc(bytes * report_num);
+    col = malloc(sizeof(*col) * 64 * report_num);
+    ref = malloc(sizeof(*ref) * 64 * report_num);
+    if (buf == NULL || col == NULL || ref == NULL)
+        error(1, 0, "Failed to allocate the report stream");
+    srand(1);
+    for (i = 0; i < bytes * report_num; i++)
+        buf[i] = (i % bytes == 0) ? 1 : (uint8_t)rand();
+
+    printf("%zu reports of %zu bytes, %zu iterations\n",
+           report_num, bytes, iter_num);
+    printf("%-10s %-8s %12s %12s\n",
+           "field", "kernel", "Mvalues/s", "MB/s");
+
+    field = hidrd_layout_report_get_field_list(layout, report);
+    for (f = 0; f < report->field_num; f++, field++)
+    {
+        hidrd_report_col_extract(layout, field,
+                                 HIDRD_REPORT_COL_KERN_SCALAR,
+                                 buf, bytes, report_num, ref);
+
+        for (kern = HIDRD_REPORT_COL_KERN_SCALAR;
+             kern < HIDRD_REPORT_COL_KERN_NUM; kern++)
+        {
+            if (!hidrd_report_col_kern_supported(kern))
+                continue;
+
+            start = now();
+            for (i = 0; i < iter_num; i++)
+                hidrd_report_col_extract(layout, field, kern,
+                                         buf, bytes, report_num, col);
+            time = now() - start;
+
+            if (memcmp(col, ref,
+                       sizeof(*col) * field->count * report_num) != 0)
+                error(1, 0, "%s kernel output differs from scalar",
+                      hidrd_report_col_kern_name(kern));
+
+            printf("%-10s %-8s %12.1f %12.1f\n",
+                   bench_field_name_list[f],
+                   hidrd_report_col_kern_name(kern),
+                   field->count * report_num * iter_num / time / 1e6,
+                   (field->count * field->bit_size + 7) / 8 *
+                   report_num * iter_num / time / 1e6);
+        }
+    }
+
+    free(ref);
+    free(col);
+    free(buf);
+    hidrd_layout_delete(layout);
+
+    return 0;
+}
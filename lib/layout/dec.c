@@ -0,0 +1,162 @@
+/** @file
+ * @brief HID report descriptor - report layout - report decoder
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include "hidrd/layout/dec.h"
+#include "bits.h"
+
+
+size_t
+hidrd_layout_get_value_max(const hidrd_layout *layout)
+{
+    const hidrd_layout_report  *report;
+    const hidrd_layout_report  *report_end;
+    size_t                      max     = 0;
+
+    assert(hidrd_layout_valid(layout));
+
+    report = hidrd_layout_get_report_list(layout);
+    for (report_end = report + layout->report_num;
+         report < report_end; report++)
+        if (report->value_num > max)
+            max = report->value_num;
+
+    return max;
+}
+
+
+/**
+ * Decode values of a single field.
+ *
+ * @param field     Field to decode.
+ * @param buf       Report data, without the report ID.
+ * @param len       Report data length; values are never loaded past it.
+ * @param values    Output list for the field values.
+ */
+static inline void
+hidrd_report_decode_field(const hidrd_layout_field *field,
+                          const uint8_t            *buf,
+                          size_t                    len,
+                          int32_t                  *values)
+{
+    uint32_t        size    = field->bit_size;
+    uint64_t        mask    = (UINT64_C(1) << size) - 1;
+    unsigned int    ext     = 32 - size;
+    uint32_t        bit     = field->bit_off;
+    int32_t        *value   = values;
+    int32_t        *end     = values + field->count;
+    uint32_t        raw;
+
+    if (field->flags & HIDRD_LAYOUT_FIELD_FLAG_SIGNED)
+        for (; value < end; value++, bit += size)
+        {
+            raw = (layout_bits_load(buf, len, bit >> 3) >> (bit & 7)) &
+                  mask;
+            *value = (int32_t)(raw << ext) >> ext;
+        }
+    else
+        for (; value < end; value++, bit += size)
+            *value = (int32_t)(uint32_t)
+                     ((layout_bits_load(buf, len, bit >> 3) >> (bit & 7)) &
+                      mask);
+}
+
+
+const hidrd_layout_report *
+hidrd_report_decode_dir(const hidrd_layout *layout,
+                        hidrd_layout_dir    dir,
+                        const void         *buf,
+                        size_t              len,
+                        int32_t            *values)
+{
+    const uint8_t              *data    = (const uint8_t *)buf;
+    uint8_t                     id      = 0;
+    const hidrd_layout_report  *report;
+    const hidrd_layout_field   *field;
+    const hidrd_layout_field   *field_end;
+
+    assert(layout != NULL);
+    assert(hidrd_layout_dir_valid(dir));
+    assert(buf != NULL || len == 0);
+    assert(values != NULL);
+
+    if (layout->ids)
+    {
+        if (len == 0)
+            return NULL;
+        id = *data++;
+        len--;
+    }
+
+    report = hidrd_layout_lookup(layout, dir, id);
+    if (report == NULL || len < (report->bit_size + 7) / 8)
+        return NULL;
+
+    field = hidrd_layout_report_get_field_list(layout, report);
+    for (field_end = field + report->field_num; field < field_end; field++)
+        hidrd_report_decode_field(field, data, len,
+                                  values + field->value_idx);
+
+    return report;
+}
+
+
+size_t
+hidrd_report_decode_batch(const hidrd_layout           *layout,
+                          hidrd_layout_dir              dir,
+                          const void                   *buf,
+                          size_t                        size,
+                          size_t                        num,
+                          int32_t                      *values,
+                          size_t                        value_stride,
+                          const hidrd_layout_report   **report_list,
+                          size_t                       *psize)
+{
+    const uint8_t              *data    = (const uint8_t *)buf;
+    size_t                      off     = 0;
+    size_t                      i;
+    const hidrd_layout_report  *report;
+
+    assert(hidrd_layout_valid(layout));
+    assert(hidrd_layout_dir_valid(dir));
+    assert(buf != NULL || size == 0);
+    assert(values != NULL || num == 0);
+    assert(value_stride >= hidrd_layout_get_value_max(layout));
+
+    for (i = 0; i < num && off < size; i++, values += value_stride)
+    {
+        report = hidrd_report_decode_dir(layout, dir,
+                                         data + off, size - off, values);
+        if (report == NULL)
+            break;
+        if (report_list != NULL)
+            report_list[i] = report;
+        off += hidrd_layout_report_get_bytes(layout, report);
+    }
+
+    if (psize != NULL)
+        *psize = off;
+
+    return i;
+}
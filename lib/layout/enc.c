@@ -0,0 +1,269 @@
+/** @file
+ * @brief HID report descriptor - report layout - report encoding
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "hidrd/layout/enc.h"
+#include "bits.h"
+
+
+/**
+ * Clamp a value of a variable field to the field logical range.
+ *
+ * @param field Field to clamp the value for.
+ * @param value Value to clamp.
+ *
+ * @return Clamped value.
+ */
+static inline uint32_t
+hidrd_report_clamp(const hidrd_layout_field *field, int32_t value)
+{
+    int32_t     min = field->logical_minimum;
+    int32_t     max = field->logical_maximum;
+
+    /* Maximum below minimum is an unsigned maximum past INT32_MAX */
+    if (max >= min)
+        return (uint32_t)(value < min ? min : value > max ? max : value);
+    else
+        return (value < 0 || (uint32_t)value < (uint32_t)min)
+                ? (uint32_t)min
+                : (uint32_t)value > (uint32_t)max
+                    ? (uint32_t)max
+                    : (uint32_t)value;
+}
+
+
+/**
+ * Encode values of a single field.
+ *
+ * @param field     Field to encode.
+ * @param buf       Report data, without the report ID.
+ * @param len       Report data length.
+ * @param values    Field values.
+ */
+static inline void
+hidrd_report_encode_field(const hidrd_layout_field *field,
+                          uint8_t                  *buf,
+                          size_t                    len,
+                          const int32_t            *values)
+{
+    uint32_t        size    = field->bit_size;
+    uint64_t        mask    = (UINT64_C(1) << size) - 1;
+    uint32_t        bit     = field->bit_off;
+    const int32_t  *value   = values;
+    const int32_t  *end     = values + field->count;
+
+    if (field->flags & HIDRD_LAYOUT_FIELD_FLAG_VARIABLE)
+        for (; value < end; value++, bit += size)
+            layout_bits_store(buf, len, bit, mask,
+                              hidrd_report_clamp(field, *value));
+    else
+        for (; value < end; value++, bit += size)
+            layout_bits_store(buf, len, bit, mask, (uint32_t)*value);
+}
+
+
+/**
+ * Start encoding a report: check the buffer size, zero the report and
+ * write the report ID.
+ *
+ * @param layout    Layout the report belongs to.
+ * @param report    Report to start encoding.
+ * @param buf       Output buffer.
+ * @param size      Output buffer size.
+ * @param pdata     Location for the report data pointer.
+ *
+ * @return Report size in bytes, including the ID, or zero if the buffer is
+ *         too small.
+ */
+static size_t
+hidrd_report_encode_start(const hidrd_layout           *layout,
+                          const hidrd_layout_report    *report,
+                          void                         *buf,
+                          size_t                        size,
+                          uint8_t                     **pdata)
+{
+    size_t      bytes   = hidrd_layout_report_get_bytes(layout, report);
+    uint8_t    *data    = (uint8_t *)buf;
+
+    if (size < bytes)
+        return 0;
+
+    memset(data, 0, bytes);
+    if (layout->ids)
+        *data++ = report->id;
+
+    *pdata = data;
+    return bytes;
+}
+
+
+size_t
+hidrd_report_encode_values(const hidrd_layout          *layout,
+                           const hidrd_layout_report   *report,
+                           const int32_t               *values,
+                           void                        *buf,
+                           size_t                       size)
+{
+    size_t                      bytes;
+    size_t                      len;
+    uint8_t                    *data;
+    const hidrd_layout_field   *field;
+    const hidrd_layout_field   *field_end;
+
+    assert(layout != NULL);
+    assert(report != NULL);
+    assert(values != NULL || report->value_num == 0);
+    assert(buf != NULL || size == 0);
+
+    bytes = hidrd_report_encode_start(layout, report, buf, size, &data);
+    if (bytes == 0)
+        return 0;
+    len = bytes - (layout->ids ? 1 : 0);
+
+    field = hidrd_layout_report_get_field_list(layout, report);
+    for (field_end = field + report->field_num; field < field_end; field++)
+        if (!(field->flags & HIDRD_LAYOUT_FIELD_FLAG_CONSTANT))
+            hidrd_report_encode_field(field, data, len,
+                                      values + field->value_idx);
+
+    return bytes;
+}
+
+
+/**
+ * Find the index of a usage in a field usage list.
+ *
+ * @param layout    Layout the field belongs to.
+ * @param field     Field to look up the usage in.
+ * @param usage     Usage to look up.
+ * @param pidx      Location for the usage index.
+ *
+ * @return True if the usage was found, false otherwise.
+ */
+static bool
+hidrd_report_field_find_usage(const hidrd_layout       *layout,
+                              const hidrd_layout_field *field,
+                              hidrd_usage               usage,
+                              uint32_t                 *pidx)
+{
+    const hidrd_layout_usage   *range;
+    const hidrd_layout_usage   *range_end;
+    uint32_t                    idx         = 0;
+
+    range = hidrd_layout_field_get_usage_list(layout, field);
+    for (range_end = range + field->usage_num; range < range_end; range++)
+    {
+        if (usage >= range->min && usage <= range->max)
+        {
+            *pidx = idx + (usage - range->min);
+            return true;
+        }
+        idx += range->max - range->min + 1;
+    }
+
+    return false;
+}
+
+
+size_t
+hidrd_report_encode(const hidrd_layout             *layout,
+                    hidrd_layout_dir                dir,
+                    uint8_t                         id,
+                    const hidrd_report_usage_value *list,
+                    size_t                          num,
+                    void                           *buf,
+                    size_t                          size)
+{
+    const hidrd_layout_report      *report;
+    size_t                          bytes;
+    size_t                          len;
+    uint8_t                        *data;
+    const hidrd_layout_field       *field;
+    const hidrd_layout_field       *field_end;
+    const hidrd_report_usage_value *pair;
+    const hidrd_report_usage_value *pair_end    = list + num;
+    uint64_t                        mask;
+    int64_t                         max;
+    uint32_t                        idx;
+    uint32_t                        slot;
+
+    assert(layout != NULL);
+    assert(hidrd_layout_dir_valid(dir));
+    assert(list != NULL || num == 0);
+    assert(buf != NULL || size == 0);
+
+    report = hidrd_layout_lookup(layout, dir, id);
+    if (report == NULL)
+        return 0;
+
+    bytes = hidrd_report_encode_start(layout, report, buf, size, &data);
+    if (bytes == 0)
+        return 0;
+    len = bytes - (layout->ids ? 1 : 0);
+
+    field = hidrd_layout_report_get_field_list(layout, report);
+    for (field_end = field + report->field_num; field < field_end; field++)
+    {
+        if (field->flags & HIDRD_LAYOUT_FIELD_FLAG_CONSTANT)
+            continue;
+
+        mask = (UINT64_C(1) << field->bit_size) - 1;
+
+        if (field->flags & HIDRD_LAYOUT_FIELD_FLAG_VARIABLE)
+        {
+            for (pair = list; pair < pair_end; pair++)
+                if (hidrd_report_field_find_usage(layout, field,
+                                                  pair->usage, &idx) &&
+                    idx < field->count)
+                    layout_bits_store(data, len,
+                                      field->bit_off +
+                                      idx * field->bit_size,
+                                      mask,
+                                      hidrd_report_clamp(field,
+                                                         pair->value));
+        }
+        else
+        {
+            /* Maximum below minimum is an unsigned maximum */
+            max = field->logical_maximum >= field->logical_minimum
+                    ? field->logical_maximum
+                    : (int64_t)(uint32_t)field->logical_maximum;
+            for (pair = list, slot = 0;
+                 pair < pair_end && slot < field->count; pair++)
+                if (pair->value != 0 &&
+                    hidrd_report_field_find_usage(layout, field,
+                                                  pair->usage, &idx) &&
+                    field->logical_minimum + (int64_t)idx <= max)
+                    layout_bits_store(data, len,
+                                      field->bit_off +
+                                      slot++ * field->bit_size,
+                                      mask,
+                                      (uint32_t)field->logical_minimum +
+                                      idx);
+        }
+    }
+
+    return bytes;
+}
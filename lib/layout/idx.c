@@ -0,0 +1,397 @@
+/** @file
+ * @brief HID report descriptor - report layout - usage index
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hidrd/layout/idx.h"
+
+
+/**
+ * Hash a usage block into a bucket index.
+ *
+ * @param block Usage block.
+ * @param log2  Log2 of the number of buckets, at least one.
+ *
+ * @return Bucket index.
+ */
+static inline uint32_t
+hidrd_layout_idx_hash(uint32_t block, uint32_t log2)
+{
+    return (uint32_t)(block * 0x9E3779B9u) >> (32 - log2);
+}
+
+
+/**
+ * Calculate the number of usage blocks an entry covers.
+ *
+ * @param ent   Entry to calculate the number for.
+ *
+ * @return Number of covered blocks.
+ */
+static inline uint32_t
+hidrd_layout_idx_ent_block_num(const hidrd_layout_idx_ent *ent)
+{
+    return (ent->max >> HIDRD_LAYOUT_IDX_BLOCK_LOG2) -
+           (ent->min >> HIDRD_LAYOUT_IDX_BLOCK_LOG2) + 1;
+}
+
+
+/**
+ * Fill or count index entries of a layout.
+ *
+ * @param layout    Layout to fill the entries from.
+ * @param ent       Entry list to fill, or NULL to only count.
+ *
+ * @return Number of entries.
+ */
+static uint32_t
+hidrd_layout_idx_fill(const hidrd_layout *layout, hidrd_layout_idx_ent *ent)
+{
+    const hidrd_layout_field   *field_list;
+    const hidrd_layout_field   *field;
+    const hidrd_layout_usage   *usage;
+    const hidrd_layout_usage   *usage_end;
+    uint64_t                    start;
+    uint32_t                    max;
+    uint32_t                    num     = 0;
+
+    field_list = hidrd_layout_get_field_list(layout);
+    for (field = field_list; field < field_list + layout->field_num; field++)
+    {
+        usage = hidrd_layout_field_get_usage_list(layout, field);
+        usage_end = usage + field->usage_num;
+        for (start = 0; usage < usage_end;
+             start += (uint64_t)usage->max - usage->min + 1, usage++)
+        {
+            max = usage->max;
+            /* Clip variable field usages to the field values */
+            if (field->flags & HIDRD_LAYOUT_FIELD_FLAG_VARIABLE)
+            {
+                if (start >= field->count)
+                    break;
+                if (max - usage->min >= field->count - start)
+                    max = usage->min + (uint32_t)(field->count - start) - 1;
+            }
+
+            if (ent != NULL)
+            {
+                ent->min = usage->min;
+                ent->max = max;
+                ent->report_idx = field->report_idx;
+                ent->field_idx = field - field_list;
+                ent->idx = (uint32_t)start;
+                ent++;
+            }
+            num++;
+        }
+    }
+
+    return num;
+}
+
+
+hidrd_layout_idx *
+hidrd_layout_idx_new(const hidrd_layout *layout)
+{
+    hidrd_layout_idx           *idx;
+    hidrd_layout_idx_ent       *ent_list;
+    hidrd_layout_idx_ent       *ent;
+    uint32_t                    ent_num;
+    uint32_t                   *bucket_list;
+    uint32_t                    bucket_num;
+    uint32_t                    bucket_log2;
+    hidrd_layout_idx_ref       *ref_list;
+    uint32_t                    ref_num     = 0;
+    uint32_t                   *wide_list;
+    uint32_t                    wide_num    = 0;
+    uint32_t                    block;
+    uint32_t                    block_end;
+    uint32_t                    h;
+    size_t                      size;
+
+    assert(hidrd_layout_valid(layout));
+
+    /* Count entries, references and wide ranges */
+    ent_num = hidrd_layout_idx_fill(layout, NULL);
+    ent_list = malloc(sizeof(*ent_list) * (ent_num == 0 ? 1 : ent_num));
+    if (ent_list == NULL)
+        return NULL;
+    hidrd_layout_idx_fill(layout, ent_list);
+
+    for (ent = ent_list; ent < ent_list + ent_num; ent++)
+        if (hidrd_layout_idx_ent_block_num(ent) >
+                HIDRD_LAYOUT_IDX_RANGE_BLOCK_MAX)
+            wide_num++;
+        else
+            ref_num += hidrd_layout_idx_ent_block_num(ent);
+
+    /* Have at least as many buckets as references */
+    for (bucket_log2 = 1; (UINT32_C(1) << bucket_log2) < ref_num;
+         bucket_log2++);
+    bucket_num = UINT32_C(1) << bucket_log2;
+
+    /* Allocate the index block */
+    size = sizeof(*idx) +
+           sizeof(*bucket_list) * (bucket_num + 1) +
+           sizeof(*ref_list) * ref_num +
+           sizeof(*wide_list) * wide_num +
+           sizeof(*ent_list) * ent_num;
+    idx = calloc(1, size);
+    if (idx == NULL)
+    {
+        free(ent_list);
+        return NULL;
+    }
+
+    idx->size = size;
+    idx->field_num = layout->field_num;
+    idx->bucket_log2 = bucket_log2;
+    idx->bucket_off = sizeof(*idx);
+    idx->ref_off = idx->bucket_off + sizeof(*bucket_list) * (bucket_num + 1);
+    idx->ref_num = ref_num;
+    idx->wide_off = idx->ref_off + sizeof(*ref_list) * ref_num;
+    idx->wide_num = wide_num;
+    idx->ent_off = idx->wide_off + sizeof(*wide_list) * wide_num;
+    idx->ent_num = ent_num;
+
+    bucket_list = (uint32_t *)((uint8_t *)idx + idx->bucket_off);
+    ref_list = (hidrd_layout_idx_ref *)((uint8_t *)idx + idx->ref_off);
+    wide_list = (uint32_t *)((uint8_t *)idx + idx->wide_off);
+    memcpy((uint8_t *)idx + idx->ent_off, ent_list,
+           sizeof(*ent_list) * ent_num);
+
+    /* Count references per bucket, after the bucket start */
+    for (ent = ent_list; ent < ent_list + ent_num; ent++)
+        if (hidrd_layout_idx_ent_block_num(ent) <=
+                HIDRD_LAYOUT_IDX_RANGE_BLOCK_MAX)
+            for (block = ent->min >> HIDRD_LAYOUT_IDX_BLOCK_LOG2,
+                 block_end = ent->max >> HIDRD_LAYOUT_IDX_BLOCK_LOG2;
+                 block <= block_end; block++)
+                bucket_list[hidrd_layout_idx_hash(block, bucket_log2) + 1]++;
+
+    /* Convert counts to bucket starts */
+    for (h = 0; h < bucket_num; h++)
+        bucket_list[h + 1] += bucket_list[h];
+
+    /* Place references, advancing bucket starts to bucket ends */
+    wide_num = 0;
+    for (ent = ent_list; ent < ent_list + ent_num; ent++)
+    {
+        if (hidrd_layout_idx_ent_block_num(ent) >
+                HIDRD_LAYOUT_IDX_RANGE_BLOCK_MAX)
+        {
+            wide_list[wide_num++] = ent - ent_list;
+            continue;
+        }
+        for (block = ent->min >> HIDRD_LAYOUT_IDX_BLOCK_LOG2,
+             block_end = ent->max >> HIDRD_LAYOUT_IDX_BLOCK_LOG2;
+             block <= block_end; block++)
+        {
+            h = hidrd_layout_idx_hash(block, bucket_log2);
+            ref_list[bucket_list[h]].block = block;
+            ref_list[bucket_list[h]].ent_idx = ent - ent_list;
+            bucket_list[h]++;
+        }
+    }
+
+    /* Shift bucket ends back to bucket starts */
+    for (h = bucket_num; h > 0; h--)
+        bucket_list[h] = bucket_list[h - 1];
+    bucket_list[0] = 0;
+
+    free(ent_list);
+
+    assert(hidrd_layout_idx_valid(idx));
+
+    return idx;
+}
+
+
+/**
+ * Check if an index list is within the index block.
+ *
+ * @param idx   Index containing the list.
+ * @param off   List offset, in bytes.
+ * @param num   Number of list entries.
+ * @param size  Size of a list entry.
+ *
+ * @return True if the list is within the index block, false otherwise.
+ */
+static bool
+hidrd_layout_idx_list_valid(const hidrd_layout_idx *idx,
+                            uint32_t                off,
+                            uint32_t                num,
+                            size_t                  size)
+{
+    return off >= sizeof(*idx) &&
+           off % sizeof(uint32_t) == 0 &&
+           off <= idx->size &&
+           num <= (idx->size - off) / size;
+}
+
+
+bool
+hidrd_layout_idx_valid(const hidrd_layout_idx *idx)
+{
+    const uint32_t                 *bucket_list;
+    const hidrd_layout_idx_ref     *ref_list;
+    const uint32_t                 *wide_list;
+    const hidrd_layout_idx_ent     *ent_list;
+    uint32_t                        bucket_num;
+    uint32_t                        i;
+
+    if (idx == NULL ||
+        idx->size < sizeof(*idx) ||
+        idx->bucket_log2 < 1 || idx->bucket_log2 > 31)
+        return false;
+
+    bucket_num = UINT32_C(1) << idx->bucket_log2;
+    if (!hidrd_layout_idx_list_valid(idx, idx->bucket_off, bucket_num + 1,
+                                     sizeof(*bucket_list)) ||
+        !hidrd_layout_idx_list_valid(idx, idx->ref_off, idx->ref_num,
+                                     sizeof(*ref_list)) ||
+        !hidrd_layout_idx_list_valid(idx, idx->wide_off, idx->wide_num,
+                                     sizeof(*wide_list)) ||
+        !hidrd_layout_idx_list_valid(idx, idx->ent_off, idx->ent_num,
+                                     sizeof(*ent_list)))
+        return false;
+
+    bucket_list = (const uint32_t *)((const uint8_t *)idx + idx->bucket_off);
+    ref_list = (const hidrd_layout_idx_ref *)
+                    ((const uint8_t *)idx + idx->ref_off);
+    wide_list = (const uint32_t *)((const uint8_t *)idx + idx->wide_off);
+    ent_list = (const hidrd_layout_idx_ent *)
+                    ((const uint8_t *)idx + idx->ent_off);
+
+    if (bucket_list[0] != 0 || bucket_list[bucket_num] != idx->ref_num)
+        return false;
+    for (i = 0; i < bucket_num; i++)
+        if (bucket_list[i] > bucket_list[i + 1])
+            return false;
+
+    for (i = 0; i < idx->ref_num; i++)
+        if (ref_list[i].ent_idx >= idx->ent_num)
+            return false;
+
+    for (i = 0; i < idx->wide_num; i++)
+        if (wide_list[i] >= idx->ent_num)
+            return false;
+
+    for (i = 0; i < idx->ent_num; i++)
+        if (ent_list[i].min > ent_list[i].max ||
+            ent_list[i].field_idx >= idx->field_num)
+            return false;
+
+    return true;
+}
+
+
+void
+hidrd_layout_idx_delete(hidrd_layout_idx *idx)
+{
+    assert(idx == NULL || hidrd_layout_idx_valid(idx));
+    free(idx);
+}
+
+
+/**
+ * Output a location of a usage within an entry, if the entry matches.
+ *
+ * @param ent           Entry to match.
+ * @param report_idx    Report index to match, or
+ *                      HIDRD_LAYOUT_IDX_REPORT_ANY.
+ * @param usage         Usage to match.
+ * @param list          Output location list.
+ * @param num           Maximum number of locations to output.
+ * @param found         Number of locations found so far.
+ *
+ * @return Number of locations found, including this one, if matched.
+ */
+static inline size_t
+hidrd_layout_idx_match(const hidrd_layout_idx_ent  *ent,
+                       uint32_t                     report_idx,
+                       hidrd_usage                  usage,
+                       hidrd_layout_loc            *list,
+                       size_t                       num,
+                       size_t                       found)
+{
+    if (usage < ent->min || usage > ent->max ||
+        (report_idx != HIDRD_LAYOUT_IDX_REPORT_ANY &&
+         report_idx != ent->report_idx))
+        return found;
+
+    if (found < num)
+    {
+        list[found].field_idx = ent->field_idx;
+        list[found].idx = ent->idx + (usage - ent->min);
+    }
+
+    return found + 1;
+}
+
+
+size_t
+hidrd_layout_idx_lookup(const hidrd_layout_idx *idx,
+                        uint32_t                report_idx,
+                        hidrd_usage             usage,
+                        hidrd_layout_loc       *list,
+                        size_t                  num)
+{
+    const uint32_t                 *bucket_list;
+    const hidrd_layout_idx_ref     *ref;
+    const hidrd_layout_idx_ref     *ref_end;
+    const uint32_t                 *wide;
+    const uint32_t                 *wide_end;
+    const hidrd_layout_idx_ent     *ent_list;
+    uint32_t                        block;
+    uint32_t                        h;
+    size_t                          found   = 0;
+
+    assert(idx != NULL);
+    assert(list != NULL || num == 0);
+
+    bucket_list = (const uint32_t *)((const uint8_t *)idx + idx->bucket_off);
+    ent_list = (const hidrd_layout_idx_ent *)
+                    ((const uint8_t *)idx + idx->ent_off);
+
+    block = (uint32_t)usage >> HIDRD_LAYOUT_IDX_BLOCK_LOG2;
+    h = hidrd_layout_idx_hash(block, idx->bucket_log2);
+    ref = (const hidrd_layout_idx_ref *)
+                ((const uint8_t *)idx + idx->ref_off);
+    for (ref_end = ref + bucket_list[h + 1], ref += bucket_list[h];
+         ref < ref_end; ref++)
+        if (ref->block == block)
+            found = hidrd_layout_idx_match(ent_list + ref->ent_idx,
+                                           report_idx, usage,
+                                           list, num, found);
+
+    wide = (const uint32_t *)((const uint8_t *)idx + idx->wide_off);
+    for (wide_end = wide + idx->wide_num; wide < wide_end; wide++)
+        found = hidrd_layout_idx_match(ent_list + *wide,
+                                       report_idx, usage,
+                                       list, num, found);
+
+    return found;
+}
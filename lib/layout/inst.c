@@ -0,0 +1,181 @@
+/** @file
+ * @brief HID report descriptor - report layout
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include "hidrd/layout/inst.h"
+
+
+/**
+ * Check if a layout list lies within the layout block and is aligned.
+ *
+ * @param layout    Layout containing the list.
+ * @param off       List offset, in bytes.
+ * @param num       Number of list entries.
+ * @param size      List entry size, in bytes.
+ *
+ * @return True if the list is within the layout block, false otherwise.
+ */
+static bool
+hidrd_layout_list_valid(const hidrd_layout *layout,
+                        uint32_t            off,
+                        uint32_t            num,
+                        size_t              size)
+{
+    return off >= sizeof(*layout) &&
+           off % sizeof(uint32_t) == 0 &&
+           off <= layout->size &&
+           num <= (layout->size - off) / size;
+}
+
+
+bool
+hidrd_layout_valid(const hidrd_layout *layout)
+{
+    const hidrd_layout_report  *report_list;
+    const hidrd_layout_report  *report;
+    const hidrd_layout_field   *field_list;
+    const hidrd_layout_field   *field;
+    size_t                      dir;
+    size_t                      id;
+    uint32_t                    idx;
+    uint64_t                    field_num   = 0;
+
+    if (layout == NULL ||
+        layout->size < sizeof(*layout) ||
+        !hidrd_layout_list_valid(layout, layout->report_off,
+                                 layout->report_num, sizeof(*report)) ||
+        !hidrd_layout_list_valid(layout, layout->field_off,
+                                 layout->field_num, sizeof(*field)) ||
+        !hidrd_layout_list_valid(layout, layout->usage_off,
+                                 layout->usage_num,
+                                 sizeof(hidrd_layout_usage)))
+        return false;
+
+    report_list = hidrd_layout_get_report_list(layout);
+    field_list = hidrd_layout_get_field_list(layout);
+
+    for (dir = 0; dir < HIDRD_LAYOUT_DIR_NUM; dir++)
+        for (id = 0; id < HIDRD_LAYOUT_ID_NUM; id++)
+        {
+            idx = layout->report_map[dir][id];
+            if (idx == HIDRD_LAYOUT_REPORT_NONE)
+                continue;
+            if (idx >= layout->report_num ||
+                report_list[idx].dir != dir ||
+                report_list[idx].id != id)
+                return false;
+        }
+
+    for (report = report_list;
+         report < report_list + layout->report_num; report++)
+    {
+        if (!hidrd_layout_dir_valid(report->dir) ||
+            layout->report_map[report->dir][report->id] !=
+                (report - report_list) ||
+            report->bit_size > HIDRD_LAYOUT_REPORT_SIZE_MAX * 8 ||
+            report->field_idx > layout->field_num ||
+            report->field_num > layout->field_num - report->field_idx)
+            return false;
+        field_num += report->field_num;
+    }
+
+    /*
+     * As each field is checked to be within its report field range below,
+     * this makes the report field ranges cover each field exactly once
+     */
+    if (field_num != layout->field_num)
+        return false;
+
+    for (field = field_list; field < field_list + layout->field_num; field++)
+    {
+        if (field->report_idx >= layout->report_num)
+            return false;
+        report = report_list + field->report_idx;
+        idx = field - field_list;
+        if (idx < report->field_idx ||
+            idx - report->field_idx >= report->field_num ||
+            field->bit_size == 0 ||
+            field->bit_size > HIDRD_LAYOUT_FIELD_SIZE_MAX ||
+            field->bit_off > report->bit_size ||
+            (uint64_t)field->bit_size * field->count >
+                report->bit_size - field->bit_off ||
+            field->value_idx > report->value_num ||
+            field->count > report->value_num - field->value_idx ||
+            field->usage_idx > layout->usage_num ||
+            field->usage_num > layout->usage_num - field->usage_idx)
+            return false;
+    }
+
+    return true;
+}
+
+
+void
+hidrd_layout_delete(hidrd_layout *layout)
+{
+    assert(layout == NULL || hidrd_layout_valid(layout));
+    free(layout);
+}
+
+
+bool
+hidrd_layout_field_get_usage(const hidrd_layout        *layout,
+                             const hidrd_layout_field  *field,
+                             uint32_t                   idx,
+                             hidrd_usage               *pusage)
+{
+    const hidrd_layout_usage   *usage;
+    const hidrd_layout_usage   *usage_end;
+    uint32_t                    num;
+
+    assert(layout != NULL);
+    assert(field != NULL);
+
+    if (field->usage_num == 0)
+        return false;
+
+    usage = hidrd_layout_field_get_usage_list(layout, field);
+    usage_end = usage + field->usage_num;
+
+    for (; usage < usage_end; usage++)
+    {
+        num = usage->max - usage->min;
+        if (idx <= num)
+        {
+            if (pusage != NULL)
+                *pusage = usage->min + idx;
+            return true;
+        }
+        idx -= num + 1;
+    }
+
+    if (!(field->flags & HIDRD_LAYOUT_FIELD_FLAG_VARIABLE))
+        return false;
+
+    if (pusage != NULL)
+        *pusage = usage_end[-1].max;
+
+    return true;
+}
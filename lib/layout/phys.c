@@ -0,0 +1,235 @@
+/** @file
+ * @brief HID report descriptor - report layout - physical value conversion
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include "hidrd/item/unit.h"
+#include "hidrd/layout/phys.h"
+
+/** Maximum magnitude of a decimal exponent, applied */
+#define HIDRD_LAYOUT_PHYS_EXP_MAX   30
+
+/** Maximum fixed-point right shift */
+#define HIDRD_LAYOUT_PHYS_SHIFT_MAX 32
+
+int32_t
+hidrd_layout_phys_exp(int32_t value)
+{
+    return (value >= 0 && hidrd_unit_exp_valid(value))
+                ? hidrd_unit_exp_to_int(value)
+                : value;
+}
+
+
+/**
+ * Round a double to the nearest 64-bit integer.
+ *
+ * @param x Number to round, within the int64_t range.
+ *
+ * @return Rounded number.
+ */
+static int64_t
+hidrd_layout_phys_round(double x)
+{
+    return (int64_t)(x < 0 ? x - 0.5 : x + 0.5);
+}
+
+
+/**
+ * Fetch the range of a field, interpreting a maximum below a non-negative
+ * minimum as an unsigned 32-bit value.
+ *
+ * @param min   Range minimum.
+ * @param max   Range maximum.
+ * @param pmin  Location for the minimum.
+ * @param pmax  Location for the maximum.
+ */
+static void
+hidrd_layout_phys_range(int32_t min, int32_t max,
+                        int64_t *pmin, int64_t *pmax)
+{
+    *pmin = min;
+    *pmax = (max < min && min >= 0) ? (int64_t)(uint32_t)max : max;
+}
+
+
+void
+hidrd_layout_phys_init(hidrd_layout_phys           *phys,
+                       const hidrd_layout_field    *field)
+{
+    int64_t     lmin;
+    int64_t     lmax;
+    int64_t     pmin;
+    int64_t     pmax;
+    int32_t     exp;
+    double      pow10   = 1;
+    double      vmax;
+    double      bound;
+    double      k;
+    int32_t     i;
+
+    assert(phys != NULL);
+    assert(field != NULL);
+
+    hidrd_layout_phys_range(field->logical_minimum,
+                            field->logical_maximum, &lmin, &lmax);
+    if (field->physical_minimum == 0 && field->physical_maximum == 0)
+    {
+        pmin = lmin;
+        pmax = lmax;
+    }
+    else
+        hidrd_layout_phys_range(field->physical_minimum,
+                                field->physical_maximum, &pmin, &pmax);
+
+    exp = hidrd_layout_phys_exp(field->unit_exponent);
+    if (exp > HIDRD_LAYOUT_PHYS_EXP_MAX)
+        exp = HIDRD_LAYOUT_PHYS_EXP_MAX;
+    else if (exp < -HIDRD_LAYOUT_PHYS_EXP_MAX)
+        exp = -HIDRD_LAYOUT_PHYS_EXP_MAX;
+    for (i = (exp < 0 ? -exp : exp); i > 0; i--)
+        pow10 *= 10;
+
+    phys->exp = exp;
+    phys->unit = field->unit;
+    phys->uns = !(field->flags & HIDRD_LAYOUT_FIELD_FLAG_SIGNED);
+
+    /* Compute the floating-point factors */
+    phys->scale = (lmax == lmin)
+                    ? 0
+                    : (double)(pmax - pmin) / (double)(lmax - lmin);
+    phys->offset = (double)pmin - (double)lmin * phys->scale;
+    if (exp < 0)
+    {
+        phys->scale /= pow10;
+        phys->offset /= pow10;
+    }
+    else
+    {
+        phys->scale *= pow10;
+        phys->offset *= pow10;
+    }
+
+    /* Find the maximum result magnitude over all representable values */
+    vmax = phys->uns
+                ? (double)((UINT64_C(1) << field->bit_size) - 1)
+                : (double)(UINT64_C(1) << (field->bit_size - 1));
+    bound = (phys->scale < 0 ? -phys->scale : phys->scale) * vmax +
+            (phys->offset < 0 ? -phys->offset : phys->offset);
+
+    /* Compute the fixed-point factors with the largest fitting shift */
+    phys->fx = false;
+    phys->mul = 0;
+    phys->add = 0;
+    phys->shift = 0;
+    for (i = HIDRD_LAYOUT_PHYS_SHIFT_MAX; i >= 0; i--)
+    {
+        k = (double)(UINT64_C(1) << (HIDRD_LAYOUT_PHYS_FX_FRAC + i));
+        if (bound * k < (double)(UINT64_C(1) << 62))
+        {
+            phys->fx = true;
+            phys->shift = i;
+            phys->mul = hidrd_layout_phys_round(phys->scale * k);
+            phys->add = hidrd_layout_phys_round(phys->offset * k) +
+                        ((i > 0) ? (INT64_C(1) << (i - 1)) : 0);
+            break;
+        }
+    }
+}
+
+
+hidrd_layout_phys *
+hidrd_layout_phys_list_new(const hidrd_layout *layout)
+{
+    hidrd_layout_phys          *list;
+    const hidrd_layout_field   *field;
+    uint32_t                    i;
+
+    assert(hidrd_layout_valid(layout));
+
+    list = malloc(sizeof(*list) *
+                  (layout->field_num == 0 ? 1 : layout->field_num));
+    if (list == NULL)
+        return NULL;
+
+    field = hidrd_layout_get_field_list(layout);
+    for (i = 0; i < layout->field_num; i++)
+        hidrd_layout_phys_init(list + i, field + i);
+
+    return list;
+}
+
+
+void
+hidrd_layout_phys_conv(const hidrd_layout_phys *phys,
+                       const int32_t           *values,
+                       size_t                   stride,
+                       size_t                   num,
+                       double                  *out)
+{
+    double          scale   = phys->scale;
+    double          offset  = phys->offset;
+    double         *end     = out + num;
+
+    assert(phys != NULL);
+    assert(values != NULL || num == 0);
+    assert(out != NULL || num == 0);
+
+    if (phys->uns)
+        for (; out < end; out++, values += stride)
+            *out = (double)(uint32_t)*values * scale + offset;
+    else
+        for (; out < end; out++, values += stride)
+            *out = (double)*values * scale + offset;
+}
+
+
+bool
+hidrd_layout_phys_conv_fx(const hidrd_layout_phys  *phys,
+                          const int32_t            *values,
+                          size_t                    stride,
+                          size_t                    num,
+                          int64_t                  *out)
+{
+    int64_t         mul     = phys->mul;
+    int64_t         add     = phys->add;
+    uint32_t        shift   = phys->shift;
+    int64_t        *end     = out + num;
+
+    assert(phys != NULL);
+    assert(values != NULL || num == 0);
+    assert(out != NULL || num == 0);
+
+    if (!phys->fx)
+        return false;
+
+    if (phys->uns)
+        for (; out < end; out++, values += stride)
+            *out = ((int64_t)(uint32_t)*values * mul + add) >> shift;
+    else
+        for (; out < end; out++, values += stride)
+            *out = ((int64_t)*values * mul + add) >> shift;
+
+    return true;
+}
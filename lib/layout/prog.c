@@ -0,0 +1,658 @@
+/** @file
+ * @brief HID report descriptor - report layout - decoding program
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hidrd/layout/dec.h"
+#include "hidrd/layout/prog.h"
+#include "bits.h"
+
+/** Maximum instruction size, including the operation code */
+#define HIDRD_LAYOUT_PROG_OP_SIZE_MAX   17
+
+/** Instruction sizes, including the operation code, indexed by opcode */
+static const uint8_t hidrd_layout_prog_op_size[HIDRD_LAYOUT_PROG_OP_NUM] = {
+    [HIDRD_LAYOUT_PROG_OP_FAIL]     = 1,
+    [HIDRD_LAYOUT_PROG_OP_END]      = 3,
+    [HIDRD_LAYOUT_PROG_OP_BR_ID]    = 6,
+    [HIDRD_LAYOUT_PROG_OP_CHK]      = 3,
+    [HIDRD_LAYOUT_PROG_OP_LD]       = 3,
+    [HIDRD_LAYOUT_PROG_OP_EXT]      = 3,
+    [HIDRD_LAYOUT_PROG_OP_SEXT]     = 2,
+    [HIDRD_LAYOUT_PROG_OP_SCALE]    = 17,
+    [HIDRD_LAYOUT_PROG_OP_ST]       = 3,
+};
+
+/** Instruction mnemonics, indexed by opcode */
+static const char *hidrd_layout_prog_op_name[HIDRD_LAYOUT_PROG_OP_NUM] = {
+    [HIDRD_LAYOUT_PROG_OP_FAIL]     = "fail",
+    [HIDRD_LAYOUT_PROG_OP_END]      = "end",
+    [HIDRD_LAYOUT_PROG_OP_BR_ID]    = "br_id",
+    [HIDRD_LAYOUT_PROG_OP_CHK]      = "chk",
+    [HIDRD_LAYOUT_PROG_OP_LD]       = "ld",
+    [HIDRD_LAYOUT_PROG_OP_EXT]      = "ext",
+    [HIDRD_LAYOUT_PROG_OP_SEXT]     = "sext",
+    [HIDRD_LAYOUT_PROG_OP_SCALE]    = "scale",
+    [HIDRD_LAYOUT_PROG_OP_ST]       = "st",
+};
+
+/** Direction names, indexed by direction */
+static const char *hidrd_layout_prog_dir_name[HIDRD_LAYOUT_DIR_NUM] = {
+    [HIDRD_LAYOUT_DIR_INPUT]    = "input",
+    [HIDRD_LAYOUT_DIR_OUTPUT]   = "output",
+    [HIDRD_LAYOUT_DIR_FEATURE]  = "feature",
+};
+
+static inline uint16_t
+hidrd_layout_prog_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t
+hidrd_layout_prog_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline int32_t
+hidrd_layout_prog_get_s32(const uint8_t *p)
+{
+    return (int32_t)hidrd_layout_prog_get_u32(p);
+}
+
+static inline void
+hidrd_layout_prog_set_u32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+
+/**
+ * Emit an instruction.
+ *
+ * @param code  Code buffer to append the instruction to.
+ * @param op    Operation code.
+ * @param ...   Operands, as unsigned int for u8 and u16 operands, and as
+ *              uint32_t/int32_t for 32-bit operands.
+ *
+ * @return True if emitted successfully, false if failed to allocate
+ *         memory.
+ */
+static bool
+hidrd_layout_prog_emit(hidrd_buf *code, hidrd_layout_prog_op op, ...)
+{
+    uint8_t     insn[HIDRD_LAYOUT_PROG_OP_SIZE_MAX];
+    uint8_t    *p       = insn;
+    va_list     ap;
+    unsigned    v;
+    int         i;
+
+    *p++ = (uint8_t)op;
+
+    va_start(ap, op);
+    switch (op)
+    {
+        case HIDRD_LAYOUT_PROG_OP_END:
+        case HIDRD_LAYOUT_PROG_OP_CHK:
+        case HIDRD_LAYOUT_PROG_OP_LD:
+        case HIDRD_LAYOUT_PROG_OP_ST:
+            v = va_arg(ap, unsigned);
+            assert(v <= UINT16_MAX);
+            *p++ = (uint8_t)v;
+            *p++ = (uint8_t)(v >> 8);
+            break;
+        case HIDRD_LAYOUT_PROG_OP_BR_ID:
+            *p++ = (uint8_t)va_arg(ap, unsigned);
+            hidrd_layout_prog_set_u32(p, va_arg(ap, uint32_t));
+            p += 4;
+            break;
+        case HIDRD_LAYOUT_PROG_OP_EXT:
+            *p++ = (uint8_t)va_arg(ap, unsigned);
+            /* FALLTHROUGH */
+        case HIDRD_LAYOUT_PROG_OP_SEXT:
+            *p++ = (uint8_t)va_arg(ap, unsigned);
+            break;
+        case HIDRD_LAYOUT_PROG_OP_SCALE:
+            for (i = 0; i < 4; i++, p += 4)
+                hidrd_layout_prog_set_u32(p, (uint32_t)va_arg(ap, int32_t));
+            break;
+        default:
+            break;
+    }
+    va_end(ap);
+
+    assert(p - insn == hidrd_layout_prog_op_size[op]);
+
+    return hidrd_buf_add_ptr(code, insn, p - insn);
+}
+
+
+/**
+ * Emit the physical scaling of a field's values, if enabled and the
+ * field has a physical range which can be mapped to.
+ *
+ * @param code  Code buffer to append the instruction to.
+ * @param field Field to emit the scaling for.
+ *
+ * @return True if emitted successfully, or scaling wasn't needed, false
+ *         if failed to allocate memory.
+ */
+static bool
+hidrd_layout_prog_emit_scale(hidrd_buf                 *code,
+                             const hidrd_layout_field  *field)
+{
+    int64_t lmin    = field->logical_minimum;
+    int64_t pmin    = field->physical_minimum;
+    int64_t num     = (int64_t)field->physical_maximum - pmin;
+    int64_t den     = (int64_t)field->logical_maximum - lmin;
+
+    /* Physical range equal to the logical one, or not specified */
+    if ((field->physical_minimum == 0 && field->physical_maximum == 0) ||
+        (num == den && pmin == lmin))
+        return true;
+
+    /* Keep the denominator positive */
+    if (den < 0)
+    {
+        lmin += den;
+        pmin += num;
+        num = -num;
+        den = -den;
+    }
+
+    /* Skip ranges not fitting the operands */
+    if (den == 0 || den > INT32_MAX || num < INT32_MIN || num > INT32_MAX)
+        return true;
+
+    return hidrd_layout_prog_emit(code, HIDRD_LAYOUT_PROG_OP_SCALE,
+                                  (int32_t)lmin, (int32_t)pmin,
+                                  (int32_t)num, (int32_t)den);
+}
+
+
+/**
+ * Emit the code decoding a single report.
+ *
+ * @param code      Code buffer to append the code to.
+ * @param layout    Layout containing the report.
+ * @param report    Report to emit the code for.
+ * @param flags     Compilation flags (hidrd_layout_prog_flag).
+ *
+ * @return True if emitted successfully, false if failed to allocate
+ *         memory.
+ */
+static bool
+hidrd_layout_prog_emit_report(hidrd_buf                    *code,
+                              const hidrd_layout           *layout,
+                              const hidrd_layout_report    *report,
+                              uint32_t                      flags)
+{
+    const hidrd_layout_field   *field;
+    const hidrd_layout_field   *field_end;
+    uint32_t                    loaded  = UINT32_MAX;
+    uint32_t                    bit;
+    uint32_t                    i;
+
+    if (!hidrd_layout_prog_emit(code, HIDRD_LAYOUT_PROG_OP_CHK,
+                                (unsigned)((report->bit_size + 7) / 8)))
+        return false;
+
+    field = hidrd_layout_report_get_field_list(layout, report);
+    for (field_end = field + report->field_num; field < field_end; field++)
+        for (i = 0, bit = field->bit_off; i < field->count;
+             i++, bit += field->bit_size)
+        {
+            /* Reload the word, unless the value is within it already */
+            if (loaded == UINT32_MAX || bit < loaded * 8 ||
+                bit + field->bit_size > loaded * 8 + 64)
+            {
+                loaded = bit >> 3;
+                if (!hidrd_layout_prog_emit(code, HIDRD_LAYOUT_PROG_OP_LD,
+                                            (unsigned)loaded))
+                    return false;
+            }
+
+            if (!hidrd_layout_prog_emit(code, HIDRD_LAYOUT_PROG_OP_EXT,
+                                        (unsigned)(bit - loaded * 8),
+                                        (unsigned)field->bit_size))
+                return false;
+
+            if ((field->flags & HIDRD_LAYOUT_FIELD_FLAG_SIGNED) &&
+                field->bit_size < 32 &&
+                !hidrd_layout_prog_emit(code, HIDRD_LAYOUT_PROG_OP_SEXT,
+                                        (unsigned)field->bit_size))
+                return false;
+
+            if ((flags & HIDRD_LAYOUT_PROG_FLAG_PHYSICAL) &&
+                !hidrd_layout_prog_emit_scale(code, field))
+                return false;
+
+            if (!hidrd_layout_prog_emit(code, HIDRD_LAYOUT_PROG_OP_ST,
+                                        (unsigned)(field->value_idx + i)))
+                return false;
+        }
+
+    return hidrd_layout_prog_emit(
+                code, HIDRD_LAYOUT_PROG_OP_END,
+                (unsigned)(report - hidrd_layout_get_report_list(layout)));
+}
+
+
+/**
+ * Check if a layout fits the decoding program operands.
+ *
+ * @param layout    Layout to check.
+ *
+ * @return True if the layout fits, false otherwise.
+ */
+static bool
+hidrd_layout_prog_fits(const hidrd_layout *layout)
+{
+    const hidrd_layout_report  *report;
+    const hidrd_layout_report  *report_end;
+
+    /* Value slots are u16 and limited by the program validator */
+    if (hidrd_layout_get_value_max(layout) > HIDRD_LAYOUT_REPORT_SIZE_MAX)
+        return false;
+
+    /* Report indexes, lengths and word offsets are u16 */
+    if (layout->report_num > UINT16_MAX)
+        return false;
+    report = hidrd_layout_get_report_list(layout);
+    for (report_end = report + layout->report_num;
+         report < report_end; report++)
+        if ((report->bit_size + 7) / 8 > UINT16_MAX)
+            return false;
+
+    return true;
+}
+
+
+hidrd_layout_prog *
+hidrd_layout_prog_new(const hidrd_layout *layout, uint32_t flags)
+{
+    hidrd_layout_prog          *prog    = NULL;
+    hidrd_buf                   code    = HIDRD_BUF_EMPTY;
+    uint32_t                    entry[HIDRD_LAYOUT_DIR_NUM];
+    uint8_t                     id_list[HIDRD_LAYOUT_ID_NUM];
+    size_t                      target_list[HIDRD_LAYOUT_ID_NUM];
+    size_t                      id_num;
+    size_t                      i;
+    hidrd_layout_dir            dir;
+    unsigned int                id;
+    const hidrd_layout_report  *report;
+    size_t                      size;
+
+    assert(hidrd_layout_valid(layout));
+
+    if (!hidrd_layout_prog_fits(layout))
+    {
+        errno = EFBIG;
+        return NULL;
+    }
+
+    for (dir = 0; dir < HIDRD_LAYOUT_DIR_NUM; dir++)
+    {
+        entry[dir] = code.len;
+
+        if (!layout->ids)
+        {
+            report = hidrd_layout_lookup(layout, dir, 0);
+            if (!((report == NULL)
+                    ? hidrd_layout_prog_emit(&code,
+                                             HIDRD_LAYOUT_PROG_OP_FAIL)
+                    : hidrd_layout_prog_emit_report(&code, layout,
+                                                    report, flags)))
+                goto cleanup;
+            continue;
+        }
+
+        /* Output the report ID dispatch */
+        for (id_num = 0, id = 0; id < HIDRD_LAYOUT_ID_NUM; id++)
+        {
+            if (hidrd_layout_lookup(layout, dir, id) == NULL)
+                continue;
+            if (!hidrd_layout_prog_emit(&code, HIDRD_LAYOUT_PROG_OP_BR_ID,
+                                        id, (uint32_t)0))
+                goto cleanup;
+            id_list[id_num] = id;
+            target_list[id_num] = code.len - 4;
+            id_num++;
+        }
+        if (!hidrd_layout_prog_emit(&code, HIDRD_LAYOUT_PROG_OP_FAIL))
+            goto cleanup;
+
+        /* Output the reports, resolving the dispatch targets */
+        for (i = 0; i < id_num; i++)
+        {
+            hidrd_layout_prog_set_u32((uint8_t *)code.ptr + target_list[i],
+                                      code.len);
+            if (!hidrd_layout_prog_emit_report(
+                        &code, layout,
+                        hidrd_layout_lookup(layout, dir, id_list[i]),
+                        flags))
+                goto cleanup;
+        }
+    }
+
+    size = sizeof(*prog) + code.len;
+    prog = malloc(size);
+    if (prog == NULL)
+        goto cleanup;
+
+    prog->size = size;
+    prog->version = HIDRD_LAYOUT_PROG_VERSION;
+    prog->flags = flags;
+    prog->ids = layout->ids ? 1 : 0;
+    prog->value_max = hidrd_layout_get_value_max(layout);
+    prog->code_off = sizeof(*prog);
+    prog->code_len = code.len;
+    memcpy(prog->entry, entry, sizeof(entry));
+    memcpy((uint8_t *)prog + prog->code_off, code.ptr, code.len);
+
+    assert(hidrd_layout_prog_valid(prog));
+
+cleanup:
+
+    hidrd_buf_clnp(&code);
+
+    if (prog == NULL)
+        errno = ENOMEM;
+
+    return prog;
+}
+
+
+bool
+hidrd_layout_prog_valid(const hidrd_layout_prog *prog)
+{
+    bool            result  = false;
+    const uint8_t  *code;
+    uint8_t        *start   = NULL;
+    uint32_t        off;
+    uint32_t        target;
+    uint8_t         op      = HIDRD_LAYOUT_PROG_OP_FAIL;
+    const uint8_t  *p;
+    size_t          i;
+
+    if (prog == NULL ||
+        prog->size < sizeof(*prog) ||
+        prog->version != HIDRD_LAYOUT_PROG_VERSION ||
+        prog->value_max > HIDRD_LAYOUT_REPORT_SIZE_MAX ||
+        prog->code_off < sizeof(*prog) ||
+        prog->code_off > prog->size ||
+        prog->code_len == 0 ||
+        prog->code_len > prog->size - prog->code_off)
+        return false;
+
+    code = hidrd_layout_prog_get_code(prog);
+
+    /* Mark instruction starts, checking the operands */
+    start = calloc(prog->code_len, 1);
+    if (start == NULL)
+        return false;
+    for (off = 0; off < prog->code_len; off += hidrd_layout_prog_op_size[op])
+    {
+        p = code + off;
+        op = *p;
+        if (op >= HIDRD_LAYOUT_PROG_OP_NUM ||
+            hidrd_layout_prog_op_size[op] > prog->code_len - off)
+            goto cleanup;
+        start[off] = 1;
+        switch (op)
+        {
+            case HIDRD_LAYOUT_PROG_OP_EXT:
+                if (p[2] < 1 || p[2] > 32 || p[1] + p[2] > 64)
+                    goto cleanup;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_SEXT:
+                if (p[1] < 1 || p[1] > 32)
+                    goto cleanup;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_SCALE:
+                if (hidrd_layout_prog_get_s32(p + 13) <= 0)
+                    goto cleanup;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_ST:
+                if (hidrd_layout_prog_get_u16(p + 1) >= prog->value_max)
+                    goto cleanup;
+                break;
+            default:
+                break;
+        }
+    }
+
+    /* The code must not run past its end */
+    if (op != HIDRD_LAYOUT_PROG_OP_FAIL && op != HIDRD_LAYOUT_PROG_OP_END)
+        goto cleanup;
+
+    /* Check the entries and only forward jumps are to instructions */
+    for (i = 0; i < HIDRD_LAYOUT_DIR_NUM; i++)
+        if (prog->entry[i] >= prog->code_len || !start[prog->entry[i]])
+            goto cleanup;
+    for (off = 0; off < prog->code_len; off += hidrd_layout_prog_op_size[op])
+    {
+        p = code + off;
+        op = *p;
+        if (op != HIDRD_LAYOUT_PROG_OP_BR_ID)
+            continue;
+        target = hidrd_layout_prog_get_u32(p + 2);
+        if (target <= off || target >= prog->code_len || !start[target])
+            goto cleanup;
+    }
+
+    result = true;
+
+cleanup:
+
+    free(start);
+
+    return result;
+}
+
+
+void
+hidrd_layout_prog_delete(hidrd_layout_prog *prog)
+{
+    assert(prog == NULL || hidrd_layout_prog_valid(prog));
+    free(prog);
+}
+
+
+uint32_t
+hidrd_layout_prog_run(const hidrd_layout_prog  *prog,
+                      hidrd_layout_dir          dir,
+                      const void               *buf,
+                      size_t                    len,
+                      int32_t                  *values)
+{
+    const uint8_t  *code    = hidrd_layout_prog_get_code(prog);
+    const uint8_t  *pc;
+    const uint8_t  *data    = (const uint8_t *)buf;
+    uint8_t         id      = 0;
+    uint64_t        word    = 0;
+    int64_t         value   = 0;
+    int64_t         sign;
+    int64_t         lmin;
+    int64_t         den;
+
+    assert(prog != NULL);
+    assert(hidrd_layout_dir_valid(dir));
+    assert(buf != NULL || len == 0);
+    assert(values != NULL);
+
+    if (prog->ids)
+    {
+        if (len == 0)
+            return HIDRD_LAYOUT_PROG_FAIL;
+        id = *data++;
+        len--;
+    }
+
+    for (pc = code + prog->entry[dir];;)
+        switch (*pc)
+        {
+            case HIDRD_LAYOUT_PROG_OP_FAIL:
+                return HIDRD_LAYOUT_PROG_FAIL;
+            case HIDRD_LAYOUT_PROG_OP_END:
+                return hidrd_layout_prog_get_u16(pc + 1);
+            case HIDRD_LAYOUT_PROG_OP_BR_ID:
+                pc = (pc[1] == id)
+                        ? code + hidrd_layout_prog_get_u32(pc + 2)
+                        : pc + 6;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_CHK:
+                if (len < hidrd_layout_prog_get_u16(pc + 1))
+                    return HIDRD_LAYOUT_PROG_FAIL;
+                pc += 3;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_LD:
+                word = layout_bits_load(data, len,
+                                        hidrd_layout_prog_get_u16(pc + 1));
+                pc += 3;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_EXT:
+                value = (int64_t)((word >> pc[1]) &
+                                  ((UINT64_C(1) << pc[2]) - 1));
+                pc += 3;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_SEXT:
+                sign = INT64_C(1) << (pc[1] - 1);
+                value = (value ^ sign) - sign;
+                pc += 2;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_SCALE:
+                /* Clamp to the logical range, then map */
+                lmin = hidrd_layout_prog_get_s32(pc + 1);
+                den = hidrd_layout_prog_get_s32(pc + 13);
+                if (value < lmin)
+                    value = lmin;
+                else if (value > lmin + den)
+                    value = lmin + den;
+                value = hidrd_layout_prog_get_s32(pc + 5) +
+                        (value - lmin) *
+                        hidrd_layout_prog_get_s32(pc + 9) / den;
+                pc += 17;
+                break;
+            case HIDRD_LAYOUT_PROG_OP_ST:
+                values[hidrd_layout_prog_get_u16(pc + 1)] = (int32_t)value;
+                pc += 3;
+                break;
+            default:
+                assert(!"Invalid operation code");
+                return HIDRD_LAYOUT_PROG_FAIL;
+        }
+}
+
+
+bool
+hidrd_layout_prog_disasm(const hidrd_layout_prog *prog, hidrd_buf *buf)
+{
+    const uint8_t  *code;
+    const uint8_t  *p;
+    uint32_t        off;
+    size_t          i;
+    bool            ok;
+
+    assert(hidrd_layout_prog_valid(prog));
+    assert(buf != NULL);
+
+    if (!hidrd_buf_add_printf(buf,
+                              "version %u\n"
+                              "ids %s\n"
+                              "physical %s\n"
+                              "values %u\n"
+                              "size %u\n",
+                              prog->version,
+                              prog->ids ? "yes" : "no",
+                              (prog->flags &
+                               HIDRD_LAYOUT_PROG_FLAG_PHYSICAL)
+                                ? "yes" : "no",
+                              prog->value_max,
+                              prog->size))
+        return false;
+
+    code = hidrd_layout_prog_get_code(prog);
+    for (off = 0; off < prog->code_len;
+         off += hidrd_layout_prog_op_size[*p])
+    {
+        p = code + off;
+
+        /* Label direction entries */
+        for (i = 0; i < HIDRD_LAYOUT_DIR_NUM; i++)
+            if (prog->entry[i] == off &&
+                !hidrd_buf_add_printf(buf, "%s:\n",
+                                      hidrd_layout_prog_dir_name[i]))
+                return false;
+
+        if (!hidrd_buf_add_printf(buf, "%04X %s",
+                                  off, hidrd_layout_prog_op_name[*p]))
+            return false;
+
+        switch (*p)
+        {
+            case HIDRD_LAYOUT_PROG_OP_END:
+            case HIDRD_LAYOUT_PROG_OP_CHK:
+            case HIDRD_LAYOUT_PROG_OP_LD:
+            case HIDRD_LAYOUT_PROG_OP_ST:
+                ok = hidrd_buf_add_printf(buf, " %u",
+                                          hidrd_layout_prog_get_u16(p + 1));
+                break;
+            case HIDRD_LAYOUT_PROG_OP_BR_ID:
+                ok = hidrd_buf_add_printf(buf, " %u, %04X",
+                                          p[1],
+                                          hidrd_layout_prog_get_u32(p + 2));
+                break;
+            case HIDRD_LAYOUT_PROG_OP_EXT:
+                ok = hidrd_buf_add_printf(buf, " %u, %u", p[1], p[2]);
+                break;
+            case HIDRD_LAYOUT_PROG_OP_SEXT:
+                ok = hidrd_buf_add_printf(buf, " %u", p[1]);
+                break;
+            case HIDRD_LAYOUT_PROG_OP_SCALE:
+                ok = hidrd_buf_add_printf(buf, " %d, %d, %d, %d",
+                                          hidrd_layout_prog_get_s32(p + 1),
+                                          hidrd_layout_prog_get_s32(p + 5),
+                                          hidrd_layout_prog_get_s32(p + 9),
+                                          hidrd_layout_prog_get_s32(p + 13));
+                break;
+            default:
+                ok = true;
+                break;
+        }
+
+        if (!ok || !hidrd_buf_add_char(buf, '\n'))
+            return false;
+    }
+
+    return true;
+}
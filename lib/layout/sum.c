@@ -0,0 +1,295 @@
+/** @file
+ * @brief HID report descriptor - report layout - report size summary
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "hidrd/layout/sum.h"
+
+
+void
+hidrd_layout_sum_init(hidrd_layout_sum *sum)
+{
+    assert(sum != NULL);
+
+    memset(sum, 0, sizeof(*sum));
+    hidrd_buf_init(&sum->stack);
+    sum->err = HIDRD_LAYOUT_SUM_ERR_NONE;
+}
+
+
+bool
+hidrd_layout_sum_valid(const hidrd_layout_sum *sum)
+{
+    return sum != NULL &&
+           hidrd_buf_valid(&sum->stack) &&
+           sum->stack.len % sizeof(hidrd_layout_sum_state) == 0;
+}
+
+
+static bool
+hidrd_layout_sum_global(hidrd_layout_sum   *sum,
+                        const hidrd_item   *item)
+{
+    hidrd_layout_sum_state *state   = &sum->state;
+
+    switch (hidrd_item_global_get_tag(item))
+    {
+        case HIDRD_ITEM_GLOBAL_TAG_REPORT_SIZE:
+            state->report_size = hidrd_item_report_size_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_REPORT_COUNT:
+            state->report_count = hidrd_item_report_count_get_value(item);
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_REPORT_ID:
+            {
+                uint32_t    id  = hidrd_item_report_id_get_value(item);
+
+                if (id == 0 || id >= HIDRD_LAYOUT_ID_NUM)
+                {
+                    sum->err = HIDRD_LAYOUT_SUM_ERR_REPORT_ID;
+                    return false;
+                }
+                state->report_id = id;
+                sum->ids = true;
+            }
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_PUSH:
+            if (!hidrd_buf_add_ptr(&sum->stack, state, sizeof(*state)))
+            {
+                sum->err = HIDRD_LAYOUT_SUM_ERR_ALLOC;
+                return false;
+            }
+            break;
+        case HIDRD_ITEM_GLOBAL_TAG_POP:
+            if (sum->stack.len == 0)
+            {
+                sum->err = HIDRD_LAYOUT_SUM_ERR_POP;
+                return false;
+            }
+            memcpy(state,
+                   (uint8_t *)sum->stack.ptr + sum->stack.len -
+                   sizeof(*state),
+                   sizeof(*state));
+            hidrd_buf_del(&sum->stack, sizeof(*state));
+            break;
+        default:
+            break;
+    }
+
+    return true;
+}
+
+
+bool
+hidrd_layout_sum_put(hidrd_layout_sum *sum, const hidrd_item *item)
+{
+    hidrd_layout_dir    dir;
+
+    assert(hidrd_layout_sum_valid(sum));
+    assert(hidrd_item_valid(item));
+
+    switch (hidrd_item_basic_get_type(item))
+    {
+        case HIDRD_ITEM_BASIC_TYPE_GLOBAL:
+            return hidrd_layout_sum_global(sum, item);
+        case HIDRD_ITEM_BASIC_TYPE_MAIN:
+            switch (hidrd_item_main_get_tag(item))
+            {
+                case HIDRD_ITEM_MAIN_TAG_INPUT:
+                    dir = HIDRD_LAYOUT_DIR_INPUT;
+                    break;
+                case HIDRD_ITEM_MAIN_TAG_OUTPUT:
+                    dir = HIDRD_LAYOUT_DIR_OUTPUT;
+                    break;
+                case HIDRD_ITEM_MAIN_TAG_FEATURE:
+                    dir = HIDRD_LAYOUT_DIR_FEATURE;
+                    break;
+                default:
+                    return true;
+            }
+            sum->bits[dir][sum->state.report_id] +=
+                (uint64_t)sum->state.report_size * sum->state.report_count;
+            return true;
+        default:
+            return true;
+    }
+}
+
+
+char *
+hidrd_layout_sum_errmsg(const hidrd_layout_sum *sum)
+{
+    const char *msg;
+
+    assert(sum != NULL);
+
+    switch (sum->err)
+    {
+        case HIDRD_LAYOUT_SUM_ERR_NONE:
+            msg = "";
+            break;
+        case HIDRD_LAYOUT_SUM_ERR_ALLOC:
+            msg = "memory allocation failure";
+            break;
+        case HIDRD_LAYOUT_SUM_ERR_POP:
+            msg = "Pop item without matching Push";
+            break;
+        case HIDRD_LAYOUT_SUM_ERR_REPORT_ID:
+            msg = "invalid report ID";
+            break;
+        default:
+            assert(!"Unknown error code");
+            return NULL;
+    }
+
+    return strdup(msg);
+}
+
+
+void
+hidrd_layout_sum_clnp(hidrd_layout_sum *sum)
+{
+    assert(sum != NULL);
+
+    hidrd_buf_clnp(&sum->stack);
+}
+
+
+size_t
+hidrd_layout_sum_get_max_bytes(const hidrd_layout_sum  *sum,
+                               hidrd_layout_dir         dir)
+{
+    size_t  id;
+    size_t  bytes;
+    size_t  max     = 0;
+
+    assert(sum != NULL);
+    assert(hidrd_layout_dir_valid(dir));
+
+    for (id = 0; id < HIDRD_LAYOUT_ID_NUM; id++)
+    {
+        bytes = hidrd_layout_sum_get_bytes(sum, dir, id);
+        if (bytes > max)
+            max = bytes;
+    }
+
+    return max;
+}
+
+
+bool
+hidrd_layout_sum_format(const hidrd_layout_sum *sum, hidrd_buf *buf)
+{
+    static const char  *dir_name_list[HIDRD_LAYOUT_DIR_NUM] = {
+        [HIDRD_LAYOUT_DIR_INPUT]    = "input",
+        [HIDRD_LAYOUT_DIR_OUTPUT]   = "output",
+        [HIDRD_LAYOUT_DIR_FEATURE]  = "feature",
+    };
+    size_t              id;
+    size_t              dir;
+
+    assert(sum != NULL);
+    assert(hidrd_buf_valid(buf));
+
+    if (!hidrd_buf_add_printf(buf, "ids=%s\n", sum->ids ? "yes" : "no"))
+        return false;
+
+    for (id = 0; id < HIDRD_LAYOUT_ID_NUM; id++)
+        for (dir = 0; dir < HIDRD_LAYOUT_DIR_NUM; dir++)
+            if (sum->bits[dir][id] != 0 &&
+                !hidrd_buf_add_printf(buf,
+                                      "report id=%zu dir=%s "
+                                      "bits=%llu bytes=%zu\n",
+                                      id, dir_name_list[dir],
+                                      (unsigned long long)
+                                            sum->bits[dir][id],
+                                      hidrd_layout_sum_get_bytes(
+                                            sum, dir, id)))
+                return false;
+
+    for (dir = 0; dir < HIDRD_LAYOUT_DIR_NUM; dir++)
+        if (!hidrd_buf_add_printf(buf, "max dir=%s bytes=%zu\n",
+                                  dir_name_list[dir],
+                                  hidrd_layout_sum_get_max_bytes(sum, dir)))
+            return false;
+
+    return true;
+}
+
+
+bool
+hidrd_layout_summarize(hidrd_layout_sum    *sum,
+                       hidrd_src           *src,
+                       char               **perr)
+{
+    bool                result      = false;
+    const hidrd_item   *item;
+    size_t              pos;
+    char               *err         = NULL;
+    char               *posstr      = NULL;
+
+    assert(sum != NULL);
+    assert(hidrd_src_valid(src));
+
+    hidrd_layout_sum_init(sum);
+
+    for (pos = hidrd_src_getpos(src);
+         (item = hidrd_src_get(src)) != NULL;
+         pos = hidrd_src_getpos(src))
+        if (!hidrd_layout_sum_put(sum, item))
+        {
+            char   *msg = hidrd_layout_sum_errmsg(sum);
+
+            posstr = hidrd_src_fmtpos(src, pos);
+            if (msg == NULL || posstr == NULL ||
+                asprintf(&err, "%s at %s", msg, posstr) < 0)
+                err = NULL;
+            free(msg);
+            goto cleanup;
+        }
+
+    if (hidrd_src_error(src))
+    {
+        err = hidrd_src_errmsg(src);
+        goto cleanup;
+    }
+
+    result = true;
+
+cleanup:
+
+    free(posstr);
+
+    if (!result)
+        hidrd_layout_sum_clnp(sum);
+
+    if (perr != NULL)
+        *perr = result ? strdup("") : err;
+    else
+        free(err);
+
+    return result;
+}
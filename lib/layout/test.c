@@ -0,0 +1,1049 @@
+/** @file
+ * @brief HID report descriptor - report layout library test
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <error.h>
+#include <stdio.h>
+#include "hidrd/layout.h"
+
+/** Mouse, keyboard and vendor feature descriptor, using report IDs */
+static const uint8_t test_desc[] = {
+    /* Mouse, report ID 1 */
+    0x05, 0x01, 0x09, 0x02, 0xA1, 0x01, 0x85, 0x01, 0x09, 0x01, 0xA1, 0x00,
+    0x05, 0x09, 0x19, 0x01, 0x29, 0x03, 0x15, 0x00, 0x25, 0x01, 0x95, 0x03,
+    0x75, 0x01, 0x81, 0x02, 0x95, 0x01, 0x75, 0x05, 0x81, 0x03, 0x05, 0x01,
+    0x09, 0x30, 0x09, 0x31, 0x15, 0x81, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x02,
+    0x81, 0x06, 0xC0, 0xC0,
+    /* Keyboard, report ID 2 */
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x85, 0x02, 0x05, 0x07, 0x19, 0xE0,
+    0x29, 0xE7, 0x15, 0x00, 0x25, 0x01, 0x75, 0x01, 0x95, 0x08, 0x81, 0x02,
+    0x95, 0x01, 0x75, 0x08, 0x81, 0x01, 0x95, 0x05, 0x75, 0x01, 0x05, 0x08,
+    0x19, 0x01, 0x29, 0x05, 0x91, 0x02, 0x95, 0x01, 0x75, 0x03, 0x91, 0x01,
+    0x95, 0x06, 0x75, 0x08, 0x15, 0x00, 0x26, 0xFF, 0x00, 0x05, 0x07, 0x19,
+    0x00, 0x2A, 0xFF, 0x00, 0x81, 0x00, 0xC0,
+    /* Vendor feature, report ID 3, with an unsigned one-byte maximum */
+    0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01, 0x85, 0x03, 0xA4, 0x15, 0x00,
+    0x25, 0xFF, 0x75, 0x08, 0x95, 0x04, 0x09, 0x02, 0xB1, 0x02, 0xB4, 0xC0,
+};
+
+/** Two 12-bit signed values, without report IDs */
+static const uint8_t test_desc_12bit[] = {
+    0x05, 0x01, 0x09, 0x30, 0x09, 0x31, 0x16, 0x00, 0xF8, 0x26, 0xFF, 0x07,
+    0x75, 0x0C, 0x95, 0x02, 0x81, 0x02,
+};
+
+/** Two bytes separated by 64-bit constant padding, without IDs */
+static const uint8_t test_desc_pad[] = {
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x75, 0x08, 0x95, 0x01, 0x81, 0x02,
+    0x75, 0x40, 0x81, 0x01, 0x75, 0x08, 0x81, 0x02,
+};
+
+/** 64-bit data value, unsupported */
+static const uint8_t test_desc_data_64bit[] = {
+    0x75, 0x40, 0x95, 0x01, 0x81, 0x02,
+};
+
+/** 40 signed bytes, 20 signed and 20 unsigned words, without IDs */
+static const uint8_t test_desc_wide[] = {
+    0x15, 0x80, 0x25, 0x7F, 0x75, 0x08, 0x95, 0x28, 0x81, 0x02,
+    0x16, 0x00, 0x80, 0x26, 0xFF, 0x7F, 0x75, 0x10, 0x95, 0x14, 0x81, 0x02,
+    0x15, 0x00, 0x27, 0xFF, 0xFF, 0x00, 0x00, 0x81, 0x02,
+};
+
+/** 20 signed and 21 unsigned packed 12-bit values, without IDs */
+static const uint8_t test_desc_packed[] = {
+    0x16, 0x00, 0xF8, 0x26, 0xFF, 0x07, 0x75, 0x0C, 0x95, 0x14, 0x81, 0x02,
+    0x15, 0x00, 0x26, 0xFF, 0x0F, 0x95, 0x15, 0x81, 0x02,
+};
+
+/** Two-value array of a whole vendor usage page, without IDs */
+static const uint8_t test_desc_page[] = {
+    0x06, 0x00, 0xFF, 0x19, 0x00, 0x2A, 0xFF, 0xFF, 0x15, 0x00, 0x26, 0xFF,
+    0x00, 0x75, 0x08, 0x95, 0x02, 0x81, 0x00,
+};
+
+/** Byte with logical range 0-255 and physical range 0-1000 */
+static const uint8_t test_desc_phys[] = {
+    0x15, 0x00, 0x26, 0xFF, 0x00, 0x35, 0x00, 0x46, 0xE8, 0x03, 0x75, 0x08,
+    0x95, 0x01, 0x81, 0x02,
+};
+
+/** 70000 one-bit values, too many for a decoding program */
+static const uint8_t test_desc_huge[] = {
+    0x05, 0x01, 0x09, 0x01, 0xA1, 0x01, 0x75, 0x01, 0x97, 0x70, 0x11, 0x01,
+    0x00, 0x81, 0x02, 0xC0,
+};
+
+/**
+ * Two signed bytes with logical range -127-127, physical range -500-500
+ * and unit exponent -2 (4-bit code)
+ */
+static const uint8_t test_desc_phys_exp[] = {
+    0x15, 0x81, 0x25, 0x7F, 0x36, 0x0C, 0xFE, 0x46, 0xF4, 0x01, 0x55, 0x0E,
+    0x75, 0x08, 0x95, 0x02, 0x81, 0x02,
+};
+
+/** Expected field */
+typedef struct test_field {
+    uint8_t     id;
+    uint8_t     dir;
+    uint32_t    bit_off;
+    uint32_t    bit_size;
+    uint32_t    count;
+    int32_t     logical_minimum;
+    int32_t     logical_maximum;
+    uint32_t    flags;
+    uint32_t    usage_min;
+    uint32_t    usage_max;
+} test_field;
+
+#define V   HIDRD_LAYOUT_FIELD_FLAG_VARIABLE
+#define C   HIDRD_LAYOUT_FIELD_FLAG_CONSTANT
+#define R   HIDRD_LAYOUT_FIELD_FLAG_RELATIVE
+#define S   HIDRD_LAYOUT_FIELD_FLAG_SIGNED
+#define I   HIDRD_LAYOUT_DIR_INPUT
+#define O   HIDRD_LAYOUT_DIR_OUTPUT
+#define F   HIDRD_LAYOUT_DIR_FEATURE
+
+static const test_field test_field_list[] = {
+    {1, I, 0,  1, 3,    0,   1, V,         0x00090001, 0x00090003},
+    {1, I, 3,  5, 1,    0,   1, C | V,     0,          0},
+    {1, I, 8,  8, 2, -127, 127, V | R | S, 0x00010030, 0x00010031},
+    {2, I, 0,  1, 8,    0,   1, V,         0x000700E0, 0x000700E7},
+    {2, I, 8,  8, 1,    0,   1, C,         0,          0},
+    {2, I, 16, 8, 6,    0, 255, 0,         0x00070000, 0x000700FF},
+    {2, O, 0,  1, 5,    0,   1, V,         0x00080001, 0x00080005},
+    {2, O, 5,  3, 1,    0,   1, C,         0,          0},
+    {3, F, 0,  8, 4,    0, 255, V,         0xFF000002, 0xFF000002},
+};
+
+#undef V
+#undef C
+#undef R
+#undef S
+#undef I
+#undef O
+#undef F
+
+/** Report stream: mouse, keyboard, mouse, truncated keyboard */
+static const uint8_t test_report_stream[] = {
+    0x01, 0x05, 0xFF, 0x10,
+    0x02, 0x81, 0x00, 0x04, 0x05, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x02, 0x01, 0x80,
+    0x02, 0x00, 0x00,
+};
+
+/** Expected mouse and keyboard report values */
+static const int32_t test_mouse_values[] = {1, 0, 1, 0, -1, 16};
+static const int32_t test_keyboard_values[] = {1, 0, 0, 0, 0, 0, 0, 1,
+                                               0,
+                                               4, 5, 0, 0, 0, 0};
+
+/** Vendor feature report and its expected values */
+static const uint8_t test_feature_report[] = {0x03, 0xFF, 0x80, 0x01, 0x02};
+static const int32_t test_feature_values[] = {255, 128, 1, 2};
+
+/**
+ * Keyboard LED and key usage values, expected output and input reports;
+ * the modifier usage matches both the modifier and the key array fields.
+ */
+static const hidrd_report_usage_value test_keyboard_usage_list[] = {
+    {0x00080001, 1}, {0x00080003, 5}, {0x00090001, 1},
+    {0x000700E1, 1}, {0x00070004, 1}, {0x00070029, 0}, {0x00070005, 1},
+};
+static const uint8_t test_keyboard_output_report[] = {0x02, 0x05};
+static const uint8_t test_keyboard_input_report[] = {
+    0x02, 0x02, 0x00, 0xE1, 0x04, 0x05, 0x00, 0x00, 0x00,
+};
+
+/** Out-of-range feature values and the expected clamped report */
+static const int32_t test_feature_clamp_values[] = {300, -5, 128, 7};
+static const uint8_t test_feature_clamp_report[] = {
+    0x03, 0xFF, 0x00, 0x80, 0x07
+};
+
+/** Report for the 12-bit descriptor: -2 and 0x123 */
+static const uint8_t test_report_12bit[] = {0xFE, 0x3F, 0x12};
+
+/**
+ * Feed a native descriptor to a layout compiler.
+ *
+ * @param cmpl  Compiler to feed.
+ * @param buf   Descriptor buffer.
+ * @param size  Descriptor size.
+ *
+ * @return True if fed successfully, false otherwise.
+ */
+static bool
+feed(hidrd_layout_cmpl *cmpl, const uint8_t *buf, size_t size)
+{
+    const uint8_t  *p;
+    size_t          item_size;
+
+    for (p = buf; p < buf + size; p += item_size)
+    {
+        if (!hidrd_item_fits(p, buf + size - p, &item_size))
+            error(1, 0, "Truncated test descriptor");
+        if (!hidrd_layout_cmpl_put(cmpl, p))
+            return false;
+    }
+
+    return true;
+}
+
+
+
+/**
+ * Compile a native descriptor into a layout, failing the test on error.
+ *
+ * @param buf   Descriptor buffer.
+ * @param size  Descriptor size.
+ *
+ * @return Compiled layout.
+ */
+static hidrd_layout *
+compile(const uint8_t *buf, size_t size)
+{
+    hidrd_layout_cmpl   cmpl;
+    hidrd_layout       *layout;
+
+    if (!hidrd_layout_cmpl_init(&cmpl))
+        error(1, 0, "Failed to initialize layout compiler");
+    if (!feed(&cmpl, buf, size))
+        error(1, 0, "Failed to compile test descriptor: %s",
+              hidrd_layout_cmpl_errmsg(&cmpl));
+    layout = hidrd_layout_cmpl_finish(&cmpl);
+    if (layout == NULL)
+        error(1, 0, "Failed to finish test descriptor layout: %s",
+              hidrd_layout_cmpl_errmsg(&cmpl));
+    hidrd_layout_cmpl_clnp(&cmpl);
+
+    if (!hidrd_layout_valid(layout))
+        error(1, 0, "Compiled layout is invalid");
+
+    return layout;
+}
+
+
+/**
+ * Check decoded values against expected ones, failing the test on
+ * mismatch.
+ *
+ * @param name      Report name.
+ * @param values    Decoded values.
+ * @param expected  Expected values.
+ * @param num       Number of values.
+ */
+static void
+check_values(const char    *name,
+             const int32_t *values,
+             const int32_t *expected,
+             size_t         num)
+{
+    size_t  i;
+
+    for (i = 0; i < num; i++)
+        if (values[i] != expected[i])
+            error(1, 0, "%s report value #%zu is %d instead of %d",
+                  name, i, values[i], expected[i]);
+}
+
+
+/**
+ * Check column extraction of every field of a report with every
+ * supported kernel against the report decoder, failing the test on
+ * mismatch.
+ *
+ * @param layout    Layout to use.
+ * @param report    Report to extract the fields of.
+ * @param buf       Buffer containing the reports.
+ * @param num       Number of reports in the buffer, up to 4.
+ */
+static void
+check_col(const hidrd_layout           *layout,
+          const hidrd_layout_report    *report,
+          const uint8_t                *buf,
+          size_t                        num)
+{
+    size_t                      bytes   = hidrd_layout_report_get_bytes(
+                                                            layout, report);
+    const hidrd_layout_field   *field;
+    const hidrd_layout_field   *field_end;
+    hidrd_report_col_kern       kern;
+    int32_t                     values[4][128];
+    int32_t                     col[4 * 128];
+    size_t                      i;
+
+    for (i = 0; i < num; i++)
+        if (hidrd_report_decode_dir(layout, report->dir, buf + bytes * i,
+                                    bytes, values[i]) != report)
+            error(1, 0, "Failed to decode column test report");
+
+    field = hidrd_layout_report_get_field_list(layout, report);
+    for (field_end = field + report->field_num; field < field_end; field++)
+        for (kern = HIDRD_REPORT_COL_KERN_AUTO;
+             kern < HIDRD_REPORT_COL_KERN_NUM; kern++)
+        {
+            if (!hidrd_report_col_kern_supported(kern))
+                continue;
+            hidrd_report_col_extract(layout, field, kern,
+                                     buf, bytes, num, col);
+            for (i = 0; i < num; i++)
+                if (memcmp(col + field->count * i,
+                           values[i] + field->value_idx,
+                           sizeof(*col) * field->count) != 0)
+                    error(1, 0, "%s kernel extracted field #%u of "
+                          "report #%zu incorrectly",
+                          hidrd_report_col_kern_name(kern),
+                          (unsigned)(field - hidrd_layout_get_field_list(
+                                                    layout)),
+                          i);
+        }
+}
+
+
+/**
+ * Lookup a usage in a usage index and check it is found exactly at the
+ * specified location, failing the test otherwise.
+ *
+ * @param idx           Index to lookup in.
+ * @param report_idx    Report index to lookup in.
+ * @param usage         Usage to lookup.
+ * @param field_idx     Expected field index.
+ * @param usage_idx     Expected usage index in the field.
+ */
+static void
+check_idx(const hidrd_layout_idx   *idx,
+          uint32_t                  report_idx,
+          hidrd_usage               usage,
+          uint32_t                  field_idx,
+          uint32_t                  usage_idx)
+{
+    hidrd_layout_loc    loc;
+
+    if (hidrd_layout_idx_lookup(idx, report_idx, usage, &loc, 1) != 1 ||
+        loc.field_idx != field_idx || loc.idx != usage_idx)
+        error(1, 0, "Usage 0x%08X is not found at field #%u, index %u",
+              usage, field_idx, usage_idx);
+}
+
+
+/**
+ * Run a decoding program on a report and check the result against the
+ * report decoder, failing the test on mismatch.
+ *
+ * @param layout    Layout the program was compiled from.
+ * @param prog      Program compiled without the physical scaling.
+ * @param dir       Report direction.
+ * @param buf       Report buffer.
+ * @param len       Report buffer length.
+ */
+static void
+check_prog(const hidrd_layout      *layout,
+           const hidrd_layout_prog *prog,
+           hidrd_layout_dir         dir,
+           const uint8_t           *buf,
+           size_t                   len)
+{
+    const hidrd_layout_report  *report;
+    uint32_t                    report_idx;
+    int32_t                     expected[128];
+    int32_t                     values[128];
+
+    report = hidrd_report_decode_dir(layout, dir, buf, len, expected);
+    report_idx = hidrd_layout_prog_run(prog, dir, buf, len, values);
+    if (report == NULL)
+    {
+        if (report_idx != HIDRD_LAYOUT_PROG_FAIL)
+            error(1, 0, "Program decoded an undecodable report");
+        return;
+    }
+    if (report_idx !=
+            (uint32_t)(report - hidrd_layout_get_report_list(layout)))
+        error(1, 0, "Program decoded report #%u instead of #%u",
+              report_idx,
+              (unsigned int)(report - hidrd_layout_get_report_list(layout)));
+    check_values("Program", values, expected, report->value_num);
+}
+
+
+/**
+ * Convert logical values to physical ones, both in floating and fixed
+ * point, and check them, failing the test on mismatch.
+ *
+ * @param phys      Conversion factors.
+ * @param values    Logical values.
+ * @param expected  Expected physical values.
+ * @param num       Number of values, up to 4.
+ */
+static void
+check_phys(const hidrd_layout_phys *phys,
+           const int32_t           *values,
+           const double            *expected,
+           size_t                   num)
+{
+    double  out[4];
+    int64_t out_fx[4];
+    double  diff;
+    size_t  i;
+
+    hidrd_layout_phys_conv(phys, values, 1, num, out);
+    if (!hidrd_layout_phys_conv_fx(phys, values, 1, num, out_fx))
+        error(1, 0, "Fixed-point physical conversion is not available");
+    for (i = 0; i < num; i++)
+    {
+        diff = out[i] - expected[i];
+        if (diff < -1e-9 || diff > 1e-9)
+            error(1, 0, "Physical value #%zu is %f instead of %f",
+                  i, out[i], expected[i]);
+        diff = (double)out_fx[i] -
+               expected[i] * (1 << HIDRD_LAYOUT_PHYS_FX_FRAC);
+        if (diff < -1 || diff > 1)
+            error(1, 0, "Fixed-point physical value #%zu is %f "
+                  "instead of %f", i,
+                  (double)out_fx[i] / (1 << HIDRD_LAYOUT_PHYS_FX_FRAC),
+                  expected[i]);
+    }
+}
+
+
+/**
+ * Summarize report sizes of a native descriptor and check them against
+ * its compiled layout, failing the test on mismatch.
+ *
+ * @param layout    Layout compiled from the descriptor.
+ * @param buf       Descriptor buffer.
+ * @param size      Descriptor size.
+ */
+static void
+check_sum(const hidrd_layout *layout, const uint8_t *buf, size_t size)
+{
+    hidrd_layout_sum            sum;
+    const uint8_t              *p;
+    size_t                      item_size;
+    size_t                      dir;
+    size_t                      id;
+    const hidrd_layout_report  *report;
+
+    hidrd_layout_sum_init(&sum);
+    for (p = buf; p < buf + size; p += item_size)
+    {
+        if (!hidrd_item_fits(p, buf + size - p, &item_size))
+            error(1, 0, "Truncated test descriptor");
+        if (!hidrd_layout_sum_put(&sum, p))
+            error(1, 0, "Failed to summarize test descriptor: %s",
+                  hidrd_layout_sum_errmsg(&sum));
+    }
+
+    if (sum.ids != (layout->ids != 0))
+        error(1, 0, "Summary report ID use doesn't match layout");
+
+    for (dir = 0; dir < HIDRD_LAYOUT_DIR_NUM; dir++)
+        for (id = 0; id < HIDRD_LAYOUT_ID_NUM; id++)
+        {
+            report = hidrd_layout_lookup(layout, dir, id);
+            if (hidrd_layout_sum_get_bytes(&sum, dir, id) !=
+                (report == NULL
+                    ? 0
+                    : hidrd_layout_report_get_bytes(layout, report)))
+                error(1, 0, "Summary size of report %zu, direction %zu "
+                      "doesn't match layout", id, dir);
+        }
+
+    hidrd_layout_sum_clnp(&sum);
+}
+
+/**
+ * Corrupt a cached layout, check the cache still loads but the layout is
+ * not found, and restore it, failing the test otherwise.
+ *
+ * @param name      Corruption name.
+ * @param path      Cache file path.
+ * @param desc      Native descriptor of the corrupted layout.
+ * @param desc_size Native descriptor size.
+ * @param off       Cache file offset of the corrupted data.
+ * @param data      Corrupted data.
+ * @param size      Corrupted data size, up to 8 bytes.
+ */
+static void
+check_cache_corrupt(const char *name, const char *path,
+                    const void *desc, size_t desc_size,
+                    off_t off, const void *data, size_t size)
+{
+    hidrd_layout_cache  cache   = HIDRD_LAYOUT_CACHE_EMPTY;
+    uint8_t             orig[8];
+    int                 fd;
+
+    assert(size <= sizeof(orig));
+
+    fd = open(path, O_RDWR);
+    if (fd < 0 ||
+        pread(fd, orig, size, off) != (ssize_t)size ||
+        pwrite(fd, data, size, off) != (ssize_t)size)
+        error(1, errno, "Failed to corrupt cache with %s", name);
+
+    if (!hidrd_layout_cache_load(&cache, path))
+        error(1, errno, "Failed to load cache with %s", name);
+    if (hidrd_layout_cache_lookup(&cache, desc, desc_size) != NULL)
+        error(1, 0, "Layout with %s is found", name);
+    hidrd_layout_cache_unload(&cache);
+
+    if (pwrite(fd, orig, size, off) != (ssize_t)size)
+        error(1, errno, "Failed to restore cache after %s", name);
+    close(fd);
+}
+
+int
+main(int argc, char **argv)
+{
+    hidrd_layout_cmpl           cmpl;
+    hidrd_layout               *layout;
+    const hidrd_layout_report  *report;
+    const hidrd_layout_field   *field;
+    const test_field           *test;
+    size_t                      i;
+    hidrd_usage                 usage;
+    uint8_t                     pop = 0xB4;
+    int32_t                     values[15];
+    int32_t                     batch_values[4][15];
+    const hidrd_layout_report  *batch_report_list[4];
+    size_t                      size;
+    uint8_t                     buf[16];
+    uint8_t                     wide_buf[120 * 4];
+    hidrd_layout_idx           *idx;
+    hidrd_layout_loc            locs[2];
+    hidrd_layout_sum            sum;
+    hidrd_layout_prog          *prog;
+    hidrd_layout_prog          *prog_copy;
+    hidrd_buf                   text        = HIDRD_BUF_EMPTY;
+    hidrd_layout_phys          *phys;
+    static const int32_t        phys_values[] = {0, 128, 255, -127};
+    static const double         phys_expected[] = {0, 128000.0 / 255,
+                                                   1000, -5};
+    hidrd_layout_cache_bld      cache_bld;
+    hidrd_layout_cache          cache       = HIDRD_LAYOUT_CACHE_EMPTY;
+    const hidrd_layout         *cached;
+    char                        cache_path[] = "/tmp/hidrd_layout_test.XXXXXX";
+    int                         cache_fd;
+    off_t                       cache_off;
+    off_t                       field_off;
+    static const uint32_t       cache_none  = UINT32_MAX;
+    static const uint32_t       cache_zero  = 0;
+    uint32_t                    cache_bad[2];
+
+    (void)argc;
+    (void)argv;
+
+    /*
+     * Compile and check the test descriptor
+     */
+    layout = compile(test_desc, sizeof(test_desc));
+    if (!layout->ids)
+        error(1, 0, "Report IDs are not marked as used");
+    if (layout->report_num != 4)
+        error(1, 0, "Layout has %u reports instead of 4",
+              layout->report_num);
+    if (layout->field_num != sizeof(test_field_list) /
+                             sizeof(*test_field_list))
+        error(1, 0, "Layout has %u fields instead of %zu",
+              layout->field_num,
+              sizeof(test_field_list) / sizeof(*test_field_list));
+
+    for (i = 0, test = test_field_list;
+         i < sizeof(test_field_list) / sizeof(*test_field_list);
+         i++, test++)
+    {
+        report = hidrd_layout_lookup(layout, test->dir, test->id);
+        if (report == NULL)
+            error(1, 0, "Report %u of direction %u is missing",
+                  test->id, test->dir);
+        field = hidrd_layout_get_field_list(layout) + i;
+        if (hidrd_layout_get_report_list(layout) + field->report_idx !=
+                report ||
+            field->bit_off != test->bit_off ||
+            field->bit_size != test->bit_size ||
+            field->count != test->count ||
+            field->logical_minimum != test->logical_minimum ||
+            field->logical_maximum != test->logical_maximum ||
+            field->flags != test->flags)
+            error(1, 0, "Field #%zu doesn't match expectations", i);
+        if (test->usage_min == 0)
+        {
+            if (field->usage_num != 0)
+                error(1, 0, "Field #%zu has unexpected usages", i);
+            continue;
+        }
+        if (field->usage_num == 0 ||
+            !hidrd_layout_field_get_usage(layout, field, 0, &usage) ||
+            usage != test->usage_min ||
+            !hidrd_layout_field_get_usage(layout, field,
+                                          test->usage_max -
+                                          test->usage_min,
+                                          &usage) ||
+            usage != test->usage_max)
+            error(1, 0, "Field #%zu usages don't match expectations", i);
+    }
+
+    report = hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_INPUT, 2);
+    if (hidrd_layout_report_get_bytes(layout, report) != 9)
+        error(1, 0, "Keyboard input report is %zu bytes instead of 9",
+              hidrd_layout_report_get_bytes(layout, report));
+    if (report->value_num != 15)
+        error(1, 0, "Keyboard input report has %u values instead of 15",
+              report->value_num);
+    if (hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_OUTPUT, 1) != NULL)
+        error(1, 0, "Found non-existent mouse output report");
+
+    /* Variable field usage past the list end is the last usage */
+    field = hidrd_layout_report_get_field_list(
+                layout, hidrd_layout_lookup(layout,
+                                            HIDRD_LAYOUT_DIR_FEATURE, 3));
+    if (!hidrd_layout_field_get_usage(layout, field, 3, &usage) ||
+        usage != 0xFF000002)
+        error(1, 0, "Variable field last usage is not repeated");
+
+    /*
+     * Decode reports
+     */
+    if (hidrd_layout_get_value_max(layout) != 15)
+        error(1, 0, "Maximum report value number is %zu instead of 15",
+              hidrd_layout_get_value_max(layout));
+
+    report = hidrd_report_decode(layout, test_report_stream, 4, values);
+    if (report != hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_INPUT, 1))
+        error(1, 0, "Failed to decode mouse report");
+    check_values("Mouse", values, test_mouse_values,
+                 sizeof(test_mouse_values) / sizeof(*test_mouse_values));
+
+    if (hidrd_report_decode(layout, test_report_stream, 3, values) != NULL)
+        error(1, 0, "Truncated mouse report is decoded");
+    if (hidrd_report_decode(layout, test_feature_report,
+                            sizeof(test_feature_report), values) != NULL)
+        error(1, 0, "Report with unknown input ID is decoded");
+
+    report = hidrd_report_decode_dir(layout, HIDRD_LAYOUT_DIR_FEATURE,
+                                     test_feature_report,
+                                     sizeof(test_feature_report), values);
+    if (report == NULL)
+        error(1, 0, "Failed to decode feature report");
+    check_values("Feature", values, test_feature_values,
+                 sizeof(test_feature_values) /
+                 sizeof(*test_feature_values));
+
+    memset(batch_values, 0, sizeof(batch_values));
+    if (hidrd_report_decode_batch(layout, HIDRD_LAYOUT_DIR_INPUT,
+                                  test_report_stream,
+                                  sizeof(test_report_stream),
+                                  4, batch_values[0], 15,
+                                  batch_report_list, &size) != 3 ||
+        size != 17)
+        error(1, 0, "Failed to decode report batch");
+    check_values("Batch mouse", batch_values[0], test_mouse_values,
+                 sizeof(test_mouse_values) / sizeof(*test_mouse_values));
+    check_values("Batch keyboard", batch_values[1], test_keyboard_values,
+                 sizeof(test_keyboard_values) /
+                 sizeof(*test_keyboard_values));
+    if (batch_values[2][0] != 0 || batch_values[2][1] != 1 ||
+        batch_values[2][4] != 1 || batch_values[2][5] != -128 ||
+        batch_report_list[2] != batch_report_list[0])
+        error(1, 0, "Batch second mouse report is decoded incorrectly");
+
+    /*
+     * Decode reports with a program
+     */
+    prog = hidrd_layout_prog_new(layout, 0);
+    if (prog == NULL || !hidrd_layout_prog_valid(prog) ||
+        prog->value_max != 15)
+        error(1, 0, "Failed to compile decoding program");
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_INPUT,
+               test_report_stream, 4);
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_INPUT,
+               test_report_stream, 3);
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_INPUT,
+               test_report_stream + 4, 9);
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_INPUT,
+               test_report_stream + 17, 3);
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_INPUT,
+               test_feature_report, sizeof(test_feature_report));
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_FEATURE,
+               test_feature_report, sizeof(test_feature_report));
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_OUTPUT,
+               test_keyboard_output_report,
+               sizeof(test_keyboard_output_report));
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_OUTPUT, buf, 0);
+
+    /* Copy the program, as if stored and loaded, then corrupt a jump */
+    prog_copy = malloc(prog->size);
+    if (prog_copy == NULL)
+        error(1, 0, "Failed to allocate program copy");
+    memcpy(prog_copy, prog, prog->size);
+    check_prog(layout, prog_copy, HIDRD_LAYOUT_DIR_INPUT,
+               test_report_stream + 4, 9);
+    if (((uint8_t *)prog_copy)[prog_copy->code_off] !=
+            HIDRD_LAYOUT_PROG_OP_BR_ID)
+        error(1, 0, "Program doesn't start with report ID dispatch");
+    ((uint8_t *)prog_copy)[prog_copy->code_off + 2] = 0;
+    if (hidrd_layout_prog_valid(prog_copy))
+        error(1, 0, "Program with backward jump is valid");
+    free(prog_copy);
+
+    if (!hidrd_layout_prog_disasm(prog, &text) || text.len == 0)
+        error(1, 0, "Failed to disassemble decoding program");
+    hidrd_buf_clnp(&text);
+    hidrd_layout_prog_delete(prog);
+
+    /*
+     * Check the report size summary
+     */
+    check_sum(layout, test_desc, sizeof(test_desc));
+
+    /*
+     * Lookup usages in the usage index
+     */
+    idx = hidrd_layout_idx_new(layout);
+    if (idx == NULL)
+        error(1, 0, "Failed to build usage index");
+    check_idx(idx, HIDRD_LAYOUT_IDX_REPORT_ANY,
+              hidrd_usage_compose(HIDRD_USAGE_PAGE_DESKTOP, 0x31), 2, 1);
+    check_idx(idx, HIDRD_LAYOUT_IDX_REPORT_ANY, 0x00080003, 6, 2);
+    check_idx(idx, HIDRD_LAYOUT_IDX_REPORT_ANY, 0xFF000002, 8, 0);
+    check_idx(idx, HIDRD_LAYOUT_IDX_REPORT_ANY, 0x00070029, 5, 0x29);
+    report = hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_INPUT, 2);
+    if (hidrd_layout_idx_lookup_report(idx, layout, report, 0x00080003,
+                                       NULL, 0) != 0)
+        error(1, 0, "LED usage is found in keyboard input report");
+    /* Modifier usages are both in the modifier and the key array */
+    if (hidrd_layout_idx_lookup_report(idx, layout, report, 0x000700E1,
+                                       locs, 2) != 2 ||
+        locs[0].field_idx + locs[1].field_idx != 3 + 5 ||
+        locs[0].idx + locs[1].idx != 1 + 0xE1)
+        error(1, 0, "Modifier usage locations are not found");
+    if (hidrd_layout_idx_lookup(idx, HIDRD_LAYOUT_IDX_REPORT_ANY,
+                                0x00090004, locs, 2) != 0)
+        error(1, 0, "Non-existent button usage is found");
+    hidrd_layout_idx_delete(idx);
+
+    /*
+     * Extract columns from a keyboard report
+     */
+    check_col(layout, hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_INPUT, 2),
+              test_report_stream + 4, 1);
+
+    /*
+     * Encode reports
+     */
+    if (hidrd_report_encode(layout, HIDRD_LAYOUT_DIR_OUTPUT, 2,
+                            test_keyboard_usage_list,
+                            sizeof(test_keyboard_usage_list) /
+                            sizeof(*test_keyboard_usage_list),
+                            buf, sizeof(buf)) !=
+            sizeof(test_keyboard_output_report) ||
+        memcmp(buf, test_keyboard_output_report,
+               sizeof(test_keyboard_output_report)) != 0)
+        error(1, 0, "Failed to encode keyboard output report");
+    if (hidrd_report_encode(layout, HIDRD_LAYOUT_DIR_INPUT, 2,
+                            test_keyboard_usage_list,
+                            sizeof(test_keyboard_usage_list) /
+                            sizeof(*test_keyboard_usage_list),
+                            buf, sizeof(buf)) !=
+            sizeof(test_keyboard_input_report) ||
+        memcmp(buf, test_keyboard_input_report,
+               sizeof(test_keyboard_input_report)) != 0)
+        error(1, 0, "Failed to encode keyboard input report");
+    if (hidrd_report_encode(layout, HIDRD_LAYOUT_DIR_OUTPUT, 1,
+                            NULL, 0, buf, sizeof(buf)) != 0)
+        error(1, 0, "Non-existent mouse output report is encoded");
+    if (hidrd_report_encode(layout, HIDRD_LAYOUT_DIR_INPUT, 2,
+                            NULL, 0, buf, 8) != 0)
+        error(1, 0, "Keyboard input report is encoded into short buffer");
+
+    report = hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_FEATURE, 3);
+    if (hidrd_report_encode_values(layout, report,
+                                   test_feature_clamp_values,
+                                   buf, sizeof(buf)) !=
+            sizeof(test_feature_clamp_report) ||
+        memcmp(buf, test_feature_clamp_report,
+               sizeof(test_feature_clamp_report)) != 0)
+        error(1, 0, "Failed to encode clamped feature report");
+
+    /* Round trip of the keyboard input report */
+    report = hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_INPUT, 2);
+    if (hidrd_report_encode_values(layout, report, test_keyboard_values,
+                                   buf, sizeof(buf)) != 9 ||
+        memcmp(buf, test_report_stream + 4, 9) != 0)
+        error(1, 0, "Failed to encode keyboard input report values");
+
+    hidrd_layout_delete(layout);
+
+    /*
+     * Decode unaligned 12-bit signed values
+     */
+    layout = compile(test_desc_12bit, sizeof(test_desc_12bit));
+    check_sum(layout, test_desc_12bit, sizeof(test_desc_12bit));
+    if (layout->ids ||
+        hidrd_report_decode(layout, test_report_12bit,
+                            sizeof(test_report_12bit), values) == NULL ||
+        values[0] != -2 || values[1] != 0x123)
+        error(1, 0, "Failed to decode 12-bit values");
+    prog = hidrd_layout_prog_new(layout, 0);
+    if (prog == NULL)
+        error(1, 0, "Failed to compile 12-bit decoding program");
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_INPUT,
+               test_report_12bit, sizeof(test_report_12bit));
+    hidrd_layout_prog_delete(prog);
+    values[0] = -3000;
+    if (hidrd_report_encode_values(layout,
+                                   hidrd_layout_lookup(
+                                        layout, HIDRD_LAYOUT_DIR_INPUT, 0),
+                                   values, buf, sizeof(buf)) != 3 ||
+        buf[0] != 0x00 || buf[1] != 0x38 || buf[2] != 0x12)
+        error(1, 0, "Failed to encode 12-bit values");
+    hidrd_layout_delete(layout);
+
+    /*
+     * Skip oversized constant padding, but reject oversized data
+     */
+    layout = compile(test_desc_pad, sizeof(test_desc_pad));
+    check_sum(layout, test_desc_pad, sizeof(test_desc_pad));
+    for (i = 0; i < 10; i++)
+        buf[i] = (uint8_t)(i + 1);
+    report = hidrd_report_decode(layout, buf, 10, values);
+    if (report == NULL || report->bit_size != 80 ||
+        report->field_num != 2 || report->value_num != 2 ||
+        hidrd_layout_get_field_list(layout)[1].bit_off != 72 ||
+        values[0] != 1 || values[1] != 10)
+        error(1, 0, "Failed to decode values around 64-bit padding");
+    prog = hidrd_layout_prog_new(layout, 0);
+    if (prog == NULL)
+        error(1, 0, "Failed to compile padded decoding program");
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_INPUT, buf, 10);
+    hidrd_layout_prog_delete(prog);
+    hidrd_layout_delete(layout);
+    if (!hidrd_layout_cmpl_init(&cmpl))
+        error(1, 0, "Failed to initialize layout compiler");
+    if (feed(&cmpl, test_desc_data_64bit, sizeof(test_desc_data_64bit)) ||
+        cmpl.err != HIDRD_LAYOUT_CMPL_ERR_REPORT_SIZE)
+        error(1, 0, "64-bit data value is not rejected");
+    hidrd_layout_cmpl_clnp(&cmpl);
+
+    /*
+     * Extract columns of wide fields
+     */
+    layout = compile(test_desc_wide, sizeof(test_desc_wide));
+    report = hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_INPUT, 0);
+    if (hidrd_layout_report_get_bytes(layout, report) != 120)
+        error(1, 0, "Wide report is %zu bytes instead of 120",
+              hidrd_layout_report_get_bytes(layout, report));
+    for (i = 0; i < sizeof(wide_buf); i++)
+        wide_buf[i] = (uint8_t)(i * 37 + 11);
+    check_col(layout, report, wide_buf, 4);
+    prog = hidrd_layout_prog_new(layout, 0);
+    if (prog == NULL)
+        error(1, 0, "Failed to compile wide decoding program");
+    check_prog(layout, prog, HIDRD_LAYOUT_DIR_INPUT, wide_buf, 120);
+    hidrd_layout_prog_delete(prog);
+    hidrd_layout_delete(layout);
+
+    /*
+     * Extract columns of packed 12-bit fields
+     */
+    layout = compile(test_desc_packed, sizeof(test_desc_packed));
+    report = hidrd_layout_lookup(layout, HIDRD_LAYOUT_DIR_INPUT, 0);
+    if (hidrd_layout_report_get_bytes(layout, report) != 62)
+        error(1, 0, "Packed report is %zu bytes instead of 62",
+              hidrd_layout_report_get_bytes(layout, report));
+    check_col(layout, report, wide_buf, 4);
+    hidrd_layout_delete(layout);
+
+    /*
+     * Decode a physical value with a program
+     */
+    layout = compile(test_desc_phys, sizeof(test_desc_phys));
+    prog = hidrd_layout_prog_new(layout, HIDRD_LAYOUT_PROG_FLAG_PHYSICAL);
+    if (prog == NULL)
+        error(1, 0, "Failed to compile physical decoding program");
+    buf[0] = 0x80;
+    if (hidrd_layout_prog_run(prog, HIDRD_LAYOUT_DIR_INPUT,
+                              buf, 1, values) != 0 ||
+        values[0] != 501)
+        error(1, 0, "Failed to decode physical value");
+    buf[0] = 0xFF;
+    if (hidrd_layout_prog_run(prog, HIDRD_LAYOUT_DIR_INPUT,
+                              buf, 1, values) != 0 ||
+        values[0] != 1000)
+        error(1, 0, "Failed to decode maximum physical value");
+    hidrd_layout_prog_delete(prog);
+    phys = hidrd_layout_phys_list_new(layout);
+    if (phys == NULL)
+        error(1, 0, "Failed to compute physical conversion factors");
+    check_phys(phys, phys_values, phys_expected, 3);
+    free(phys);
+    hidrd_layout_delete(layout);
+
+    /*
+     * Refuse to compile programs for layouts exceeding the operands
+     */
+    layout = compile(test_desc_huge, sizeof(test_desc_huge));
+    errno = 0;
+    prog = hidrd_layout_prog_new(layout, 0);
+    if (prog != NULL || errno != EFBIG)
+        error(1, 0, "Compiled program for too many values");
+    hidrd_layout_delete(layout);
+
+    /*
+     * Convert signed values with a unit exponent to physical ones
+     */
+    if (hidrd_layout_phys_exp(0x0E) != -2 ||
+        hidrd_layout_phys_exp(-2) != -2 ||
+        hidrd_layout_phys_exp(7) != 7 ||
+        hidrd_layout_phys_exp(8) != -8 ||
+        hidrd_layout_phys_exp(16) != 16)
+        error(1, 0, "Unit exponent values are decoded incorrectly");
+    layout = compile(test_desc_phys_exp, sizeof(test_desc_phys_exp));
+    phys = hidrd_layout_phys_list_new(layout);
+    if (phys == NULL)
+        error(1, 0, "Failed to compute physical conversion factors");
+    if (phys->exp != -2)
+        error(1, 0, "Unit exponent is %d instead of -2", phys->exp);
+    values[0] = 127;
+    values[1] = 0;
+    values[2] = -127;
+    values[3] = 1;
+    check_phys(phys, values, (const double []){5, 0, -5, 5.0 / 127}, 4);
+    free(phys);
+    hidrd_layout_delete(layout);
+
+    /*
+     * Lookup a usage in a whole-page range
+     */
+    layout = compile(test_desc_page, sizeof(test_desc_page));
+    idx = hidrd_layout_idx_new(layout);
+    if (idx == NULL || idx->wide_num != 1)
+        error(1, 0, "Failed to build whole-page usage index");
+    check_idx(idx, 0, 0xFF001234, 0, 0x1234);
+    hidrd_layout_idx_delete(idx);
+    hidrd_layout_delete(layout);
+
+    /*
+     * Store layouts into a cache file, load it and look them up
+     */
+    cache_fd = mkstemp(cache_path);
+    if (cache_fd < 0)
+        error(1, errno, "Failed to create cache file");
+    close(cache_fd);
+    hidrd_layout_cache_bld_init(&cache_bld);
+    layout = compile(test_desc, sizeof(test_desc));
+    if (!hidrd_layout_cache_bld_add(&cache_bld, test_desc,
+                                    sizeof(test_desc), layout) ||
+        !hidrd_layout_cache_bld_add(&cache_bld, test_desc,
+                                    sizeof(test_desc), layout))
+        error(1, 0, "Failed to add layout to cache");
+    hidrd_layout_delete(layout);
+    layout = compile(test_desc_12bit, sizeof(test_desc_12bit));
+    if (!hidrd_layout_cache_bld_add(&cache_bld, test_desc_12bit,
+                                    sizeof(test_desc_12bit), layout))
+        error(1, 0, "Failed to add layout to cache");
+    if (!hidrd_layout_cache_store(&cache_bld, cache_path))
+        error(1, errno, "Failed to store cache");
+    hidrd_layout_cache_bld_clnp(&cache_bld);
+    if (!hidrd_layout_cache_load(&cache, cache_path))
+        error(1, errno, "Failed to load cache");
+    if (cache.hdr->ent_num != 2)
+        error(1, 0, "Cache has %u entries instead of 2",
+              cache.hdr->ent_num);
+    cached = hidrd_layout_cache_lookup(&cache, test_desc_12bit,
+                                       sizeof(test_desc_12bit));
+    if (cached == NULL || cached->size != layout->size ||
+        memcmp(cached, layout, layout->size) != 0)
+        error(1, 0, "Cached 12-bit layout is not found");
+    hidrd_layout_delete(layout);
+    cached = hidrd_layout_cache_lookup(&cache, test_desc,
+                                       sizeof(test_desc));
+    if (cached == NULL ||
+        hidrd_report_decode(cached, test_report_stream, 4,
+                            values) == NULL)
+        error(1, 0, "Cached layout is not found");
+    check_values("Cached mouse", values, test_mouse_values,
+                 sizeof(test_mouse_values) / sizeof(*test_mouse_values));
+    if (hidrd_layout_cache_lookup(&cache, test_desc,
+                                  sizeof(test_desc) - 1) != NULL ||
+        hidrd_layout_cache_lookup(&cache, &pop, sizeof(pop)) != NULL)
+        error(1, 0, "Uncached layout is found");
+
+    /*
+     * Corrupt the cached mouse layout and check it's not found: with an
+     * invalid report number, a zero-size signed field, and the X/Y field
+     * moved to the end of the keyboard input report, fitting it, but not
+     * the mouse report it's decoded with
+     */
+    cache_off = (const uint8_t *)cached - (const uint8_t *)cache.hdr;
+    field_off = cache_off + cached->field_off;
+    cache_bad[0] = hidrd_layout_get_field_list(cached)[3].report_idx;
+    cache_bad[1] = 48;
+    hidrd_layout_cache_unload(&cache);
+    check_cache_corrupt("invalid report number", cache_path,
+                        test_desc, sizeof(test_desc),
+                        cache_off + offsetof(hidrd_layout, report_num),
+                        &cache_none, sizeof(cache_none));
+    check_cache_corrupt("zero-size field", cache_path,
+                        test_desc, sizeof(test_desc),
+                        field_off + sizeof(hidrd_layout_field) * 2 +
+                            offsetof(hidrd_layout_field, bit_size),
+                        &cache_zero, sizeof(cache_zero));
+    check_cache_corrupt("field outside its report", cache_path,
+                        test_desc, sizeof(test_desc),
+                        field_off + sizeof(hidrd_layout_field) * 2 +
+                            offsetof(hidrd_layout_field, report_idx),
+                        cache_bad, sizeof(cache_bad));
+    if (!hidrd_layout_cache_load(&cache, cache_path) ||
+        hidrd_layout_cache_lookup(&cache, test_desc,
+                                  sizeof(test_desc)) == NULL)
+        error(1, 0, "Restored cached layout is not found");
+    hidrd_layout_cache_unload(&cache);
+    unlink(cache_path);
+
+    /*
+     * Check Pop without Push is rejected
+     */
+    if (!hidrd_layout_cmpl_init(&cmpl))
+        error(1, 0, "Failed to initialize layout compiler");
+    if (feed(&cmpl, &pop, sizeof(pop)) ||
+        cmpl.err != HIDRD_LAYOUT_CMPL_ERR_POP)
+        error(1, 0, "Pop without Push is not rejected");
+    hidrd_layout_cmpl_clnp(&cmpl);
+    hidrd_layout_sum_init(&sum);
+    if (hidrd_layout_sum_put(&sum, &pop) ||
+        sum.err != HIDRD_LAYOUT_SUM_ERR_POP)
+        error(1, 0, "Pop without Push is not rejected by summary");
+    hidrd_layout_sum_clnp(&sum);
+
+    return 0;
+}
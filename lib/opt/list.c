@@ -81,6 +81,23 @@ hidrd_opt_list_lkp(const hidrd_opt *list, const char *name)
 }
 
 
+bool
+hidrd_opt_list_spec_valid(const hidrd_opt      *list,
+                          const hidrd_opt_spec *spec_list)
+{
+    assert(hidrd_opt_list_valid(list));
+    assert(hidrd_opt_spec_list_valid(spec_list));
+
+    for (; list->name != NULL; list++, spec_list++)
+        if (spec_list->name == NULL ||
+            strcasecmp(list->name, spec_list->name) != 0 ||
+            list->type != spec_list->type)
+            return false;
+
+    return spec_list->name == NULL;
+}
+
+
 bool
 hidrd_opt_list_get_boolean(const hidrd_opt *list,
                            const char      *name)
@@ -125,12 +142,53 @@ hidrd_opt_list_get_u32(const hidrd_opt *list,
 }
 
 
+bool
+hidrd_opt_list_get_boolean_at(const hidrd_opt *list, size_t idx)
+{
+    assert(hidrd_opt_list_valid(list));
+    assert(idx < hidrd_opt_list_len(list));
+
+    return hidrd_opt_get_boolean(&list[idx]);
+}
+
+
+const char *
+hidrd_opt_list_get_string_at(const hidrd_opt *list, size_t idx)
+{
+    assert(hidrd_opt_list_valid(list));
+    assert(idx < hidrd_opt_list_len(list));
+
+    return hidrd_opt_get_string(&list[idx]);
+}
+
+
+int32_t
+hidrd_opt_list_get_s32_at(const hidrd_opt *list, size_t idx)
+{
+    assert(hidrd_opt_list_valid(list));
+    assert(idx < hidrd_opt_list_len(list));
+
+    return hidrd_opt_get_s32(&list[idx]);
+}
+
+
+uint32_t
+hidrd_opt_list_get_u32_at(const hidrd_opt *list, size_t idx)
+{
+    assert(hidrd_opt_list_valid(list));
+    assert(idx < hidrd_opt_list_len(list));
+
+    return hidrd_opt_get_u32(&list[idx]);
+}
+
+
 hidrd_opt *
 hidrd_opt_list_parse_tkns_list(const hidrd_opt_spec    *spec_list,
                                const hidrd_opt_tkns    *tkns_list)
 {
     hidrd_opt              *result      = NULL;
     hidrd_opt              *opt_list    = NULL;
+    size_t                  len;
     hidrd_opt              *opt;
     const hidrd_opt_tkns   *tkns;
     const hidrd_opt_spec   *spec;
@@ -138,18 +196,17 @@ hidrd_opt_list_parse_tkns_list(const hidrd_opt_spec    *spec_list,
     assert(hidrd_opt_spec_list_valid(spec_list));
     assert(hidrd_opt_tkns_list_valid(tkns_list));
 
-    /* Allocate output option list */
-    opt_list = malloc(sizeof(*opt_list) *
-                      (hidrd_opt_spec_list_len(spec_list) + 1));
+    /* Allocate output option list, one option per specification */
+    len = hidrd_opt_spec_list_len(spec_list);
+    opt_list = malloc(sizeof(*opt_list) * (len + 1));
     if (opt_list == NULL)
         goto cleanup;
-    /* Begin with the first option */
-    opt = opt_list;
-    /* Keep it terminated */
-    opt->name = NULL;
+    /* Mark every option as missing */
+    for (opt = opt_list; opt <= opt_list + len; opt++)
+        opt->name = NULL;
 
     /*
-     * Convert each token pair
+     * Convert each token pair into the option at its specification index
      */
     for (tkns = tkns_list; tkns->name != NULL; tkns++)
     {
@@ -159,6 +216,11 @@ hidrd_opt_list_parse_tkns_list(const hidrd_opt_spec    *spec_list,
         if (spec == NULL)
             goto cleanup;
 
+        opt = opt_list + (spec - spec_list);
+        /* If the option was already specified, the first one wins */
+        if (opt->name != NULL)
+            continue;
+
         /* Parse the value according to the specification type */
         if (!hidrd_opt_type_parse_value(spec->type, &opt->value,
                                         tkns->value))
@@ -167,20 +229,15 @@ hidrd_opt_list_parse_tkns_list(const hidrd_opt_spec    *spec_list,
         /* Fill-in remaining fields */
         opt->name = spec->name;
         opt->type = spec->type;
-
-        /* Proceed with the next option */
-        opt++;
-        /* Keep it terminated */
-        opt->name = NULL;
     }
 
     /*
      * Check option presence, add missing
      */
-    for (spec = spec_list; spec->name != NULL; spec++)
+    for (spec = spec_list, opt = opt_list; spec->name != NULL; spec++, opt++)
     {
         /* If the option is there */
-        if (hidrd_opt_list_lkp(opt_list, spec->name) != NULL)
+        if (opt->name != NULL)
             continue;
 
         /* If option is required */
@@ -191,17 +248,13 @@ hidrd_opt_list_parse_tkns_list(const hidrd_opt_spec    *spec_list,
         opt->name   = spec->name;
         opt->type   = spec->type;
         opt->value  = spec->dflt;
-
-        /* Proceed with the next option */
-        opt++;
-        /* Keep it terminated */
-        opt->name = NULL;
     }
 
     /* Output */
     result = opt_list;
     opt_list = NULL;
     assert(hidrd_opt_list_valid(result));
+    assert(hidrd_opt_list_spec_valid(result, spec_list));
 
 cleanup:
 
@@ -232,6 +285,48 @@ hidrd_opt_list_parse(const hidrd_opt_spec  *spec_list,
 }
 
 
+hidrd_opt *
+hidrd_opt_list_compile(const hidrd_opt_spec    *spec_list,
+                       const char              *str)
+{
+    hidrd_opt  *result      = NULL;
+    size_t      list_size;
+    size_t      str_size;
+    hidrd_opt  *opt_list    = NULL;
+    char       *buf;
+    hidrd_opt  *parsed_list = NULL;
+
+    assert(hidrd_opt_spec_list_valid(spec_list));
+    assert(str != NULL);
+
+    /* Allocate the option list and the string it will reference at once */
+    list_size = sizeof(*opt_list) * (hidrd_opt_spec_list_len(spec_list) + 1);
+    str_size = strlen(str) + 1;
+    opt_list = malloc(list_size + str_size);
+    if (opt_list == NULL)
+        goto cleanup;
+    buf = (char *)opt_list + list_size;
+    memcpy(buf, str, str_size);
+
+    /* Parse the string copy, so the string values reference it */
+    parsed_list = hidrd_opt_list_parse(spec_list, buf);
+    if (parsed_list == NULL)
+        goto cleanup;
+    memcpy(opt_list, parsed_list, list_size);
+
+    /* Output */
+    result = opt_list;
+    opt_list = NULL;
+
+cleanup:
+
+    free(parsed_list);
+    free(opt_list);
+
+    return result;
+}
+
+
 hidrd_opt_tkns *
 hidrd_opt_list_format_tkns_list(const hidrd_opt *opt_list)
 {
@@ -51,6 +51,7 @@ main(int argc, char **argv)
     char                   *orig_norm_opt_buf   = NULL;
     hidrd_opt              *test_norm_opt_list  = NULL;
     char                   *test_norm_opt_str   = NULL;
+    hidrd_opt              *test_comp_opt_list  = NULL;
 
     (void)argc;
     (void)argv;
@@ -222,6 +223,32 @@ main(int argc, char **argv)
     free(test_norm_opt_list);
     free(orig_norm_opt_buf);
 
+    /*******************************************
+     * Test option list compilation
+     *******************************************/
+    test_comp_opt_list = hidrd_opt_list_compile(test_norm_spec_list,
+                                                "obscure=yes,type=comp,"
+                                                "format=no,type=dup");
+    if (test_comp_opt_list == NULL)
+        error(1, errno, "Failed to compile option list");
+
+    if (!hidrd_opt_list_spec_valid(test_comp_opt_list, test_norm_spec_list))
+        error(1, 0, "Compiled option list doesn't follow specification list");
+
+    if (hidrd_opt_list_get_boolean_at(test_comp_opt_list, 0) != false ||
+        strcmp(hidrd_opt_list_get_string_at(test_comp_opt_list, 1),
+               "Nikolai Kondrashov") != 0 ||
+        hidrd_opt_list_get_boolean_at(test_comp_opt_list, 2) != true ||
+        strcmp(hidrd_opt_list_get_string_at(test_comp_opt_list, 3),
+               "comp") != 0 ||
+        hidrd_opt_list_get_boolean_at(test_comp_opt_list, 4) != true)
+        error(1, 0, "Unexpected compiled option list values");
+
+    free(test_comp_opt_list);
+
+    if (hidrd_opt_list_compile(test_norm_spec_list, "format=no") != NULL)
+        error(1, 0, "Compiled option list without required options");
+
     free(test_norm_spec_list);
     free(orig_norm_spec_buf);
 
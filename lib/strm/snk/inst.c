@@ -45,6 +45,30 @@ hidrd_snk_errmsg(const hidrd_snk *snk)
 }
 
 
+/**
+ * Zero caller-provided storage for a sink instance of specified type and
+ * set the type field.
+ *
+ * @param mem   Storage of at least type->size bytes.
+ * @param type  Sink type to place instance of.
+ *
+ * @return Uninitialized, but zeroed instance of the specified sink type.
+ */
+static hidrd_snk *
+hidrd_snk_place(void *mem, const hidrd_snk_type *type)
+{
+    hidrd_snk *snk = (hidrd_snk *)mem;
+
+    assert(mem != NULL);
+    assert(hidrd_snk_type_valid(type));
+
+    memset(mem, 0, type->size);
+    snk->type = type;
+
+    return snk;
+}
+
+
 /**
  * Allocate (an uninitialized, but zeroed) sink instance of specified type
  * (set the type field).
@@ -61,9 +85,9 @@ hidrd_snk_alloc(const hidrd_snk_type *type)
 
     assert(hidrd_snk_type_valid(type));
 
-    snk = calloc(1, type->size);
+    snk = malloc(type->size);
     if (snk != NULL)
-        snk->type = type;
+        hidrd_snk_place(snk, type);
 
     return snk;
 }
@@ -151,6 +175,50 @@ hidrd_snk_init(hidrd_snk   *snk,
 
 
 #ifdef HIDRD_WITH_OPT
+/**
+ * Initialize sink instance with a parsed option list.
+ *
+ * @param snk       Sink instance to initialize.
+ * @param perr      Location for a dynamically allocated error message
+ *                  pointer, in case the initialization failed, or for a
+ *                  dynamically allocated empty string otherwise; could be
+ *                  NULL.
+ * @param pbuf      Location of sink buffer pointer.
+ * @param psize     Location of sink buffer size.
+ * @param opt_list  Option list parsed against the sink type option
+ *                  specification list.
+ *
+ * @return True if initialization succeeded, false otherwise.
+ */
+static bool
+hidrd_snk_init_opt_list(hidrd_snk         *snk,
+                        char             **perr,
+                        void             **pbuf,
+                        size_t            *psize,
+                        const hidrd_opt   *opt_list)
+{
+    assert(snk != NULL);
+    assert(hidrd_snk_type_valid(snk->type));
+    assert(hidrd_opt_list_valid(opt_list));
+    assert(snk->type->opts_spec == NULL
+            ? hidrd_opt_list_empty(opt_list)
+            : hidrd_opt_list_spec_valid(opt_list, snk->type->opts_spec));
+
+    /* If there is init_opts member */
+    if (snk->type->init_opts != NULL)
+    {
+        /* Initialize with option list */
+        snk->pbuf  = pbuf;
+        snk->psize = psize;
+
+        return (*snk->type->init_opts)(snk, perr, opt_list);
+    }
+    else
+        /* Do the regular initialization */
+        return hidrd_snk_init(snk, perr, pbuf, psize);
+}
+
+
 /**
  * Initialize sink instance with an option string, formatted using
  * sprintf.
@@ -230,22 +298,9 @@ hidrd_snk_init_optsf(hidrd_snk     *snk,
         goto cleanup;
     }
 
-    /* If there is init_opts member */
-    if (snk->type->init_opts != NULL)
-    {
-        /* Initialize with option list */
-        snk->pbuf  = pbuf;
-        snk->psize = psize;
-
-        if (!(*snk->type->init_opts)(snk, perr, opt_list))
-            goto cleanup;
-    }
-    else
-    {
-        /* Do the regular initialization */
-        if (!hidrd_snk_init(snk, perr, pbuf, psize))
-            goto cleanup;
-    }
+    /* Initialize with the option list */
+    if (!hidrd_snk_init_opt_list(snk, perr, pbuf, psize, opt_list))
+        goto cleanup;
 
     assert(hidrd_snk_valid(snk));
 
@@ -313,6 +368,75 @@ hidrd_snk_new_opts(const hidrd_snk_type    *type,
 
     return snk;
 }
+
+
+hidrd_snk *
+hidrd_snk_init_mem_opts(void                   *mem,
+                        const hidrd_snk_type   *type,
+                        char                  **perr,
+                        void                  **pbuf,
+                        size_t                 *psize,
+                        const char             *opts)
+{
+    hidrd_snk *snk;
+
+    assert(opts != NULL);
+
+    snk = hidrd_snk_place(mem, type);
+
+    if (!hidrd_snk_init_opts(snk, perr, pbuf, psize, opts))
+        return NULL;
+
+    return snk;
+}
+
+
+hidrd_snk *
+hidrd_snk_new_opt_list(const hidrd_snk_type   *type,
+                       char                  **perr,
+                       void                  **pbuf,
+                       size_t                 *psize,
+                       const hidrd_opt        *opt_list)
+{
+    hidrd_snk *snk;
+
+    /* Allocate */
+    snk = hidrd_snk_alloc(type);
+    if (snk == NULL)
+    {
+        if (perr != NULL)
+            *perr = strdup("instance allocation failed");
+        return NULL;
+    }
+
+    /* Initialize */
+    if (!hidrd_snk_init_opt_list(snk, perr, pbuf, psize, opt_list))
+    {
+        free(snk);
+        return NULL;
+    }
+
+    return snk;
+}
+
+
+hidrd_snk *
+hidrd_snk_init_mem_opt_list(void                   *mem,
+                            const hidrd_snk_type   *type,
+                            char                  **perr,
+                            void                  **pbuf,
+                            size_t                 *psize,
+                            const hidrd_opt        *opt_list)
+{
+    hidrd_snk *snk;
+
+    snk = hidrd_snk_place(mem, type);
+
+    if (!hidrd_snk_init_opt_list(snk, perr, pbuf, psize, opt_list))
+        return NULL;
+
+    return snk;
+}
 #endif /* HIDRD_WITH_OPT */
 
 
@@ -347,6 +471,30 @@ hidrd_snk_new(const hidrd_snk_type     *type,
 }
 
 
+hidrd_snk *
+hidrd_snk_init_mem(void                   *mem,
+                   const hidrd_snk_type   *type,
+                   char                  **perr,
+                   void                  **pbuf,
+                   size_t                 *psize,
+                   ...)
+{
+    hidrd_snk *snk;
+    bool        result;
+    va_list     ap;
+
+    snk = hidrd_snk_place(mem, type);
+
+    va_start(ap, psize);
+    result = hidrd_snk_initv(snk, perr, pbuf, psize, ap);
+    va_end(ap);
+    if (!result)
+        return NULL;
+
+    return snk;
+}
+
+
 bool
 hidrd_snk_put(hidrd_snk *snk, const hidrd_item *item)
 {
@@ -367,13 +515,7 @@ hidrd_snk_flush(hidrd_snk *snk)
 }
 
 
-/**
- * Cleanup sink instance - free any internal data, but don't free the
- * sink itself.
- *
- * @param snk  Sink instance to cleanup.
- */
-static void
+void
 hidrd_snk_clnp(hidrd_snk *snk)
 {
     assert(hidrd_snk_valid(snk));
@@ -55,6 +55,30 @@ hidrd_src_errmsg(const hidrd_src *src)
 }
 
 
+/**
+ * Zero caller-provided storage for a source instance of specified type and
+ * set the type field.
+ *
+ * @param mem   Storage of at least type->size bytes.
+ * @param type  Source type to place instance of.
+ *
+ * @return Uninitialized, but zeroed instance of the specified source type.
+ */
+static hidrd_src *
+hidrd_src_place(void *mem, const hidrd_src_type *type)
+{
+    hidrd_src *src = (hidrd_src *)mem;
+
+    assert(mem != NULL);
+    assert(hidrd_src_type_valid(type));
+
+    memset(mem, 0, type->size);
+    src->type = type;
+
+    return src;
+}
+
+
 /**
  * Allocate (an uninitialized, but zeroed) source instance of specified
  * type and set the type field.
@@ -71,9 +95,9 @@ hidrd_src_alloc(const hidrd_src_type *type)
 
     assert(hidrd_src_type_valid(type));
 
-    src = calloc(1, type->size);
+    src = malloc(type->size);
     if (src != NULL)
-        src->type = type;
+        hidrd_src_place(src, type);
 
     return src;
 }
@@ -153,6 +177,51 @@ hidrd_src_init(hidrd_src   *src,
 
 
 #ifdef HIDRD_WITH_OPT
+/**
+ * Initialize source instance with a parsed option list.
+ *
+ * @param src       Source instance to initialize.
+ * @param perr      Location for a dynamically allocated error message
+ *                  pointer, in case the initialization failed, or for a
+ *                  dynamically allocated empty string otherwise; could be
+ *                  NULL.
+ * @param buf       Source buffer pointer.
+ * @param size      Source buffer size.
+ * @param opt_list  Option list parsed against the source type option
+ *                  specification list.
+ *
+ * @return True if initialization succeeded, false otherwise.
+ */
+static bool
+hidrd_src_init_opt_list(hidrd_src         *src,
+                        char             **perr,
+                        const void        *buf,
+                        size_t             size,
+                        const hidrd_opt   *opt_list)
+{
+    assert(src != NULL);
+    assert(hidrd_src_type_valid(src->type));
+    assert(hidrd_opt_list_valid(opt_list));
+    assert(src->type->opts_spec == NULL
+            ? hidrd_opt_list_empty(opt_list)
+            : hidrd_opt_list_spec_valid(opt_list, src->type->opts_spec));
+
+    /* If there is init_opts member */
+    if (src->type->init_opts != NULL)
+    {
+        /* Initialize with option list */
+        src->buf    = buf;
+        src->size   = size;
+        src->error  = false;
+
+        return (*src->type->init_opts)(src, perr, opt_list);
+    }
+    else
+        /* Do the regular initialization */
+        return hidrd_src_init(src, perr, buf, size);
+}
+
+
 /**
  * Initialize source instance with an option string, formatted using
  * sprintf.
@@ -224,23 +293,9 @@ hidrd_src_init_optsf(hidrd_src     *src,
         goto cleanup;
     }
 
-    /* If there is init_opts member */
-    if (src->type->init_opts != NULL)
-    {
-        /* Initialize with option list */
-        src->buf    = buf;
-        src->size   = size;
-        src->error  = false;
-
-        if (!(*src->type->init_opts)(src, perr, opt_list))
-            goto cleanup;
-    }
-    else
-    {
-        /* Do the regular initialization */
-        if (!hidrd_src_init(src, perr, buf, size))
-            goto cleanup;
-    }
+    /* Initialize with the option list */
+    if (!hidrd_src_init_opt_list(src, perr, buf, size, opt_list))
+        goto cleanup;
 
     assert(hidrd_src_valid(src));
 
@@ -308,6 +363,75 @@ hidrd_src_new_opts(const hidrd_src_type    *type,
 
     return src;
 }
+
+
+hidrd_src *
+hidrd_src_init_mem_opts(void                   *mem,
+                        const hidrd_src_type   *type,
+                        char                  **perr,
+                        const void             *buf,
+                        size_t                  size,
+                        const char             *opts)
+{
+    hidrd_src *src;
+
+    assert(opts != NULL);
+
+    src = hidrd_src_place(mem, type);
+
+    if (!hidrd_src_init_opts(src, perr, buf, size, opts))
+        return NULL;
+
+    return src;
+}
+
+
+hidrd_src *
+hidrd_src_new_opt_list(const hidrd_src_type   *type,
+                       char                  **perr,
+                       const void             *buf,
+                       size_t                  size,
+                       const hidrd_opt        *opt_list)
+{
+    hidrd_src *src;
+
+    /* Allocate */
+    src = hidrd_src_alloc(type);
+    if (src == NULL)
+    {
+        if (perr != NULL)
+            *perr = strdup("instance allocation failed");
+        return NULL;
+    }
+
+    /* Initialize */
+    if (!hidrd_src_init_opt_list(src, perr, buf, size, opt_list))
+    {
+        free(src);
+        return NULL;
+    }
+
+    return src;
+}
+
+
+hidrd_src *
+hidrd_src_init_mem_opt_list(void                   *mem,
+                            const hidrd_src_type   *type,
+                            char                  **perr,
+                            const void             *buf,
+                            size_t                  size,
+                            const hidrd_opt        *opt_list)
+{
+    hidrd_src *src;
+
+    src = hidrd_src_place(mem, type);
+
+    if (!hidrd_src_init_opt_list(src, perr, buf, size, opt_list))
+        return NULL;
+
+    return src;
+}
 #endif /* HIDRD_WITH_OPT */
 
 
@@ -342,6 +466,30 @@ hidrd_src_new(const hidrd_src_type     *type,
 }
 
 
+hidrd_src *
+hidrd_src_init_mem(void                   *mem,
+                   const hidrd_src_type   *type,
+                   char                  **perr,
+                   const void             *buf,
+                   size_t                  size,
+                   ...)
+{
+    hidrd_src *src;
+    bool        result;
+    va_list     ap;
+
+    src = hidrd_src_place(mem, type);
+
+    va_start(ap, size);
+    result = hidrd_src_initv(src, perr, buf, size, ap);
+    va_end(ap);
+    if (!result)
+        return NULL;
+
+    return src;
+}
+
+
 size_t
 hidrd_src_getpos(const hidrd_src *src)
 {
@@ -373,13 +521,7 @@ hidrd_src_get(hidrd_src *src)
 }
 
 
-/**
- * Cleanup source instance - free any internal data, but don't free the
- * source itself.
- *
- * @param src  Source instance to cleanup.
- */
-static void
+void
 hidrd_src_clnp(hidrd_src *src)
 {
     assert(hidrd_src_valid(src));
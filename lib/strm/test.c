@@ -0,0 +1,327 @@
+/** @file
+ * @brief HID report descriptor - stream library test
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <error.h>
+#include "hidrd/strm.h"
+
+/** Item put out by the test source: End Collection */
+static const uint8_t test_item[] = {0xC0};
+
+/** Test source instance */
+typedef struct test_src_inst {
+    hidrd_src   src;    /**< Parent structure */
+    uint32_t    num;    /**< Number of items to put out */
+    uint32_t    pos;    /**< Number of items put out */
+} test_src_inst;
+
+static bool
+test_src_init(hidrd_src *src, char **perr, uint32_t num)
+{
+    test_src_inst  *test_src    = (test_src_inst *)src;
+
+    test_src->num = num;
+    test_src->pos = 0;
+
+    if (perr != NULL)
+        *perr = strdup("");
+
+    return true;
+}
+
+
+static bool
+test_src_initv(hidrd_src *src, char **perr, va_list ap)
+{
+    return test_src_init(src, perr, va_arg(ap, uint32_t));
+}
+
+
+static const hidrd_opt_spec test_src_opts_spec[] = {
+    {.name  = "num",
+     .type  = HIDRD_OPT_TYPE_U32,
+     .req   = false,
+     .dflt  = {.u32 = 1},
+     .desc  = "number of items"},
+    {.name  = NULL}
+};
+
+static bool
+test_src_init_opts(hidrd_src *src, char **perr, const hidrd_opt *list)
+{
+    return test_src_init(src, perr, hidrd_opt_list_get_u32_at(list, 0));
+}
+
+
+static char *
+test_src_errmsg(const hidrd_src *src)
+{
+    (void)src;
+    return strdup("");
+}
+
+
+static const hidrd_item *
+test_src_get(hidrd_src *src)
+{
+    test_src_inst  *test_src    = (test_src_inst *)src;
+
+    if (test_src->pos >= test_src->num)
+        return NULL;
+    test_src->pos++;
+
+    return test_item;
+}
+
+
+static const hidrd_src_type test_src = {
+    .size       = sizeof(test_src_inst),
+    .initv      = test_src_initv,
+    .init_opts  = test_src_init_opts,
+    .opts_spec  = test_src_opts_spec,
+    .errmsg     = test_src_errmsg,
+    .get        = test_src_get,
+};
+
+
+/** Test sink instance */
+typedef struct test_snk_inst {
+    hidrd_snk   snk;    /**< Parent structure */
+    uint32_t    dup;    /**< Number of output bytes per item */
+    size_t      len;    /**< Output length */
+} test_snk_inst;
+
+static bool
+test_snk_init(hidrd_snk *snk, char **perr, uint32_t dup)
+{
+    test_snk_inst  *test_snk    = (test_snk_inst *)snk;
+
+    test_snk->dup = dup;
+    test_snk->len = 0;
+
+    if (perr != NULL)
+        *perr = strdup("");
+
+    return true;
+}
+
+
+static bool
+test_snk_initv(hidrd_snk *snk, char **perr, va_list ap)
+{
+    return test_snk_init(snk, perr, va_arg(ap, uint32_t));
+}
+
+
+static const hidrd_opt_spec test_snk_opts_spec[] = {
+    {.name  = "dup",
+     .type  = HIDRD_OPT_TYPE_U32,
+     .req   = false,
+     .dflt  = {.u32 = 1},
+     .desc  = "number of output bytes per item"},
+    {.name  = NULL}
+};
+
+static bool
+test_snk_init_opts(hidrd_snk *snk, char **perr, const hidrd_opt *list)
+{
+    return test_snk_init(snk, perr, hidrd_opt_list_get_u32_at(list, 0));
+}
+
+
+static char *
+test_snk_errmsg(const hidrd_snk *snk)
+{
+    (void)snk;
+    return strdup("");
+}
+
+
+static bool
+test_snk_put(hidrd_snk *snk, const hidrd_item *item)
+{
+    test_snk_inst  *test_snk    = (test_snk_inst *)snk;
+
+    test_snk->len += hidrd_item_get_size(item) * test_snk->dup;
+
+    return true;
+}
+
+
+static bool
+test_snk_flush(hidrd_snk *snk)
+{
+    test_snk_inst  *test_snk    = (test_snk_inst *)snk;
+    void           *buf;
+
+    buf = calloc(test_snk->len + 1, 1);
+    if (buf == NULL)
+        return false;
+
+    if (snk->pbuf != NULL)
+    {
+        free(*snk->pbuf);
+        *snk->pbuf = buf;
+    }
+    else
+        free(buf);
+
+    if (snk->psize != NULL)
+        *snk->psize = test_snk->len;
+
+    return true;
+}
+
+
+static const hidrd_snk_type test_snk = {
+    .size       = sizeof(test_snk_inst),
+    .initv      = test_snk_initv,
+    .init_opts  = test_snk_init_opts,
+    .opts_spec  = test_snk_opts_spec,
+    .errmsg     = test_snk_errmsg,
+    .put        = test_snk_put,
+    .flush      = test_snk_flush,
+};
+
+
+/**
+ * Transfer all the items from a source to a sink, closing the sink.
+ *
+ * @param src   Source to transfer the items from.
+ * @param snk   Sink to transfer the items to.
+ * @param name  Instance description, for error messages.
+ */
+static void
+transfer(hidrd_src *src, hidrd_snk *snk, const char *name)
+{
+    const hidrd_item   *item;
+
+    while ((item = hidrd_src_get(src)) != NULL)
+        if (!hidrd_snk_put(snk, item))
+            error(1, 0, "Failed to put item to %s sink", name);
+    if (hidrd_src_error(src))
+        error(1, 0, "Failed to get item from %s source", name);
+    if (!hidrd_snk_flush(snk))
+        error(1, 0, "Failed to flush %s sink", name);
+}
+
+
+int
+main(int argc, char **argv)
+{
+    hidrd_opt          *src_opt_list;
+    hidrd_opt          *snk_opt_list;
+    hidrd_src          *src;
+    hidrd_snk          *snk;
+    test_src_inst       src_mem;
+    test_snk_inst       snk_mem;
+    void               *buf         = NULL;
+    size_t              size        = 0;
+    unsigned int        i;
+
+    (void)argc;
+    (void)argv;
+
+    /*
+     * Compile the options once
+     */
+    src_opt_list = hidrd_opt_list_compile(test_src_opts_spec, "num=3");
+    if (src_opt_list == NULL)
+        error(1, 0, "Failed to compile source options");
+    snk_opt_list = hidrd_opt_list_compile(test_snk_opts_spec, "dup=5");
+    if (snk_opt_list == NULL)
+        error(1, 0, "Failed to compile sink options");
+
+    /*
+     * Create several instances from the same compiled lists
+     */
+    for (i = 0; i < 4; i++)
+    {
+        src = hidrd_src_new_opt_list(&test_src, NULL,
+                                     NULL, 0, src_opt_list);
+        if (src == NULL)
+            error(1, 0, "Failed to create source #%u", i);
+        snk = hidrd_snk_new_opt_list(&test_snk, NULL,
+                                     &buf, &size, snk_opt_list);
+        if (snk == NULL)
+            error(1, 0, "Failed to create sink #%u", i);
+        if (((test_src_inst *)src)->num != 3 ||
+            ((test_snk_inst *)snk)->dup != 5)
+            error(1, 0, "Options of instances #%u don't take effect", i);
+        transfer(src, snk, "allocated");
+        if (size != 15)
+            error(1, 0, "Output #%u is %zu bytes instead of 15", i, size);
+        hidrd_snk_delete(snk);
+        hidrd_src_delete(src);
+    }
+
+    /*
+     * Initialize instances in place from the same compiled lists
+     */
+    for (i = 0; i < 4; i++)
+    {
+        size = 0;
+        src = hidrd_src_init_mem_opt_list(&src_mem, &test_src, NULL,
+                                          NULL, 0, src_opt_list);
+        if (src != &src_mem.src)
+            error(1, 0, "Failed to initialize source #%u in place", i);
+        snk = hidrd_snk_init_mem_opt_list(&snk_mem, &test_snk, NULL,
+                                          &buf, &size, snk_opt_list);
+        if (snk != &snk_mem.snk)
+            error(1, 0, "Failed to initialize sink #%u in place", i);
+        transfer(src, snk, "placed");
+        if (size != 15)
+            error(1, 0, "Placed output #%u is %zu bytes instead of 15",
+                  i, size);
+        hidrd_snk_clnp(snk);
+        hidrd_src_clnp(src);
+    }
+
+    /*
+     * Check the defaults apply with empty options
+     */
+    free(src_opt_list);
+    free(snk_opt_list);
+    src_opt_list = hidrd_opt_list_compile(test_src_opts_spec, "");
+    snk_opt_list = hidrd_opt_list_compile(test_snk_opts_spec, "");
+    if (src_opt_list == NULL || snk_opt_list == NULL)
+        error(1, 0, "Failed to compile empty options");
+    src = hidrd_src_new_opt_list(&test_src, NULL, NULL, 0, src_opt_list);
+    snk = hidrd_snk_new_opt_list(&test_snk, NULL,
+                                 &buf, &size, snk_opt_list);
+    if (src == NULL || snk == NULL)
+        error(1, 0, "Failed to create instances with empty options");
+    transfer(src, snk, "default");
+    if (size != 1)
+        error(1, 0, "Default output is %zu bytes instead of 1", size);
+    hidrd_snk_delete(snk);
+    hidrd_src_delete(src);
+
+    free(buf);
+    free(src_opt_list);
+    free(snk_opt_list);
+
+    return 0;
+}
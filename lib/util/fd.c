@@ -23,8 +23,10 @@
  */
 
 #include <errno.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include "hidrd/util/fd.h"
 
 bool
@@ -59,7 +61,7 @@ hidrd_fd_read_whole(int fd, void **pbuf, size_t *psize)
         }
     }
 
-    if (errno != 0)
+    if (read_size < 0)
         goto cleanup;
 
     new_buf = realloc(buf, size);
@@ -105,3 +107,47 @@ hidrd_fd_write_whole(int fd, const void *buf, size_t size)
 }
 
 
+bool
+hidrd_fd_replace_whole(const char *path, const void *buf, size_t size)
+{
+    bool    result      = false;
+    char   *tmp_path    = NULL;
+    int     fd          = -1;
+    int     orig_errno;
+
+    if (asprintf(&tmp_path, "%s.XXXXXX", path) < 0)
+    {
+        tmp_path = NULL;
+        errno = ENOMEM;
+        goto cleanup;
+    }
+    fd = mkstemp(tmp_path);
+    if (fd < 0)
+        goto cleanup;
+    if (fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0 ||
+        !hidrd_fd_write_whole(fd, buf, size) ||
+        fsync(fd) != 0)
+        goto cleanup;
+    if (close(fd) != 0)
+    {
+        fd = -1;
+        goto cleanup;
+    }
+    fd = -1;
+    if (rename(tmp_path, path) != 0)
+        goto cleanup;
+
+    result = true;
+
+cleanup:
+
+    orig_errno = errno;
+    if (fd >= 0)
+        close(fd);
+    if (!result && tmp_path != NULL)
+        unlink(tmp_path);
+    free(tmp_path);
+    errno = orig_errno;
+
+    return result;
+}
@@ -25,6 +25,7 @@
 #include <stddef.h>
 #include <string.h>
 #include <stdlib.h>
+#include "hidrd/util/num.h"
 #include "hidrd/util/dec.h"
 #include "hidrd/util/hex.h"
 #include "hidrd/util/fmt.h"
@@ -110,6 +111,89 @@ hidrd_fmtpva(char             **pstr,
 }
 
 
+bool
+hidrd_fmtpva_buf(hidrd_buf         *buf,
+                 const char       **pstr,
+                 hidrd_fmt_type     type,
+                 va_list           *pap)
+{
+    const char *str     = NULL;
+    size_t      len     = 0;
+
+    assert(hidrd_buf_valid(buf));
+    assert(pstr != NULL);
+
+    hidrd_buf_reset(buf);
+
+    switch (type)
+    {
+        case HIDRD_FMT_TYPE_NULL:
+            break;
+        case HIDRD_FMT_TYPE_S32:
+            if (!hidrd_buf_grow(buf, HIDRD_NUM_STR_SIZE))
+                return false;
+            hidrd_num_s32_to_buf(buf->ptr, va_arg(*pap, int32_t),
+                                 HIDRD_NUM_BMRK_NONE, HIDRD_NUM_BASE_DEC);
+            str = buf->ptr;
+            break;
+        case HIDRD_FMT_TYPE_U32:
+            if (!hidrd_buf_grow(buf, HIDRD_NUM_STR_SIZE))
+                return false;
+            hidrd_num_u32_to_buf(buf->ptr, va_arg(*pap, uint32_t),
+                                 HIDRD_NUM_BMRK_NONE, HIDRD_NUM_BASE_DEC);
+            str = buf->ptr;
+            break;
+        case HIDRD_FMT_TYPE_STRDUP:
+            str = va_arg(*pap, const char *);
+            assert(str != NULL);
+            break;
+        case HIDRD_FMT_TYPE_STROWN:
+            {
+                char   *arg = va_arg(*pap, char *);
+                bool    ok;
+
+                assert(arg != NULL);
+
+                len = strlen(arg) + 1;
+                ok = hidrd_buf_grow(buf, len);
+                if (ok)
+                    memcpy(buf->ptr, arg, len);
+                free(arg);
+                if (!ok)
+                    return false;
+                str = buf->ptr;
+            }
+            break;
+        case HIDRD_FMT_TYPE_HEX:
+        case HIDRD_FMT_TYPE_SHEX:
+            {
+                const void *arg     = va_arg(*pap, const void *);
+                size_t      size    = va_arg(*pap, size_t);
+                char       *p;
+
+                assert(arg != NULL || size == 0);
+
+                if (!hidrd_buf_grow(buf, size * 2 + 2))
+                    return false;
+                p = buf->ptr;
+                len = hidrd_hex_buf_to_chrs(p, arg, size);
+                if (type == HIDRD_FMT_TYPE_SHEX)
+                    p[len++] = 'h';
+                p[len] = '\0';
+                str = p;
+            }
+            break;
+        default:
+            assert(!"Unknown string format");
+            return false;
+    }
+
+    *pstr = str;
+
+    return true;
+}
+
+
 void
 hidrd_fmtfreepv(hidrd_fmt_type  type,
                 va_list        *pap)
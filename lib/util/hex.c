@@ -22,58 +22,137 @@
  * @author Nikolai Kondrashov <spbnick@gmail.com>
  */
 
-#include <ctype.h>
 #include <stdlib.h>
-#include <stdio.h>
+#include <string.h>
 #include "hidrd/util/hex.h"
 
-
-bool
-hidrd_hex_buf_from_str(void        *buf,
-                       size_t       size,
-                       size_t      *plen,
-                       const char  *str)
+const uint8_t hidrd_hex_chr_class_list[256] = {
+#define DIGIT(_c, _v)   [_c] = HIDRD_HEX_CHR_DIGIT | (_v)
+    DIGIT('0', 0x0), DIGIT('1', 0x1), DIGIT('2', 0x2), DIGIT('3', 0x3),
+    DIGIT('4', 0x4), DIGIT('5', 0x5), DIGIT('6', 0x6), DIGIT('7', 0x7),
+    DIGIT('8', 0x8), DIGIT('9', 0x9),
+    DIGIT('A', 0xA), DIGIT('B', 0xB), DIGIT('C', 0xC),
+    DIGIT('D', 0xD), DIGIT('E', 0xE), DIGIT('F', 0xF),
+    DIGIT('a', 0xA), DIGIT('b', 0xB), DIGIT('c', 0xC),
+    DIGIT('d', 0xD), DIGIT('e', 0xE), DIGIT('f', 0xF),
+#undef DIGIT
+#define SPACE(_c)       [_c] = HIDRD_HEX_CHR_SPACE
+    SPACE(' '), SPACE('\t'), SPACE('\n'),
+    SPACE('\v'), SPACE('\f'), SPACE('\r'),
+#undef SPACE
+};
+
+const char hidrd_hex_digit_list[2][16] = {
+    {'0', '1', '2', '3', '4', '5', '6', '7',
+     '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'},
+    {'0', '1', '2', '3', '4', '5', '6', '7',
+     '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'},
+};
+
+
+hidrd_hex_dec_err
+hidrd_hex_buf_from_chrs(void          *buf,
+                        size_t         size,
+                        size_t        *plen,
+                        const char    *str,
+                        size_t         len,
+                        size_t        *ppos)
 {
-    bool        high;
-    uint8_t     nibble;
-    const char *p;
-    char        c;
-    uint8_t    *b;
-    size_t      len;
+    hidrd_hex_dec_err   err     = HIDRD_HEX_DEC_ERR_NONE;
+    const uint8_t      *p       = (const uint8_t *)str;
+    const uint8_t      *end     = p + len;
+    const uint8_t      *q;
+    uint8_t            *b       = (uint8_t *)buf;
+    uint8_t            *b_end   = b + size;
+    uint8_t             hi;
+    uint8_t             lo;
 
     assert(buf != NULL || size == 0);
-    assert(str != NULL);
+    assert(str != NULL || len == 0);
 
-    for (high = true, b = buf, len = 0, p = str; (c = *p) != '\0'; p++)
+    while (p < end)
     {
-        if (isspace(c))
-            continue;
+        hi = hidrd_hex_chr_class_list[p[0]];
 
-        if (c >= '0' && c <= '9')
-            nibble = (uint8_t)c - '0';
-        else if (c >= 'a' && c <= 'f')
-            nibble = (uint8_t)c - 'a' + 0xA;
-        else if (c >= 'A' && c <= 'F')
-            nibble = (uint8_t)c - 'A' + 0xA;
-        else
-            return false;
+        /* Fast path: an adjacent digit pair */
+        if (p + 1 < end)
+        {
+            lo = hidrd_hex_chr_class_list[p[1]];
+            if (hi & lo & HIDRD_HEX_CHR_DIGIT)
+            {
+                if (b >= b_end)
+                {
+                    err = HIDRD_HEX_DEC_ERR_SIZE;
+                    break;
+                }
+                *b++ = (hi << 4) | (lo & 0xF);
+                p += 2;
+                continue;
+            }
+        }
+
+        if (hi == HIDRD_HEX_CHR_SPACE)
+        {
+            p++;
+            continue;
+        }
+        if (hi == HIDRD_HEX_CHR_INVALID)
+        {
+            err = HIDRD_HEX_DEC_ERR_CHAR;
+            break;
+        }
+        if (b >= b_end)
+        {
+            err = HIDRD_HEX_DEC_ERR_SIZE;
+            break;
+        }
 
-        if (high)
+        /* Look for the low digit past the whitespace */
+        for (q = p + 1;
+             q < end &&
+             (lo = hidrd_hex_chr_class_list[*q]) == HIDRD_HEX_CHR_SPACE;
+             q++);
+        if (q >= end)
         {
-            if (len >= size)
-                return false;
-            *b = nibble << 4;
-            high = false;
-            len++;
+            *b++ = hi << 4;
+            p = q;
+            break;
         }
-        else
+        if (lo == HIDRD_HEX_CHR_INVALID)
         {
-            *b |= nibble;
-            high = true;
-            b++;
+            p = q;
+            err = HIDRD_HEX_DEC_ERR_CHAR;
+            break;
         }
+        *b++ = (hi << 4) | (lo & 0xF);
+        p = q + 1;
     }
 
+    if (plen != NULL)
+        *plen = b - (uint8_t *)buf;
+    if (ppos != NULL)
+        *ppos = p - (const uint8_t *)str;
+
+    return err;
+}
+
+
+bool
+hidrd_hex_buf_from_str(void        *buf,
+                       size_t       size,
+                       size_t      *plen,
+                       const char  *str)
+{
+    size_t  len;
+
+    assert(buf != NULL || size == 0);
+    assert(str != NULL);
+
+    if (hidrd_hex_buf_from_chrs(buf, size, &len,
+                                str, strlen(str), NULL) !=
+            HIDRD_HEX_DEC_ERR_NONE)
+        return false;
+
     if (plen != NULL)
         *plen = len;
 
@@ -81,14 +160,26 @@ hidrd_hex_buf_from_str(void        *buf,
 }
 
 
-char *
-hidrd_hex_buf_to_str(const void *buf, size_t size)
+size_t
+hidrd_hex_buf_to_chrs(char *str, const void *buf, size_t size)
 {
-    static const char   map[16] = "0123456789ABCDEF";
     const uint8_t      *bbuf    = (const uint8_t *)buf;
-    char               *str;
     char               *p;
-    uint8_t             b;
+
+    assert(str != NULL);
+    assert(buf != NULL || size == 0);
+
+    for (p = str; size > 0; size--, bbuf++)
+        p = hidrd_hex_byte_to_chrs(p, *bbuf, false);
+
+    return p - str;
+}
+
+
+char *
+hidrd_hex_buf_to_str(const void *buf, size_t size)
+{
+    char   *str;
 
     assert(buf != NULL || size == 0);
 
@@ -96,14 +187,7 @@ hidrd_hex_buf_to_str(const void *buf, size_t size)
     if (str == NULL)
         return NULL;
 
-    for (p = str; size > 0; size--, bbuf++)
-    {
-        b = *bbuf;
-        *p++ = map[b >> 4];
-        *p++ = map[b & 0xF];
-    }
-
-    *p = '\0';
+    str[hidrd_hex_buf_to_chrs(str, buf, size)] = '\0';
 
     return str;
 }
@@ -112,19 +196,18 @@ hidrd_hex_buf_to_str(const void *buf, size_t size)
 char *
 hidrd_hex_buf_to_sstr(const void *buf, size_t size)
 {
-    char   *str;
     char   *sstr;
+    size_t  len;
 
-    str = hidrd_hex_buf_to_str(buf, size);
-    if (str == NULL)
-        return NULL;
+    assert(buf != NULL || size == 0);
 
-    if (asprintf(&sstr, "%sh", str) < 0)
-    {
-        free(str);
+    sstr = malloc((size * 2) + 2);
+    if (sstr == NULL)
         return NULL;
-    }
-    free(str);
+
+    len = hidrd_hex_buf_to_chrs(sstr, buf, size);
+    sstr[len++] = 'h';
+    sstr[len] = '\0';
 
     return sstr;
 }
@@ -0,0 +1,99 @@
+/** @file
+ * @brief HID report descriptor - utilities - hexadecimal conversion test
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <error.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hidrd/util/hex.h"
+
+#define ERROR(_fmt, _args...) \
+    error_at_line(1, 0, __FILE__, __LINE__, _fmt, ##_args)
+
+#define CHECK_DEC(_str, _size, _err, _pos, _expected) \
+    do {                                                                \
+        static const uint8_t    expected[] = _expected;                 \
+        const char             *str        = _str;                      \
+        uint8_t                 buf[16];                                \
+        size_t                  len;                                    \
+        size_t                  pos;                                    \
+        hidrd_hex_dec_err       err;                                    \
+                                                                        \
+        err = hidrd_hex_buf_from_chrs(buf, _size, &len,                 \
+                                      str, strlen(str), &pos);          \
+        if (err != (_err))                                              \
+            ERROR("Unexpected error %d decoding \"%s\"", err, str);     \
+        if (pos != (_pos))                                              \
+            ERROR("Unexpected position %zu decoding \"%s\"", pos, str); \
+        if (len != sizeof(expected) ||                                  \
+            memcmp(buf, expected, len) != 0)                            \
+            ERROR("Unexpected output decoding \"%s\"", str);            \
+    } while (0)
+
+#define BYTES(_args...) {_args}
+
+int
+main(void)
+{
+    uint8_t     buf[256];
+    uint8_t     out[256];
+    char       *str;
+    char        chrs[2];
+    size_t      len;
+    size_t      i;
+
+    CHECK_DEC("0a 1B\n\t2", 16, HIDRD_HEX_DEC_ERR_NONE, 8,
+              BYTES(0x0A, 0x1B, 0x20));
+    CHECK_DEC("0 1 2 3", 16, HIDRD_HEX_DEC_ERR_NONE, 7,
+              BYTES(0x01, 0x23));
+    CHECK_DEC(" 01 \r\n", 16, HIDRD_HEX_DEC_ERR_NONE, 6, BYTES(0x01));
+    CHECK_DEC("01 zz", 16, HIDRD_HEX_DEC_ERR_CHAR, 3, BYTES(0x01));
+    CHECK_DEC("01 2\x80", 16, HIDRD_HEX_DEC_ERR_CHAR, 4, BYTES(0x01));
+    CHECK_DEC("0102", 1, HIDRD_HEX_DEC_ERR_SIZE, 2, BYTES(0x01));
+    CHECK_DEC("01 2", 1, HIDRD_HEX_DEC_ERR_SIZE, 3, BYTES(0x01));
+
+    if (hidrd_hex_buf_from_str(buf, sizeof(buf), &len, "0x01") ||
+        !hidrd_hex_buf_from_str(buf, sizeof(buf), &len, "FfEe") ||
+        len != 2 || buf[0] != 0xFF || buf[1] != 0xEE)
+        ERROR("Unexpected string parsing result");
+
+    /* Round trip every byte value */
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = i;
+    str = hidrd_hex_buf_to_str(buf, sizeof(buf));
+    if (str == NULL)
+        ERROR("Failed to format a buffer");
+    if (strncmp(str, "000102", 6) != 0 ||
+        strcmp(str + 500, "FAFBFCFDFEFF") != 0)
+        ERROR("Unexpected buffer formatting result");
+    if (!hidrd_hex_buf_from_str(out, sizeof(out), &len, str) ||
+        len != sizeof(out) || memcmp(buf, out, len) != 0)
+        ERROR("Buffer formatting round trip failed");
+    free(str);
+
+    if (hidrd_hex_byte_to_chrs(chrs, 0xAB, true) != chrs + 2 ||
+        chrs[0] != 'a' || chrs[1] != 'b')
+        ERROR("Unexpected lower case byte formatting result");
+
+    return 0;
+}
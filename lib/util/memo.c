@@ -0,0 +1,124 @@
+/** @file
+ * @brief HID report descriptor - utilities - string memoization cache
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hidrd/util/memo.h"
+
+
+/**
+ * Calculate memo cache slot index for a (kind, key) pair.
+ *
+ * @param kind  String kind.
+ * @param key   String key.
+ *
+ * @return Slot index.
+ */
+static size_t
+hidrd_memo_idx(uint32_t kind, uint32_t key)
+{
+    /*
+     * Fibonacci hashing of the key, offset by the kind, so different kinds
+     * of the same key land in different slots
+     */
+    return (((uint32_t)(key * 0x9E3779B9u) >> (32 - HIDRD_MEMO_SIZE_LOG2)) +
+            kind) & (HIDRD_MEMO_SIZE - 1);
+}
+
+
+void
+hidrd_memo_init(hidrd_memo *memo)
+{
+    assert(memo != NULL);
+    memset(memo, 0, sizeof(*memo));
+}
+
+
+bool
+hidrd_memo_valid(const hidrd_memo *memo)
+{
+    size_t  i;
+
+    if (memo == NULL)
+        return false;
+
+    for (i = 0; i < HIDRD_MEMO_SIZE; i++)
+        if (memo->list[i].str != NULL &&
+            hidrd_memo_idx(memo->list[i].kind, memo->list[i].key) != i)
+            return false;
+
+    return true;
+}
+
+
+void
+hidrd_memo_clnp(hidrd_memo *memo)
+{
+    size_t  i;
+
+    assert(hidrd_memo_valid(memo));
+
+    for (i = 0; i < HIDRD_MEMO_SIZE; i++)
+    {
+        free(memo->list[i].str);
+        memo->list[i].str = NULL;
+    }
+}
+
+
+const char *
+hidrd_memo_get(const hidrd_memo *memo, uint32_t kind, uint32_t key)
+{
+    const hidrd_memo_slot  *slot;
+
+    assert(memo != NULL);
+
+    slot = &memo->list[hidrd_memo_idx(kind, key)];
+
+    return (slot->str != NULL && slot->kind == kind && slot->key == key)
+                ? slot->str
+                : NULL;
+}
+
+
+const char *
+hidrd_memo_put(hidrd_memo *memo, uint32_t kind, uint32_t key, char *str)
+{
+    hidrd_memo_slot    *slot;
+
+    assert(memo != NULL);
+
+    if (str == NULL)
+        return NULL;
+
+    slot = &memo->list[hidrd_memo_idx(kind, key)];
+
+    free(slot->str);
+    slot->kind  = kind;
+    slot->key   = key;
+    slot->str   = str;
+
+    return str;
+}
@@ -175,6 +175,19 @@ hidrd_num_u32_from_str(uint32_t        *pnum,
     assert(hidrd_num_base_valid(base));
     assert(bmrk != HIDRD_NUM_BMRK_NONE || base != HIDRD_NUM_BASE_NONE);
 
+    /* Parse plain decimal numbers in a single scan */
+    if (bmrk == HIDRD_NUM_BMRK_NONE && base == HIDRD_NUM_BASE_DEC)
+    {
+        uint32_t    dec;
+
+        if (!hidrd_num_u32_from_any_str(&dec, str, NULL, &base) ||
+            base != HIDRD_NUM_BASE_DEC)
+            return false;
+        if (pnum != NULL)
+            *pnum = dec;
+        return true;
+    }
+
     /* Lookup expected number end and base, if needed */
     if (!find_exp_end_and_sfx_base(str, bmrk, &base, &exp_end))
         return false;
@@ -225,6 +238,19 @@ hidrd_num_s32_from_str(int32_t         *pnum,
     assert(hidrd_num_base_valid(base));
     assert(bmrk != HIDRD_NUM_BMRK_NONE || base != HIDRD_NUM_BASE_NONE);
 
+    /* Parse plain decimal numbers in a single scan */
+    if (bmrk == HIDRD_NUM_BMRK_NONE && base == HIDRD_NUM_BASE_DEC)
+    {
+        int32_t     dec;
+
+        if (!hidrd_num_s32_from_any_str(&dec, str, NULL, &base) ||
+            base != HIDRD_NUM_BASE_DEC)
+            return false;
+        if (pnum != NULL)
+            *pnum = dec;
+        return true;
+    }
+
     /* Lookup expected number end and base, if needed */
     if (!find_exp_end_and_sfx_base(str, bmrk, &base, &exp_end))
         return false;
@@ -249,88 +275,404 @@ hidrd_num_s32_from_str(int32_t         *pnum,
 }
 
 
-char *
-hidrd_num_u32_to_str(uint32_t num, hidrd_num_bmrk bmrk, hidrd_num_base base)
+/**
+ * Parse a number magnitude with an optional sign and an auto-detected base
+ * in a single scan.
+ *
+ * @param pneg  Location for the "negative" flag.
+ * @param pmag  Location for the number magnitude.
+ * @param pbmrk Location for the detected base mark type.
+ * @param pbase Location for the detected base.
+ * @param str   String to parse.
+ *
+ * @return True if the string was valid and parsed successfully, false
+ *         otherwise.
+ */
+static bool
+mag_from_any_str(bool              *pneg,
+                 uint32_t          *pmag,
+                 hidrd_num_bmrk    *pbmrk,
+                 hidrd_num_base    *pbase,
+                 const char        *str)
 {
-    char   *str;
+    const char     *p           = str;
+    const char     *start;
+    bool            neg         = false;
+    hidrd_num_bmrk  bmrk        = HIDRD_NUM_BMRK_NONE;
+    hidrd_num_base  base;
+    uint32_t        dec         = 0;
+    uint32_t        hex         = 0;
+    bool            dec_digits  = true;
+    bool            dec_ovf     = false;
+    bool            hex_ovf     = false;
+    unsigned int    c;
+    unsigned int    d;
 
-    assert(hidrd_num_bmrk_valid(bmrk));
-    assert(hidrd_num_base_valid(base));
-    assert(base != HIDRD_NUM_BASE_NONE);
+    assert(str != NULL);
 
-    if (base == HIDRD_NUM_BASE_HEX)
+    /* Skip leading space */
+    while (isspace((unsigned char)*p))
+        p++;
+
+    /* Take the sign */
+    if (*p == '-')
     {
-        if (asprintf(&str,
-                     ((bmrk == HIDRD_NUM_BMRK_NONE)
-                        ? "%.*X"
-                        : (bmrk == HIDRD_NUM_BMRK_SFX)
-                            ? "%.*Xh"
-                            : "0x%.*X"),
-                     ((num == 0 && bmrk == HIDRD_NUM_BMRK_NONE)
-                        ? 1
-                        : num <= UINT8_MAX
-                            ? 2
-                            : num <= UINT16_MAX
-                                ? 4
-                                : 8),
-                     (unsigned int)num) < 0)
-            return NULL;
+        neg = true;
+        p++;
+    }
+    else if (*p == '+')
+        p++;
+
+    /* Take the hexadecimal prefix, if followed by a digit */
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X') &&
+        isxdigit((unsigned char)p[2]))
+    {
+        bmrk = HIDRD_NUM_BMRK_PFX;
+        p += 2;
+    }
+
+    /* Accumulate both decimal and hexadecimal values */
+    for (start = p; ; p++)
+    {
+        c = (unsigned char)*p;
+        if (c >= '0' && c <= '9')
+            d = c - '0';
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+        {
+            d = (c | 0x20) - 'a' + 10;
+            dec_digits = false;
+        }
+        else
+            break;
+
+        if (hex > (UINT32_MAX >> 4))
+            hex_ovf = true;
+        hex = (hex << 4) | d;
+
+        if (dec_digits)
+        {
+            if (dec > (UINT32_MAX - d) / 10)
+                dec_ovf = true;
+            dec = dec * 10 + d;
+        }
     }
+
+    /* If there are no digits */
+    if (p == start)
+        return false;
+
+    /* Determine base */
+    if (bmrk == HIDRD_NUM_BMRK_PFX)
+        base = HIDRD_NUM_BASE_HEX;
+    else if (*p == 'h' || *p == 'H')
+    {
+        bmrk = HIDRD_NUM_BMRK_SFX;
+        base = HIDRD_NUM_BASE_HEX;
+        p++;
+    }
+    else if (dec_digits)
+        base = HIDRD_NUM_BASE_DEC;
     else
+        return false;
+
+    /* Skip trailing space and expect the end */
+    while (isspace((unsigned char)*p))
+        p++;
+    if (*p != '\0')
+        return false;
+
+    if (base == HIDRD_NUM_BASE_HEX ? hex_ovf : dec_ovf)
+        return false;
+
+    *pneg = neg;
+    *pmag = (base == HIDRD_NUM_BASE_HEX) ? hex : dec;
+    *pbmrk = bmrk;
+    *pbase = base;
+
+    return true;
+}
+
+
+bool
+hidrd_num_u32_from_any_str(uint32_t        *pnum,
+                           const char      *str,
+                           hidrd_num_bmrk  *pbmrk,
+                           hidrd_num_base  *pbase)
+{
+    bool            neg;
+    uint32_t        mag;
+    hidrd_num_bmrk  bmrk;
+    hidrd_num_base  base;
+
+    assert(str != NULL);
+
+    if (!mag_from_any_str(&neg, &mag, &bmrk, &base, str))
+        return false;
+
+    if (neg)
+        return false;
+
+    if (pnum != NULL)
+        *pnum = mag;
+    if (pbmrk != NULL)
+        *pbmrk = bmrk;
+    if (pbase != NULL)
+        *pbase = base;
+
+    return true;
+}
+
+
+bool
+hidrd_num_s32_from_any_str(int32_t         *pnum,
+                           const char      *str,
+                           hidrd_num_bmrk  *pbmrk,
+                           hidrd_num_base  *pbase)
+{
+    bool            neg;
+    uint32_t        mag;
+    hidrd_num_bmrk  bmrk;
+    hidrd_num_base  base;
+
+    assert(str != NULL);
+
+    if (!mag_from_any_str(&neg, &mag, &bmrk, &base, str))
+        return false;
+
+    if (mag > (neg ? (uint32_t)INT32_MAX + 1 : (uint32_t)INT32_MAX))
+        return false;
+
+    if (pnum != NULL)
+        *pnum = neg ? (int32_t)((uint32_t)0 - mag) : (int32_t)mag;
+    if (pbmrk != NULL)
+        *pbmrk = bmrk;
+    if (pbase != NULL)
+        *pbase = base;
+
+    return true;
+}
+
+
+/** Decimal digit pairs for numbers 0-99 */
+static const char dec_pair_list[200] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/** Hexadecimal digit pairs for numbers 0x00-0xFF */
+static const char hex_pair_list[512] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+/** Hexadecimal digits */
+static const char hex_digit_list[16] = "0123456789ABCDEF";
+
+
+/**
+ * Format an unsigned 32-bit integer as decimal digits, right-aligned at
+ * the end of a buffer.
+ *
+ * @param end   End of the buffer to write to; the buffer must be at least
+ *              10 characters long.
+ * @param num   The number to format.
+ *
+ * @return Start of the written digits.
+ */
+static char *
+dec_to_buf_end(char *end, uint32_t num)
+{
+    char   *p   = end;
+
+    while (num >= 100)
+    {
+        p -= 2;
+        memcpy(p, dec_pair_list + (num % 100) * 2, 2);
+        num /= 100;
+    }
+
+    if (num >= 10)
     {
-        if (asprintf(&str, "%u", (unsigned int)num) < 0)
-            return NULL;
+        p -= 2;
+        memcpy(p, dec_pair_list + num * 2, 2);
     }
+    else
+        *--p = '0' + num;
 
-    return str;
+    return p;
 }
 
 
-char *
-hidrd_num_s32_to_str(int32_t num, hidrd_num_bmrk bmrk, hidrd_num_base base)
+/**
+ * Format an unsigned 32-bit integer as uppercase hexadecimal digits into a
+ * buffer.
+ *
+ * @param buf   Buffer to write to; must be at least 8 characters long.
+ * @param num   The number to format.
+ * @param prec  Minimum number of digits to output.
+ *
+ * @return Number of digits written.
+ */
+static size_t
+hex_to_buf(char *buf, uint32_t num, size_t prec)
 {
-    char   *str;
+    size_t  len;
+    char   *p;
 
-    assert(hidrd_num_bmrk_valid(bmrk));
-    assert(hidrd_num_base_valid(base));
-    assert(base != HIDRD_NUM_BASE_NONE);
+    /* Count significant digits */
+    for (len = 1; len < 8 && (num >> (len * 4)) != 0; len++);
+    if (len < prec)
+        len = prec;
 
-    if (base == HIDRD_NUM_BASE_HEX)
+    /* Write digits from the end, two at a time */
+    for (p = buf + len; p - buf >= 2; num >>= 8)
     {
-        const char *sgn;
+        p -= 2;
+        memcpy(p, hex_pair_list + (num & 0xFF) * 2, 2);
+    }
+    if (p != buf)
+        *--p = hex_digit_list[num & 0xF];
 
-        if (num >= 0)
-            sgn = "";
-        else
+    return len;
+}
+
+
+/**
+ * Get hexadecimal representation precision for a number magnitude.
+ *
+ * @param num   Number magnitude.
+ *
+ * @return Precision, in digits: 2, 4 or 8.
+ */
+static size_t
+hex_prec(uint32_t num)
+{
+    return num <= UINT8_MAX
+                ? 2
+                : num <= UINT16_MAX
+                    ? 4
+                    : 8;
+}
+
+
+/**
+ * Format a number magnitude with optional sign into a buffer.
+ *
+ * @param buf   Buffer to write to; must be at least HIDRD_NUM_STR_SIZE
+ *              characters long.
+ * @param neg   True if the number is negative.
+ * @param num   Number magnitude.
+ * @param bmrk  Number base mark type.
+ * @param base  Number base to convert to, must be specified (not
+ *              HIDRD_NUM_BASE_NONE).
+ * @param prec  Minimum number of digits to output, for hexadecimal base.
+ *
+ * @return Length of the formatted string, excluding terminating zero.
+ */
+static size_t
+mag_to_buf(char            *buf,
+           bool             neg,
+           uint32_t         num,
+           hidrd_num_bmrk   bmrk,
+           hidrd_num_base   base,
+           size_t           prec)
+{
+    char   *p       = buf;
+    char    dec[10];
+    char   *start;
+
+    if (neg)
+        *p++ = '-';
+
+    if (base == HIDRD_NUM_BASE_HEX)
+    {
+        if (bmrk == HIDRD_NUM_BMRK_PFX)
         {
-            num = -num;
-            sgn = "-";
+            *p++ = '0';
+            *p++ = 'x';
         }
-
-        if (asprintf(&str,
-                     ((bmrk == HIDRD_NUM_BMRK_NONE)
-                        ? "%s%.*X"
-                        : (bmrk == HIDRD_NUM_BMRK_SFX)
-                            ? "%s%.*Xh"
-                            : "%s0x%.*X"),
-                     sgn,
-                     (bmrk == HIDRD_NUM_BMRK_NONE
-                        ? 1
-                        : num <= UINT8_MAX
-                            ? 2
-                            : num <= UINT16_MAX
-                                ? 4
-                                : 8),
-                     (unsigned int)num) < 0)
-            return NULL;
+        p += hex_to_buf(p, num, prec);
+        if (bmrk == HIDRD_NUM_BMRK_SFX)
+            *p++ = 'h';
     }
     else
     {
-        if (asprintf(&str, "%d", (int)num) < 0)
-            return NULL;
+        start = dec_to_buf_end(dec + sizeof(dec), num);
+        memcpy(p, start, dec + sizeof(dec) - start);
+        p += dec + sizeof(dec) - start;
     }
 
-    return str;
+    *p = '\0';
+
+    return p - buf;
+}
+
+
+size_t
+hidrd_num_u32_to_buf(char              *buf,
+                     uint32_t           num,
+                     hidrd_num_bmrk     bmrk,
+                     hidrd_num_base     base)
+{
+    assert(buf != NULL);
+    assert(hidrd_num_bmrk_valid(bmrk));
+    assert(hidrd_num_base_valid(base));
+    assert(base != HIDRD_NUM_BASE_NONE);
+
+    return mag_to_buf(buf, false, num, bmrk, base,
+                      (num == 0 && bmrk == HIDRD_NUM_BMRK_NONE)
+                        ? 1
+                        : hex_prec(num));
+}
+
+
+size_t
+hidrd_num_s32_to_buf(char              *buf,
+                     int32_t            num,
+                     hidrd_num_bmrk     bmrk,
+                     hidrd_num_base     base)
+{
+    uint32_t    mag;
+
+    assert(buf != NULL);
+    assert(hidrd_num_bmrk_valid(bmrk));
+    assert(hidrd_num_base_valid(base));
+    assert(base != HIDRD_NUM_BASE_NONE);
+
+    /* Negate in unsigned domain, to handle INT32_MIN */
+    mag = (num < 0) ? (uint32_t)0 - (uint32_t)num : (uint32_t)num;
+
+    return mag_to_buf(buf, num < 0, mag, bmrk, base,
+                      bmrk == HIDRD_NUM_BMRK_NONE ? 1 : hex_prec(mag));
+}
+
+
+char *
+hidrd_num_u32_to_str(uint32_t num, hidrd_num_bmrk bmrk, hidrd_num_base base)
+{
+    char    buf[HIDRD_NUM_STR_SIZE];
+
+    hidrd_num_u32_to_buf(buf, num, bmrk, base);
+
+    return strdup(buf);
+}
+
+
+char *
+hidrd_num_s32_to_str(int32_t num, hidrd_num_bmrk bmrk, hidrd_num_base base)
+{
+    char    buf[HIDRD_NUM_STR_SIZE];
+
+    hidrd_num_s32_to_buf(buf, num, bmrk, base);
+
+    return strdup(buf);
 }
 
 
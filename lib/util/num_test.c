@@ -24,8 +24,10 @@
 
 #include <assert.h>
 #include <error.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "hidrd/util/num.h"
 
 #define FMT_u32 "%u"
@@ -119,11 +121,244 @@ TEST_TYPE(u32);
         free(str);                                              \
     } while (0)
 
+#define PASS_FROM_ANY_STR(_t, _v, _s, _m, _b) \
+    do {                                                        \
+        HIDRD_NUM_##_t##_TYPE   num;                            \
+        hidrd_num_bmrk          bmrk;                           \
+        hidrd_num_base          base;                           \
+                                                                \
+        if (!hidrd_num_##_t##_from_any_str(&num, _s,            \
+                                           &bmrk, &base))       \
+            ERROR("Failed parsing string \"%s\" "               \
+                  "unexpectedly", _s);                          \
+        if (num != _v)                                          \
+            ERROR("Unexpected parsing result: "                 \
+                  FMT_##_t " instead of " FMT_##_t, num,        \
+                  (HIDRD_NUM_##_t##_TYPE)_v);                   \
+        if (bmrk != HIDRD_NUM_BMRK_##_m ||                      \
+            base != HIDRD_NUM_BASE_##_b)                        \
+            ERROR("Unexpected base detected for \"%s\"", _s);   \
+    } while (0)
+
+
+#define FAIL_FROM_ANY_STR(_t, _s) \
+    do {                                                        \
+        HIDRD_NUM_##_t##_TYPE   num;                            \
+                                                                \
+        if (hidrd_num_##_t##_from_any_str(&num, _s, NULL, NULL)) \
+            ERROR("Unexpected success parsing string \"%s\", "  \
+                  "result: " FMT_##_t, _s, num);                \
+    } while (0)
+
+
+/**
+ * Format an unsigned 32-bit integer the way hidrd_num_u32_to_str did
+ * originally, using snprintf, as a reference.
+ */
+static void
+ref_u32_to_buf(char *buf, uint32_t num,
+               hidrd_num_bmrk bmrk, hidrd_num_base base)
+{
+    if (base == HIDRD_NUM_BASE_HEX)
+        snprintf(buf, HIDRD_NUM_STR_SIZE,
+                 ((bmrk == HIDRD_NUM_BMRK_NONE)
+                    ? "%.*X"
+                    : (bmrk == HIDRD_NUM_BMRK_SFX)
+                        ? "%.*Xh"
+                        : "0x%.*X"),
+                 ((num == 0 && bmrk == HIDRD_NUM_BMRK_NONE)
+                    ? 1
+                    : num <= UINT8_MAX
+                        ? 2
+                        : num <= UINT16_MAX
+                            ? 4
+                            : 8),
+                 (unsigned int)num);
+    else
+        snprintf(buf, HIDRD_NUM_STR_SIZE, "%u", (unsigned int)num);
+}
+
+
+/**
+ * Format a signed 32-bit integer the way hidrd_num_s32_to_str did
+ * originally, using snprintf, as a reference.
+ */
+static void
+ref_s32_to_buf(char *buf, int32_t num,
+               hidrd_num_bmrk bmrk, hidrd_num_base base)
+{
+    if (base == HIDRD_NUM_BASE_HEX)
+    {
+        uint32_t mag = (num < 0) ? (uint32_t)0 - (uint32_t)num
+                                 : (uint32_t)num;
+
+        snprintf(buf, HIDRD_NUM_STR_SIZE,
+                 ((bmrk == HIDRD_NUM_BMRK_NONE)
+                    ? "%s%.*X"
+                    : (bmrk == HIDRD_NUM_BMRK_SFX)
+                        ? "%s%.*Xh"
+                        : "%s0x%.*X"),
+                 (num < 0 ? "-" : ""),
+                 (bmrk == HIDRD_NUM_BMRK_NONE
+                    ? 1
+                    : mag <= UINT8_MAX
+                        ? 2
+                        : mag <= UINT16_MAX
+                            ? 4
+                            : 8),
+                 (unsigned int)mag);
+    }
+    else
+        snprintf(buf, HIDRD_NUM_STR_SIZE, "%d", (int)num);
+}
+
+
+static const hidrd_num_bmrk bmrk_list[] = {HIDRD_NUM_BMRK_NONE,
+                                           HIDRD_NUM_BMRK_SFX,
+                                           HIDRD_NUM_BMRK_PFX};
+static const hidrd_num_base base_list[] = {HIDRD_NUM_BASE_DEC,
+                                           HIDRD_NUM_BASE_HEX};
+
+#define ARRAY_SIZE(_a) (sizeof(_a) / sizeof(*(_a)))
+
+/**
+ * Check buffer formatting against the reference and parse the result back
+ * with the single-scan parser, for a number.
+ */
+static void
+check_to_buf(uint32_t num)
+{
+    size_t          m;
+    size_t          b;
+    char            ref[HIDRD_NUM_STR_SIZE];
+    char            buf[HIDRD_NUM_STR_SIZE];
+    size_t          len;
+    uint32_t        u32;
+    int32_t         s32;
+
+    for (m = 0; m < ARRAY_SIZE(bmrk_list); m++)
+        for (b = 0; b < ARRAY_SIZE(base_list); b++)
+        {
+            ref_u32_to_buf(ref, num, bmrk_list[m], base_list[b]);
+            len = hidrd_num_u32_to_buf(buf, num,
+                                       bmrk_list[m], base_list[b]);
+            if (strcmp(buf, ref) != 0 || len != strlen(ref))
+                ERROR("Unexpected u32 buffer formatting result: "
+                      "%s instead of %s", buf, ref);
+            /* Unmarked hex is indistinguishable from decimal */
+            if ((bmrk_list[m] != HIDRD_NUM_BMRK_NONE ||
+                 base_list[b] == HIDRD_NUM_BASE_DEC) &&
+                (!hidrd_num_u32_from_any_str(&u32, buf, NULL, NULL) ||
+                 u32 != num))
+                ERROR("Failed parsing \"%s\" back", buf);
+
+            ref_s32_to_buf(ref, (int32_t)num, bmrk_list[m], base_list[b]);
+            len = hidrd_num_s32_to_buf(buf, (int32_t)num,
+                                       bmrk_list[m], base_list[b]);
+            if (strcmp(buf, ref) != 0 || len != strlen(ref))
+                ERROR("Unexpected s32 buffer formatting result: "
+                      "%s instead of %s", buf, ref);
+            if ((bmrk_list[m] != HIDRD_NUM_BMRK_NONE ||
+                 base_list[b] == HIDRD_NUM_BASE_DEC) &&
+                (!hidrd_num_s32_from_any_str(&s32, buf, NULL, NULL) ||
+                 s32 != (int32_t)num))
+                ERROR("Failed parsing \"%s\" back", buf);
+        }
+}
+
+
+/**
+ * Get monotonic time in seconds.
+ */
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+
+#define BENCH(_name, _code) \
+    do {                                                        \
+        double  _start  = now();                                \
+        size_t  _i;                                             \
+                                                                \
+        for (_i = 0; _i < iter_num; _i++)                       \
+        {                                                       \
+            uint32_t    n = (uint32_t)(_i * 2654435761u);       \
+                                                                \
+            (void)n;                                            \
+            _code;                                              \
+        }                                                       \
+        printf("%-32s %8.1f ns/op\n", _name,                    \
+               (now() - _start) * 1e9 / iter_num);              \
+    } while (0)
+
+
+/**
+ * Benchmark the buffer formatting and single-scan parsing against the
+ * allocating formatting and alternate-string parsing.
+ */
+static void
+bench(size_t iter_num)
+{
+    static const char  *str_list[]  = {"123", "0x1F", "7FFFh", "4294967295",
+                                       "-0x80", "65535", "FFh", "0x00"};
+    char                buf[HIDRD_NUM_STR_SIZE];
+    char               *str;
+    volatile size_t     sink        = 0;
+
+    BENCH("snprintf hex", ref_u32_to_buf(buf, n, HIDRD_NUM_BMRK_PFX,
+                                         HIDRD_NUM_BASE_HEX);
+                          sink += buf[0]);
+    BENCH("hidrd_num_u32_to_str hex",
+          str = hidrd_num_u32_to_str(n, HIDRD_NUM_BMRK_PFX,
+                                     HIDRD_NUM_BASE_HEX);
+          sink += str[0]; free(str));
+    BENCH("hidrd_num_u32_to_buf hex",
+          sink += hidrd_num_u32_to_buf(buf, n, HIDRD_NUM_BMRK_PFX,
+                                       HIDRD_NUM_BASE_HEX));
+    BENCH("snprintf dec", ref_s32_to_buf(buf, (int32_t)n,
+                                         HIDRD_NUM_BMRK_NONE,
+                                         HIDRD_NUM_BASE_DEC);
+                          sink += buf[0]);
+    BENCH("hidrd_num_s32_to_str dec",
+          str = hidrd_num_s32_to_str((int32_t)n, HIDRD_NUM_BMRK_NONE,
+                                     HIDRD_NUM_BASE_DEC);
+          sink += str[0]; free(str));
+    BENCH("hidrd_num_s32_to_buf dec",
+          sink += hidrd_num_s32_to_buf(buf, (int32_t)n, HIDRD_NUM_BMRK_NONE,
+                                       HIDRD_NUM_BASE_DEC));
+    BENCH("hidrd_num_from_alt_str",
+          int32_t v = 0;
+          hidrd_num_from_alt_str(&v, str_list[_i % ARRAY_SIZE(str_list)],
+                                 hidrd_test_s32_from_dec,
+                                 hidrd_test_s32_from_sstr,
+                                 hidrd_test_s32_from_pstr,
+                                 NULL);
+          sink += v);
+    BENCH("hidrd_num_s32_from_any_str",
+          int32_t v = 0;
+          hidrd_num_s32_from_any_str(&v,
+                                     str_list[_i % ARRAY_SIZE(str_list)],
+                                     NULL, NULL);
+          sink += v);
+}
+
+
 int
 main(int argc, char **argv)
 {
-    (void)argc;
-    (void)argv;
+    uint32_t    num;
+
+    /* If asked to benchmark */
+    if (argc > 1 && strcmp(argv[1], "bench") == 0)
+    {
+        bench(argc > 2 ? strtoul(argv[2], NULL, 0) : 1000000);
+        return 0;
+    }
 
     PASS_BOTH(u32,  UINT32_MAX, "4294967295",   NONE,   DEC);
     PASS_BOTH(u32,  UINT16_MAX, "65535",        NONE,   DEC);
@@ -296,6 +531,16 @@ main(int argc, char **argv)
     FAIL_FROM_STR(s8,   "128",          NONE,   DEC);
 
     PASS_FROM_STR(u32,  10, " 10 ",     NONE,   DEC);
+    PASS_FROM_STR(u32,  10, "+10",      NONE,   DEC);
+    PASS_FROM_STR(u32,  7,  "007",      NONE,   DEC);
+    PASS_FROM_STR(s32,  -10, " -10 ",   NONE,   DEC);
+
+    /* Decimal parsing doesn't take marked hexadecimal numbers */
+    FAIL_FROM_STR(u32,  "0x10",         NONE,   DEC);
+    FAIL_FROM_STR(u32,  "10h",          NONE,   DEC);
+    FAIL_FROM_STR(s32,  "-0x10",        NONE,   DEC);
+    FAIL_FROM_STR(s32,  "-10h",         NONE,   DEC);
+    FAIL_FROM_STR(u32,  "-0",           NONE,   DEC);
 
     FAIL_FROM_STR(u32,  "a1",           NONE,   DEC);
     FAIL_FROM_STR(u32,  "1a",           NONE,   DEC);
@@ -325,5 +570,43 @@ main(int argc, char **argv)
     PASS_TO_ALT_STR1_1("-2147483648",    test_s32,   INT32_MIN,  null, dec);
     PASS_TO_ALT_STR1_1("2147483647",     test_s32,   INT32_MAX,  null, dec);
 
+    PASS_FROM_ANY_STR(u32,  10,         " 10 ",         NONE,   DEC);
+    PASS_FROM_ANY_STR(u32,  0,          "0",            NONE,   DEC);
+    PASS_FROM_ANY_STR(u32,  UINT32_MAX, "4294967295",   NONE,   DEC);
+    PASS_FROM_ANY_STR(u32,  UINT32_MAX, "0xFFFFFFFF",   PFX,    HEX);
+    PASS_FROM_ANY_STR(u32,  UINT32_MAX, "FFFFFFFFh",    SFX,    HEX);
+    PASS_FROM_ANY_STR(u32,  0xA,        "ah",           SFX,    HEX);
+    PASS_FROM_ANY_STR(u32,  0xA,        "0xa",          PFX,    HEX);
+    PASS_FROM_ANY_STR(u32,  10,         "010",          NONE,   DEC);
+    PASS_FROM_ANY_STR(u32,  0,          "0h",           SFX,    HEX);
+    PASS_FROM_ANY_STR(s32,  INT32_MIN,  "-2147483648",  NONE,   DEC);
+    PASS_FROM_ANY_STR(s32,  INT32_MIN,  "-0x80000000",  PFX,    HEX);
+    PASS_FROM_ANY_STR(s32,  INT32_MIN,  "-80000000h",   SFX,    HEX);
+    PASS_FROM_ANY_STR(s32,  INT32_MAX,  "+7FFFFFFFh",   SFX,    HEX);
+
+    FAIL_FROM_ANY_STR(u32,  "");
+    FAIL_FROM_ANY_STR(u32,  " ");
+    FAIL_FROM_ANY_STR(u32,  "-1");
+    FAIL_FROM_ANY_STR(u32,  "4294967296");
+    FAIL_FROM_ANY_STR(u32,  "100000000h");
+    FAIL_FROM_ANY_STR(u32,  "a1");
+    FAIL_FROM_ANY_STR(u32,  "1 a");
+    FAIL_FROM_ANY_STR(u32,  "a h");
+    FAIL_FROM_ANY_STR(u32,  "0x a");
+    FAIL_FROM_ANY_STR(u32,  "0x");
+    FAIL_FROM_ANY_STR(u32,  "0x1h");
+    FAIL_FROM_ANY_STR(s32,  "2147483648");
+    FAIL_FROM_ANY_STR(s32,  "-2147483649");
+    FAIL_FROM_ANY_STR(s32,  "--1");
+
+    /* Check buffer formatting against snprintf over the value range */
+    for (num = 0; num < 0x10000; num++)
+        check_to_buf(num);
+    for (num = 0x10000; num >= 0x10000; num += 0x10001)
+        check_to_buf(num);
+    check_to_buf(UINT32_MAX);
+    check_to_buf(INT32_MAX);
+    check_to_buf((uint32_t)INT32_MIN);
+
     return 0;
 }
@@ -0,0 +1,283 @@
+/** @file
+ * @brief HID report descriptor - utilities - sysfs descriptor scanning
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hidrd/util/hex.h"
+#include "hidrd/util/sysfs.h"
+
+/** Minimum free buffer space to read descriptors into */
+#define HIDRD_SYSFS_READ_SIZE   4096
+
+/**
+ * Parse a four-digit hexadecimal number.
+ *
+ * @param pp    Location of the pointer to the number to parse, advanced
+ *              past the number, if parsed successfully.
+ * @param pval  Location for the number value.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+hidrd_sysfs_hex4(const char **pp, uint16_t *pval)
+{
+    const char *p   = *pp;
+    uint16_t    val = 0;
+    uint8_t     cls;
+    size_t      i;
+
+    for (i = 0; i < 4; i++, p++)
+    {
+        cls = hidrd_hex_chr_class(*p);
+        if (!(cls & HIDRD_HEX_CHR_DIGIT))
+            return false;
+        val = (val << 4) | (cls & 0xF);
+    }
+
+    *pp = p;
+    *pval = val;
+    return true;
+}
+
+
+bool
+hidrd_sysfs_dev_id(const char *name, uint16_t *pvid, uint16_t *ppid)
+{
+    const char *p   = name;
+    uint16_t    bus;
+    uint16_t    vid;
+    uint16_t    pid;
+
+    assert(name != NULL);
+
+    if (!hidrd_sysfs_hex4(&p, &bus) || *p++ != ':' ||
+        !hidrd_sysfs_hex4(&p, &vid) || *p++ != ':' ||
+        !hidrd_sysfs_hex4(&p, &pid) || *p++ != '.' ||
+        !(hidrd_hex_chr_class(*p) & HIDRD_HEX_CHR_DIGIT))
+        return false;
+    for (; hidrd_hex_chr_class(*p) & HIDRD_HEX_CHR_DIGIT; p++);
+    if (*p != '\0')
+        return false;
+
+    if (pvid != NULL)
+        *pvid = vid;
+    if (ppid != NULL)
+        *ppid = pid;
+
+    return true;
+}
+
+
+/**
+ * Filter out hidden and special directory entries.
+ *
+ * @param ent   Directory entry to check.
+ *
+ * @return Non-zero if the entry should be scanned, zero otherwise.
+ */
+static int
+hidrd_sysfs_scan_filter(const struct dirent *ent)
+{
+    return ent->d_name[0] != '.';
+}
+
+
+bool
+hidrd_sysfs_scan_open(hidrd_sysfs_scan *scan, const char *root)
+{
+    int n;
+    int orig_errno;
+
+    assert(scan != NULL);
+    assert(root != NULL);
+
+    memset(scan, 0, sizeof(*scan));
+    hidrd_buf_init(&scan->path);
+    hidrd_buf_init(&scan->desc);
+
+    scan->root = strdup(root);
+    if (scan->root == NULL)
+    {
+        errno = ENOMEM;
+        return false;
+    }
+
+    /* Scan in natural order, so hidraw10 goes after hidraw9 */
+    n = scandir(root, &scan->ent_list,
+                hidrd_sysfs_scan_filter, versionsort);
+    if (n < 0)
+    {
+        orig_errno = errno;
+        free(scan->root);
+        scan->root = NULL;
+        errno = orig_errno;
+        return false;
+    }
+    scan->ent_num = n;
+
+    return true;
+}
+
+
+bool
+hidrd_sysfs_scan_valid(const hidrd_sysfs_scan *scan)
+{
+    return scan != NULL &&
+           scan->root != NULL &&
+           (scan->ent_list != NULL || scan->ent_num == 0) &&
+           scan->ent_idx <= scan->ent_num &&
+           hidrd_buf_valid(&scan->path) &&
+           hidrd_buf_valid(&scan->desc);
+}
+
+
+/**
+ * Read a whole file into a buffer, replacing its contents, and growing it
+ * only if the file doesn't fit.
+ *
+ * @param fd    File descriptor to read from.
+ * @param buf   Buffer to read into.
+ *
+ * @return True if read successfully, false otherwise (see errno in this
+ *         case).
+ */
+static bool
+hidrd_sysfs_read(int fd, hidrd_buf *buf)
+{
+    ssize_t rc;
+
+    hidrd_buf_reset(buf);
+
+    do {
+        if (!hidrd_buf_grow(buf, buf->len + HIDRD_SYSFS_READ_SIZE))
+        {
+            errno = ENOMEM;
+            return false;
+        }
+        rc = read(fd, (uint8_t *)buf->ptr + buf->len,
+                  buf->size - buf->len);
+        if (rc < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        buf->len += rc;
+    } while (rc > 0);
+
+    return true;
+}
+
+
+bool
+hidrd_sysfs_scan_next(hidrd_sysfs_scan *scan)
+{
+    const char *name;
+    char        link[PATH_MAX];
+    ssize_t     len;
+    char       *base;
+    int         fd;
+    bool        read_ok;
+
+    assert(hidrd_sysfs_scan_valid(scan));
+
+    while (scan->ent_idx < scan->ent_num)
+    {
+        name = scan->ent_list[scan->ent_idx++]->d_name;
+        scan->name = name;
+
+        hidrd_buf_reset(&scan->path);
+        if (!hidrd_buf_add_printf(&scan->path, "%s/%s/device",
+                                  scan->root, name))
+        {
+            scan->err = ENOMEM;
+            return false;
+        }
+
+        /* Take the device IDs from the device link target name */
+        scan->vid = 0;
+        scan->pid = 0;
+        len = readlink(scan->path.ptr, link, sizeof(link) - 1);
+        if (len > 0)
+        {
+            link[len] = '\0';
+            base = strrchr(link, '/');
+            hidrd_sysfs_dev_id(base == NULL ? link : base + 1,
+                               &scan->vid, &scan->pid);
+        }
+
+        if (!hidrd_buf_add_printf(&scan->path, "/report_descriptor"))
+        {
+            scan->err = ENOMEM;
+            return false;
+        }
+
+        fd = open(scan->path.ptr, O_RDONLY);
+        if (fd < 0)
+        {
+            /* Skip entries which are not HID devices */
+            if (errno == ENOENT || errno == ENOTDIR)
+                continue;
+            scan->err = errno;
+            return false;
+        }
+        read_ok = hidrd_sysfs_read(fd, &scan->desc);
+        scan->err = read_ok ? 0 : errno;
+        close(fd);
+
+        return read_ok;
+    }
+
+    scan->name = NULL;
+    scan->err = 0;
+    return false;
+}
+
+
+void
+hidrd_sysfs_scan_close(hidrd_sysfs_scan *scan)
+{
+    size_t  i;
+
+    assert(hidrd_sysfs_scan_valid(scan));
+
+    for (i = 0; i < scan->ent_num; i++)
+        free(scan->ent_list[i]);
+    free(scan->ent_list);
+    scan->ent_list = NULL;
+    scan->ent_num = 0;
+    scan->ent_idx = 0;
+    scan->name = NULL;
+
+    free(scan->root);
+    scan->root = NULL;
+
+    hidrd_buf_clnp(&scan->path);
+    hidrd_buf_clnp(&scan->desc);
+}
@@ -0,0 +1,198 @@
+/** @file
+ * @brief HID report descriptor - utilities - sysfs descriptor scanning test
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <errno.h>
+#include <error.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "hidrd/util/fd.h"
+#include "hidrd/util/sysfs.h"
+
+#define ERROR(_fmt, _args...) \
+    error_at_line(1, 0, __FILE__, __LINE__, _fmt, ##_args)
+
+/** Fake sysfs tree directories, in creation order */
+static const char *dir_list[] = {
+    "devices",
+    "devices/0003:256C:006E.0001",
+    "devices/0005:046D:B012.000A",
+    "class",
+    "class/hidraw2",
+    "class/hidraw3",
+    "class/hidraw3/device",
+    "class/hidraw10",
+    "class/misc",
+    "class/.hidden",
+    "class/.hidden/device",
+    NULL
+};
+
+/** Fake sysfs tree device links */
+static const char *link_list[][2] = {
+    {"class/hidraw2/device",    "../../devices/0003:256C:006E.0001"},
+    {"class/hidraw10/device",   "../../devices/0005:046D:B012.000A"},
+    {NULL, NULL}
+};
+
+/** Fake sysfs tree descriptor files and their sizes */
+static const struct {
+    const char *path;
+    size_t      size;
+} desc_list[] = {
+    {"devices/0003:256C:006E.0001/report_descriptor",  3},
+    {"devices/0005:046D:B012.000A/report_descriptor",  5000},
+    {"class/hidraw3/device/report_descriptor",         0},
+    {"class/.hidden/device/report_descriptor",         1},
+    {NULL, 0}
+};
+
+/** Expected scanning results */
+static const struct {
+    const char *name;
+    uint16_t    vid;
+    uint16_t    pid;
+    size_t      size;
+} scan_list[] = {
+    {"hidraw2",     0x256C, 0x006E, 3},
+    {"hidraw3",     0,      0,      0},
+    {"hidraw10",    0x046D, 0xB012, 5000},
+    {NULL, 0, 0, 0}
+};
+
+int
+main(void)
+{
+    char                root[] = "/tmp/hidrd_sysfs_test.XXXXXX";
+    char                path[256];
+    uint8_t             desc[5000];
+    hidrd_sysfs_scan    scan;
+    uint16_t            vid;
+    uint16_t            pid;
+    size_t              i;
+    int                 fd;
+
+    if (!hidrd_sysfs_dev_id("0003:256C:006E.0001", &vid, &pid) ||
+        vid != 0x256C || pid != 0x006E ||
+        !hidrd_sysfs_dev_id("0018:04f3:0c1a.12345", &vid, &pid) ||
+        vid != 0x04F3 || pid != 0x0C1A)
+        ERROR("Failed to parse a HID device name");
+    if (hidrd_sysfs_dev_id("0003:256C:006E", NULL, NULL) ||
+        hidrd_sysfs_dev_id("0003:256C:006E.", NULL, NULL) ||
+        hidrd_sysfs_dev_id("0003:256C:6E.0001", NULL, NULL) ||
+        hidrd_sysfs_dev_id("0003:256C:006E.0001/", NULL, NULL) ||
+        hidrd_sysfs_dev_id("hidraw0", NULL, NULL))
+        ERROR("Parsed an invalid HID device name");
+
+    for (i = 0; i < sizeof(desc); i++)
+        desc[i] = i;
+
+    /*
+     * Create a fake sysfs tree
+     */
+    if (mkdtemp(root) == NULL)
+        error(1, errno, "Failed to create test directory");
+    for (i = 0; dir_list[i] != NULL; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, dir_list[i]);
+        if (mkdir(path, S_IRWXU) != 0)
+            error(1, errno, "Failed to create %s", path);
+    }
+    for (i = 0; link_list[i][0] != NULL; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, link_list[i][0]);
+        if (symlink(link_list[i][1], path) != 0)
+            error(1, errno, "Failed to create %s", path);
+    }
+    for (i = 0; desc_list[i].path != NULL; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, desc_list[i].path);
+        fd = open(path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        if (fd < 0 || !hidrd_fd_write_whole(fd, desc, desc_list[i].size))
+            error(1, errno, "Failed to write %s", path);
+        close(fd);
+    }
+
+    /*
+     * Scan the fake tree
+     */
+    snprintf(path, sizeof(path), "%s/class", root);
+    if (!hidrd_sysfs_scan_open(&scan, path))
+        error(1, errno, "Failed to open scanner");
+
+    for (i = 0; scan_list[i].name != NULL; i++)
+    {
+        if (!hidrd_sysfs_scan_next(&scan))
+            ERROR("Failed to scan %s: %s", scan_list[i].name,
+                  strerror(scan.err));
+        if (scan.name == NULL || strcmp(scan.name, scan_list[i].name) != 0)
+            ERROR("Unexpected entry name scanned instead of %s",
+                  scan_list[i].name);
+        snprintf(path, sizeof(path), "%s/class/%s/device/report_descriptor",
+                 root, scan_list[i].name);
+        if (strcmp(scan.path.ptr, path) != 0)
+            ERROR("Unexpected path %s scanned instead of %s",
+                  (const char *)scan.path.ptr, path);
+        if (scan.vid != scan_list[i].vid || scan.pid != scan_list[i].pid)
+            ERROR("Unexpected device IDs scanned for %s",
+                  scan_list[i].name);
+        if (scan.desc.len != scan_list[i].size ||
+            memcmp(scan.desc.ptr, desc, scan.desc.len) != 0)
+            ERROR("Unexpected descriptor scanned for %s",
+                  scan_list[i].name);
+    }
+    if (hidrd_sysfs_scan_next(&scan) || scan.err != 0)
+        ERROR("Scanning didn't end cleanly");
+
+    hidrd_sysfs_scan_close(&scan);
+
+    if (hidrd_sysfs_scan_open(&scan, "/nonexistent/hidrd/sysfs") ||
+        errno != ENOENT)
+        ERROR("Opened a scanner for a nonexistent root");
+
+    /*
+     * Remove the fake tree
+     */
+    for (i = 0; desc_list[i].path != NULL; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, desc_list[i].path);
+        unlink(path);
+    }
+    for (i = 0; link_list[i][0] != NULL; i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, link_list[i][0]);
+        unlink(path);
+    }
+    for (i = sizeof(dir_list) / sizeof(*dir_list) - 1; i > 0; i--)
+    {
+        snprintf(path, sizeof(path), "%s/%s", root, dir_list[i - 1]);
+        rmdir(path);
+    }
+    rmdir(root);
+
+    return 0;
+}
@@ -22,8 +22,12 @@
  * @author Nikolai Kondrashov <spbnick@gmail.com>
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 #include "hidrd/cfg.h"
 #include "hidrd/util/dec.h"
+#include "hidrd/util/char.h"
 #include "hidrd/util/str.h"
 #include "hidrd/util/tkn.h"
 #include "hidrd/util/buf.h"
@@ -164,6 +168,101 @@ cleanup:
 }
 
 
+/**
+ * Convert an expression string to a unit of the specified system.
+ *
+ * @param punit     Location for the resulting unit.
+ * @param expr      Expression string to convert.
+ * @param system    Known unit system to look the exponent names up in.
+ *
+ * @return True if the expression was valid for the system, false
+ *         otherwise.
+ */
+static bool
+unit_from_expr_system(hidrd_unit       *punit,
+                      const char       *expr,
+                      hidrd_unit_system system)
+{
+    hidrd_unit  unit    = hidrd_unit_set_system(HIDRD_UNIT_NONE, system);
+    const char *p       = expr;
+    const char *name;
+    size_t      name_len;
+    size_t      i;
+    long        exp_int;
+    char       *end;
+
+    while (true)
+    {
+        while (isspace((unsigned char)*p))
+            p++;
+
+        /* Read the exponent name */
+        for (name = p; hidrd_char_istkn(*p); p++);
+        name_len = p - name;
+        if (name_len == 0)
+            return false;
+
+        for (i = 0; i < HIDRD_UNIT_NIBBLE_INDEX_EXP_NUM; i++)
+            if (strncasecmp(exp_tkn[i][system], name, name_len) == 0 &&
+                exp_tkn[i][system][name_len] == '\0')
+                break;
+        if (i >= HIDRD_UNIT_NIBBLE_INDEX_EXP_NUM ||
+            hidrd_unit_get_nibble(unit,
+                                  i + HIDRD_UNIT_NIBBLE_INDEX_EXP_MIN) !=
+                HIDRD_UNIT_EXP_0)
+            return false;
+
+        /* Read the optional power */
+        if (*p == '^')
+        {
+            exp_int = strtol(p + 1, &end, 10);
+            if (end == p + 1 || exp_int == 0 ||
+                !hidrd_unit_exp_valid_int(exp_int))
+                return false;
+            p = end;
+        }
+        else
+            exp_int = 1;
+
+        unit = hidrd_unit_set_nibble(unit,
+                                     i + HIDRD_UNIT_NIBBLE_INDEX_EXP_MIN,
+                                     hidrd_unit_exp_from_int(exp_int));
+
+        while (isspace((unsigned char)*p))
+            p++;
+
+        if (*p == '\0')
+            break;
+        if (*p++ != '*')
+            return false;
+    }
+
+    *punit = unit;
+    return true;
+}
+
+
+bool
+hidrd_unit_from_expr(hidrd_unit *punit, const char *expr)
+{
+    hidrd_unit_system   system;
+    hidrd_unit          unit;
+
+    assert(expr != NULL);
+
+    for (system = HIDRD_UNIT_SYSTEM_KNOWN_MIN;
+         system <= HIDRD_UNIT_SYSTEM_KNOWN_MAX; system++)
+        if (unit_from_expr_system(&unit, expr, system))
+        {
+            if (punit != NULL)
+                *punit = unit;
+            return true;
+        }
+
+    return false;
+}
+
+
 #endif /* HIDRD_WITH_TOKENS */
 
 
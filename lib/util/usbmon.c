@@ -0,0 +1,1017 @@
+/** @file
+ * @brief HID report descriptor - utilities - usbmon capture scanning
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <assert.h>
+#include <byteswap.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "hidrd/util/hex.h"
+#include "hidrd/util/usbmon.h"
+
+/** GET_DESCRIPTOR request code */
+#define HIDRD_USBMON_GET_DESCRIPTOR     0x06
+/** Device-to-host, standard, device request type */
+#define HIDRD_USBMON_IN_STD_DEV         0x80
+/** Device-to-host, standard, interface request type */
+#define HIDRD_USBMON_IN_STD_IFACE       0x81
+/** Device descriptor type */
+#define HIDRD_USBMON_DESC_DEV           0x01
+/** Report descriptor type */
+#define HIDRD_USBMON_DESC_REPORT        0x22
+/** Device descriptor size up to and including idProduct */
+#define HIDRD_USBMON_DESC_DEV_ID_SIZE   12
+
+/** Linux USB header transfer type of control transfers */
+#define HIDRD_USBMON_XFER_CTRL          2
+/** Linux USB header endpoint direction bit */
+#define HIDRD_USBMON_EP_IN              0x80
+
+/** pcap file magic, for microsecond timestamps */
+#define HIDRD_USBMON_PCAP_MAGIC_US      0xA1B2C3D4
+/** pcap file magic, for nanosecond timestamps */
+#define HIDRD_USBMON_PCAP_MAGIC_NS      0xA1B23C4D
+/** pcap file header size */
+#define HIDRD_USBMON_PCAP_HDR_SIZE      24
+/** pcap record header size */
+#define HIDRD_USBMON_PCAP_REC_SIZE      16
+/** pcap link type bits */
+#define HIDRD_USBMON_PCAP_LINK_MASK     0x0FFFFFFF
+
+/** pcapng section header block type */
+#define HIDRD_USBMON_PCAPNG_SHB         0x0A0D0D0A
+/** pcapng interface description block type */
+#define HIDRD_USBMON_PCAPNG_IDB         1
+/** pcapng simple packet block type */
+#define HIDRD_USBMON_PCAPNG_SPB         3
+/** pcapng enhanced packet block type */
+#define HIDRD_USBMON_PCAPNG_EPB         6
+/** pcapng section byte-order magic */
+#define HIDRD_USBMON_PCAPNG_BOM         0x1A2B3C4D
+
+/** Linux USB link type, with 48-byte headers */
+#define HIDRD_USBMON_LINK_USB_LINUX     189
+/** Linux USB link type, with 64-byte headers */
+#define HIDRD_USBMON_LINK_USB_LINUX_MM  220
+
+/** Capture event, either text or binary */
+typedef struct hidrd_usbmon_ev {
+    uint64_t        id;         /**< URB ID */
+    char            type;       /**< Event type: 'S', 'C' or 'E' */
+    uint16_t        bus;        /**< Bus number */
+    uint8_t         dev;        /**< Device address */
+    const uint8_t  *setup;      /**< Setup packet, or NULL */
+    int32_t         status;     /**< Completion status */
+    size_t          len;        /**< Transferred data length */
+    const uint8_t  *data;       /**< Binary captured data, or NULL */
+    size_t          data_len;   /**< Binary captured data length */
+    const char     *text;       /**< Text captured data words, or NULL */
+    const char     *text_end;   /**< Text captured data words end */
+} hidrd_usbmon_ev;
+
+
+/**
+ * Read a 16-bit capture number in the capture byte order.
+ *
+ * @param scan  Scanner providing the byte order.
+ * @param p     Number location, possibly unaligned.
+ *
+ * @return The number.
+ */
+static uint16_t
+hidrd_usbmon_get16(const hidrd_usbmon_scan *scan, const uint8_t *p)
+{
+    uint16_t    val;
+
+    memcpy(&val, p, sizeof(val));
+    return scan->swap ? bswap_16(val) : val;
+}
+
+
+/**
+ * Read a 32-bit capture number in the capture byte order.
+ *
+ * @param scan  Scanner providing the byte order.
+ * @param p     Number location, possibly unaligned.
+ *
+ * @return The number.
+ */
+static uint32_t
+hidrd_usbmon_get32(const hidrd_usbmon_scan *scan, const uint8_t *p)
+{
+    uint32_t    val;
+
+    memcpy(&val, p, sizeof(val));
+    return scan->swap ? bswap_32(val) : val;
+}
+
+
+/**
+ * Read a 64-bit capture number in the capture byte order.
+ *
+ * @param scan  Scanner providing the byte order.
+ * @param p     Number location, possibly unaligned.
+ *
+ * @return The number.
+ */
+static uint64_t
+hidrd_usbmon_get64(const hidrd_usbmon_scan *scan, const uint8_t *p)
+{
+    uint64_t    val;
+
+    memcpy(&val, p, sizeof(val));
+    return scan->swap ? bswap_64(val) : val;
+}
+
+
+/**
+ * Get a Linux USB header size for a link type.
+ *
+ * @param link  Link type.
+ *
+ * @return Header size, or zero if the link type is not Linux USB.
+ */
+static size_t
+hidrd_usbmon_link_hdr_size(uint32_t link)
+{
+    switch (link & HIDRD_USBMON_PCAP_LINK_MASK)
+    {
+        case HIDRD_USBMON_LINK_USB_LINUX:
+            return 48;
+        case HIDRD_USBMON_LINK_USB_LINUX_MM:
+            return 64;
+        default:
+            return 0;
+    }
+}
+
+
+bool
+hidrd_usbmon_scan_init(hidrd_usbmon_scan   *scan,
+                       const void          *ptr,
+                       size_t               size)
+{
+    uint32_t    magic   = 0;
+
+    assert(scan != NULL);
+    assert(ptr != NULL || size == 0);
+
+    memset(scan, 0, sizeof(*scan));
+    hidrd_buf_init(&scan->buf);
+    scan->ptr = ptr;
+    scan->size = size;
+    scan->fmt = HIDRD_USBMON_FMT_TEXT;
+
+    if (size >= sizeof(magic))
+        memcpy(&magic, ptr, sizeof(magic));
+
+    if (magic == HIDRD_USBMON_PCAPNG_SHB)
+        scan->fmt = HIDRD_USBMON_FMT_PCAPNG;
+    else if (magic == HIDRD_USBMON_PCAP_MAGIC_US ||
+             magic == HIDRD_USBMON_PCAP_MAGIC_NS ||
+             magic == bswap_32(HIDRD_USBMON_PCAP_MAGIC_US) ||
+             magic == bswap_32(HIDRD_USBMON_PCAP_MAGIC_NS))
+    {
+        scan->fmt = HIDRD_USBMON_FMT_PCAP;
+        scan->swap = (magic == bswap_32(HIDRD_USBMON_PCAP_MAGIC_US) ||
+                      magic == bswap_32(HIDRD_USBMON_PCAP_MAGIC_NS));
+        if (size < HIDRD_USBMON_PCAP_HDR_SIZE)
+        {
+            errno = EINVAL;
+            return false;
+        }
+        scan->link = hidrd_usbmon_get32(scan, scan->ptr + 20);
+        if (hidrd_usbmon_link_hdr_size(scan->link) == 0)
+        {
+            errno = EINVAL;
+            return false;
+        }
+        scan->pos = HIDRD_USBMON_PCAP_HDR_SIZE;
+    }
+
+    return true;
+}
+
+
+bool
+hidrd_usbmon_scan_open(hidrd_usbmon_scan *scan, const char *path)
+{
+    int         fd;
+    struct stat st;
+    void       *map     = NULL;
+    int         orig_errno;
+
+    assert(scan != NULL);
+    assert(path != NULL);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &st) != 0)
+        goto fail;
+
+    if (st.st_size > 0)
+    {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED)
+            goto fail;
+        /* Captures are read once, front to back */
+        madvise(map, st.st_size, MADV_SEQUENTIAL);
+    }
+    close(fd);
+
+    if (!hidrd_usbmon_scan_init(scan, map, st.st_size))
+    {
+        orig_errno = errno;
+        if (map != NULL)
+            munmap(map, st.st_size);
+        errno = orig_errno;
+        return false;
+    }
+    scan->map = map;
+    scan->map_size = st.st_size;
+
+    return true;
+
+fail:
+
+    orig_errno = errno;
+    close(fd);
+    errno = orig_errno;
+    return false;
+}
+
+
+bool
+hidrd_usbmon_scan_valid(const hidrd_usbmon_scan *scan)
+{
+    return scan != NULL &&
+           (scan->ptr != NULL || scan->size == 0) &&
+           scan->pos <= scan->size &&
+           scan->drop_pos <= scan->pos &&
+           (scan->map == NULL || scan->map == scan->ptr) &&
+           (scan->if_list != NULL || scan->if_num == 0) &&
+           (scan->dev_list != NULL || scan->dev_num == 0) &&
+           scan->pend_next < HIDRD_USBMON_PEND_NUM &&
+           hidrd_buf_valid(&scan->buf);
+}
+
+
+/**
+ * Record device IDs from a device descriptor.
+ *
+ * @param scan  Scanner to record the IDs in.
+ * @param bus   Device bus number.
+ * @param dev   Device address.
+ * @param desc  Device descriptor, at least HIDRD_USBMON_DESC_DEV_ID_SIZE
+ *              bytes long.
+ *
+ * @return True if recorded successfully, false otherwise.
+ */
+static bool
+hidrd_usbmon_dev_add(hidrd_usbmon_scan *scan,
+                     uint16_t bus, uint8_t dev, const uint8_t *desc)
+{
+    hidrd_usbmon_dev   *entry;
+    size_t              i;
+
+    for (i = 0; i < scan->dev_num; i++)
+        if (scan->dev_list[i].bus == bus && scan->dev_list[i].dev == dev)
+            break;
+
+    if (i == scan->dev_num)
+    {
+        /* Grow the list when the number of entries reaches a power of 2 */
+        if ((i & (i - 1)) == 0)
+        {
+            entry = realloc(scan->dev_list,
+                            sizeof(*entry) * (i == 0 ? 1 : i * 2));
+            if (entry == NULL)
+                return false;
+            scan->dev_list = entry;
+        }
+        scan->dev_num++;
+    }
+
+    entry = &scan->dev_list[i];
+    entry->bus = bus;
+    entry->dev = dev;
+    /* Descriptor fields are little-endian */
+    entry->vid = desc[8] | (desc[9] << 8);
+    entry->pid = desc[10] | (desc[11] << 8);
+
+    return true;
+}
+
+
+/**
+ * Decode text data words into the scanner buffer.
+ *
+ * @param scan  Scanner to decode into.
+ * @param p     Data words.
+ * @param end   Data words end.
+ *
+ * @return True if decoded successfully, false if the words are invalid,
+ *         or memory allocation failed (with errno set to ENOMEM).
+ */
+static bool
+hidrd_usbmon_text_data(hidrd_usbmon_scan *scan,
+                       const char *p, const char *end)
+{
+    uint8_t     hi;
+    uint8_t     lo;
+
+    hidrd_buf_reset(&scan->buf);
+    /* Each byte takes at least two characters */
+    if (!hidrd_buf_grow(&scan->buf, (end - p) / 2 + 1))
+    {
+        errno = ENOMEM;
+        return false;
+    }
+
+    while (p < end)
+    {
+        if (*p == ' ' || *p == '\t' || *p == '\r')
+        {
+            p++;
+            continue;
+        }
+        if (end - p < 2)
+            return false;
+        hi = hidrd_hex_chr_class(p[0]);
+        lo = hidrd_hex_chr_class(p[1]);
+        if (!(hi & lo & HIDRD_HEX_CHR_DIGIT))
+            return false;
+        ((uint8_t *)scan->buf.ptr)[scan->buf.len++] =
+            ((hi & 0xF) << 4) | (lo & 0xF);
+        p += 2;
+    }
+
+    errno = 0;
+    return true;
+}
+
+
+/**
+ * Process a capture event.
+ *
+ * @param scan  Scanner to process the event with.
+ * @param ev    Event to process.
+ *
+ * @return True if the event completed a report descriptor request, which
+ *         is now the last descriptor scanned, false otherwise; scan->err
+ *         is set if processing failed.
+ */
+static bool
+hidrd_usbmon_scan_ev(hidrd_usbmon_scan *scan, const hidrd_usbmon_ev *ev)
+{
+    hidrd_usbmon_pend  *pend;
+    hidrd_usbmon_pend   done;
+    const uint8_t      *data;
+    size_t              data_len;
+    size_t              i;
+
+    if (ev->type == 'S')
+    {
+        if (ev->setup == NULL ||
+            ev->setup[1] != HIDRD_USBMON_GET_DESCRIPTOR ||
+            !((ev->setup[0] == HIDRD_USBMON_IN_STD_DEV &&
+               ev->setup[3] == HIDRD_USBMON_DESC_DEV) ||
+              (ev->setup[0] == HIDRD_USBMON_IN_STD_IFACE &&
+               ev->setup[3] == HIDRD_USBMON_DESC_REPORT)))
+            return false;
+
+        /* Reuse the slot of the same URB, a free one, or the next one */
+        for (pend = NULL, i = 0; i < HIDRD_USBMON_PEND_NUM; i++)
+        {
+            if (scan->pend_list[i].type != 0 &&
+                scan->pend_list[i].id == ev->id)
+            {
+                pend = &scan->pend_list[i];
+                break;
+            }
+            if (pend == NULL && scan->pend_list[i].type == 0)
+                pend = &scan->pend_list[i];
+        }
+        if (pend == NULL)
+        {
+            pend = &scan->pend_list[scan->pend_next];
+            scan->pend_next = (scan->pend_next + 1) % HIDRD_USBMON_PEND_NUM;
+        }
+
+        pend->id = ev->id;
+        pend->bus = ev->bus;
+        pend->dev = ev->dev;
+        pend->type = ev->setup[3];
+        /* Setup packet fields are little-endian */
+        pend->iface = ev->setup[4] | (ev->setup[5] << 8);
+        return false;
+    }
+
+    /* Look up and retire the request */
+    for (i = 0; i < HIDRD_USBMON_PEND_NUM; i++)
+    {
+        pend = &scan->pend_list[i];
+        if (pend->type != 0 && pend->id == ev->id &&
+            pend->bus == ev->bus && pend->dev == ev->dev)
+            break;
+    }
+    if (i == HIDRD_USBMON_PEND_NUM)
+        return false;
+    done = *pend;
+    pend->type = 0;
+
+    if (ev->type != 'C' || ev->status != 0)
+        return false;
+
+    /* Decode text data only for the completions of interest */
+    if (ev->text != NULL)
+    {
+        if (!hidrd_usbmon_text_data(scan, ev->text, ev->text_end))
+        {
+            if (errno == ENOMEM)
+                scan->err = ENOMEM;
+            return false;
+        }
+        data = scan->buf.ptr;
+        data_len = scan->buf.len;
+    }
+    else
+    {
+        data = ev->data;
+        data_len = ev->data_len;
+    }
+
+    if (done.type == HIDRD_USBMON_DESC_DEV)
+    {
+        if (data_len >= HIDRD_USBMON_DESC_DEV_ID_SIZE &&
+            !hidrd_usbmon_dev_add(scan, done.bus, done.dev, data))
+            scan->err = ENOMEM;
+        return false;
+    }
+
+    /* Text captures only have the first 32 bytes of data */
+    if (data_len < ev->len)
+    {
+        scan->trunc_num++;
+        return false;
+    }
+
+    scan->desc = data;
+    scan->desc_size = ev->len;
+    scan->bus = done.bus;
+    scan->dev = done.dev;
+    scan->iface = done.iface;
+    scan->vid = 0;
+    scan->pid = 0;
+    for (i = 0; i < scan->dev_num; i++)
+        if (scan->dev_list[i].bus == done.bus &&
+            scan->dev_list[i].dev == done.dev)
+        {
+            scan->vid = scan->dev_list[i].vid;
+            scan->pid = scan->dev_list[i].pid;
+            break;
+        }
+
+    return true;
+}
+
+
+/**
+ * Extract the next space-separated word of a text line.
+ *
+ * @param pp    Location of the pointer to the line remainder, advanced
+ *              past the word.
+ * @param end   Line end.
+ * @param pw    Location for the word pointer.
+ *
+ * @return Word length, zero if there are no more words.
+ */
+static size_t
+hidrd_usbmon_text_word(const char **pp, const char *end, const char **pw)
+{
+    const char *p   = *pp;
+    const char *w;
+
+    for (; p < end && (*p == ' ' || *p == '\t' || *p == '\r'); p++);
+    for (w = p; p < end && *p != ' ' && *p != '\t' && *p != '\r'; p++);
+
+    *pp = p;
+    *pw = w;
+    return p - w;
+}
+
+
+/**
+ * Parse a hexadecimal number.
+ *
+ * @param w     Number characters.
+ * @param len   Number length, must be non-zero.
+ * @param pval  Location for the number value.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+hidrd_usbmon_text_hex(const char *w, size_t len, uint64_t *pval)
+{
+    uint64_t    val = 0;
+    uint8_t     cls;
+
+    if (len == 0 || len > 16)
+        return false;
+
+    for (; len > 0; w++, len--)
+    {
+        cls = hidrd_hex_chr_class(*w);
+        if (!(cls & HIDRD_HEX_CHR_DIGIT))
+            return false;
+        val = (val << 4) | (cls & 0xF);
+    }
+
+    *pval = val;
+    return true;
+}
+
+
+/**
+ * Parse a decimal number, optionally negative.
+ *
+ * @param w     Number characters.
+ * @param len   Number length.
+ * @param max   Maximum absolute value.
+ * @param pval  Location for the number value.
+ *
+ * @return True if parsed successfully, false otherwise.
+ */
+static bool
+hidrd_usbmon_text_dec(const char *w, size_t len,
+                      int64_t max, int64_t *pval)
+{
+    bool        neg = false;
+    int64_t     val = 0;
+
+    if (len > 0 && *w == '-')
+    {
+        neg = true;
+        w++;
+        len--;
+    }
+    if (len == 0)
+        return false;
+
+    for (; len > 0; w++, len--)
+    {
+        if (*w < '0' || *w > '9')
+            return false;
+        val = val * 10 + (*w - '0');
+        if (val > max)
+            return false;
+    }
+
+    *pval = neg ? -val : val;
+    return true;
+}
+
+
+/**
+ * Parse a usbmon text line, as described in the kernel
+ * Documentation/usb/usbmon.rst, e.g.:
+ *
+ * ffff88003b3a9d80 1561477456 S Ci:1:002:0 s 81 06 2200 0000 0041 65 <
+ * ffff88003b3a9d80 1561478522 C Ci:1:002:0 0 65 = 05010902 a1010901
+ *
+ * Only the control IN transfer events are parsed.
+ *
+ * @param p         Line.
+ * @param end       Line end.
+ * @param ev        Location for the event.
+ * @param setup     Location for the setup packet.
+ *
+ * @return True if the line is a control IN transfer event, false
+ *         otherwise.
+ */
+static bool
+hidrd_usbmon_text_ev(const char *p, const char *end,
+                     hidrd_usbmon_ev *ev, uint8_t *setup)
+{
+    /* Setup packet field sizes, in hex digits */
+    static const size_t setup_len[] = {2, 2, 4, 4, 4};
+    const char         *w;
+    size_t              len;
+    const char         *addr_end;
+    int64_t             addr[3];
+    size_t              addr_num;
+    const char         *sep;
+    uint64_t            val;
+    int64_t             dec;
+    size_t              i;
+    size_t              setup_pos;
+
+    memset(ev, 0, sizeof(*ev));
+
+    /* URB tag */
+    len = hidrd_usbmon_text_word(&p, end, &w);
+    if (!hidrd_usbmon_text_hex(w, len, &ev->id))
+        return false;
+    /* Timestamp */
+    if (hidrd_usbmon_text_word(&p, end, &w) == 0)
+        return false;
+    /* Event type */
+    len = hidrd_usbmon_text_word(&p, end, &w);
+    if (len != 1 || (*w != 'S' && *w != 'C' && *w != 'E'))
+        return false;
+    ev->type = *w;
+
+    /* Address: "Ci:BUS:DEV:EP", or "Ci:DEV:EP" for the "t" format */
+    len = hidrd_usbmon_text_word(&p, end, &w);
+    if (len < 3 || w[0] != 'C' || w[1] != 'i' || w[2] != ':')
+        return false;
+    addr_end = w + len;
+    for (w += 3, addr_num = 0; w < addr_end; w = sep + 1, addr_num++)
+    {
+        sep = memchr(w, ':', addr_end - w);
+        if (sep == NULL)
+            sep = addr_end;
+        if (addr_num >= 3 ||
+            !hidrd_usbmon_text_dec(w, sep - w,
+                                   UINT16_MAX, &addr[addr_num]) ||
+            addr[addr_num] < 0)
+            return false;
+    }
+    if (addr_num == 3)
+    {
+        ev->bus = addr[0];
+        if (addr[1] > UINT8_MAX)
+            return false;
+        ev->dev = addr[1];
+    }
+    else if (addr_num == 2)
+    {
+        if (addr[0] > UINT8_MAX)
+            return false;
+        ev->dev = addr[0];
+    }
+    else
+        return false;
+
+    if (ev->type == 'S')
+    {
+        /* Setup packet, if captured */
+        len = hidrd_usbmon_text_word(&p, end, &w);
+        if (len == 1 && *w == 's')
+        {
+            for (i = 0, setup_pos = 0; i < sizeof(setup_len) /
+                                           sizeof(*setup_len); i++)
+            {
+                len = hidrd_usbmon_text_word(&p, end, &w);
+                if (len != setup_len[i] ||
+                    !hidrd_usbmon_text_hex(w, len, &val))
+                    return false;
+                /* Store the fields as they are on the wire */
+                setup[setup_pos++] = val & 0xFF;
+                if (len == 4)
+                    setup[setup_pos++] = val >> 8;
+            }
+            ev->setup = setup;
+        }
+        return true;
+    }
+
+    /* Status */
+    len = hidrd_usbmon_text_word(&p, end, &w);
+    if (!hidrd_usbmon_text_dec(w, len, INT32_MAX, &dec))
+        return false;
+    ev->status = dec;
+    if (ev->type == 'E')
+        return true;
+
+    /* Length */
+    len = hidrd_usbmon_text_word(&p, end, &w);
+    if (!hidrd_usbmon_text_dec(w, len, INT32_MAX, &dec) || dec < 0)
+        return false;
+    ev->len = dec;
+
+    /* Data, if captured */
+    len = hidrd_usbmon_text_word(&p, end, &w);
+    if (len == 1 && *w == '=')
+    {
+        ev->text = p;
+        ev->text_end = end;
+    }
+    else
+    {
+        /* Empty data */
+        ev->text = end;
+        ev->text_end = end;
+    }
+
+    return true;
+}
+
+
+/**
+ * Parse a Linux USB packet, as captured with the "usbmon" pcap
+ * interface.
+ *
+ * @param scan      Scanner to parse with, providing the byte order.
+ * @param link      Packet link type.
+ * @param p         Packet.
+ * @param len       Packet captured length.
+ * @param ev        Location for the event.
+ *
+ * @return True if the packet is a control IN transfer event, false
+ *         otherwise.
+ */
+static bool
+hidrd_usbmon_bin_ev(const hidrd_usbmon_scan    *scan,
+                    uint32_t                    link,
+                    const uint8_t              *p,
+                    size_t                      len,
+                    hidrd_usbmon_ev            *ev)
+{
+    size_t      hdr_size    = hidrd_usbmon_link_hdr_size(link);
+    size_t      data_len;
+
+    if (hdr_size == 0 || len < hdr_size ||
+        p[9] != HIDRD_USBMON_XFER_CTRL || !(p[10] & HIDRD_USBMON_EP_IN) ||
+        (p[8] != 'S' && p[8] != 'C' && p[8] != 'E'))
+        return false;
+
+    memset(ev, 0, sizeof(*ev));
+    ev->id = hidrd_usbmon_get64(scan, p);
+    ev->type = p[8];
+    ev->dev = p[11];
+    ev->bus = hidrd_usbmon_get16(scan, p + 12);
+    /* Setup and data flags are zero if those are present */
+    if (p[14] == 0)
+        ev->setup = p + 40;
+    ev->status = hidrd_usbmon_get32(scan, p + 28);
+    ev->len = hidrd_usbmon_get32(scan, p + 32);
+    if (p[15] == 0)
+    {
+        data_len = hidrd_usbmon_get32(scan, p + 36);
+        ev->data = p + hdr_size;
+        ev->data_len = (data_len < len - hdr_size)
+                            ? data_len : len - hdr_size;
+    }
+    else
+        ev->data = p + hdr_size;
+
+    return true;
+}
+
+
+/**
+ * Extract the next packet from a pcapng capture, processing other blocks
+ * on the way.
+ *
+ * @param scan  Scanner to extract with.
+ * @param plink Location for the packet link type.
+ * @param pp    Location for the packet pointer.
+ * @param plen  Location for the packet captured length.
+ *
+ * @return True if a packet was extracted, false if there are no more
+ *         packets, or the capture is invalid, or memory allocation failed
+ *         (with scan->err set in the latter two cases).
+ */
+static bool
+hidrd_usbmon_pcapng_next(hidrd_usbmon_scan *scan, uint32_t *plink,
+                         const uint8_t **pp, size_t *plen)
+{
+    const uint8_t  *block;
+    uint32_t        type;
+    uint32_t        bom;
+    uint32_t        block_len;
+    const uint8_t  *body;
+    size_t          body_len;
+    uint32_t        if_idx;
+    size_t          len;
+    uint16_t       *if_list;
+
+    while (scan->pos < scan->size)
+    {
+        block = scan->ptr + scan->pos;
+        if (scan->size - scan->pos < 12)
+            goto invalid;
+
+        memcpy(&type, block, sizeof(type));
+        if (type == HIDRD_USBMON_PCAPNG_SHB)
+        {
+            /* Each section has its own byte order and interfaces */
+            memcpy(&bom, block + 8, sizeof(bom));
+            if (bom == HIDRD_USBMON_PCAPNG_BOM)
+                scan->swap = false;
+            else if (bom == bswap_32(HIDRD_USBMON_PCAPNG_BOM))
+                scan->swap = true;
+            else
+                goto invalid;
+            scan->if_num = 0;
+        }
+        else if (scan->swap)
+            type = bswap_32(type);
+
+        block_len = hidrd_usbmon_get32(scan, block + 4);
+        if (block_len < 12 || (block_len & 3) != 0 ||
+            block_len > scan->size - scan->pos)
+            goto invalid;
+        scan->pos += block_len;
+        body = block + 8;
+        body_len = block_len - 12;
+
+        switch (type)
+        {
+            case HIDRD_USBMON_PCAPNG_IDB:
+                if (body_len < 8)
+                    goto invalid;
+                if ((scan->if_num & (scan->if_num - 1)) == 0)
+                {
+                    if_list = realloc(scan->if_list,
+                                      sizeof(*if_list) *
+                                      (scan->if_num == 0
+                                        ? 1 : scan->if_num * 2));
+                    if (if_list == NULL)
+                    {
+                        scan->err = ENOMEM;
+                        return false;
+                    }
+                    scan->if_list = if_list;
+                }
+                scan->if_list[scan->if_num++] =
+                    hidrd_usbmon_get16(scan, body);
+                break;
+            case HIDRD_USBMON_PCAPNG_EPB:
+                if (body_len < 20)
+                    goto invalid;
+                if_idx = hidrd_usbmon_get32(scan, body);
+                len = hidrd_usbmon_get32(scan, body + 12);
+                if (if_idx >= scan->if_num || len > body_len - 20)
+                    goto invalid;
+                *plink = scan->if_list[if_idx];
+                *pp = body + 20;
+                *plen = len;
+                return true;
+            case HIDRD_USBMON_PCAPNG_SPB:
+                if (body_len < 4 || scan->if_num == 0)
+                    goto invalid;
+                len = hidrd_usbmon_get32(scan, body);
+                *plink = scan->if_list[0];
+                *pp = body + 4;
+                *plen = (len < body_len - 4) ? len : body_len - 4;
+                return true;
+        }
+    }
+
+    return false;
+
+invalid:
+
+    scan->err = EINVAL;
+    return false;
+}
+
+
+/**
+ * Release the memory of the mapped capture pages scanned, if enough of
+ * them accumulated; the pages are read again if accessed.
+ *
+ * @param scan  Scanner to release the memory of.
+ */
+static void
+hidrd_usbmon_scan_drop(hidrd_usbmon_scan *scan)
+{
+    size_t  end;
+
+    if (scan->map == NULL ||
+        scan->pos - scan->drop_pos < HIDRD_USBMON_DROP_SIZE)
+        return;
+
+    end = scan->pos & ~((size_t)sysconf(_SC_PAGESIZE) - 1);
+    madvise((uint8_t *)scan->map + scan->drop_pos,
+            end - scan->drop_pos, MADV_DONTNEED);
+    scan->drop_pos = end;
+}
+
+
+bool
+hidrd_usbmon_scan_next(hidrd_usbmon_scan *scan)
+{
+    const char     *line;
+    const char     *end;
+    uint8_t         setup[8];
+    uint32_t        link;
+    const uint8_t  *p;
+    size_t          len;
+    hidrd_usbmon_ev ev;
+
+    assert(hidrd_usbmon_scan_valid(scan));
+
+    scan->desc = NULL;
+    scan->desc_size = 0;
+    if (scan->err != 0)
+        return false;
+
+    while (scan->pos < scan->size)
+    {
+        hidrd_usbmon_scan_drop(scan);
+
+        switch (scan->fmt)
+        {
+            case HIDRD_USBMON_FMT_TEXT:
+                line = (const char *)scan->ptr + scan->pos;
+                end = memchr(line, '\n', scan->size - scan->pos);
+                if (end == NULL)
+                    end = (const char *)scan->ptr + scan->size;
+                scan->pos = (const uint8_t *)end - scan->ptr;
+                if (scan->pos < scan->size)
+                    scan->pos++;
+                if (!hidrd_usbmon_text_ev(line, end, &ev, setup))
+                    continue;
+                break;
+            case HIDRD_USBMON_FMT_PCAP:
+                if (scan->size - scan->pos < HIDRD_USBMON_PCAP_REC_SIZE)
+                    goto invalid;
+                p = scan->ptr + scan->pos;
+                len = hidrd_usbmon_get32(scan, p + 8);
+                if (len > scan->size - scan->pos -
+                          HIDRD_USBMON_PCAP_REC_SIZE)
+                    goto invalid;
+                scan->pos += HIDRD_USBMON_PCAP_REC_SIZE + len;
+                if (!hidrd_usbmon_bin_ev(scan, scan->link,
+                                         p + HIDRD_USBMON_PCAP_REC_SIZE,
+                                         len, &ev))
+                    continue;
+                break;
+            case HIDRD_USBMON_FMT_PCAPNG:
+                if (!hidrd_usbmon_pcapng_next(scan, &link, &p, &len))
+                    return false;
+                if (!hidrd_usbmon_bin_ev(scan, link, p, len, &ev))
+                    continue;
+                break;
+        }
+
+        if (hidrd_usbmon_scan_ev(scan, &ev))
+            return true;
+        if (scan->err != 0)
+            return false;
+    }
+
+    return false;
+
+invalid:
+
+    scan->err = EINVAL;
+    return false;
+}
+
+
+void
+hidrd_usbmon_scan_close(hidrd_usbmon_scan *scan)
+{
+    assert(hidrd_usbmon_scan_valid(scan));
+
+    if (scan->map != NULL)
+        munmap(scan->map, scan->map_size);
+    scan->map = NULL;
+    scan->map_size = 0;
+    scan->ptr = NULL;
+    scan->size = 0;
+    scan->pos = 0;
+    scan->drop_pos = 0;
+
+    free(scan->if_list);
+    scan->if_list = NULL;
+    scan->if_num = 0;
+    free(scan->dev_list);
+    scan->dev_list = NULL;
+    scan->dev_num = 0;
+
+    hidrd_buf_clnp(&scan->buf);
+    scan->desc = NULL;
+    scan->desc_size = 0;
+}
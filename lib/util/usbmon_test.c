@@ -0,0 +1,373 @@
+/** @file
+ * @brief HID report descriptor - utilities - usbmon capture scanning test
+ *
+ * Copyright (C) 2010 Nikolai Kondrashov
+ *
+ * This file is part of hidrd.
+ *
+ * Hidrd is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * Hidrd is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with hidrd; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * @author Nikolai Kondrashov <spbnick@gmail.com>
+ */
+
+#include <byteswap.h>
+#include <errno.h>
+#include <error.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hidrd/util/fd.h"
+#include "hidrd/util/usbmon.h"
+
+#define ERROR(_fmt, _args...) \
+    error_at_line(1, 0, __FILE__, __LINE__, _fmt, ##_args)
+
+/**
+ * Text capture: device 1:5 enumeration, with a report descriptor too
+ * long for the text interface, a stalled request, an unrelated transfer,
+ * a failed submission, and a report descriptor request to device 7,
+ * captured in the old "t" format, without the bus number.
+ */
+static const char text[] =
+    "ffff8800b1d4c000 1000 S Ci:1:005:0 s 80 06 0100 0000 0012 18 <\n"
+    "ffff8800b1d4c000 1001 C Ci:1:005:0 0 18 = 12010002 00000040 "
+        "6d0412b0 01010102 0001\n"
+    "this line is not a usbmon event\n"
+    "ffff8800b1d4c000 1002 S Ci:1:005:0 s 81 06 2200 0001 0041 65 <\n"
+    "ffff8800b1d4c000 1003 C Ci:1:005:0 0 65 = 05010902 a1010901 "
+        "a1000509 19012903 15002501 95037501\n"
+    "ffff8800b1d4cc00 1004 S Co:1:005:0 s 21 0a 0000 0000 0000 0\n"
+    "ffff8800b1d4cc00 1005 C Co:1:005:0 0 0\n"
+    "ffff8800b1d4c000 1006 S Ci:1:005:0 s 81 06 2200 0002 0040 64 <\n"
+    "ffff8800b1d4c000 1007 C Ci:1:005:0 -32 0\n"
+    "ffff8800b1d4c600 1008 S Ci:1:005:0 s 81 06 2200 0000 0049 73 <\n"
+    "ffff8800b1d4c600 1009 E Ci:1:005:0 -19\n"
+    "ffff8800b1d4c000 1010 S Ci:1:005:0 s 81 06 2200 0000 0009 9 <\n"
+    "ffff8800b1d4c000 1011 C Ci:1:005:0 0 9 = 05010906 a1010507 c0\n"
+    "ffff8800b1d4c300 1012 S Ci:007:00 s 81 06 2200 0003 0003 3 <\n"
+    "ffff8800b1d4c300 1013 C Ci:007:00 0 3 = 0501c0";
+
+/** Device descriptor of device 1:5 */
+static const uint8_t dev_desc[] = {
+    0x12, 0x01, 0x00, 0x02, 0x00, 0x00, 0x00, 0x40,
+    0x6D, 0x04, 0x12, 0xB0, 0x01, 0x01, 0x01, 0x02,
+    0x00, 0x01
+};
+
+/** Report descriptors */
+static const uint8_t desc1[] = {
+    0x05, 0x01, 0x09, 0x06, 0xA1, 0x01, 0x05, 0x07, 0xC0
+};
+static const uint8_t desc2[] = {0x05, 0x01, 0xC0};
+
+/** Expected scanning results */
+static const struct {
+    const uint8_t  *desc;
+    size_t          size;
+    uint16_t        bus;
+    uint8_t         dev;
+    uint16_t        iface;
+    uint16_t        vid;
+    uint16_t        pid;
+} text_scan_list[] = {
+    {desc1, sizeof(desc1), 1, 5, 0, 0x046D, 0xB012},
+    {desc2, sizeof(desc2), 0, 7, 3, 0,      0},
+    {NULL, 0, 0, 0, 0, 0, 0}
+};
+
+static bool     swap;
+
+static void
+put(hidrd_buf *buf, const void *ptr, size_t size)
+{
+    if (!hidrd_buf_add_ptr(buf, ptr, size))
+        ERROR("Failed to grow buffer");
+}
+
+static void
+put8(hidrd_buf *buf, uint8_t val)
+{
+    put(buf, &val, sizeof(val));
+}
+
+static void
+put16(hidrd_buf *buf, uint16_t val)
+{
+    val = swap ? bswap_16(val) : val;
+    put(buf, &val, sizeof(val));
+}
+
+static void
+put32(hidrd_buf *buf, uint32_t val)
+{
+    val = swap ? bswap_32(val) : val;
+    put(buf, &val, sizeof(val));
+}
+
+static void
+put64(hidrd_buf *buf, uint64_t val)
+{
+    val = swap ? bswap_64(val) : val;
+    put(buf, &val, sizeof(val));
+}
+
+/**
+ * Output a Linux USB control IN packet.
+ */
+static void
+put_pkt(hidrd_buf *buf, size_t hdr_size, uint64_t id, char type,
+        const uint8_t *setup, const uint8_t *data, size_t size)
+{
+    put64(buf, id);
+    put8(buf, type);
+    put8(buf, 2);                       /* Control transfer */
+    put8(buf, 0x80);                    /* Endpoint 0 IN */
+    put8(buf, 5);                       /* Device address */
+    put16(buf, 1);                      /* Bus number */
+    put8(buf, setup != NULL ? 0 : '-');
+    put8(buf, data != NULL ? 0 : '<');
+    put64(buf, 0);                      /* Timestamp */
+    put32(buf, 0);
+    put32(buf, 0);                      /* Status */
+    put32(buf, size);
+    put32(buf, data != NULL ? size : 0);
+    if (setup != NULL)
+        put(buf, setup, 8);
+    else
+        put64(buf, 0);
+    if (hdr_size > 48)
+    {
+        put64(buf, 0);
+        put64(buf, 0);
+    }
+    if (data != NULL)
+        put(buf, data, size);
+}
+
+/** Setup packets of the device and report descriptor requests */
+static const uint8_t dev_setup[8] = {0x80, 0x06, 0x00, 0x01,
+                                     0x00, 0x00, 0x12, 0x00};
+static const uint8_t report_setup[8] = {0x81, 0x06, 0x00, 0x22,
+                                        0x01, 0x00, 0x09, 0x00};
+
+/**
+ * Output the packets of device 1:5 enumeration: a device descriptor and
+ * a report descriptor of interface 1 requests.
+ */
+static void
+put_pkt_list(hidrd_buf *buf, size_t hdr_size,
+             void (*put_rec)(hidrd_buf *buf, const hidrd_buf *pkt))
+{
+    hidrd_buf   pkt = HIDRD_BUF_EMPTY;
+
+    put_pkt(&pkt, hdr_size, 1, 'S', dev_setup, NULL, sizeof(dev_desc));
+    put_rec(buf, &pkt);
+    hidrd_buf_reset(&pkt);
+    put_pkt(&pkt, hdr_size, 1, 'C', NULL, dev_desc, sizeof(dev_desc));
+    put_rec(buf, &pkt);
+    hidrd_buf_reset(&pkt);
+    put_pkt(&pkt, hdr_size, 2, 'S', report_setup, NULL, sizeof(desc1));
+    put_rec(buf, &pkt);
+    hidrd_buf_reset(&pkt);
+    put_pkt(&pkt, hdr_size, 2, 'C', NULL, desc1, sizeof(desc1));
+    put_rec(buf, &pkt);
+    hidrd_buf_clnp(&pkt);
+}
+
+static void
+put_pcap_rec(hidrd_buf *buf, const hidrd_buf *pkt)
+{
+    put32(buf, 0);
+    put32(buf, 0);
+    put32(buf, pkt->len);
+    put32(buf, pkt->len);
+    put(buf, pkt->ptr, pkt->len);
+}
+
+static void
+put_pcap(hidrd_buf *buf, size_t hdr_size)
+{
+    put32(buf, 0xA1B2C3D4);
+    put16(buf, 2);
+    put16(buf, 4);
+    put32(buf, 0);
+    put32(buf, 0);
+    put32(buf, 65535);
+    put32(buf, hdr_size > 48 ? 220 : 189);
+    put_pkt_list(buf, hdr_size, put_pcap_rec);
+}
+
+static void
+put_pcapng_epb(hidrd_buf *buf, const hidrd_buf *pkt)
+{
+    size_t  pad = (4 - pkt->len % 4) % 4;
+
+    put32(buf, 6);
+    put32(buf, 32 + pkt->len + pad);
+    put32(buf, 0);
+    put32(buf, 0);
+    put32(buf, 0);
+    put32(buf, pkt->len);
+    put32(buf, pkt->len);
+    put(buf, pkt->ptr, pkt->len);
+    put32(buf, 0);
+    buf->len -= 4 - pad;
+    put32(buf, 32 + pkt->len + pad);
+}
+
+static void
+put_pcapng(hidrd_buf *buf, size_t hdr_size)
+{
+    /* Section header block */
+    put32(buf, 0x0A0D0D0A);
+    put32(buf, 28);
+    put32(buf, 0x1A2B3C4D);
+    put16(buf, 1);
+    put16(buf, 0);
+    put64(buf, UINT64_MAX);
+    put32(buf, 28);
+    /* Interface description block */
+    put32(buf, 1);
+    put32(buf, 20);
+    put16(buf, hdr_size > 48 ? 220 : 189);
+    put16(buf, 0);
+    put32(buf, 0);
+    put32(buf, 20);
+    put_pkt_list(buf, hdr_size, put_pcapng_epb);
+}
+
+/**
+ * Check a binary capture yields the report descriptor of interface 1 of
+ * device 1:5, from the capture memory.
+ */
+static void
+check_bin(const char *name, const hidrd_buf *buf)
+{
+    hidrd_usbmon_scan   scan;
+
+    if (!hidrd_usbmon_scan_init(&scan, buf->ptr, buf->len))
+        ERROR("Failed to initialize %s scanner: %s",
+              name, strerror(errno));
+    if (!hidrd_usbmon_scan_next(&scan))
+        ERROR("Failed to scan %s: %s", name, strerror(scan.err));
+    if (scan.desc_size != sizeof(desc1) ||
+        memcmp(scan.desc, desc1, sizeof(desc1)) != 0 ||
+        (const uint8_t *)scan.desc < (const uint8_t *)buf->ptr ||
+        (const uint8_t *)scan.desc >= (const uint8_t *)buf->ptr + buf->len)
+        ERROR("Unexpected descriptor scanned from %s", name);
+    if (scan.bus != 1 || scan.dev != 5 || scan.iface != 1 ||
+        scan.vid != 0x046D || scan.pid != 0xB012)
+        ERROR("Unexpected descriptor location scanned from %s", name);
+    if (hidrd_usbmon_scan_next(&scan) || scan.err != 0)
+        ERROR("Scanning %s didn't end cleanly", name);
+    hidrd_usbmon_scan_close(&scan);
+
+    /* Cut the last packet short */
+    if (!hidrd_usbmon_scan_init(&scan, buf->ptr, buf->len - 1))
+        ERROR("Failed to initialize %s scanner: %s",
+              name, strerror(errno));
+    if (hidrd_usbmon_scan_next(&scan) || scan.err != EINVAL)
+        ERROR("Truncated %s was not detected", name);
+    hidrd_usbmon_scan_close(&scan);
+}
+
+int
+main(void)
+{
+    char                path[] = "/tmp/hidrd_usbmon_test.XXXXXX";
+    int                 fd;
+    hidrd_usbmon_scan   scan;
+    hidrd_buf           buf     = HIDRD_BUF_EMPTY;
+    size_t              i;
+
+    /*
+     * Scan the text capture from a file
+     */
+    fd = mkstemp(path);
+    if (fd < 0)
+        error(1, errno, "Failed to create capture file");
+    if (write(fd, text, sizeof(text) - 1) != sizeof(text) - 1)
+        error(1, errno, "Failed to write capture file");
+    close(fd);
+
+    if (!hidrd_usbmon_scan_open(&scan, path))
+        error(1, errno, "Failed to open scanner");
+    if (scan.fmt != HIDRD_USBMON_FMT_TEXT)
+        ERROR("Text capture format not detected");
+    for (i = 0; text_scan_list[i].desc != NULL; i++)
+    {
+        if (!hidrd_usbmon_scan_next(&scan))
+            ERROR("Failed to scan descriptor #%zu: %s", i + 1,
+                  strerror(scan.err));
+        if (scan.desc_size != text_scan_list[i].size ||
+            memcmp(scan.desc, text_scan_list[i].desc, scan.desc_size) != 0)
+            ERROR("Unexpected descriptor #%zu scanned", i + 1);
+        if (scan.bus != text_scan_list[i].bus ||
+            scan.dev != text_scan_list[i].dev ||
+            scan.iface != text_scan_list[i].iface ||
+            scan.vid != text_scan_list[i].vid ||
+            scan.pid != text_scan_list[i].pid)
+            ERROR("Unexpected descriptor #%zu location scanned", i + 1);
+    }
+    if (hidrd_usbmon_scan_next(&scan) || scan.err != 0)
+        ERROR("Scanning didn't end cleanly");
+    if (scan.trunc_num != 1)
+        ERROR("Unexpected number of truncated descriptors: %zu",
+              scan.trunc_num);
+    hidrd_usbmon_scan_close(&scan);
+
+    unlink(path);
+    if (hidrd_usbmon_scan_open(&scan, path) || errno != ENOENT)
+        ERROR("Opened a scanner for a nonexistent capture");
+
+    /*
+     * Scan binary captures in both byte orders, with both header sizes
+     */
+    for (swap = false; ; swap = true)
+    {
+        hidrd_buf_reset(&buf);
+        put_pcap(&buf, 48);
+        check_bin("pcap", &buf);
+        hidrd_buf_reset(&buf);
+        put_pcap(&buf, 64);
+        check_bin("mmapped pcap", &buf);
+        hidrd_buf_reset(&buf);
+        put_pcapng(&buf, 48);
+        check_bin("pcapng", &buf);
+        hidrd_buf_reset(&buf);
+        put_pcapng(&buf, 64);
+        check_bin("mmapped pcapng", &buf);
+        if (swap)
+            break;
+    }
+
+    /* Other link types are not accepted */
+    hidrd_buf_reset(&buf);
+    swap = false;
+    put32(&buf, 0xA1B2C3D4);
+    put16(&buf, 2);
+    put16(&buf, 4);
+    put32(&buf, 0);
+    put32(&buf, 0);
+    put32(&buf, 65535);
+    put32(&buf, 1);
+    if (hidrd_usbmon_scan_init(&scan, buf.ptr, buf.len) || errno != EINVAL)
+        ERROR("Non-USB pcap capture was accepted");
+
+    hidrd_buf_clnp(&buf);
+
+    return 0;
+}
@@ -33,7 +33,10 @@
 #include <getopt.h>
 #include "hidrd/util/str.h"
 #include "hidrd/util/fd.h"
+#include "hidrd/util/sysfs.h"
+#include "hidrd/util/usbmon.h"
 #include "hidrd/fmt.h"
+#include "hidrd/layout.h"
 
 
 static bool
@@ -138,9 +141,25 @@ usage(FILE *stream, const char *progname)
     if (fprintf(
             stream, 
             "Usage: %s [OPTION]... [INPUT [OUTPUT]]\n"
+            "  or:  %s -b ARCHIVE [OPTION]... [INPUT]...\n"
+            "  or:  %s -x ARCHIVE [OPTION]... [ENTRY [OUTPUT]]\n"
+            "  or:  %s -s[ROOT] [OPTION]... OUTPUT_DIR\n"
+            "  or:  %s -s[ROOT] -b ARCHIVE [OPTION]...\n"
+            "  or:  %s -u [OPTION]... CAPTURE... OUTPUT_DIR\n"
+            "  or:  %s -u -b ARCHIVE [OPTION]... CAPTURE...\n"
             "Convert a HID report descriptor.\n"
             "With no INPUT, or when INPUT is -, read standard input.\n"
             "With no OUTPUT, or when OUTPUT is -, write standard output.\n"
+            "With -b, add INPUTs to a native descriptor ARCHIVE, named\n"
+            "after their paths, creating it if it doesn't exist.\n"
+            "With -x, convert ENTRY of a native descriptor ARCHIVE,\n"
+            "or list the ARCHIVE entries if ENTRY is not specified.\n"
+            "With -s, convert the report descriptors of all the devices\n"
+            "found in sysfs under ROOT (" HIDRD_SYSFS_ROOT " by default)\n"
+            "to OUTPUT_DIR/NAME.FORMAT files, or add them to ARCHIVE.\n"
+            "With -u, do the same for the report descriptors found in\n"
+            "usbmon text, pcap or pcapng CAPTUREs, naming them after\n"
+            "CAPTURE, bus, device and interface.\n"
             "\n"
             "Options:\n"
             "  -h, --help                       this help message\n"
@@ -152,10 +171,19 @@ usage(FILE *stream, const char *progname)
             "  -o, --output-format=FORMAT       use FORMAT for output\n"
             "  --oo=LIST, --output-options=LIST "
                                         "use LIST output format options\n"
+            "  -c, --cache=FILE                 add the input layout to\n"
+            "                                   layout cache FILE\n"
+            "  -b, --build=ARCHIVE              add INPUTs to ARCHIVE\n"
+            "  -x, --extract=ARCHIVE            extract ENTRY of ARCHIVE\n"
+            "  -s[ROOT], --sysfs[=ROOT]         read the descriptors of\n"
+            "                                   all devices under ROOT\n"
+            "  -u, --usbmon                     read the descriptors\n"
+            "                                   found in CAPTUREs\n"
             "\n"
             "Formats:\n"
             "\n",
-            progname) < 0)
+            progname, progname, progname, progname, progname,
+            progname, progname) < 0)
         return false;
 
     for (max_len = 0, pfmt = hidrd_fmt_list; *pfmt != NULL; pfmt++)
@@ -183,99 +211,678 @@ usage(FILE *stream, const char *progname)
 }
 
 
-static int
-process(const char *input_name,
-        const char *input_fmt_name,
-        const char *input_options,
-
-        const char *output_name,
-        const char *output_fmt_name,
-        const char *output_options)
+/**
+ * Add a descriptor layout to a layout cache file, creating it if it
+ * doesn't exist.
+ *
+ * @param cache_name    Cache file name.
+ * @param desc          Native descriptor.
+ * @param size          Native descriptor size.
+ * @param layout        Descriptor layout.
+ *
+ * @return True if added successfully, false otherwise.
+ */
+static bool
+cache_add(const char           *cache_name,
+          const void           *desc,
+          size_t                size,
+          const hidrd_layout   *layout)
 {
-    int                 result          = 1;
+    bool                    result  = false;
+    hidrd_layout_cache_bld  bld;
+    hidrd_layout_cache      cache   = HIDRD_LAYOUT_CACHE_EMPTY;
 
-    int                 input_fd        = -1;
-    void               *input_buf       = NULL;
-    size_t              input_size      = 0;
-    const hidrd_fmt    *input_fmt       = NULL;
-    hidrd_src          *input           = NULL;
+    hidrd_layout_cache_bld_init(&bld);
 
-    int                 output_fd       = -1;
-    void               *output_buf      = NULL;
-    size_t              output_size     = 0;
-    const hidrd_fmt    *output_fmt      = NULL;
-    hidrd_snk          *output          = NULL;
+    if (hidrd_layout_cache_load(&cache, cache_name))
+    {
+        if (!hidrd_layout_cache_bld_add_cache(&bld, &cache))
+        {
+            fprintf(stderr, "Failed to read layout cache: %s\n",
+                    strerror(errno));
+            goto cleanup;
+        }
+    }
+    else if (errno != ENOENT)
+    {
+        fprintf(stderr, "Failed to load layout cache: %s\n",
+                errno == EINVAL ? "invalid cache file" : strerror(errno));
+        goto cleanup;
+    }
 
-    const hidrd_item   *item;
+    if (!hidrd_layout_cache_bld_add(&bld, desc, size, layout))
+    {
+        fprintf(stderr, "Failed to add layout to cache: %s\n",
+                strerror(errno));
+        goto cleanup;
+    }
 
-    char               *err             = NULL;
-    size_t              pos;
-    char               *posstr          = NULL;
+    if (!hidrd_layout_cache_store(&bld, cache_name))
+    {
+        fprintf(stderr, "Failed to store layout cache: %s\n",
+                strerror(errno));
+        goto cleanup;
+    }
 
-    assert(input_name != NULL);
-    assert(*input_name != '\0');
-    assert(input_fmt_name != NULL);
-    assert(*input_fmt_name != '\0');
-    assert(input_options != NULL);
+    result = true;
 
-    assert(output_name != NULL);
-    assert(*output_name != '\0');
-    assert(output_fmt_name != NULL);
-    assert(*output_fmt_name != '\0');
-    assert(output_options != NULL);
+cleanup:
 
-    /*
-     * Lookup and initialize input and output formats
-     */
-    input_fmt = hidrd_fmt_list_lkp(input_fmt_name);
-    if (input_fmt == NULL)
+    if (cache.hdr != NULL)
+        hidrd_layout_cache_unload(&cache);
+    hidrd_layout_cache_bld_clnp(&bld);
+
+    return result;
+}
+
+
+/**
+ * Lookup and initialize a format for input or output.
+ *
+ * @param name  Format name.
+ * @param input True if the format is for input, false if for output.
+ *
+ * @return Initialized format, or NULL if not found, not supported in the
+ *         direction, or failed to initialize; an error message is output
+ *         in this case.
+ */
+static const hidrd_fmt *
+fmt_open(const char *name, bool input)
+{
+    const hidrd_fmt    *fmt;
+
+    fmt = hidrd_fmt_list_lkp(name);
+    if (fmt == NULL)
     {
-        fprintf(stderr, "Unknown input format \"%s\".\n\n",
-                input_fmt_name);
+        fprintf(stderr, "Unknown %s format \"%s\".\n\n",
+                (input ? "input" : "output"), name);
         usage_formats(stderr, program_invocation_short_name);
-        goto cleanup;
+        return NULL;
     }
-    if (!hidrd_fmt_readable(input_fmt))
+    if (input && !hidrd_fmt_readable(fmt))
     {
         fprintf(stderr, "Reading of %s format is not supported.\n\n",
-                input_fmt->desc);
+                fmt->desc);
         usage_formats(stderr, program_invocation_short_name);
-        goto cleanup;
+        return NULL;
+    }
+    if (!input && !hidrd_fmt_writable(fmt))
+    {
+        fprintf(stderr, "Writing to %s format is not supported.\n\n",
+                fmt->desc);
+        usage_formats(stderr, program_invocation_short_name);
+        return NULL;
     }
-    if (!hidrd_fmt_init(input_fmt))
+    if (!hidrd_fmt_init(fmt))
     {
         fprintf(stderr, "Failed to initialize %s format library\n",
-                input_fmt->desc);
+                fmt->desc);
+        return NULL;
+    }
+
+    return fmt;
+}
+
+
+/**
+ * Compile format options once, for creating any number of input or
+ * output stream instances.
+ *
+ * @param fmt       Initialized format.
+ * @param input     True if the options are for input, false if for
+ *                  output.
+ * @param options   Format options.
+ *
+ * @return Dynamically allocated option list, or NULL if failed to parse
+ *         the options or allocate memory; an error message is output in
+ *         this case.
+ */
+static hidrd_opt *
+opts_compile(const hidrd_fmt *fmt, bool input, const char *options)
+{
+    static const hidrd_opt_spec empty_spec_list[] = {{.name = NULL}};
+
+    const hidrd_opt_spec   *spec_list;
+    hidrd_opt              *opt_list;
+
+    spec_list = input ? fmt->src->opts_spec : fmt->snk->opts_spec;
+    opt_list = hidrd_opt_list_compile(
+                    spec_list != NULL ? spec_list : empty_spec_list,
+                    options);
+    if (opt_list == NULL)
+        fprintf(stderr,
+                "Failed to open %s stream:\n"
+                "failed to parse options string\n",
+                (input ? "input" : "output"));
+
+    return opt_list;
+}
+
+
+/**
+ * Read a descriptor from a file into a native descriptor buffer.
+ *
+ * @param input_name    Input file name, or "-" for standard input.
+ * @param input_fmt     Input format.
+ * @param input_opts    Input format options, compiled with opts_compile.
+ * @param desc          Buffer to append the native descriptor to.
+ *
+ * @return True if read successfully, false otherwise.
+ */
+static bool
+read_desc(const char       *input_name,
+          const hidrd_fmt  *input_fmt,
+          const hidrd_opt  *input_opts,
+          hidrd_buf        *desc)
+{
+    bool                result      = false;
+    int                 input_fd    = -1;
+    void               *input_buf   = NULL;
+    size_t              input_size  = 0;
+    hidrd_src          *input       = NULL;
+    const hidrd_item   *item;
+    char               *err         = NULL;
+    size_t              pos;
+    char               *posstr      = NULL;
+
+    if (input_name[0] == '-' && input_name[1] == '\0')
+        input_fd = STDIN_FILENO;
+    else
+    {
+        input_fd = open(input_name, O_RDONLY);
+        if (input_fd < 0)
+        {
+            fprintf(stderr, "%s: Failed to open input: %s\n",
+                    input_name, strerror(errno));
+            goto cleanup;
+        }
+    }
+
+    if (!hidrd_fd_read_whole(input_fd, &input_buf, &input_size))
+    {
+        fprintf(stderr, "%s: Failed to read input: %s\n",
+                input_name, strerror(errno));
         goto cleanup;
     }
 
+    input = hidrd_src_new_opt_list(input_fmt->src, &err,
+                                   input_buf, input_size, input_opts);
+    if (input == NULL)
+    {
+        fprintf(stderr, "%s: Failed to open input stream:\n%s\n",
+                input_name, err);
+        goto cleanup;
+    }
+    free(err);
+    err = NULL;
 
-    output_fmt = hidrd_fmt_list_lkp(output_fmt_name);
-    if (output_fmt == NULL)
+    while (pos = hidrd_src_getpos(input),
+           ((item = hidrd_src_get(input)) != NULL))
+        if (!hidrd_buf_add_ptr(desc, item, hidrd_item_get_size(item)))
+        {
+            fprintf(stderr, "%s: Failed to store input item\n",
+                    input_name);
+            goto cleanup;
+        }
+
+    if (hidrd_src_error(input))
     {
-        fprintf(stderr, "Unknown output format \"%s\".\n\n",
-                output_fmt_name);
-        usage_formats(stderr, program_invocation_short_name);
+        fprintf(stderr, "%s: Failed to read input item at %s:\n%s\n",
+                input_name,
+                (posstr = hidrd_src_fmtpos(input, pos)),
+                (err = hidrd_src_errmsg(input)));
         goto cleanup;
     }
-    if (!hidrd_fmt_writable(output_fmt))
+
+    result = true;
+
+cleanup:
+
+    free(posstr);
+    free(err);
+    hidrd_src_delete(input);
+    free(input_buf);
+    if (input_fd >= 0 && input_fd != STDIN_FILENO)
+        close(input_fd);
+
+    return result;
+}
+
+
+/**
+ * Extract device vendor and product IDs from a descriptor file path, if
+ * it has a component named after a HID device, as in sysfs, e.g.
+ * "/sys/bus/hid/devices/0003:256C:006E.0001/report_descriptor".
+ *
+ * @param name  Descriptor file path.
+ * @param pvid  Location for the vendor ID, zero if not found.
+ * @param ppid  Location for the product ID, zero if not found.
+ */
+static void
+archive_name_id(const char *name, uint16_t *pvid, uint16_t *ppid)
+{
+    const char *p;
+    const char *end;
+    char        comp[32];
+
+    *pvid = 0;
+    *ppid = 0;
+
+    for (p = name; *p != '\0'; p = (*end == '\0' ? end : end + 1))
     {
-        fprintf(stderr, "Writing to %s format is not supported.\n\n",
-                output_fmt->desc);
-        usage_formats(stderr, program_invocation_short_name);
+        end = strchrnul(p, '/');
+        if ((size_t)(end - p) < sizeof(comp))
+        {
+            memcpy(comp, p, end - p);
+            comp[end - p] = '\0';
+            if (hidrd_sysfs_dev_id(comp, pvid, ppid))
+                return;
+        }
+    }
+}
+
+
+/** Descriptor collection type */
+typedef enum coll_type {
+    COLL_TYPE_SYSFS,    /**< sysfs tree */
+    COLL_TYPE_USBMON,   /**< usbmon captures */
+} coll_type;
+
+/** Descriptor collection scanner */
+typedef struct coll {
+    coll_type           type;       /**< Collection type */
+    const char * const *list;       /**< sysfs root or capture path list */
+    size_t              num;        /**< Number of paths in the list */
+    size_t              idx;        /**< Index of the next path to open */
+    bool                open;       /**< True if a scanner is open */
+    hidrd_sysfs_scan    sysfs;      /**< sysfs tree scanner */
+    hidrd_usbmon_scan   usbmon;     /**< usbmon capture scanner */
+    hidrd_buf           name;       /**< Last descriptor name */
+    hidrd_buf           base;       /**< Last descriptor output file
+                                         base name */
+    const void         *desc;       /**< Last descriptor */
+    size_t              size;       /**< Last descriptor size */
+    uint16_t            vid;        /**< Last descriptor vendor ID */
+    uint16_t            pid;        /**< Last descriptor product ID */
+} coll;
+
+/**
+ * Initialize a descriptor collection scanner.
+ *
+ * @param c     Collection scanner to initialize.
+ * @param type  Collection type.
+ * @param list  sysfs root or capture path list.
+ * @param num   Number of paths in the list.
+ */
+static void
+coll_init(coll *c, coll_type type, const char * const *list, size_t num)
+{
+    memset(c, 0, sizeof(*c));
+    c->type = type;
+    c->list = list;
+    c->num = num;
+    hidrd_buf_init(&c->name);
+    hidrd_buf_init(&c->base);
+}
+
+
+/**
+ * Close the scanner of the current collection path, if open, reporting
+ * the report descriptors skipped in a usbmon capture.
+ *
+ * @param c     Collection scanner to close the current path scanner of.
+ */
+static void
+coll_path_close(coll *c)
+{
+    if (!c->open)
+        return;
+
+    if (c->type == COLL_TYPE_SYSFS)
+        hidrd_sysfs_scan_close(&c->sysfs);
+    else
+    {
+        if (c->usbmon.trunc_num > 0)
+            fprintf(stderr, "%s: Skipped %zu incompletely captured "
+                            "report descriptor(s)\n",
+                    c->list[c->idx - 1], c->usbmon.trunc_num);
+        hidrd_usbmon_scan_close(&c->usbmon);
+    }
+    c->open = false;
+}
+
+
+/**
+ * Cleanup a descriptor collection scanner.
+ *
+ * @param c     Collection scanner to cleanup.
+ */
+static void
+coll_clnp(coll *c)
+{
+    coll_path_close(c);
+    hidrd_buf_clnp(&c->name);
+    hidrd_buf_clnp(&c->base);
+}
+
+
+/**
+ * Scan the next descriptor of a collection, reporting and skipping the
+ * paths and descriptors which fail to be read.
+ *
+ * @param c         Collection scanner to scan with.
+ * @param pfailed   Location of the flag to set if anything failed.
+ *
+ * @return True if the next descriptor was scanned, false if there are no
+ *         more descriptors.
+ */
+static bool
+coll_next(coll *c, bool *pfailed)
+{
+    const char *path;
+    const char *base;
+
+    while (true)
+    {
+        if (!c->open)
+        {
+            if (c->idx >= c->num)
+                return false;
+            path = c->list[c->idx++];
+            if (c->type == COLL_TYPE_SYSFS
+                    ? !hidrd_sysfs_scan_open(&c->sysfs, path)
+                    : !hidrd_usbmon_scan_open(&c->usbmon, path))
+            {
+                fprintf(stderr, "Failed to scan %s: %s\n", path,
+                        errno == EINVAL ? "not a usbmon capture"
+                                        : strerror(errno));
+                *pfailed = true;
+                continue;
+            }
+            c->open = true;
+        }
+
+        path = c->list[c->idx - 1];
+        hidrd_buf_reset(&c->name);
+        hidrd_buf_reset(&c->base);
+
+        if (c->type == COLL_TYPE_SYSFS)
+        {
+            if (!hidrd_sysfs_scan_next(&c->sysfs))
+            {
+                if (c->sysfs.err == 0)
+                {
+                    coll_path_close(c);
+                    continue;
+                }
+                fprintf(stderr, "%s: Failed to read descriptor: %s\n",
+                        (const char *)c->sysfs.path.ptr,
+                        strerror(c->sysfs.err));
+                *pfailed = true;
+                continue;
+            }
+            if (!hidrd_buf_add_printf(&c->name, "%s",
+                                      (const char *)c->sysfs.path.ptr) ||
+                !hidrd_buf_add_printf(&c->base, "%s", c->sysfs.name))
+                goto nomem;
+            c->desc = c->sysfs.desc.ptr;
+            c->size = c->sysfs.desc.len;
+            c->vid = c->sysfs.vid;
+            c->pid = c->sysfs.pid;
+        }
+        else
+        {
+            if (!hidrd_usbmon_scan_next(&c->usbmon))
+            {
+                if (c->usbmon.err != 0)
+                {
+                    fprintf(stderr, "%s: Failed to read capture: %s\n",
+                            path, c->usbmon.err == EINVAL
+                                    ? "invalid capture"
+                                    : strerror(c->usbmon.err));
+                    *pfailed = true;
+                }
+                coll_path_close(c);
+                continue;
+            }
+            base = strrchr(path, '/');
+            base = (base == NULL) ? path : base + 1;
+            if (!hidrd_buf_add_printf(&c->name, "%s:%u-%u-%u", path,
+                                      c->usbmon.bus, c->usbmon.dev,
+                                      c->usbmon.iface) ||
+                !hidrd_buf_add_printf(&c->base, "%s-%u-%u-%u", base,
+                                      c->usbmon.bus, c->usbmon.dev,
+                                      c->usbmon.iface))
+                goto nomem;
+            c->desc = c->usbmon.desc;
+            c->size = c->usbmon.desc_size;
+            c->vid = c->usbmon.vid;
+            c->pid = c->usbmon.pid;
+        }
+
+        return true;
+
+nomem:
+        fprintf(stderr, "%s: Failed to format descriptor name\n", path);
+        *pfailed = true;
+    }
+}
+
+
+/**
+ * Add descriptor files, or the descriptors of a collection, to a
+ * native descriptor archive, creating it if it doesn't exist; entries are
+ * named after the file paths, or the collection descriptor names.
+ *
+ * @param archive_name      Archive file name.
+ * @param input_fmt_name    Input format name.
+ * @param input_options     Input format options.
+ * @param input_list        Input file name list.
+ * @param input_num         Number of input file names.
+ * @param c                 Collection scanner to take the native
+ *                          descriptors from, instead of reading the
+ *                          input files, or NULL.
+ *
+ * @return Program exit status: zero if all the inputs were added, one
+ *         otherwise; the inputs which were read are added in any case.
+ */
+static int
+archive_build(const char           *archive_name,
+              const char           *input_fmt_name,
+              const char           *input_options,
+              const char * const   *input_list,
+              size_t                input_num,
+              coll                 *c)
+{
+    int                 result      = 1;
+    bool                failed      = false;
+    const hidrd_fmt    *input_fmt   = NULL;
+    hidrd_opt          *input_opts  = NULL;
+    hidrd_natv_arc_bld  bld;
+    hidrd_natv_arc      arc         = HIDRD_NATV_ARC_EMPTY;
+    hidrd_buf           desc        = HIDRD_BUF_EMPTY;
+    uint16_t            vid;
+    uint16_t            pid;
+    size_t              i;
+
+    hidrd_natv_arc_bld_init(&bld);
+
+    input_fmt = fmt_open(input_fmt_name, true);
+    if (input_fmt == NULL)
         goto cleanup;
+    input_opts = opts_compile(input_fmt, true, input_options);
+    if (input_opts == NULL)
+        goto cleanup;
+
+    if (hidrd_natv_arc_load(&arc, archive_name))
+    {
+        if (!hidrd_natv_arc_bld_add_arc(&bld, &arc))
+        {
+            fprintf(stderr, "Failed to read archive: %s\n",
+                    strerror(errno));
+            goto cleanup;
+        }
+        hidrd_natv_arc_unload(&arc);
     }
-    if (!hidrd_fmt_init(output_fmt))
+    else if (errno != ENOENT)
     {
-        fprintf(stderr, "Failed to initialize %s format library\n",
-                output_fmt->desc);
+        fprintf(stderr, "Failed to load archive: %s\n",
+                errno == EINVAL ? "invalid archive file" : strerror(errno));
+        goto cleanup;
+    }
+
+    while (c != NULL && coll_next(c, &failed))
+        if (!hidrd_natv_arc_bld_add(&bld, c->name.ptr, c->desc, c->size,
+                                    c->vid, c->pid))
+        {
+            fprintf(stderr, "Failed to add descriptor to archive: %s\n",
+                    strerror(errno));
+            goto cleanup;
+        }
+
+    for (i = 0; c == NULL && i < input_num; i++)
+    {
+        hidrd_buf_reset(&desc);
+        if (!read_desc(input_list[i], input_fmt, input_opts, &desc))
+        {
+            failed = true;
+            continue;
+        }
+        archive_name_id(input_list[i], &vid, &pid);
+        if (!hidrd_natv_arc_bld_add(&bld, input_list[i],
+                                    desc.ptr, desc.len, vid, pid))
+        {
+            fprintf(stderr, "Failed to add descriptor to archive: %s\n",
+                    strerror(errno));
+            goto cleanup;
+        }
+    }
+
+    if (!hidrd_natv_arc_store(&bld, archive_name))
+    {
+        fprintf(stderr, "Failed to store archive: %s\n", strerror(errno));
         goto cleanup;
     }
 
+    result = failed ? 1 : 0;
+
+cleanup:
+
+    hidrd_buf_clnp(&desc);
+    hidrd_natv_arc_unload(&arc);
+    hidrd_natv_arc_bld_clnp(&bld);
+    free(input_opts);
+    if (input_fmt != NULL)
+        hidrd_fmt_clnp(input_fmt);
+
+    return result;
+}
+
+
+/**
+ * List the entries of a native descriptor archive to standard output, a
+ * line per entry, with the vendor and product IDs, the descriptor size
+ * and the name.
+ *
+ * @param arc   Archive to list the entries of.
+ *
+ * @return Program exit status.
+ */
+static int
+archive_list(const hidrd_natv_arc *arc)
+{
+    const hidrd_natv_arc_ent   *ent;
+    size_t                      i;
+
+    for (i = 0; i < arc->hdr->ent_num; i++)
+    {
+        ent = hidrd_natv_arc_get(arc, i);
+        if (ent == NULL)
+        {
+            fprintf(stderr, "Archive entry #%zu is invalid\n", i + 1);
+            return 1;
+        }
+        if (printf("%04X:%04X %6u %s\n", ent->vid, ent->pid,
+                   ent->desc_size, hidrd_natv_arc_ent_name(arc, ent)) < 0)
+            return 1;
+    }
+
+    return 0;
+}
+
+
+/**
+ * Convert a descriptor.
+ *
+ * @param input_name        Input file name, or "-" for standard input;
+ *                          only used in messages if input_buf is not
+ *                          NULL.
+ * @param input_fmt         Initialized input format.
+ * @param input_opts        Input format options, compiled with
+ *                          opts_compile.
+ * @param input_buf         Input buffer to read in place instead of the
+ *                          input file, or NULL.
+ * @param input_size        Input buffer size.
+ * @param output_name       Output file name, or "-" for standard output.
+ * @param output_fmt        Initialized output format.
+ * @param output_opts       Output format options, compiled with
+ *                          opts_compile.
+ * @param cache_name        Layout cache file name to add the input layout
+ *                          to, or NULL.
+ *
+ * @return True if converted successfully, false otherwise.
+ */
+static bool
+convert(const char         *input_name,
+        const hidrd_fmt    *input_fmt,
+        const hidrd_opt    *input_opts,
+        const void         *input_buf,
+        size_t              input_size,
+
+        const char         *output_name,
+        const hidrd_fmt    *output_fmt,
+        const hidrd_opt    *output_opts,
+
+        const char         *cache_name)
+{
+    bool                result          = false;
+
+    int                 input_fd        = -1;
+    void               *read_buf        = NULL;
+    hidrd_src          *input           = NULL;
+
+    int                 output_fd       = -1;
+    void               *output_buf      = NULL;
+    size_t              output_size     = 0;
+    hidrd_snk          *output          = NULL;
+
+    hidrd_buf           cache_desc      = HIDRD_BUF_EMPTY;
+    hidrd_layout_cmpl   cache_cmpl;
+    bool                cache_cmpl_init = false;
+    hidrd_layout       *cache_layout    = NULL;
+
+    const hidrd_item   *item;
+
+    char               *err             = NULL;
+    size_t              pos;
+    char               *posstr          = NULL;
+
+    assert(input_name != NULL);
+    assert(*input_name != '\0');
+    assert(input_fmt != NULL);
+    assert(input_opts != NULL);
+
+    assert(output_name != NULL);
+    assert(*output_name != '\0');
+    assert(output_fmt != NULL);
+    assert(output_opts != NULL);
+
     /*
      * Open input and output files
      */
-    if (input_name[0] == '-' && input_name[1] == '\0')
+    if (input_buf != NULL)
+        ;
+    else if (input_name[0] == '-' && input_name[1] == '\0')
         input_fd = STDIN_FILENO;
     else
     {
@@ -303,19 +910,24 @@ process(const char *input_name,
     }
 
     /*
-     * Read the whole input file
+     * Read the whole input file, unless reading a buffer in place
      */
-    if (!hidrd_fd_read_whole(input_fd, &input_buf, &input_size))
+    if (input_buf == NULL)
     {
-        fprintf(stderr, "Failed to read input: %s\n", strerror(errno));
-        goto cleanup;
+        if (!hidrd_fd_read_whole(input_fd, &read_buf, &input_size))
+        {
+            fprintf(stderr, "Failed to read input: %s\n",
+                    strerror(errno));
+            goto cleanup;
+        }
+        input_buf = read_buf;
     }
 
     /*
      * Open input and output streams
      */
-    input = hidrd_src_new_opts(input_fmt->src, &err,
-                               input_buf, input_size, input_options);
+    input = hidrd_src_new_opt_list(input_fmt->src, &err,
+                                   input_buf, input_size, input_opts);
     if (input == NULL)
     {
         fprintf(stderr, "Failed to open input stream:\n%s\n", err);
@@ -324,8 +936,8 @@ process(const char *input_name,
     free(err);
     err = NULL;
 
-    output = hidrd_snk_new_opts(output_fmt->snk, &err,
-                                &output_buf, &output_size, output_options);
+    output = hidrd_snk_new_opt_list(output_fmt->snk, &err,
+                                    &output_buf, &output_size, output_opts);
     if (output == NULL)
     {
         fprintf(stderr, "Failed to open output stream:\n%s\n", err);
@@ -334,17 +946,38 @@ process(const char *input_name,
     free(err);
     err = NULL;
 
+    if (cache_name != NULL)
+    {
+        if (!hidrd_layout_cmpl_init(&cache_cmpl))
+        {
+            fprintf(stderr, "Failed to initialize layout compiler\n");
+            goto cleanup;
+        }
+        cache_cmpl_init = true;
+    }
+
     /*
      * Transfer the stream
      */
     while (pos = hidrd_src_getpos(input),
            ((item = hidrd_src_get(input)) != NULL))
+    {
         if (!hidrd_snk_put(output, item))
         {
             fprintf(stderr, "Failed to write output stream:\n%s\n",
                     (err = hidrd_snk_errmsg(output)));
             goto cleanup;
         }
+        if (cache_cmpl_init &&
+            (!hidrd_buf_add_ptr(&cache_desc, item,
+                                hidrd_item_get_size(item)) ||
+             !hidrd_layout_cmpl_put(&cache_cmpl, item)))
+        {
+            fprintf(stderr, "Failed to compile input layout:\n%s\n",
+                    (err = hidrd_layout_cmpl_errmsg(&cache_cmpl)));
+            goto cleanup;
+        }
+    }
 
     if (hidrd_src_error(input))
     {
@@ -377,8 +1010,25 @@ process(const char *input_name,
         goto cleanup;
     }
 
+    /*
+     * Add the input layout to the cache
+     */
+    if (cache_cmpl_init)
+    {
+        cache_layout = hidrd_layout_cmpl_finish(&cache_cmpl);
+        if (cache_layout == NULL)
+        {
+            fprintf(stderr, "Failed to compile input layout:\n%s\n",
+                    (err = hidrd_layout_cmpl_errmsg(&cache_cmpl)));
+            goto cleanup;
+        }
+        if (!cache_add(cache_name, cache_desc.ptr, cache_desc.len,
+                       cache_layout))
+            goto cleanup;
+    }
+
     /* Success! */
-    result = 0;
+    result = true;
 
 cleanup:
 
@@ -388,14 +1038,168 @@ cleanup:
     hidrd_src_delete(input);
     hidrd_snk_delete(output);
 
+    hidrd_layout_delete(cache_layout);
+    if (cache_cmpl_init)
+        hidrd_layout_cmpl_clnp(&cache_cmpl);
+    hidrd_buf_clnp(&cache_desc);
+
     free(output_buf);
-    free(input_buf);
+    free(read_buf);
 
     if (input_fd >= 0 && input_fd != STDIN_FILENO)
         close(input_fd);
     if (output_fd >= 0 && output_fd != STDOUT_FILENO)
         close(output_fd);
 
+    return result;
+}
+
+
+/**
+ * Convert a descriptor, looking up and initializing the formats.
+ *
+ * @param input_name        Input file name, or "-" for standard input.
+ * @param input_fmt_name    Input format name.
+ * @param input_options     Input format options.
+ * @param input_buf         Input buffer to read in place instead of the
+ *                          input file, or NULL.
+ * @param input_size        Input buffer size.
+ * @param output_name       Output file name, or "-" for standard output.
+ * @param output_fmt_name   Output format name.
+ * @param output_options    Output format options.
+ * @param cache_name        Layout cache file name to add the input layout
+ *                          to, or NULL.
+ *
+ * @return Program exit status.
+ */
+static int
+process(const char *input_name,
+        const char *input_fmt_name,
+        const char *input_options,
+        const void *input_buf,
+        size_t      input_size,
+
+        const char *output_name,
+        const char *output_fmt_name,
+        const char *output_options,
+
+        const char *cache_name)
+{
+    int                 result      = 1;
+    const hidrd_fmt    *input_fmt   = NULL;
+    hidrd_opt          *input_opts  = NULL;
+    const hidrd_fmt    *output_fmt  = NULL;
+    hidrd_opt          *output_opts = NULL;
+
+    assert(input_fmt_name != NULL);
+    assert(*input_fmt_name != '\0');
+    assert(output_fmt_name != NULL);
+    assert(*output_fmt_name != '\0');
+
+    input_fmt = fmt_open(input_fmt_name, true);
+    if (input_fmt == NULL)
+        goto cleanup;
+    output_fmt = fmt_open(output_fmt_name, false);
+    if (output_fmt == NULL)
+        goto cleanup;
+    input_opts = opts_compile(input_fmt, true, input_options);
+    if (input_opts == NULL)
+        goto cleanup;
+    output_opts = opts_compile(output_fmt, false, output_options);
+    if (output_opts == NULL)
+        goto cleanup;
+
+    if (convert(input_name, input_fmt, input_opts,
+                input_buf, input_size,
+                output_name, output_fmt, output_opts,
+                cache_name))
+        result = 0;
+
+cleanup:
+
+    free(output_opts);
+    free(input_opts);
+    if (output_fmt != NULL)
+        hidrd_fmt_clnp(output_fmt);
+    if (input_fmt != NULL)
+        hidrd_fmt_clnp(input_fmt);
+
+    return result;
+}
+
+
+/**
+ * Convert the native descriptors of a collection, writing each to a
+ * separate file in an output directory, named after the descriptor and
+ * the output format, e.g. "hidraw0.xml".
+ *
+ * @param c                 Collection scanner to take the descriptors
+ *                          from.
+ * @param output_dir        Output directory.
+ * @param output_fmt_name   Output format name.
+ * @param output_options    Output format options.
+ * @param cache_name        Layout cache file name to add the input
+ *                          layouts to, or NULL.
+ *
+ * @return Program exit status: zero if all the descriptors were
+ *         converted, one otherwise.
+ */
+static int
+harvest(coll       *c,
+        const char *output_dir,
+        const char *output_fmt_name,
+        const char *output_options,
+        const char *cache_name)
+{
+    int                 result      = 1;
+    bool                failed      = false;
+    const hidrd_fmt    *input_fmt   = NULL;
+    hidrd_opt          *input_opts  = NULL;
+    const hidrd_fmt    *output_fmt  = NULL;
+    hidrd_opt          *output_opts = NULL;
+    hidrd_buf           output_name = HIDRD_BUF_EMPTY;
+
+    input_fmt = fmt_open("natv", true);
+    if (input_fmt == NULL)
+        goto cleanup;
+    output_fmt = fmt_open(output_fmt_name, false);
+    if (output_fmt == NULL)
+        goto cleanup;
+    input_opts = opts_compile(input_fmt, true, "");
+    if (input_opts == NULL)
+        goto cleanup;
+    output_opts = opts_compile(output_fmt, false, output_options);
+    if (output_opts == NULL)
+        goto cleanup;
+
+    while (coll_next(c, &failed))
+    {
+        hidrd_buf_reset(&output_name);
+        if (!hidrd_buf_add_printf(&output_name, "%s/%s.%s",
+                                  output_dir, (const char *)c->base.ptr,
+                                  output_fmt->name))
+        {
+            fprintf(stderr, "Failed to format output file name\n");
+            goto cleanup;
+        }
+
+        if (!convert(c->name.ptr, input_fmt, input_opts, c->desc, c->size,
+                     output_name.ptr, output_fmt, output_opts,
+                     cache_name))
+        {
+            fprintf(stderr, "%s: Failed to convert descriptor\n",
+                    (const char *)c->name.ptr);
+            failed = true;
+        }
+    }
+
+    result = failed ? 1 : 0;
+
+cleanup:
+
+    hidrd_buf_clnp(&output_name);
+    free(output_opts);
+    free(input_opts);
     if (output_fmt != NULL)
         hidrd_fmt_clnp(output_fmt);
     if (input_fmt != NULL)
@@ -408,6 +1212,11 @@ cleanup:
 typedef enum opt_val {
     /* Long and short options */
     OPT_VAL_HELP           = 'h',
+    OPT_VAL_CACHE          = 'c',
+    OPT_VAL_BUILD          = 'b',
+    OPT_VAL_EXTRACT        = 'x',
+    OPT_VAL_SYSFS          = 's',
+    OPT_VAL_USBMON         = 'u',
     OPT_VAL_INPUT_FORMAT   = 'i',
     OPT_VAL_OUTPUT_FORMAT  = 'o',
 
@@ -467,20 +1276,56 @@ main(int argc, char **argv)
          .has_arg   = required_argument,
          .flag      = NULL},
 
+        {.val       = OPT_VAL_CACHE,
+         .name      = "cache",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_BUILD,
+         .name      = "build",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_EXTRACT,
+         .name      = "extract",
+         .has_arg   = required_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_SYSFS,
+         .name      = "sysfs",
+         .has_arg   = optional_argument,
+         .flag      = NULL},
+
+        {.val       = OPT_VAL_USBMON,
+         .name      = "usbmon",
+         .has_arg   = no_argument,
+         .flag      = NULL},
+
         {.val       = 0,
          .name      = NULL,
          .has_arg   = 0,
          .flag      = NULL}
     };
-    static const char  *short_opt_list = "hi:o:";
-
-    const char *input_name      = "-";
-    const char *output_name     = "-";
-    const char *input_format    = "natv";
-    const char *input_options   = "";
-    const char *output_format   = "natv";
-    const char *output_options  = "";
-    int         c;
+    static const char  *short_opt_list = "hi:o:c:b:x:s::u";
+
+    const char     *input_name      = "-";
+    const char     *output_name     = "-";
+    const char     *input_format    = "natv";
+    const char     *input_options   = "";
+    const char     *output_format   = "natv";
+    const char     *output_options  = "";
+    const char     *cache_name      = NULL;
+    const char     *build_name      = NULL;
+    const char     *extract_name    = NULL;
+    const char     *sysfs_root      = NULL;
+    bool            usbmon          = false;
+    bool            collect         = false;
+    coll            coll_scan;
+    bool            list            = false;
+    hidrd_natv_arc  arc             = HIDRD_NATV_ARC_EMPTY;
+    const hidrd_natv_arc_ent   *ent;
+    int             result;
+    int             c;
 
     /*
      * Parse command line arguments
@@ -510,6 +1355,21 @@ main(int argc, char **argv)
             case OPT_VAL_OUTPUT_OPTIONS:
                 output_options = optarg;
                 break;
+            case OPT_VAL_CACHE:
+                cache_name = optarg;
+                break;
+            case OPT_VAL_BUILD:
+                build_name = optarg;
+                break;
+            case OPT_VAL_EXTRACT:
+                extract_name = optarg;
+                break;
+            case OPT_VAL_SYSFS:
+                sysfs_root = (optarg != NULL) ? optarg : HIDRD_SYSFS_ROOT;
+                break;
+            case OPT_VAL_USBMON:
+                usbmon = true;
+                break;
             case '?':
                 usage(stderr, program_invocation_short_name);
                 return 1;
@@ -517,10 +1377,135 @@ main(int argc, char **argv)
         }
     }
 
+    /*
+     * Verify descriptor collection arguments
+     */
+    if (sysfs_root != NULL || usbmon)
+    {
+        if (sysfs_root != NULL && usbmon)
+        {
+            fprintf(stderr, "Can't read sysfs and usbmon captures "
+                            "at once\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        if (sysfs_root != NULL && *sysfs_root == '\0')
+        {
+            fprintf(stderr, "Empty sysfs root directory name\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        if (extract_name != NULL)
+        {
+            fprintf(stderr, "Can't read %s and extract at once\n",
+                    usbmon ? "usbmon captures" : "sysfs");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        if (strcmp(input_format, "natv") != 0)
+        {
+            fprintf(stderr, "%s descriptors can only be read "
+                            "in native format\n",
+                    usbmon ? "usbmon" : "sysfs");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        /* Count the positional parameters left for input */
+        c = argc - optind - (build_name != NULL ? 0 : 1);
+        if (c < 0)
+        {
+            fprintf(stderr, "Output directory must be specified\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        if (usbmon ? c == 0 : c > 0)
+        {
+            fprintf(stderr, usbmon ? "Capture files must be specified\n"
+                                   : "Too many arguments\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        if (usbmon)
+            coll_init(&coll_scan, COLL_TYPE_USBMON,
+                      (const char * const *)(argv + optind), c);
+        else
+            coll_init(&coll_scan, COLL_TYPE_SYSFS, &sysfs_root, 1);
+        collect = true;
+    }
+
+    /*
+     * Verify archive arguments and build an archive
+     */
+    if (build_name != NULL || extract_name != NULL)
+    {
+        if (build_name != NULL && extract_name != NULL)
+        {
+            fprintf(stderr, "Can't build and extract at once\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        if (*(build_name != NULL ? build_name : extract_name) == '\0')
+        {
+            fprintf(stderr, "Empty archive file name\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+    }
+    if (build_name != NULL)
+    {
+        if (cache_name != NULL)
+        {
+            fprintf(stderr, "Can't add to layout cache "
+                            "when building an archive\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        if (*input_format == '\0')
+        {
+            fprintf(stderr, "Empty input format name\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        for (c = optind; c < argc; c++)
+            if (*argv[c] == '\0')
+            {
+                fprintf(stderr, "Empty input file name\n");
+                usage(stderr, program_invocation_short_name);
+                return 1;
+            }
+        if (collect)
+        {
+            result = archive_build(build_name, input_format, input_options,
+                                   NULL, 0, &coll_scan);
+            coll_clnp(&coll_scan);
+            return result;
+        }
+        else if (optind < argc)
+            return archive_build(build_name, input_format, input_options,
+                                 (const char * const *)(argv + optind),
+                                 argc - optind, NULL);
+        else
+            return archive_build(build_name, input_format, input_options,
+                                 &input_name, 1, NULL);
+    }
+    if (extract_name != NULL)
+    {
+        if (strcmp(input_format, "natv") != 0)
+        {
+            fprintf(stderr, "Archive entries can only be read "
+                            "in native format\n");
+            usage(stderr, program_invocation_short_name);
+            return 1;
+        }
+        list = (optind >= argc);
+    }
+
     /*
      * Assign positional parameters
      */
-    if (optind < argc)
+    if (collect)
+        output_name = argv[argc - 1];
+    else if (optind < argc)
     {
         input_name = argv[optind++];
         if (optind < argc)
@@ -562,12 +1547,55 @@ main(int argc, char **argv)
         usage(stderr, program_invocation_short_name);
         return 1;
     }
+    if (cache_name != NULL && *cache_name == '\0')
+    {
+        fprintf(stderr, "Empty cache file name\n");
+        usage(stderr, program_invocation_short_name);
+        return 1;
+    }
 
     /*
      * Run
      */
-    return process(input_name, input_format, input_options,
-                   output_name, output_format, output_options);
+    if (collect)
+    {
+        result = harvest(&coll_scan, output_name,
+                         output_format, output_options, cache_name);
+        coll_clnp(&coll_scan);
+        return result;
+    }
+    if (extract_name == NULL)
+        return process(input_name, input_format, input_options, NULL, 0,
+                       output_name, output_format, output_options,
+                       cache_name);
+
+    if (!hidrd_natv_arc_load(&arc, extract_name))
+    {
+        fprintf(stderr, "Failed to load archive: %s\n",
+                errno == EINVAL ? "invalid archive file" : strerror(errno));
+        return 1;
+    }
+    if (list)
+        result = archive_list(&arc);
+    else
+    {
+        ent = hidrd_natv_arc_lookup(&arc, input_name);
+        if (ent == NULL)
+        {
+            fprintf(stderr, "Archive entry \"%s\" not found\n",
+                    input_name);
+            result = 1;
+        }
+        else
+            result = process(input_name, input_format, input_options,
+                             hidrd_natv_arc_ent_desc(&arc, ent),
+                             ent->desc_size,
+                             output_name, output_format, output_options,
+                             cache_name);
+    }
+    hidrd_natv_arc_unload(&arc);
+
+    return result;
 }
 
 